@@ -0,0 +1,47 @@
+AR = ['/usr/bin/ar']
+ARFLAGS = ['rcs']
+BINDIR = '/usr/local/bin'
+BUILD = 'debug'
+CC = ['/usr/bin/gcc']
+CCLNK_SRC_F = []
+CCLNK_TGT_F = ['-o']
+CC_NAME = 'gcc'
+CC_SRC_F = []
+CC_TGT_F = ['-c', '-o']
+CC_VERSION = ('12', '2', '0')
+CFLAGS = ['-pipe', '-g', '-O0', '-fPIC']
+CFLAGS_MACBUNDLE = ['-fPIC']
+CFLAGS_cshlib = ['-fPIC']
+COMPILER_CC = 'gcc'
+CPPPATH_ST = '-I%s'
+DEFINES_ST = '-D%s'
+DEST_BINFMT = 'elf'
+DEST_CPU = 'x86_64'
+DEST_OS = 'linux'
+GVER = '/root/repo/build_helpers/gen_version.rb'
+GVER_FLAGS = ['']
+LIB = ['util', 'rt', 'pthread', 'm', 'dl', 'm', 'm']
+LIBDIR = '/usr/local/lib64'
+LIBPATH = []
+LIBPATH_ST = '-L%s'
+LIB_ST = '-l%s'
+LINKFLAGS = ['-g', '-w']
+LINKFLAGS_MACBUNDLE = ['-bundle', '-undefined', 'dynamic_lookup']
+LINKFLAGS_cshlib = ['-shared']
+LINKFLAGS_cstlib = ['-Wl,-Bstatic']
+LINK_CC = ['/usr/bin/gcc']
+NO_WARNINGS = []
+PREFIX = '/usr/local'
+RPATH_ST = '-Wl,-rpath,%s'
+RUBY = ['/root/.rbenv/shims/ruby']
+SHLIB_MARKER = '-Wl,-Bdynamic'
+SHOW_COMMANDS = 'no'
+SONAME_ST = '-Wl,-h,%s'
+STLIBPATH_ST = '-L%s'
+STLIB_MARKER = '-Wl,-Bstatic'
+STLIB_ST = '-l%s'
+WARNINGS = ['-Wall']
+cprogram_PATTERN = '%s'
+cshlib_PATTERN = 'lib%s.so'
+cstlib_PATTERN = 'lib%s.a'
+macbundle_PATTERN = '%s.bundle'
@@ -0,0 +1,20 @@
+/* xia_version.h -- AUTOGENERATED
+ *
+ * Generated by gen_version.rb on 2026-10-16T04:45:11+00:00
+ */
+
+#ifndef XIA_VERSION_H
+#define XIA_VERSION_H
+
+#define XERXES_MAJOR_VERSION 1
+#define XERXES_MINOR_VERSION 1
+#define XERXES_RELEASE_VERSION 22
+
+#define HANDEL_MAJOR_VERSION 1
+#define HANDEL_MINOR_VERSION 1
+#define HANDEL_RELEASE_VERSION 22
+
+#define VERSION_STRING ""
+
+#endif /* __XIA_VERSION_H__ */
+
@@ -36,6 +36,8 @@
 #ifndef FALCON_MM_H
 #define FALCON_MM_H
 
+#include "lmbuf.h"
+
 /*
  * FalconX Mapping Mode Buffering Support.
  */
@@ -73,8 +75,13 @@
  * Data formatter structures.
  *
  * All levels are counts of uint32_t and not byte offsets.
+ *
+ * The buffers are a ring. The user only sees the A/B pair of the Active
+ * buffer and the one following it. Any extra buffers hold full data
+ * while the user reads out the Active buffer.
  */
-#define MMC_BUFFERS (2)
+#define MMC_BUFFERS     (2)
+#define MMC_BUFFERS_MAX (16)
 
 /*
  * Number of bytes per double value in mapping buffer header
@@ -116,18 +123,23 @@ typedef struct
 } MM_Rois;
 
 /*
- * A buffer is one of 2 output buffers accessed by the Handel user. The buffer
- * is large enough to hold the required number of pixels and any pixel header.
+ * A buffer is one of the ring of output buffers accessed by the Handel
+ * user. The buffer is large enough to hold the required number of pixels
+ * and any pixel header.
  */
 typedef struct
 {
     boolean_t full;           /* The buffer is full. */
     boolean_t done;           /* The buffer is done and can be used again. */
+    boolean_t borrowed;       /* The user holds a pointer to the data. */
+    boolean_t posted;         /* The buffer's completion has been posted. */
+    uint32_t  firstPixel;     /* The run pixel number of the first pixel. */
     uint32_t  bufferPixel;    /* The pixel count in buffer. */
     uint32_t  drops;          /* Count of skipped pixels, TCP backpressure or UDP loss. */
     size_t    next;           /* The next value to read. */
     size_t    level;          /* The amount of data in the buffer. */
     size_t    marker;         /* Buffer marker. */
+    size_t    lent;           /* Start of the borrowed data. */
     uint32_t* buffer;         /* The buffer. */
     size_t    size;           /* uint32_t units, not bytes. */
 } MM_Buffer;
@@ -135,23 +147,40 @@ typedef struct
 typedef struct
 {
     int       active;         /* The active buffer index. */
+    int       fill;           /* The next buffer index, being filled. */
+    int       count;          /* The number of buffers in the ring. */
+    uint32_t  activeNumber;   /* The count of buffers made active, labels A/B. */
     uint32_t  bufferNumber;   /* The count of buffers processed */
     uint32_t  pixel;          /* The pixel number. */
     uint32_t  numPixels;      /* The number of pixels in a run. */
     uint32_t  bufferOverruns; /* Count of buffer overruns */
     boolean_t stopped;        /* The run was stopped. Allow partial readout. */
-    MM_Buffer buffer[MMC_BUFFERS];
+    MM_Buffer buffer[MMC_BUFFERS_MAX];
 } MM_Buffers;
 
 /*
  * Binner flags.
  */
 #define MM_BINNER_GATE_HIGH      (1 << 0)   /* Gate 1 for trigger. */
+#define MM_BINNER_GATE_COLLECT_LO (1 << 1)  /* Collect while the gate is 0. */
+#define MM_BINNER_ADVANCE_SYNC   (1 << 2)   /* Spatial (SYNC) pixel advance. */
 #define MM_BINNER_GATE_TRIGGER   (1 << 16)  /* Gate has been triggered. */
 #define MM_BINNER_STATS_VALID    (1 << 17)  /* The stats are valid. */
 
 #define MM_BINNER_PIXEL_VALID(_b) \
-    (((_b)->flags ^ (MM_BINNER_GATE_TRIGGER | MM_BINNER_STATS_VALID)) == 0)
+    (((_b)->flags & (MM_BINNER_GATE_TRIGGER | MM_BINNER_STATS_VALID)) == \
+     (MM_BINNER_GATE_TRIGGER | MM_BINNER_STATS_VALID))
+
+/*
+ * Binner error bits.
+ */
+#define MM_BINNER_ERROR_CORRUPT  (1 << 0)   /* Corrupt list mode data skipped. */
+#define MM_BINNER_ERROR_OVERFLOW (1 << 1)   /* The box's list mode buffer overflowed. */
+
+/*
+ * Pulses decoded from the list mode stream at a time.
+ */
+#define MM_BINNER_PULSES (1024)
 
 /*
  * The binner takes the list mode data stream from the SiToro API and converts
@@ -163,11 +192,16 @@ typedef struct
     uint32_t  flags;         /* State flags. */
     size_t    numberOfBins;  /* The number of bins. */
     uint64_t* bins;          /* The bins. */
+    uint32_t  binShift;      /* Pulse amplitude to bin shift, the coarse bin scaling. */
     uint64_t  outOfRange;    /* Count of energy levels out of range. */
+    uint64_t  pulses;        /* Count of pulses binned in the pixel. */
     uint32_t  errorBits;     /* Error bits returned from the List API. */
     uint64_t  timestamp;     /* Current timestamp. */
-    void*     stats;         /* Extracted stats. */
+    LmStats   stats;         /* Extracted stats. */
     /* Input buffering of data from SiToro */
+    LmBuf     lm;            /* The list mode input. */
+    int32_t*  amplitude;     /* Decoded pulse amplitudes. */
+    uint8_t*  pulseFlags;    /* Decoded pulse flags. */
     uint32_t* buffer;        /* Output buffer. */
     size_t    bufferSize;    /* The size of the buffer */
     size_t    bufferLevel;   /* The level of data in the buffer. */
@@ -223,6 +257,7 @@ int psl__MappingModeBuffer_B(void);
  * Mapping Mode Buffers
  */
 int       psl__MappingModeBuffers_Open(MM_Buffers* buffers,
+                                       int         count,
                                        size_t      size,
                                        int64_t     numPixels);
 int       psl__MappingModeBuffers_Close(MM_Buffers* buffers);
@@ -270,15 +305,28 @@ void      psl__MappingModeBuffers_Active_MoveLevel(MM_Buffers* buffers, size_t l
 size_t    psl__MappingModeBuffers_Active_Remaining(MM_Buffers* buffers);
 uint32_t  psl__MappingModeBuffers_Active_Pixels(MM_Buffers* buffers);
 uint32_t  psl__MappingModeBuffers_Active_PixelTotal(MM_Buffers* buffers);
+uint32_t  psl__MappingModeBuffers_Active_FirstPixel(MM_Buffers* buffers);
+uint32_t  psl__MappingModeBuffers_Active_Drops(MM_Buffers* buffers);
+boolean_t psl__MappingModeBuffers_Active_Complete(MM_Buffers* buffers);
 boolean_t psl__MappingModeBuffers_Active_Done(MM_Buffers* buffers);
 void      psl__MappingModeBuffers_Active_SetDone(MM_Buffers* buffers);
+boolean_t psl__MappingModeBuffers_Active_Borrowed(MM_Buffers* buffers);
 
 /*
  * Copy in and out. The buffers used is fixed.
  */
-int psl__MappingModeBuffers_CopyIn(MM_Buffers* buffers, void* value, size_t size);
+int psl__MappingModeBuffers_CopyIn(MM_Buffers* buffers, const void* value, size_t size);
 int psl__MappingModeBuffers_CopyOut(MM_Buffers* buffers,  void* value, size_t* size);
 
+/*
+ * Borrow and release the Active buffer's data in place. Only a full
+ * Active that is not done can be borrowed. The data stays valid until it
+ * is released. A borrowed buffer cannot be cleared, swapped or closed.
+ */
+int psl__MappingModeBuffers_Borrow(MM_Buffers* buffers, const uint32_t** data, size_t* size);
+int psl__MappingModeBuffers_Borrowed(MM_Buffers* buffers, size_t* size);
+int psl__MappingModeBuffers_Release(MM_Buffers* buffers);
+
 /*
  * Mapping Mode Binner.
  */
@@ -288,9 +336,15 @@ int psl__MappingModeBinner_Close(MM_Binner* binner);
 int psl__MappingModeBinner_BinAdd(MM_Binner* binner,
                                   uint32_t   bin,
                                   uint32_t   amount);
+int psl__MappingModeBinner_AddData(MM_Binner*     binner,
+                                   const uint8_t* data,
+                                   size_t         size);
+int psl__MappingModeBinner_Bin(MM_Binner* binner, boolean_t* pixel);
+void psl__MappingModeBinner_PixelClear(MM_Binner* binner);
 int psl__MappingModeBinner_DataCopy(MM_Binner*      binner,
                                     MM_Buffers*     buffers);
 
+
 /*
  * Mapping Mode Control.
  */
@@ -310,7 +364,8 @@ int psl__MappingModeControl_OpenMM1(MM_Control* control,
                                     uint32_t    run_number,
                                     int64_t     num_pixels,
                                     uint16_t    number_mca_channels,
-                                    int64_t     num_pixels_buffer);
+                                    int64_t     num_pixels_buffer,
+                                    int         buffer_count);
 int psl__MappingModeControl_CloseMM1(MM_Control* control);
 MMC1_Data* psl__MappingModeControl_MM1Data(MM_Control* control);
 size_t psl__MappingModeControl_MM1BufferSize(uint16_t number_mca_channels,
@@ -319,7 +374,8 @@ size_t psl__MappingModeControl_MM1BufferSize(uint16_t number_mca_channels,
 int psl__MappingModeControl_OpenMM3(MM_Control* control,
                                     int         detChan,
                                     uint32_t    run_number,
-                                    size_t      buffer_size);
+                                    size_t      buffer_size,
+                                    int         buffer_count);
 int psl__MappingModeControl_CloseMM3(MM_Control* control);
 MMC3_Data* psl__MappingModeControl_MM3Data(MM_Control* control);
 size_t psl__MappingModeControl_MM3BufferSize(MM_Control* control);
@@ -338,6 +394,7 @@ void psl__WriteDbl(uint16_t* buffer, double value);
 int psl__XMAP_WriteBufferHeader_MM1(MMC1_Data* mm1);
 int psl__XMAP_UpdateBufferHeader_MM1(MMC1_Data* mm1);
 int psl__XMAP_WritePixelHeader_MM1(MMC1_Data* mm1, MM_Pixel_Stats* stats);
+int psl__XMAP_WriteBinnerPixel_MM1(MMC1_Data* mm1, MM_Pixel_Stats* stats);
 
 int psl__XMAP_WriteBufferHeader_MM3(MMC3_Data* mm3);
 int psl__XMAP_UpdateBufferHeader_MM3(MMC3_Data* mm3);
@@ -74,6 +74,24 @@
  */
 #define FALCONXN_RESPONSE_TIMEOUT (2)
 
+/*
+ * Receive reactor limits. The events are the ready sockets handled per
+ * wait and the batch is the packets read from a module before moving on
+ * to the next ready module. The stop timeout is in msecs.
+ */
+#define FALCONXN_REACTOR_EVENTS       (32)
+#define FALCONXN_REACTOR_BATCH        (64)
+#define FALCONXN_REACTOR_STOP_TIMEOUT (2000)
+
+/*
+ * Receive arena sizes in bytes. A histogram packet holds the accepted
+ * and rejected spectra as varints of up to 5 bytes a bin plus the
+ * statistics and encoding overhead. List mode data arrives in blocks.
+ */
+#define FALCONXN_ARENA_BIN_SIZE           (2 * 5)
+#define FALCONXN_ARENA_HISTOGRAM_OVERHEAD (1024)
+#define FALCONXN_ARENA_LIST_MODE_SIZE     (16 * 1024)
+
 /*
  * Sinc response handle. This allows us to map the response back to
  * the type and so the call to free a response.
@@ -85,6 +103,57 @@ typedef struct
     void* response;
 } Sinc_Response;
 
+/*
+ * Transactions. A request sent to the module is tagged with the next
+ * request id and held in the module's transaction table until its
+ * response is collected. The Sinc protocol has no request ids; the
+ * connection is a stream and the FalconXN answers commands in order, so
+ * a response completes the oldest unanswered request. Each request
+ * records the response type and channel it expects. A response that does
+ * not match the oldest request resyncs the table by failing the older
+ * requests whose responses were lost. Many requests can be in flight at
+ * once.
+ */
+#define FALCONXN_TRANSACTIONS (64)
+
+typedef enum {
+    TransactionFree,
+    TransactionWaiting,  /* Sent. The sender collects the response. */
+    TransactionDeferred, /* Sent. The response is checked on receipt. */
+    TransactionDiscard,  /* Sent. The sender stopped waiting. */
+    TransactionDone      /* Response received and not collected. */
+} TransactionState;
+
+typedef struct
+{
+    TransactionState state;
+    int              status;
+    int              channel; /* Expected response channel, -1 for any. */
+    int              type;    /* Expected response type, -1 for any. */
+    Sinc_Response    response;
+    char             what[64];
+} Sinc_Transaction;
+
+/*
+ * Dirty parameters. Parameter sets made in a pipeline are held in the
+ * module's dirty set and sent in order, one SetParams message for each
+ * run of sets to a channel, when the pipeline ends or before any other
+ * request. A later set of a key updates the earlier one in place. The key
+ * and any string value are copied so the caller's storage can be released
+ * once the set returns.
+ */
+#define FALCONXN_DIRTY_PARAMS  (64)
+#define FALCONXN_DIRTY_STR_LEN (64)
+
+typedef struct
+{
+    int                    channel;
+    SiToro__Sinc__KeyValue kv;
+    char                   key[FALCONXN_DIRTY_STR_LEN];
+    char                   str[FALCONXN_DIRTY_STR_LEN];
+    boolean_t              option; /* str is the option value */
+} Sinc_DirtyParam;
+
 /* The state of the Sinc channel. This tracks the Sinc parameter channel.state
  * and allows the PSL to remember whether it started a run, characterization, etc.
  */
@@ -258,37 +327,106 @@ struct _FalconXNModule {
      */
     handel_md_Mutex lock;
 
-    /* Module's Sinc data receiver thread.
+    /* Module's receive controls. The module is running while its
+     * sockets are attached to the receive reactor.
      */
-    handel_md_Thread receiver;
-
-    /* Module's receive thread controls.
-     */
-    boolean_t receiverActive;
     boolean_t receiverRunning;
 
-    /* Module's receiver event.
+    /* The sockets attached to the reactor and the next module in the
+     * reactor's list. The datagram socket is -1 if not attached.
+     */
+    int     reactorFd;
+    int     reactorDatagramFd;
+    Module* reactorNext;
+
+    /* The module is to be dispatched in the reactor's next pass. It is
+     * set when the poller reports a socket ready and kept set while a
+     * dispatch stops at the batch limit, as Sinc may hold packets in its
+     * read buffer the poller cannot see.
      */
-    handel_md_Event receiverEvent;
+    boolean_t reactorPending;
 
-    /* Lock to make all sends sequential. The event is awaited by the
-     * sender and signalled by the receive processor.
+    /* Lock held by a sender for a transaction or a pipeline. The event
+     * is awaited by the sender and signalled by the receive processor
+     * for each response.
      */
     handel_md_Mutex sendLock;
     handel_md_Event sendEvent;
-    int             sendStatus;
 
-    /* Response comes from the receive thread, which decodes the data
-     * from the FalconXN and places the response here. Commands and
-     * responses are sequential so we only need a single instance.
+    /* The transaction table. Ids are allocated from requestNext. Ids from
+     * requestOldest to requestAnswered have responses and ids from
+     * requestAnswered to requestNext are in flight. The send id is the
+     * request of the current sequential transaction.
+     */
+    Sinc_Transaction transactions[FALCONXN_TRANSACTIONS];
+    uint32_t         requestNext;
+    uint32_t         requestOldest;
+    uint32_t         requestAnswered;
+    uint32_t         sendId;
+
+    /* Pipelining. While the depth is not 0 parameter sets do not wait for
+     * their responses. The status holds the first deferred error.
+     */
+    int pipeline;
+    int pipelineStatus;
+
+    /* The dirty set. Only the pipeline's owner touches it. */
+    Sinc_DirtyParam dirty[FALCONXN_DIRTY_PARAMS];
+    int             dirtyCount;
+    uint64_t        dirtySets;
+    uint64_t        dirtyMessages;
+
+    /* The receive arena. Received packets are placed in the arena so
+     * the receive path does not allocate. A packet larger than the
+     * arena overflows to the heap and the arena grows to hold it.
      */
-    Sinc_Response response;
+    uint8_t* arena;
+    size_t   arenaSize;
+    uint64_t arenaPackets;
+    uint64_t arenaOverflows;
 
     /* One Sinc connection for the module.
      */
     Sinc sinc;
 };
 
+/*
+ * The receive reactor. A single thread waits on the sockets of all
+ * modules and dispatches the received Sinc packets to the module's
+ * receive processor. It runs while any module is attached. The locks
+ * are created when the PSL is initialised and live for the process.
+ */
+typedef struct _FalconXNReactor {
+    /* Serializes attaching and detaching modules so the reactor is not
+     * started while the last detach is stopping it. It is taken before
+     * the lock. The reactor thread does not take it.
+     */
+    handel_md_Mutex control;
+
+    /* Lock for the module list and the thread controls. It is taken
+     * before a module's lock.
+     */
+    handel_md_Mutex lock;
+
+    /* Waits for any attached socket to be readable.
+     */
+    handel_md_Poller poller;
+
+    /* The reactor thread, its controls and the event it signals on
+     * exit.
+     */
+    handel_md_Thread thread;
+    boolean_t        active;
+    handel_md_Event  stopped;
+
+    /* The attached modules and the number left pending by the last
+     * pass. The poller does not wait while any are pending.
+     */
+    Module* modules;
+    int     attached;
+    int     pending;
+} FalconXNReactor;
+
 /*
  * The SiToro Detector PSL Data.
  */
@@ -355,6 +493,11 @@ struct _FalconXNDetector {
 
     /* Mapping Mode control. */
     MM_Control mmc;
+
+    /* The mapping_mode acquisition value, cached when it is set so run
+     * data can be dispatched without reading the defaults.
+     */
+    MM_Mode mappingMode;
 };
 
 #endif /* FALCONXN_PSL_H */
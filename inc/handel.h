@@ -99,6 +99,17 @@ extern "C" {
     HANDEL_IMPORT int HANDEL_API xiaStartRun(int detChan, unsigned short resume);
     HANDEL_IMPORT int HANDEL_API xiaStopRun(int detChan);
     HANDEL_IMPORT int HANDEL_API xiaGetRunData(int detChan, const char *name, void *value);
+    HANDEL_IMPORT int HANDEL_API xiaGetRunDataHandle(int detChan, const char *name, int *handle);
+    HANDEL_IMPORT int HANDEL_API xiaGetRunDataByHandle(int detChan, int handle, void *value);
+    HANDEL_IMPORT int HANDEL_API xiaGetRunDataMulti(int detChan, const char *name, void *value,
+                                                    unsigned long stride);
+    HANDEL_IMPORT int HANDEL_API xiaWaitForBuffer(int detChan, int timeout,
+                                                  int *readyDetChan, int *buffer);
+    HANDEL_IMPORT int HANDEL_API xiaEnableBufferCompletions(XiaBufferCallback callback,
+                                                            void *arg);
+    HANDEL_IMPORT int HANDEL_API xiaDisableBufferCompletions(void);
+    HANDEL_IMPORT int HANDEL_API xiaGetBufferCompletion(int timeout,
+                                                        XiaBufferCompletion *completion);
     HANDEL_IMPORT int HANDEL_API xiaDoSpecialRun(int detChan, const char *name, void *info);
     HANDEL_IMPORT int HANDEL_API xiaGetSpecialRunData(int detChan, const char *name, void *value);
     HANDEL_IMPORT int HANDEL_API xiaLoadSystem(const char *type, const char *filename);
@@ -118,6 +129,7 @@ extern "C" {
     HANDEL_IMPORT int HANDEL_API xiaEnableLogOutput(void);
     HANDEL_IMPORT int HANDEL_API xiaSuppressLogOutput(void);
     HANDEL_IMPORT int HANDEL_API xiaSetLogLevel(int level);
+    HANDEL_IMPORT int HANDEL_API xiaSetLogAsync(int async);
     HANDEL_IMPORT int HANDEL_API xiaSetLogOutput(const char *fileName);
     HANDEL_IMPORT int HANDEL_API xiaCloseLog(void);
 
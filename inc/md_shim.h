@@ -40,6 +40,36 @@
 #include <time.h>
 
 #include "Dlldefs.h"
+#include "md_generic.h"
+
+/*
+ * Log level gating. A log statement above XIA_LOG_COMPILE_LEVEL is
+ * compiled out and one above dxp_md_log_gate, the run time log level or 0
+ * when the log is suppressed, returns before its message is formatted.
+ * Build with -DXIA_LOG_COMPILE_LEVEL=MD_INFO or lower to remove the debug
+ * logging from the receive paths.
+ */
+#ifndef XIA_LOG_COMPILE_LEVEL
+#define XIA_LOG_COMPILE_LEVEL MD_DEBUG
+#endif
+
+extern int dxp_md_log_gate;
+
+#define dxp_md_log_enabled(_level) \
+    (((_level) <= XIA_LOG_COMPILE_LEVEL) && ((_level) <= dxp_md_log_gate))
+
+/*
+ * Wrap a logging function taking the level first so the arguments are
+ * only evaluated and formatted when the level is enabled. The expand
+ * step splits the level macros into arguments on compilers with a
+ * traditional preprocessor.
+ */
+#define XIA_LOG_EXPAND(_x) _x
+#define XIA_LOG_GATE(_func, _level, ...)              \
+    do {                                              \
+        if (dxp_md_log_enabled(_level))               \
+            (_func)(_level, __VA_ARGS__);             \
+    } while (0)
 
 
 XIA_SHARED int dxp_md_wait(float *time);
@@ -47,6 +77,7 @@ XIA_SHARED char *dxp_md_fgets(char *s, int length, FILE *stream);
 XIA_SHARED int dxp_md_enable_log(void);
 XIA_SHARED int dxp_md_suppress_log(void);
 XIA_SHARED int dxp_md_set_log_level(int level);
+XIA_SHARED int dxp_md_set_log_async(int async);
 XIA_SHARED void dxp_md_log(int level, const char *routine, const char *message,
                            int error, const char *file, int line);
 XIA_SHARED void dxp_md_output(const char *filename);
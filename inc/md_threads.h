@@ -53,6 +53,11 @@ typedef void* handel_md_ThreadsHandle;
 #define THREADING_BUSY     65550
 #define THREADING_TIMEOUT  65551
 
+/*
+ * A poller wait timeout that checks the sockets and returns at once.
+ */
+#define THREADING_NO_WAIT  0xffffffffU
+
 /*
  * States a thread can be in.
  */
@@ -102,6 +107,17 @@ typedef struct
     const char*             name;
 } handel_md_Event;
 
+/*
+ * Structure to control a poller. A poller waits for any of a set of
+ * sockets to become readable. Each socket carries a user pointer that is
+ * returned when it is ready. A wake interrupts a wait from another thread.
+ */
+typedef struct
+{
+    handel_md_ThreadsHandle handle;
+    const char*             name;
+} handel_md_Poller;
+
 /*
  * Threading.
  */
@@ -130,4 +146,18 @@ XIA_SHARED int handel_md_event_wait(handel_md_Event* event, unsigned int timeout
 XIA_SHARED int handel_md_event_signal(handel_md_Event* event);
 XIA_SHARED int handel_md_event_ready(handel_md_Event* event);
 
+/*
+ * Pollers. A timeout of 0 waits forever and THREADING_NO_WAIT does not
+ * wait. A wait returns the number of ready user pointers in count, which
+ * is 0 if the wait was woken.
+ */
+XIA_SHARED int handel_md_poller_create(handel_md_Poller* poller);
+XIA_SHARED int handel_md_poller_destroy(handel_md_Poller* poller);
+XIA_SHARED int handel_md_poller_add(handel_md_Poller* poller, int fd, void* user);
+XIA_SHARED int handel_md_poller_remove(handel_md_Poller* poller, int fd);
+XIA_SHARED int handel_md_poller_wait(handel_md_Poller* poller, unsigned int timeout,
+                                     void** ready, int* count);
+XIA_SHARED int handel_md_poller_wake(handel_md_Poller* poller);
+XIA_SHARED int handel_md_poller_ready(handel_md_Poller* poller);
+
 #endif /* MD_THREADS_H */
@@ -80,6 +80,7 @@
 PSL_SHARED void PSL_API pslLog(int level, const char* file, int line,
                                const char* routine, int error,
                                const char* message, ...) PSL_PRINTF(6, 7);
+#define pslLog(...) XIA_LOG_EXPAND(XIA_LOG_GATE(pslLog, __VA_ARGS__))
 PSL_SHARED int PSL_API pslGetDefault(const char *name, void *value,
                                      XiaDefaults *defaults);
 PSL_SHARED int PSL_API pslSetDefault(const char *name, void *value,
@@ -181,4 +181,27 @@ typedef struct {
     size_t length;
 } GenBuffer;
 
+/*
+ * A mapping buffer completion. Posted when a mapping buffer of detChan
+ * fills. The buffer is 0 for buffer A or 1 for buffer B, bufferNumber
+ * counts the buffers filled in the run and the pixels are numbered from 0
+ * at the start of the run. Overruns is the run's count of buffer
+ * overruns and lost the count of completions lost because the queue was
+ * full before this one. The time is seconds from the epoch.
+ */
+typedef struct {
+    int           detChan;
+    int           buffer;
+    unsigned long bufferNumber;
+    unsigned long firstPixel;
+    unsigned long pixels;
+    unsigned long drops;
+    unsigned long overruns;
+    unsigned long lost;
+    double        time;
+} XiaBufferCompletion;
+
+typedef void (*XiaBufferCallback)(const XiaBufferCompletion *completion,
+                                  void *arg);
+
 #endif /* XIA_COMMON_H */
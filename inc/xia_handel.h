@@ -47,6 +47,7 @@
 #include "xia_common.h"
 
 #include "md_generic.h"
+#include "md_shim.h"
 
 #include "handeldef.h"
 
@@ -62,6 +63,7 @@ HANDEL_EXPORT int HANDEL_API xiaInitHandel(void);
 HANDEL_EXPORT int HANDEL_API xiaEnableLogOutput(void);
 HANDEL_EXPORT int HANDEL_API xiaSuppressLogOutput(void);
 HANDEL_EXPORT int HANDEL_API xiaSetLogLevel(int level);
+HANDEL_EXPORT int HANDEL_API xiaSetLogAsync(int async);
 HANDEL_EXPORT int HANDEL_API xiaSetLogOutput(const char *filename);
 HANDEL_EXPORT int HANDEL_API xiaCloseLog(void);
 HANDEL_EXPORT int HANDEL_API xiaNewDetector(const char *alias);
@@ -140,6 +142,25 @@ HANDEL_EXPORT int HANDEL_API xiaStopRun(int detChan);
 HANDEL_EXPORT int HANDEL_API xiaGetRunData(int detChan,
                                            const char *name,
                                            void *value);
+HANDEL_EXPORT int HANDEL_API xiaGetRunDataHandle(int detChan,
+                                                 const char *name,
+                                                 int *handle);
+HANDEL_EXPORT int HANDEL_API xiaGetRunDataByHandle(int detChan,
+                                                   int handle,
+                                                   void *value);
+HANDEL_EXPORT int HANDEL_API xiaGetRunDataMulti(int detChan,
+                                                const char *name,
+                                                void *value,
+                                                unsigned long stride);
+HANDEL_EXPORT int HANDEL_API xiaWaitForBuffer(int detChan,
+                                              int timeout,
+                                              int *readyDetChan,
+                                              int *buffer);
+HANDEL_EXPORT int HANDEL_API xiaEnableBufferCompletions(XiaBufferCallback callback,
+                                                        void *arg);
+HANDEL_EXPORT int HANDEL_API xiaDisableBufferCompletions(void);
+HANDEL_EXPORT int HANDEL_API xiaGetBufferCompletion(int timeout,
+                                                    XiaBufferCompletion *completion);
 HANDEL_EXPORT int HANDEL_API xiaDoSpecialRun(int detChan,
                                              const char *name,
                                              void *info);
@@ -219,6 +240,7 @@ HANDEL_SHARED int HANDEL_API xiaReadIniFile(const char *inifile);
 HANDEL_SHARED void HANDEL_API xiaLog(int level, const char* file, int line,
                                      int status, const char* func,
                                      const char* fmt, ...) HANDEL_PRINTF(6, 7);
+#define xiaLog(...) XIA_LOG_EXPAND(XIA_LOG_GATE(xiaLog, __VA_ARGS__))
 
 HANDEL_SHARED int HANDEL_API xiaSetupModule(const char* alias);
 HANDEL_SHARED int HANDEL_API xiaEndModule(const char* alias);
@@ -232,6 +254,12 @@ HANDEL_SHARED Module* HANDEL_API xiaFindModule(const char *alias);
 HANDEL_SHARED Detector* HANDEL_API xiaFindDetector(const char *alias);
 HANDEL_SHARED FirmwareSet* HANDEL_API xiaFindFirmware(const char *alias);
 HANDEL_SHARED XiaDefaults* HANDEL_API xiaFindDefault(const char *alias);
+HANDEL_SHARED XiaDaqEntry* HANDEL_API xiaFindDefaultEntry(XiaDefaults *defaults,
+                                                          const char *name);
+HANDEL_SHARED int HANDEL_API xiaIndexDefaultEntry(XiaDefaults *defaults,
+                                                  XiaDaqEntry *entry);
+HANDEL_SHARED void HANDEL_API xiaUnindexDefaultEntry(XiaDefaults *defaults,
+                                                     XiaDaqEntry *entry);
 HANDEL_SHARED int HANDEL_API xiaGetDetectorType(Detector* detector, char* type);
 
 HANDEL_SHARED Module* HANDEL_API xiaFindModuleFromDetAlias(const char *alias);
@@ -264,6 +292,15 @@ HANDEL_SHARED int HANDEL_API xiaMergeSort(void *data, int size,
 HANDEL_SHARED int HANDEL_API xiaGetElemType(int detChan);
 HANDEL_SHARED void HANDEL_API xiaClearTags(void);
 HANDEL_SHARED DetChanElement* HANDEL_API xiaGetDetChanPtr(int detChan);
+HANDEL_SHARED int HANDEL_API xiaGetDetChanSetChannels(int detChan,
+                                                      int *detChans, int size);
+HANDEL_SHARED int HANDEL_API xiaRunControlInit(void);
+HANDEL_SHARED void HANDEL_API xiaRunControlExit(void);
+HANDEL_SHARED void HANDEL_API xiaSignalBufferWaiters(void);
+HANDEL_SHARED void HANDEL_API xiaPostBufferCompletion(const XiaBufferCompletion *completion);
+HANDEL_SHARED int HANDEL_API xiaBuildDetChanIndex(void);
+HANDEL_SHARED void HANDEL_API xiaInvalidateDetChanIndex(void);
+HANDEL_SHARED const DetChanIndex* HANDEL_API xiaGetDetChanIndex(int detChan);
 
 HANDEL_SHARED char* HANDEL_API xiaGetAliasFromDetChan(int detChan);
 HANDEL_SHARED int HANDEL_API xiaGetModChan(int detChan);
@@ -313,6 +350,7 @@ extern char * (*handel_md_fgets)(char *s, int size, FILE *stream);
 extern int (*handel_md_enable_log)(void);
 extern int (*handel_md_suppress_log)(void);
 extern int (*handel_md_set_log_level)(int level);
+extern int (*handel_md_set_log_async)(int async);
 
 
 #define XIA_BEFORE 0
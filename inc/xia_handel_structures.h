@@ -146,6 +146,9 @@ typedef struct _XiaDaqEntry {
     /* Pointer to the next entry */
     struct _XiaDaqEntry *next;
 
+    /* Pointer to the next entry in the same index bucket */
+    struct _XiaDaqEntry *indexNext;
+
 } XiaDaqEntry;
 
 
@@ -158,6 +161,14 @@ struct XiaDefaults {
     char *alias;
     /* Linked list of DAQ entries */
     struct _XiaDaqEntry *entry;
+    /* Hash index of the DAQ entries by name. The buckets are chained
+     * through the entries' indexNext. NULL until the first entry is added.
+     */
+    struct _XiaDaqEntry **index;
+    size_t indexSize;
+    size_t indexCount;
+    /* Next defaults in the same bucket of the alias index */
+    struct XiaDefaults *aliasNext;
     /* Pointer to the next entry */
     struct XiaDefaults *next;
 };
@@ -424,4 +435,20 @@ struct Module {
     struct Module *next;
 };
 
+
+/*
+ * Dense index of the detChans. Entry n resolves detChan n to its list
+ * element and, for a single channel, its module, module channel,
+ * detector and defaults. The index is rebuilt when the system starts and
+ * when a channel set changes and is invalid after any change to the
+ * detChans, modules, detectors or defaults.
+ */
+typedef struct _DetChanIndex {
+    DetChanElement *element;
+    Module *module;
+    Detector *detector;
+    XiaDefaults *defaults;
+    int modChan;
+} DetChanIndex;
+
 #endif /* XIA_HANDEL_STRUCTURES_H */
@@ -210,6 +210,15 @@ typedef int (*startRun_FP)(int detChan, unsigned short resume, XiaDefaults *defs
 typedef int (*stopRun_FP)(int detChan, Detector *detector, Module *m);
 typedef int (*getRunData_FP)(int detChan, const char *name, void *value,
                              XiaDefaults *defs, Detector *detector, Module *m);
+typedef int (*getRunDataHandle_FP)(int detChan, const char *name, int *handle,
+                                   Detector *detector, Module *m);
+typedef int (*getRunDataByHandle_FP)(int detChan, int handle, void *value,
+                                     Detector *detector, Module *m);
+typedef int (*getRunDataMulti_FP)(const char *name, int count,
+                                  const int *detChans, void **values,
+                                  Module *m);
+typedef int (*getBufferReady_FP)(int detChan, int *buffer, boolean_t *active,
+                                 Detector *detector, Module *m);
 typedef int (*doSpecialRun_FP)(int detChan, const char *name, void *info,
                                XiaDefaults *defaults,
                                Detector *detector, Module *module);
@@ -252,6 +261,10 @@ struct PSLHandlers
     startRun_FP             startRun;
     stopRun_FP              stopRun;
     getRunData_FP           getRunData;
+    getRunDataHandle_FP     getRunDataHandle;
+    getRunDataByHandle_FP   getRunDataByHandle;
+    getRunDataMulti_FP      getRunDataMulti;
+    getBufferReady_FP       getBufferReady;
     doSpecialRun_FP         doSpecialRun;
     getSpecialRunData_FP    getSpecialRunData;
     canRemoveName_FP        canRemoveName;
@@ -52,6 +52,10 @@ bool SincInit(Sinc *sc)
     sc->datagramPort = 0;
     sc->datagramFd = -1;
     sc->datagramIsOpen = false;
+    sc->datagramRcvBufSize = 0;
+    sc->datagramsReceived = 0;
+    sc->datagramDrops = 0;
+    sc->datagramPool = NULL;
     sc->inSocketWait = false;
 
     return true;
@@ -77,6 +81,8 @@ void SincCleanup(Sinc *sc)
         SINC_BUFFER_CLEAR(&sc->readBuf);
         sc->readBuf.cbuf.data = NULL;
     }
+
+    SincDatagramPoolFree(sc);
 }
 
 
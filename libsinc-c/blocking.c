@@ -74,6 +74,134 @@ static bool SincWaitForData(Sinc *sc, int timeout, bool *readOk)
 }
 
 
+/*
+ * NAME:        SincDatagramPoolFree
+ * ACTION:      Frees the slots used to read datagrams.
+ * PARAMETERS:  Sinc *sc        - the sinc connection.
+ */
+
+void SincDatagramPoolFree(Sinc *sc)
+{
+    if (sc->datagramPool != NULL)
+    {
+        free(sc->datagramPool->slots);
+        free(sc->datagramPool);
+        sc->datagramPool = NULL;
+    }
+}
+
+
+/*
+ * NAME:        SincReadDatagrams
+ * ACTION:      Reads the waiting datagrams in a batch and appends each to the
+ *              read buffer behind a fake SINC header. The read buffer is
+ *              grown once for the whole batch.
+ * PARAMETERS:  Sinc *sc            - the sinc connection.
+ *              int *readSomeData   - set to true if a datagram was added to the read buffer.
+ * RETURNS:     true on success, false otherwise. On failure use SincErrno() and
+ *                  SincStrError() to get the error status.
+ */
+
+static bool SincReadDatagrams(Sinc *sc, int *readSomeData)
+{
+    struct SincDatagramPool *pool = sc->datagramPool;
+    int errCode;
+    int numRead;
+    int i;
+    size_t needed;
+
+    // The slots are allocated on the first datagram.
+    if (pool == NULL)
+    {
+        pool = calloc(1, sizeof(*pool));
+        if (pool != NULL)
+        {
+            pool->slots = malloc((size_t)SINC_DATAGRAM_BATCH * SINC_MAX_DATAGRAM_BYTES);
+            if (pool->slots == NULL)
+            {
+                free(pool);
+                pool = NULL;
+            }
+        }
+
+        if (pool == NULL)
+        {
+            SincReadErrorSetCode(sc, SI_TORO__SINC__ERROR_CODE__OUT_OF_MEMORY);
+            return false;
+        }
+
+        sc->datagramPool = pool;
+    }
+
+    // Read the batch.
+    uint32_t dropCount = pool->dropCount;
+    errCode = SincSocketReadDatagrams(sc->datagramFd, pool->slots, SINC_MAX_DATAGRAM_BYTES, pool->lens, SINC_DATAGRAM_BATCH, &numRead, &dropCount);
+    if (errCode == SI_TORO__SINC__ERROR_CODE__TIMEOUT)
+        return true;
+
+    if (errCode != SI_TORO__SINC__ERROR_CODE__NO_ERROR)
+    {
+        SincReadErrorSetCode(sc, (SiToro__Sinc__ErrorCode)errCode);
+        return false;
+    }
+
+    // The host's count wraps so accumulate the difference.
+    sc->datagramDrops += (uint32_t)(dropCount - pool->dropCount);
+    pool->dropCount = dropCount;
+    sc->datagramsReceived += (uint64_t)numRead;
+
+    // Make room for the whole batch.
+    needed = 0;
+    for (i = 0; i < numRead; i++)
+    {
+        if (pool->lens[i] > 0)
+            needed += pool->lens[i] + SINC_HEADER_LENGTH;
+    }
+
+    if (sc->readBuf.cbuf.len + needed > sc->readBuf.cbuf.alloced)
+        SincBufferCompact(&sc->readBuf);
+
+    if (sc->readBuf.cbuf.len + needed > sc->readBuf.cbuf.alloced)
+    {
+        // Expand the buffer.
+        size_t newSize = sc->readBuf.cbuf.len + needed;
+        uint8_t *mem = realloc(sc->readBuf.cbuf.data, newSize);
+        if (!mem)
+        {
+            SincReadErrorSetCode(sc, SI_TORO__SINC__ERROR_CODE__OUT_OF_MEMORY);
+            return false;
+        }
+
+        sc->readBuf.cbuf.data = mem;
+        sc->readBuf.cbuf.alloced = newSize;
+    }
+
+    // Append the datagrams.
+    for (i = 0; i < numRead; i++)
+    {
+        size_t bytesRead = pool->lens[i];
+        const uint8_t *datagram = &pool->slots[(size_t)i * SINC_MAX_DATAGRAM_BYTES];
+        uint8_t *bufPos = &sc->readBuf.cbuf.data[sc->readBuf.cbuf.len];
+
+        if (bytesRead == 0)
+            continue;
+
+        // Make a fake SINC header since we don't get them with datagrams.
+        uint8_t fakeMsgType = SI_TORO__SINC__MESSAGE_TYPE__HISTOGRAM_DATAGRAM_RESPONSE;
+        if (bytesRead >= 4)
+            fakeMsgType = datagram[6];
+
+        SincProtocolEncodeHeaderGeneric(bufPos, (int)bytesRead, fakeMsgType, SINC_RESPONSE_MARKER);
+        memcpy(bufPos + SINC_HEADER_LENGTH, datagram, bytesRead);
+
+        sc->readBuf.cbuf.len += bytesRead + SINC_HEADER_LENGTH;
+        *readSomeData = true;
+    }
+
+    return true;
+}
+
+
 /*
  * NAME:        SincReadMessage
  * ACTION:      Reads the next message. This may block waiting for a message to be received.
@@ -116,7 +244,6 @@ bool SincReadMessage(Sinc *sc, int timeout, SincBuffer *buf, SiToro__Sinc__Messa
         do
         {
             int errCode;
-            int readBufAvailable;
 
             // Check for data being available.
             if (!SincWaitForData(sc, 0, readAvailable))
@@ -128,6 +255,10 @@ bool SincReadMessage(Sinc *sc, int timeout, SincBuffer *buf, SiToro__Sinc__Messa
                 int readBufBytesAvailable;
                 int bytesRead = 0;
 
+                // Reclaim the consumed space before resorting to expanding the buffer.
+                if (sc->readBuf.cbuf.len == sc->readBuf.cbuf.alloced)
+                    SincBufferCompact(&sc->readBuf);
+
                 if (sc->readBuf.cbuf.len == sc->readBuf.cbuf.alloced)
                 {
                     // Out of buffer space - read and expand the buffer.
@@ -184,48 +315,8 @@ bool SincReadMessage(Sinc *sc, int timeout, SincBuffer *buf, SiToro__Sinc__Messa
             // Is there datagram data available?
             if (readAvailable[1])
             {
-                uint8_t *bufPos;
-                size_t bytesRead;
-
-                // Make sure we have at least 64k available in the buffer for reading (datagrams can't be bigger than this).
-                if (sc->readBuf.cbuf.len + SINC_MAX_DATAGRAM_BYTES + SINC_HEADER_LENGTH > sc->readBuf.cbuf.alloced)
-                {
-                    // Expand the buffer.
-                    size_t newSize = sc->readBuf.cbuf.len + SINC_MAX_DATAGRAM_BYTES + SINC_HEADER_LENGTH;
-                    uint8_t *mem = realloc(sc->readBuf.cbuf.data, newSize);
-                    if (!mem)
-                    {
-                        SincReadErrorSetCode(sc, SI_TORO__SINC__ERROR_CODE__OUT_OF_MEMORY);
-                        return false;
-                    }
-
-                    sc->readBuf.cbuf.data = mem;
-                    sc->readBuf.cbuf.alloced = newSize;
-                }
-
-                // Read the datagram.
-                readBufAvailable = (int)(sc->readBuf.cbuf.alloced - sc->readBuf.cbuf.len);
-                bufPos = &sc->readBuf.cbuf.data[sc->readBuf.cbuf.len];
-                bytesRead = (size_t)readBufAvailable - SINC_HEADER_LENGTH;
-                errCode = SincSocketReadDatagram(sc->datagramFd, bufPos + SINC_HEADER_LENGTH, &bytesRead, true);
-                if (errCode != SI_TORO__SINC__ERROR_CODE__NO_ERROR)
-                {
-                    SincReadErrorSetCode(sc, (SiToro__Sinc__ErrorCode)errCode);
+                if (!SincReadDatagrams(sc, &readSomeData))
                     return false;
-                }
-
-                if (bytesRead > 0)
-                {
-                    // Make a fake SINC header since we don't get them with datagrams.
-                    uint8_t fakeMsgType = SI_TORO__SINC__MESSAGE_TYPE__HISTOGRAM_DATAGRAM_RESPONSE;
-                    if (bytesRead >= 4)
-                        fakeMsgType = bufPos[SINC_HEADER_LENGTH + 6];
-
-                    SincProtocolEncodeHeaderGeneric(bufPos, (int)bytesRead, fakeMsgType, SINC_RESPONSE_MARKER);
-
-                    sc->readBuf.cbuf.len += bytesRead + SINC_HEADER_LENGTH;
-                    readSomeData = true;
-                }
             }
 
         } while (readAvailable[0] || readAvailable[1]);
@@ -483,6 +483,17 @@ bool SincOpenDatagramComms(Sinc *sc)
         return false;
     }
 
+    // Size the receive buffer for bursts of datagrams.
+    if (sc->datagramRcvBufSize > 0)
+    {
+        err = SincSocketSetReceiveBufferSize(sc->datagramFd, sc->datagramRcvBufSize);
+        if (err != SI_TORO__SINC__ERROR_CODE__NO_ERROR)
+        {
+            SincReadErrorSetMessage(sc, (SiToro__Sinc__ErrorCode)err, "can't set histogram datagram receive buffer size");
+            return false;
+        }
+    }
+
     return true;
 }
 
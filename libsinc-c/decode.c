@@ -861,22 +861,21 @@ errorExitDecodeOsc:
 
 
 /*
- * NAME:        SincDecodeHistogramDataResponse
- * ACTION:      Decodes an update from the histogram. Waits for the next histogram update to
- *              arrive if timeout is non-zero.
- * PARAMETERS:  Sinc *sc                - the sinc connection.
+ * NAME:        SincDecodeHistogramDataHeader
+ * ACTION:      Decodes the protobuf header of a histogram update and locates the
+ *              histogram bins which follow it in the packet.
+ * PARAMETERS:  SincError *err          - where to put any error.
  *              SincBuffer *packet      - the de-encapsulated packet to decode.
  *              int *fromChannelId      - if non-NULL this is set to the channel the histogram was received from.
- *              SincHistogram *accepted - the accepted histogram plot. Will allocate accepted->data so you must free it.
- *              SincHistogram *rejected - the rejected histogram plot. Will allocate rejected->data so you must free it.
  *              SincHistogramCountStats *stats - various statistics about the histogram. Can be NULL if not needed.
  *                                        May allocate stats->intensity so you should free it if non-NULL.
- * RETURNS:     true on success, false otherwise. On failure use SincErrno() and
- *                  SincStrError() to get the error status. There's no need to free
- *                  accepted or rejected data on failure.
+ *              uint32_t *acceptedSamples - the number of accepted bins is placed here.
+ *              uint32_t *rejectedSamples - the number of rejected bins is placed here.
+ *              uint8_t **bins          - set to the start of the bins in the packet.
+ * RETURNS:     true on success, false otherwise.
  */
 
-bool SincDecodeHistogramDataResponse(SincError *err, SincBuffer *packet, int *fromChannelId, SincHistogram *accepted, SincHistogram *rejected, SincHistogramCountStats *stats)
+static bool SincDecodeHistogramDataHeader(SincError *err, SincBuffer *packet, int *fromChannelId, SincHistogramCountStats *stats, uint32_t *acceptedSamples, uint32_t *rejectedSamples, uint8_t **bins)
 {
     uint16_t val_u16;
     uint32_t val_u32;
@@ -921,19 +920,19 @@ bool SincDecodeHistogramDataResponse(SincError *err, SincBuffer *packet, int *fr
 
     // Get the plots.
     unsigned int plotCount = 0;
-    uint32_t acceptedSamples = 0;
-    uint32_t rejectedSamples = 0;
+    *acceptedSamples = 0;
+    *rejectedSamples = 0;
     if (resp->has_spectrumselectionmask)
     {
         if ((resp->spectrumselectionmask & 0x01) && resp->n_plotlen > plotCount)
         {
-            acceptedSamples = resp->plotlen[plotCount];
+            *acceptedSamples = resp->plotlen[plotCount];
             plotCount++;
         }
 
         if ((resp->spectrumselectionmask & 0x02) && resp->n_plotlen > plotCount)
         {
-            rejectedSamples = resp->plotlen[plotCount];
+            *rejectedSamples = resp->plotlen[plotCount];
             plotCount++;
         }
     }
@@ -994,7 +993,8 @@ bool SincDecodeHistogramDataResponse(SincError *err, SincBuffer *packet, int *fr
             if (stats->intensityData == NULL)
             {
                 SincErrorSetCode(err, SI_TORO__SINC__ERROR_CODE__OUT_OF_MEMORY);
-                goto errorExit;
+                si_toro__sinc__histogram_data_response__free_unpacked(resp, NULL);
+                return false;
             }
 
             memcpy(stats->intensityData, resp->intensity, resp->n_intensity * sizeof(uint32_t));
@@ -1003,14 +1003,60 @@ bool SincDecodeHistogramDataResponse(SincError *err, SincBuffer *packet, int *fr
 
     si_toro__sinc__histogram_data_response__free_unpacked(resp, NULL);
 
-    // Copy the accepted data.
-    uint8_t *bPos = &packet->cbuf.data[protobufHeaderLen + 2];  // Skip the initial protocol buffer info.
-    int bLeft = (int)(packet->cbuf.len - protobufHeaderLen - 2);
+    // Make sure the bins are all there.
+    *bins = &packet->cbuf.data[protobufHeaderLen + 2];  // Skip the initial protocol buffer info.
+    if (((uint64_t)*acceptedSamples + *rejectedSamples) * sizeof(uint32_t) > packet->cbuf.len - protobufHeaderLen - 2)
+    {
+        SincErrorSetMessage(err, SI_TORO__SINC__ERROR_CODE__READ_FAILED, "truncated histogram packet");
+        if (stats && stats->intensityData != NULL)
+        {
+            free(stats->intensityData);
+            stats->intensityData = NULL;
+            stats->numIntensity = 0;
+        }
+
+        return false;
+    }
+
+    return true;
+}
+
 
+/*
+ * NAME:        SincDecodeHistogramDataResponse
+ * ACTION:      Decodes an update from the histogram. Waits for the next histogram update to
+ *              arrive if timeout is non-zero.
+ * PARAMETERS:  Sinc *sc                - the sinc connection.
+ *              SincBuffer *packet      - the de-encapsulated packet to decode.
+ *              int *fromChannelId      - if non-NULL this is set to the channel the histogram was received from.
+ *              SincHistogram *accepted - the accepted histogram plot. Will allocate accepted->data so you must free it.
+ *              SincHistogram *rejected - the rejected histogram plot. Will allocate rejected->data so you must free it.
+ *              SincHistogramCountStats *stats - various statistics about the histogram. Can be NULL if not needed.
+ *                                        May allocate stats->intensity so you should free it if non-NULL.
+ * RETURNS:     true on success, false otherwise. On failure use SincErrno() and
+ *                  SincStrError() to get the error status. There's no need to free
+ *                  accepted or rejected data on failure.
+ */
+
+bool SincDecodeHistogramDataResponse(SincError *err, SincBuffer *packet, int *fromChannelId, SincHistogram *accepted, SincHistogram *rejected, SincHistogramCountStats *stats)
+{
+    uint32_t acceptedSamples;
+    uint32_t rejectedSamples;
+    uint8_t *bPos;
+
+    if (accepted != NULL)
+        accepted->data = NULL;
+
+    if (rejected != NULL)
+        rejected->data = NULL;
+
+    if (!SincDecodeHistogramDataHeader(err, packet, fromChannelId, stats, &acceptedSamples, &rejectedSamples, &bPos))
+        return false;
+
+    // Copy the accepted data.
     if (accepted != NULL)
     {
         accepted->len = (int)acceptedSamples;
-        accepted->data = NULL;
         if (acceptedSamples > 0)
         {
             accepted->data = calloc(acceptedSamples, sizeof(uint32_t));
@@ -1021,16 +1067,15 @@ bool SincDecodeHistogramDataResponse(SincError *err, SincBuffer *packet, int *fr
             }
 
             memcpy(accepted->data, bPos, acceptedSamples * sizeof(uint32_t));
-            bPos += acceptedSamples * sizeof(uint32_t);
-            bLeft -= acceptedSamples * sizeof(uint32_t);
         }
     }
 
+    bPos += acceptedSamples * sizeof(uint32_t);
+
     // Copy the rejected data.
     if (rejected != NULL)
     {
         rejected->len = (int)rejectedSamples;
-        rejected->data = NULL;
         if (rejectedSamples > 0)
         {
             rejected->data = calloc(rejectedSamples, sizeof(uint32_t));
@@ -1041,8 +1086,6 @@ bool SincDecodeHistogramDataResponse(SincError *err, SincBuffer *packet, int *fr
             }
 
             memcpy(rejected->data, bPos, rejectedSamples * sizeof(uint32_t));
-            bPos += rejectedSamples * sizeof(uint32_t);
-            bLeft -= rejectedSamples * sizeof(uint32_t);
         }
     }
 
@@ -1072,6 +1115,50 @@ errorExit:
 }
 
 
+/*
+ * NAME:        SincDecodeHistogramDataResponseView
+ * ACTION:      Decodes an update from the histogram without copying the histogram bins.
+ *              The plots point into the packet buffer, so they're only valid until the
+ *              packet buffer is reused or freed. The bins may not be 32 bit aligned so
+ *              read them with memcpy().
+ * PARAMETERS:  Sinc *sc                - the sinc connection.
+ *              SincBuffer *packet      - the de-encapsulated packet to decode.
+ *              int *fromChannelId      - if non-NULL this is set to the channel the histogram was received from.
+ *              SincHistogram *accepted - the accepted histogram plot. Don't free accepted->data.
+ *              SincHistogram *rejected - the rejected histogram plot. Don't free rejected->data.
+ *              SincHistogramCountStats *stats - various statistics about the histogram. Can be NULL if not needed.
+ *                                        May allocate stats->intensity so you should free it if non-NULL.
+ * RETURNS:     true on success, false otherwise. On failure use SincErrno() and
+ *                  SincStrError() to get the error status.
+ */
+
+bool SincDecodeHistogramDataResponseView(SincError *err, SincBuffer *packet, int *fromChannelId, SincHistogram *accepted, SincHistogram *rejected, SincHistogramCountStats *stats)
+{
+    uint32_t acceptedSamples;
+    uint32_t rejectedSamples;
+    uint8_t *bPos;
+
+    if (!SincDecodeHistogramDataHeader(err, packet, fromChannelId, stats, &acceptedSamples, &rejectedSamples, &bPos))
+        return false;
+
+    if (accepted != NULL)
+    {
+        accepted->len = (int)acceptedSamples;
+        accepted->data = acceptedSamples > 0 ? (uint32_t *)bPos : NULL;
+    }
+
+    bPos += acceptedSamples * sizeof(uint32_t);
+
+    if (rejected != NULL)
+    {
+        rejected->len = (int)rejectedSamples;
+        rejected->data = rejectedSamples > 0 ? (uint32_t *)bPos : NULL;
+    }
+
+    return true;
+}
+
+
 /*
  * NAME:        SincDecodeHistogramDatagramResponse
  * ACTION:      Decodes an update from the histogram. Waits for the next histogram update to
@@ -1292,19 +1379,18 @@ errorExit:
 
 
 /*
- * NAME:        SincDecodeListModeDataResponse
- * ACTION:      Decodes a list mode packet.
- * PARAMETERS:  Sinc *sc                - the sinc connection.
+ * NAME:        SincDecodeListModeDataHeader
+ * ACTION:      Decodes the protobuf header of a list mode packet and locates the
+ *              list mode data which follows it in the packet.
+ * PARAMETERS:  SincError *err          - where to put any error.
  *              SincBuffer *packet      - the de-encapsulated packet to decode.
- *              int *fromChannelId      - if non-NULL this is set to the channel the histogram was received from.
- *              uint8_t **data, int *dataLen - filled in with a dynamically allocated buffer containing list mode data. Must be freed on success.
+ *              int *fromChannelId      - if non-NULL this is set to the channel the list mode data was received from.
  *              uint64_t *dataSetId     - if non-NULL this is set to the data set id.
- * RETURNS:     true on success, false otherwise. On failure use SincErrno() and
- *                  SincStrError() to get the error status. There's no need to free
- *                  accepted or rejected data on failure.
+ *              uint8_t **data, int *dataLen - set to the list mode data in the packet.
+ * RETURNS:     true on success, false otherwise.
  */
 
-bool SincDecodeListModeDataResponse(SincError *err, SincBuffer *packet, int *fromChannelId, uint8_t **data, int *dataLen, uint64_t *dataSetId)
+static bool SincDecodeListModeDataHeader(SincError *err, SincBuffer *packet, int *fromChannelId, uint64_t *dataSetId, uint8_t **data, int *dataLen)
 {
     uint16_t val_u16;
     uint32_t val_u32;
@@ -1354,8 +1440,33 @@ bool SincDecodeListModeDataResponse(SincError *err, SincBuffer *packet, int *fro
     si_toro__sinc__list_mode_data_response__free_unpacked(resp, NULL);
 
     // Get the list mode data.
-    uint8_t *bPos = &packet->cbuf.data[protobufHeaderLen + 2];  // Skip the initial protocol buffer info.
-    int bLen = (int)(packet->cbuf.len - protobufHeaderLen - 2);
+    *data = &packet->cbuf.data[protobufHeaderLen + 2];  // Skip the initial protocol buffer info.
+    *dataLen = (int)(packet->cbuf.len - protobufHeaderLen - 2);
+
+    return true;
+}
+
+
+/*
+ * NAME:        SincDecodeListModeDataResponse
+ * ACTION:      Decodes a list mode packet.
+ * PARAMETERS:  Sinc *sc                - the sinc connection.
+ *              SincBuffer *packet      - the de-encapsulated packet to decode.
+ *              int *fromChannelId      - if non-NULL this is set to the channel the histogram was received from.
+ *              uint8_t **data, int *dataLen - filled in with a dynamically allocated buffer containing list mode data. Must be freed on success.
+ *              uint64_t *dataSetId     - if non-NULL this is set to the data set id.
+ * RETURNS:     true on success, false otherwise. On failure use SincErrno() and
+ *                  SincStrError() to get the error status. There's no need to free
+ *                  accepted or rejected data on failure.
+ */
+
+bool SincDecodeListModeDataResponse(SincError *err, SincBuffer *packet, int *fromChannelId, uint8_t **data, int *dataLen, uint64_t *dataSetId)
+{
+    uint8_t *bPos;
+    int bLen;
+
+    if (!SincDecodeListModeDataHeader(err, packet, fromChannelId, dataSetId, &bPos, &bLen))
+        return false;
 
     if (data != NULL)
     {
@@ -1378,6 +1489,35 @@ bool SincDecodeListModeDataResponse(SincError *err, SincBuffer *packet, int *fro
 }
 
 
+/*
+ * NAME:        SincDecodeListModeDataResponseView
+ * ACTION:      Decodes a list mode packet without copying the list mode data.
+ *              The data points into the packet buffer, so it's only valid until the
+ *              packet buffer is reused or freed.
+ * PARAMETERS:  Sinc *sc                - the sinc connection.
+ *              SincBuffer *packet      - the de-encapsulated packet to decode.
+ *              int *fromChannelId      - if non-NULL this is set to the channel the list mode data was received from.
+ *              const uint8_t **data, int *dataLen - set to the list mode data in the packet. Don't free it.
+ *              uint64_t *dataSetId     - if non-NULL this is set to the data set id.
+ * RETURNS:     true on success, false otherwise. On failure use SincErrno() and
+ *                  SincStrError() to get the error status.
+ */
+
+bool SincDecodeListModeDataResponseView(SincError *err, SincBuffer *packet, int *fromChannelId, const uint8_t **data, int *dataLen, uint64_t *dataSetId)
+{
+    uint8_t *bPos;
+    int bLen;
+
+    if (!SincDecodeListModeDataHeader(err, packet, fromChannelId, dataSetId, &bPos, &bLen))
+        return false;
+
+    *data = bPos;
+    *dataLen = bLen;
+
+    return true;
+}
+
+
 /*
  * NAME:        SincDecodeAsynchronousErrorResponse
  * ACTION:      Decodes an asynchronous error response from the device. May or may not wait depending on
@@ -1617,7 +1757,7 @@ bool SincGetNextPacketFromBufferGeneric(SincBuffer *readBuf, uint32_t marker, Si
 
     *packetFound = false;
 
-    if (readBuf->cbuf.len == 0)
+    if (readBuf->readPos == readBuf->cbuf.len)
         return true;
 
     // Clear the destination buffer.
@@ -1630,11 +1770,15 @@ bool SincGetNextPacketFromBufferGeneric(SincBuffer *readBuf, uint32_t marker, Si
         bytesConsumed = 0;
         gotMessage = SincDecodePacketEncapsulation(readBuf, &bytesConsumed, &responseCode, packetType, packetBuf, marker);
 
-        // Remove the consumed data from the buffer.
+        // Step over the consumed data. It's only moved when the buffer needs the space.
         if (bytesConsumed > 0 && (packetBuf != NULL || !gotMessage))
         {
-            memmove(readBuf->cbuf.data, &readBuf->cbuf.data[bytesConsumed], readBuf->cbuf.len - (size_t)bytesConsumed);
-            readBuf->cbuf.len -= (size_t)bytesConsumed;
+            readBuf->readPos += (size_t)bytesConsumed;
+            if (readBuf->readPos == readBuf->cbuf.len)
+            {
+                readBuf->readPos = 0;
+                readBuf->cbuf.len = 0;
+            }
         }
 
         // Is there a response?
@@ -1649,3 +1793,21 @@ bool SincGetNextPacketFromBufferGeneric(SincBuffer *readBuf, uint32_t marker, Si
 
     return true;
 }
+
+
+/*
+ * NAME:        SincBufferCompact
+ * ACTION:      Discards the consumed data at the start of a read buffer by moving
+ *              the unconsumed data down to the start of the buffer.
+ * PARAMETERS:  SincBuffer *readBuf   - the buffer to compact.
+ */
+
+void SincBufferCompact(SincBuffer *readBuf)
+{
+    if (readBuf->readPos == 0)
+        return;
+
+    readBuf->cbuf.len -= readBuf->readPos;
+    memmove(readBuf->cbuf.data, &readBuf->cbuf.data[readBuf->readPos], readBuf->cbuf.len);
+    readBuf->readPos = 0;
+}
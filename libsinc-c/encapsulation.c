@@ -27,48 +27,218 @@
 /* SINC protocol constants */
 #define SINC_COMMAND_TYPE_PROTOBUF           3
 #define SINC_MAX_PACKET_SIZE                 (256 * 1024 * 1024)
+#define SINC_MARKER_LENGTH                   4
+
+/* Vectorised packet marker searches. AVX2 is selected at run time. */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SINC_MARKER_SCAN_SSE2
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(SINC_MARKER_SCAN_SSE2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SINC_MARKER_SCAN_AVX2
+#include <immintrin.h>
+#endif
 
 
 /*
- * NAME:        SincMemMem
- * ACTION:      Searches for a binary sequence in a binary buffer. Works like
- *              memmem() but is more widely compatible.
- * PARAMETERS:  const void *l, size_t l_len - the buffer to search in.
- *              const void *s, size_t s_len - the sequence to search for.
- * RETURNS:     void * - the memory location of the match or NULL if not found.
+ * NAME:        SincFindMarkerScalar
+ * ACTION:      Searches for a four byte packet marker in a binary buffer.
+ *              memchr() finds the candidates for the first byte.
+ * PARAMETERS:  const uint8_t *buf, size_t len - the buffer to search in.
+ *              const uint8_t *marker           - the four byte marker to search for.
+ * RETURNS:     uint8_t * - the memory location of the match or NULL if not found.
  */
 
-static void *SincMemMem(const void *l, size_t l_len, const void *s, size_t s_len)
+static uint8_t *SincFindMarkerScalar(const uint8_t *buf, size_t len, const uint8_t *marker)
 {
-    register char *cur, *last;
-    const char *cl = (const char *)l;
-    const char *cs = (const char *)s;
+    const uint8_t *end;
 
-    /* we need something to compare */
-    if (l_len == 0 || s_len == 0)
+    if (len < SINC_MARKER_LENGTH)
         return NULL;
 
-    /* "s" must be smaller or equal to "l" */
-    if (l_len < s_len)
-        return NULL;
+    /* the end of the positions where it's possible to find the marker */
+    end = buf + len - (SINC_MARKER_LENGTH - 1);
 
-    /* special case where s_len == 1 */
-    if (s_len == 1)
-        return memchr(l, (int)*cs, l_len);
+    while (buf < end)
+    {
+        const uint8_t *cur = memchr(buf, marker[0], (size_t)(end - buf));
+        if (cur == NULL)
+            return NULL;
 
-    /* the last position where its possible to find "s" in "l" */
-    last = (char *)cl + l_len - s_len;
+        if (cur[1] == marker[1] && cur[2] == marker[2] && cur[3] == marker[3])
+            return (uint8_t *)cur;
 
-    for (cur = (char *)cl; cur <= last; cur++)
-    {
-        if (cur[0] == cs[0] && memcmp(cur, cs, s_len) == 0)
-            return cur;
+        buf = cur + 1;
     }
 
     return NULL;
 }
 
 
+#if defined(SINC_MARKER_SCAN_SSE2)
+
+/*
+ * NAME:        SincLowestBit
+ * ACTION:      Finds the lowest set bit in a non-zero mask.
+ * PARAMETERS:  unsigned int mask - the mask.
+ * RETURNS:     unsigned int - the bit number.
+ */
+
+static unsigned int SincLowestBit(unsigned int mask)
+{
+#if defined(_MSC_VER)
+    unsigned long bit;
+    _BitScanForward(&bit, mask);
+    return (unsigned int)bit;
+#else
+    return (unsigned int)__builtin_ctz(mask);
+#endif
+}
+
+
+/*
+ * NAME:        SincFindMarkerSse2
+ * ACTION:      Searches for a four byte packet marker in a binary buffer 16
+ *              positions at a time. A position is a candidate if both its first
+ *              and last marker bytes match, so corrupt data rarely needs a
+ *              closer look.
+ * PARAMETERS:  const uint8_t *buf, size_t len - the buffer to search in.
+ *              const uint8_t *marker           - the four byte marker to search for.
+ * RETURNS:     uint8_t * - the memory location of the match or NULL if not found.
+ */
+
+static uint8_t *SincFindMarkerSse2(const uint8_t *buf, size_t len, const uint8_t *marker)
+{
+    const __m128i first = _mm_set1_epi8((char)marker[0]);
+    const __m128i last = _mm_set1_epi8((char)marker[SINC_MARKER_LENGTH - 1]);
+    size_t pos;
+
+    for (pos = 0; pos + 16 + SINC_MARKER_LENGTH - 1 <= len; pos += 16)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)(buf + pos));
+        __m128i b = _mm_loadu_si128((const __m128i *)(buf + pos + SINC_MARKER_LENGTH - 1));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+
+        while (mask != 0)
+        {
+            const uint8_t *cur = buf + pos + SincLowestBit(mask);
+            if (cur[1] == marker[1] && cur[2] == marker[2])
+                return (uint8_t *)cur;
+
+            mask &= mask - 1;
+        }
+    }
+
+    return SincFindMarkerScalar(buf + pos, len - pos, marker);
+}
+
+#endif
+
+
+#if defined(SINC_MARKER_SCAN_AVX2)
+
+/*
+ * NAME:        SincFindMarkerAvx2
+ * ACTION:      Searches for a four byte packet marker in a binary buffer 32
+ *              positions at a time. Works like SincFindMarkerSse2(). Only call
+ *              this if the CPU supports AVX2.
+ * PARAMETERS:  const uint8_t *buf, size_t len - the buffer to search in.
+ *              const uint8_t *marker           - the four byte marker to search for.
+ * RETURNS:     uint8_t * - the memory location of the match or NULL if not found.
+ */
+
+__attribute__((target("avx2")))
+static uint8_t *SincFindMarkerAvx2(const uint8_t *buf, size_t len, const uint8_t *marker)
+{
+    const __m256i first = _mm256_set1_epi8((char)marker[0]);
+    const __m256i last = _mm256_set1_epi8((char)marker[SINC_MARKER_LENGTH - 1]);
+    size_t pos;
+
+    for (pos = 0; pos + 32 + SINC_MARKER_LENGTH - 1 <= len; pos += 32)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(buf + pos));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(buf + pos + SINC_MARKER_LENGTH - 1));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last)));
+
+        while (mask != 0)
+        {
+            const uint8_t *cur = buf + pos + SincLowestBit(mask);
+            if (cur[1] == marker[1] && cur[2] == marker[2])
+                return (uint8_t *)cur;
+
+            mask &= mask - 1;
+        }
+    }
+
+    return SincFindMarkerSse2(buf + pos, len - pos, marker);
+}
+
+#endif
+
+
+/* The marker search in use. Set on first use to the fastest the CPU supports. */
+typedef uint8_t *(*SincFindMarkerFunc)(const uint8_t *buf, size_t len, const uint8_t *marker);
+static SincFindMarkerFunc SincFindMarkerImpl = NULL;
+
+
+/*
+ * NAME:        SincSelectMarkerScan
+ * ACTION:      Selects how packet markers are searched for. Normally the fastest
+ *              search the CPU supports is selected when it's first needed. This is
+ *              for testing and benchmarking.
+ * PARAMETERS:  const char *name - "scalar", "sse2" or "avx2". NULL selects the fastest.
+ * RETURNS:     bool - true on success, false if the search isn't available.
+ */
+
+bool SincSelectMarkerScan(const char *name)
+{
+#if defined(SINC_MARKER_SCAN_AVX2)
+    __builtin_cpu_init();
+    if ((name == NULL || strcmp(name, "avx2") == 0) && __builtin_cpu_supports("avx2"))
+    {
+        SincFindMarkerImpl = SincFindMarkerAvx2;
+        return true;
+    }
+#endif
+
+#if defined(SINC_MARKER_SCAN_SSE2)
+    if (name == NULL || strcmp(name, "sse2") == 0)
+    {
+        SincFindMarkerImpl = SincFindMarkerSse2;
+        return true;
+    }
+#endif
+
+    if (name != NULL && strcmp(name, "scalar") != 0)
+        return false;
+
+    SincFindMarkerImpl = SincFindMarkerScalar;
+    return true;
+}
+
+
+/*
+ * NAME:        SincFindMarker
+ * ACTION:      Searches for a four byte packet marker in a binary buffer.
+ * PARAMETERS:  const uint8_t *buf, size_t len - the buffer to search in.
+ *              const uint8_t *marker           - the four byte marker to search for.
+ * RETURNS:     uint8_t * - the memory location of the match or NULL if not found.
+ */
+
+static uint8_t *SincFindMarker(const uint8_t *buf, size_t len, const uint8_t *marker)
+{
+    // Every thread selects the same search so a race on first use is harmless.
+    if (SincFindMarkerImpl == NULL)
+        SincSelectMarkerScan(NULL);
+
+    return SincFindMarkerImpl(buf, len, marker);
+}
+
+
 /*
  * NAME:        SincProtocolEncodeHeader
  * ACTION:      Writes the header which precedes each protobuf-encoded packet.
@@ -134,8 +304,8 @@ bool SincDecodePacketEncapsulation(const SincBuffer *fromBuf, int *bytesConsumed
     size_t       bytesSkipped;
     unsigned int sincShortHeaderLength = SINC_HEADER_LENGTH - 2;
     size_t       contentLen;
-    uint8_t     *buf = fromBuf->cbuf.data;
-    unsigned int bufLen = (unsigned int)fromBuf->cbuf.len;
+    uint8_t     *buf = fromBuf->cbuf.data + fromBuf->readPos;
+    unsigned int bufLen = (unsigned int)(fromBuf->cbuf.len - fromBuf->readPos);
     uint32_t     val_u32;
 
     // By default assume we won't find a packet. We can change our mind later.
@@ -153,7 +323,7 @@ bool SincDecodePacketEncapsulation(const SincBuffer *fromBuf, int *bytesConsumed
     while (bufLen >= sincShortHeaderLength)
     {
         // Scan for the magic response marker pattern in the buffer.
-        uint8_t *packetStart = SincMemMem(buf, bufLen, &commandMarker, sizeof(commandMarker));
+        uint8_t *packetStart = SincFindMarker(buf, bufLen, commandMarker);
         if (packetStart == NULL)
         {
             if (bufLen > 4)
@@ -21,16 +21,21 @@
 /* The initial size of the input data buffer. */
 #define LMBUF_HEADER_LINE_LEN 28
 #define LMBUF_INITIAL_SIZE 65536
-#define LMBUF_CHECK_WORD_AVAILABLE(lmbuf, offset) ( (lmbuf)->bufTail + ((offset)+1) * sizeof(uint32_t) < (lmbuf)->bufHead )
+#define LMBUF_CHECK_WORD_AVAILABLE(lmbuf, offset) ( (lmbuf)->bufTail + ((offset)+1) * sizeof(uint32_t) <= (lmbuf)->bufHead )
 #define LMBUF_RAW_GET_WORD(buf, offset) ( memcpy(&val_u32, ((uint8_t *)(buf)) + ((offset) * sizeof(val_u32)), sizeof(val_u32)), val_u32 )
 #define LMBUF_LM_GET_WORD(lm, offset) ( LMBUF_RAW_GET_WORD(&(lm)->buf[(lm)->bufTail], (offset)) )
 #define LMBUF_SIGN_EXTEND_24_TO_32(v) (((v) & 0x00800000) ? (((v) & 0x7fffff) | 0xff800000) : ((v) & 0x7fffff))
 #define LMBUF_READ_AHEAD 5
-#define LMBUF_STREAM_ALIGN_WORD 0x70717273
 #define LMBUF_ERROR_MESSAGE_BUFFER_LEN 160
 
 #define LMBUF_NEW_DECODER
 
+/* Runs of pulses are decoded four words at a time where SSE2 is available. */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LMBUF_DECODE_PULSES_SSE2
+#include <emmintrin.h>
+#endif
+
 
 /* The packet's event type marker. */
 typedef enum
@@ -62,6 +67,7 @@ bool LmBufInit(LmBuf *lm)
         return false;
 
     lm->bufSize = LMBUF_INITIAL_SIZE;
+    lm->attached = false;
 
     LmBufClear(lm);
 
@@ -69,6 +75,29 @@ bool LmBufInit(LmBuf *lm)
 }
 
 
+/*
+ * NAME:        LmBufAttach
+ * ACTION:      Initialises a list mode buffer to decode directly from the
+ *              caller's data instead of a copy of it. Use this instead of
+ *              LmBufInit(). The data must stay valid until the buffer is closed
+ *              or cleared. Data can't be added to an attached buffer.
+ * PARAMETERS:  LmBuf *lm - the list mode buffer.
+ *              const uint8_t *data, size_t len - the data to decode.
+ */
+
+void LmBufAttach(LmBuf *lm, const uint8_t *data, size_t len)
+{
+    /* The buffer is never written through so it's safe to drop the const. */
+    lm->buf = (uint8_t *)data;
+    lm->bufSize = len;
+    lm->bufHead = len;
+    lm->bufTail = 0;
+    lm->srcTailPos = 0;
+    lm->scanStreamAlign = false;
+    lm->attached = true;
+}
+
+
 /*
  * NAME:        LmBufClose
  * ACTION:      Closes an LmBuf, freeing memory.
@@ -79,9 +108,13 @@ void LmBufClose(LmBuf *lm)
 {
     if (lm->buf != NULL)
     {
-        free(lm->buf);
+        if (!lm->attached)
+            free(lm->buf);
+
         lm->buf = NULL;
     }
+
+    lm->attached = false;
 }
 
 
@@ -93,7 +126,13 @@ void LmBufClose(LmBuf *lm)
 
 void LmBufClear(LmBuf *lm)
 {
-    lm->bufSize = 0;
+    if (lm->attached)
+    {
+        lm->buf = NULL;
+        lm->bufSize = 0;
+        lm->attached = false;
+    }
+
     lm->bufHead = 0;
     lm->bufTail = 0;
     lm->srcTailPos = 0;
@@ -175,10 +214,24 @@ static bool LmBufExpand(LmBuf *lm, size_t minSize)
  * RETURNS:     bool - true on success, false if out of memory.
  */
 
-bool LmBufAddData(LmBuf *lm, uint8_t *data, size_t len)
+bool LmBufAddData(LmBuf *lm, const uint8_t *data, size_t len)
 {
-    /* Don't waste space at the start of the buffer. */
-    LmBufCompact(lm);
+    if (lm->attached)
+        return false;
+
+    /*
+     * Only move the unread data back to the start of the buffer when
+     * there's no room after it, so most appends don't move anything.
+     */
+    if (lm->bufTail == lm->bufHead)
+    {
+        lm->bufHead = 0;
+        lm->bufTail = 0;
+    }
+    else if (lm->bufHead + len > lm->bufSize)
+    {
+        LmBufCompact(lm);
+    }
 
     /* Make sure the buffer's big enough to hold our new data. */
     if (!LmBufExpand(lm, lm->bufHead + len))
@@ -353,16 +406,24 @@ bool LmBufGetJsonHeader(LmBuf *lm, char **data, size_t *len, bool *invalidHeader
 
 static bool LmBufGetPulsePacket(LmBuf *lm, LmPacket *packet, uint32_t word0, unsigned int *packetBytes)
 {
-    /* Do we have enough data to get a pulse packet unambiguously? */
-    if (!LMBUF_CHECK_WORD_AVAILABLE(lm, 1))
+    uint32_t val_u32;
+    uint32_t word1 = 0;
+
+    /*
+     * Do we have enough data to get a pulse packet unambiguously? An
+     * attached buffer is complete so a pulse at the end has no time of arrival.
+     */
+    if (LMBUF_CHECK_WORD_AVAILABLE(lm, 1))
+    {
+        word1 = LMBUF_LM_GET_WORD(lm, 1);
+    }
+    else if (!lm->attached)
     {
         /* We don't have enough data to decode this packet yet. */
         return false;
     }
 
     /* Get the packet data. */
-    uint32_t val_u32;
-    uint32_t word1 = LMBUF_LM_GET_WORD(lm, 1);
     LmEventType word1EventType = (LmEventType)(word1 >> 28);
 
     packet->typ = LmPacketTypePulse;
@@ -1194,6 +1255,146 @@ bool LmBufGetNextPacket(LmBuf *lm, LmPacket *packet)
 #endif /* !LMBUF_NEW_DECODER */
 
 
+/*
+ * NAME:        LmBufDecodePulses
+ * ACTION:      Decodes a run of pulse packets from the buffer into arrays.
+ *              Decoding stops at the first packet which isn't a pulse so
+ *              LmBufGetNextPacket() can be used to get it.
+ * PARAMETERS:  LmBuf *lm - the list mode buffer.
+ *              int32_t *amplitude - the pulse amplitudes are written here.
+ *              uint32_t *timeOfArrival - the times of arrival are written here in
+ *                  1/256ths of a sample, or 0 if the pulse has no time of arrival.
+ *                  NULL if not needed.
+ *              uint8_t *flags - the LMBUF_PULSE_xxx flags for each pulse are
+ *                  written here. NULL if not needed.
+ *              size_t maxPulses - the size of the arrays.
+ * RETURNS:     size_t - the number of pulses decoded.
+ */
+
+size_t LmBufDecodePulses(LmBuf *lm, int32_t *amplitude, uint32_t *timeOfArrival, uint8_t *flags, size_t maxPulses)
+{
+    uint32_t val_u32;
+    size_t   pulses = 0;
+    size_t   pos = lm->bufTail;
+
+    /* Corrupted data has to be dealt with by LmBufGetNextPacket(). */
+    if (lm->scanStreamAlign)
+        return 0;
+
+    while (pulses < maxPulses)
+    {
+        uint32_t word0;
+        uint32_t word1;
+
+#ifdef LMBUF_DECODE_PULSES_SSE2
+        /*
+         * Like a single pulse, a run needs the word after it to be available
+         * to be sure the run is complete.
+         */
+        if (maxPulses - pulses >= 4 && pos + 5 * sizeof(uint32_t) <= lm->bufHead)
+        {
+            __m128i words = _mm_loadu_si128((const __m128i *)&lm->buf[pos]);
+            __m128i types = _mm_srli_epi32(words, 28);
+            uint32_t next = LMBUF_RAW_GET_WORD(&lm->buf[pos], 4);
+
+            /* Four pulses without times of arrival. */
+            if (_mm_movemask_epi8(_mm_cmpeq_epi32(types, _mm_setzero_si128())) == 0xffff && (LmEventType)(next >> 28) != LmEventTypePulseToa)
+            {
+                _mm_storeu_si128((__m128i *)&amplitude[pulses], _mm_srai_epi32(_mm_slli_epi32(words, 8), 8));
+
+                if (timeOfArrival != NULL)
+                    _mm_storeu_si128((__m128i *)&timeOfArrival[pulses], _mm_setzero_si128());
+
+                if (flags != NULL)
+                {
+                    __m128i invalid = _mm_and_si128(_mm_srli_epi32(words, 27), _mm_set1_epi32(LMBUF_PULSE_INVALID));
+                    uint32_t packed;
+
+                    invalid = _mm_packs_epi32(invalid, invalid);
+                    packed = (uint32_t)_mm_cvtsi128_si32(_mm_packus_epi16(invalid, invalid));
+                    memcpy(&flags[pulses], &packed, sizeof(packed));
+                }
+
+                pulses += 4;
+                pos += 4 * sizeof(uint32_t);
+                continue;
+            }
+
+            /* Two pulses, each followed by its time of arrival. */
+            if (maxPulses - pulses >= 2 && _mm_movemask_epi8(_mm_cmpeq_epi32(types, _mm_set_epi32(1, 0, 1, 0))) == 0xffff)
+            {
+                __m128i pairs = _mm_shuffle_epi32(words, _MM_SHUFFLE(3, 1, 2, 0));
+
+                _mm_storel_epi64((__m128i *)&amplitude[pulses], _mm_srai_epi32(_mm_slli_epi32(pairs, 8), 8));
+
+                if (timeOfArrival != NULL)
+                    _mm_storel_epi64((__m128i *)&timeOfArrival[pulses], _mm_and_si128(_mm_srli_si128(pairs, 8), _mm_set1_epi32(0xfffff)));
+
+                if (flags != NULL)
+                {
+                    unsigned int i;
+                    for (i = 0; i < 2; i++)
+                    {
+                        word0 = LMBUF_RAW_GET_WORD(&lm->buf[pos], i * 2);
+                        word1 = LMBUF_RAW_GET_WORD(&lm->buf[pos], i * 2 + 1);
+                        flags[pulses + i] = (uint8_t)(((word0 & 0x08000000) ? LMBUF_PULSE_INVALID : 0) | LMBUF_PULSE_TIME_OF_ARRIVAL | ((word1 & 0x00100000) ? LMBUF_PULSE_IN_MARKED_RANGE : 0));
+                    }
+                }
+
+                pulses += 2;
+                pos += 4 * sizeof(uint32_t);
+                continue;
+            }
+        }
+#endif
+
+        /* One pulse, with the same checks as LmBufGetPulsePacket(). */
+        if (pos + sizeof(uint32_t) > lm->bufHead)
+            break;
+
+        word0 = LMBUF_RAW_GET_WORD(&lm->buf[pos], 0);
+        if ((LmEventType)(word0 >> 28) != LmEventTypePulse)
+            break;
+
+        if (pos + 2 * sizeof(uint32_t) <= lm->bufHead)
+            word1 = LMBUF_RAW_GET_WORD(&lm->buf[pos], 1);
+        else if (lm->attached)
+            word1 = 0;
+        else
+            break;
+        amplitude[pulses] = (int32_t)LMBUF_SIGN_EXTEND_24_TO_32(word0);
+
+        if ((LmEventType)(word1 >> 28) == LmEventTypePulseToa)
+        {
+            if (timeOfArrival != NULL)
+                timeOfArrival[pulses] = word1 & 0xfffff;
+
+            if (flags != NULL)
+                flags[pulses] = (uint8_t)(((word0 & 0x08000000) ? LMBUF_PULSE_INVALID : 0) | LMBUF_PULSE_TIME_OF_ARRIVAL | ((word1 & 0x00100000) ? LMBUF_PULSE_IN_MARKED_RANGE : 0));
+
+            pos += 2 * sizeof(uint32_t);
+        }
+        else
+        {
+            if (timeOfArrival != NULL)
+                timeOfArrival[pulses] = 0;
+
+            if (flags != NULL)
+                flags[pulses] = (word0 & 0x08000000) ? LMBUF_PULSE_INVALID : 0;
+
+            pos += sizeof(uint32_t);
+        }
+
+        pulses++;
+    }
+
+    lm->srcTailPos += pos - lm->bufTail;
+    lm->bufTail = pos;
+
+    return pulses;
+}
+
+
 /*
  * NAME:        LmBufTranslatePacketSimple
  * ACTION:      Translates a LmPacket into textual form.
@@ -22,6 +22,10 @@ extern "C"
 #include <stdlib.h>
 
 
+/* The stream alignment word which unambiguously marks a packet boundary. */
+#define LMBUF_STREAM_ALIGN_WORD 0x70717273
+
+
 /* The version of the list mode format to encode to. */
 typedef enum
 {
@@ -43,6 +47,7 @@ typedef struct
     size_t   bufTail;      /* The lowest used value in the buffer. */
     size_t   srcTailPos;   /* Where we're up reading in the entire source data, not just the buffer. */
     bool     scanStreamAlign;   /* Currently scanning for a "resync" flag of 0x70717273. */
+    bool     attached;     /* The buffer is the caller's data, see LmBufAttach(). */
 } LmBuf;
 
 
@@ -158,6 +163,12 @@ typedef struct
 } LmPacket;
 
 
+/* Flags for each pulse decoded by LmBufDecodePulses(). */
+#define LMBUF_PULSE_INVALID             0x01
+#define LMBUF_PULSE_TIME_OF_ARRIVAL     0x02
+#define LMBUF_PULSE_IN_MARKED_RANGE     0x04
+
+
 /* Prototypes. */
 
 /*
@@ -170,6 +181,19 @@ typedef struct
 bool LmBufInit(LmBuf *lm);
 
 
+/*
+ * NAME:        LmBufAttach
+ * ACTION:      Initialises a list mode buffer to decode directly from the
+ *              caller's data instead of a copy of it. Use this instead of
+ *              LmBufInit(). The data must stay valid until the buffer is closed
+ *              or cleared. Data can't be added to an attached buffer.
+ * PARAMETERS:  LmBuf *lm - the list mode buffer.
+ *              const uint8_t *data, size_t len - the data to decode.
+ */
+
+void LmBufAttach(LmBuf *lm, const uint8_t *data, size_t len);
+
+
 /*
  * NAME:        LmBufClose
  * ACTION:      Closes an LmBuf, freeing memory.
@@ -182,6 +206,7 @@ void LmBufClose(LmBuf *lm);
 /*
  * NAME:        LmBufClear
  * ACTION:      Clears an LmBuf, emptying the contents but keeping the buffer memory ready.
+ *              An attached buffer lets go of the caller's data.
  * PARAMETERS:  LmBuf *lm - the list mode buffer.
  */
 
@@ -194,10 +219,11 @@ void LmBufClear(LmBuf *lm);
  *              this to add data read from a file or stream, then use
  *              LmBufGetNextPacket() to get packets out of the buffer.
  * PARAMETERS:  LmBuf *lm - the list mode buffer.
- * RETURNS:     bool - true on success, false if out of memory.
+ * RETURNS:     bool - true on success, false if out of memory or the buffer
+ *                  is attached.
  */
 
-bool LmBufAddData(LmBuf *lm, uint8_t *data, size_t len);
+bool LmBufAddData(LmBuf *lm, const uint8_t *data, size_t len);
 
 
 /*
@@ -229,6 +255,26 @@ bool LmBufGetJsonHeader(LmBuf *lm, char **data, size_t *len, bool *invalidHeader
 bool LmBufGetNextPacket(LmBuf *lm, LmPacket *packet);
 
 
+/*
+ * NAME:        LmBufDecodePulses
+ * ACTION:      Decodes a run of pulse packets from the buffer into arrays.
+ *              This is much faster than LmBufGetNextPacket() for pulses.
+ *              Decoding stops at the first packet which isn't a pulse so
+ *              LmBufGetNextPacket() can be used to get it.
+ * PARAMETERS:  LmBuf *lm - the list mode buffer.
+ *              int32_t *amplitude - the pulse amplitudes are written here.
+ *              uint32_t *timeOfArrival - the times of arrival are written here in
+ *                  1/256ths of a sample, or 0 if the pulse has no time of arrival.
+ *                  NULL if not needed.
+ *              uint8_t *flags - the LMBUF_PULSE_xxx flags for each pulse are
+ *                  written here. NULL if not needed.
+ *              size_t maxPulses - the size of the arrays.
+ * RETURNS:     size_t - the number of pulses decoded.
+ */
+
+size_t LmBufDecodePulses(LmBuf *lm, int32_t *amplitude, uint32_t *timeOfArrival, uint8_t *flags, size_t maxPulses);
+
+
 /*
  * NAME:        LmBufTranslatePacketSimple
  * ACTION:      Translates a LmPacket into textual form.
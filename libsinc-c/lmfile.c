@@ -0,0 +1,336 @@
+/********************************************************************
+ ***                                                              ***
+ ***                 libsinc list mode file reader                ***
+ ***                                                              ***
+ ********************************************************************/
+
+/*
+ * The list mode file reader maps a list mode data file into memory so
+ * its packets can be decoded in place with an LmBuf.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "lmfile.h"
+
+
+/* The smallest file LmBufGetJsonHeader() will look for a header in. */
+#define LMFILE_MIN_HEADER_SIZE 30
+
+
+/*
+ * NAME:        LmFileMap
+ * ACTION:      Maps a file into memory.
+ * PARAMETERS:  LmFile *lf - the list mode file.
+ *              const char *fileName - the file to map.
+ *              bool sequential - true if the file will be read from start to end.
+ * RETURNS:     bool - true on success, false if the file can't be mapped.
+ */
+
+#ifdef _WIN32
+
+static bool LmFileMap(LmFile *lf, const char *fileName, bool sequential)
+{
+    LARGE_INTEGER size;
+    HANDLE file;
+    HANDLE mapping;
+    void *data;
+
+    file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                       sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    if (!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    lf->file = file;
+    lf->size = (size_t)size.QuadPart;
+
+    /* Empty files can't be mapped. */
+    if (lf->size == 0)
+        return true;
+
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL)
+    {
+        CloseHandle(file);
+        lf->file = NULL;
+        return false;
+    }
+
+    data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        lf->file = NULL;
+        return false;
+    }
+
+    lf->mapping = mapping;
+    lf->data = data;
+
+    return true;
+}
+
+#else
+
+static bool LmFileMap(LmFile *lf, const char *fileName, bool sequential)
+{
+    struct stat st;
+    void *data;
+    int fd;
+
+    fd = open(fileName, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    lf->size = (size_t)st.st_size;
+
+    /* Empty files can't be mapped. */
+    if (lf->size == 0)
+    {
+        close(fd);
+        return true;
+    }
+
+    data = mmap(NULL, lf->size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    /* The mapping keeps the file open. */
+    close(fd);
+
+    if (data == MAP_FAILED)
+        return false;
+
+    if (sequential)
+        madvise(data, lf->size, MADV_SEQUENTIAL);
+
+    lf->data = data;
+
+    return true;
+}
+
+#endif
+
+
+/*
+ * NAME:        LmFileOpen
+ * ACTION:      Opens a list mode data file and maps it into memory. The
+ *              JSON header is read if the file has one.
+ * PARAMETERS:  LmFile *lf - the list mode file.
+ *              const char *fileName - the file to open.
+ *              bool sequential - true if the file will be read from start to end,
+ *                  so the operating system can read ahead.
+ * RETURNS:     bool - true on success, false if the file can't be read or
+ *                  its header is incomplete.
+ */
+
+bool LmFileOpen(LmFile *lf, const char *fileName, bool sequential)
+{
+    LmBuf lm;
+    bool invalidHeader;
+
+    memset(lf, 0, sizeof(*lf));
+
+    if (!LmFileMap(lf, fileName, sequential))
+        return false;
+
+    /* Read the header in place. */
+    if (lf->size >= LMFILE_MIN_HEADER_SIZE)
+    {
+        LmBufAttach(&lm, lf->data, lf->size);
+        if (!LmBufGetJsonHeader(&lm, &lf->header, &lf->headerLen, &invalidHeader))
+        {
+            /* The file ends part way through the header. */
+            LmBufClose(&lm);
+            LmFileClose(lf);
+            return false;
+        }
+
+        if (invalidHeader)
+        {
+            /* There's no header so the packets start at the beginning. */
+            lf->dataStart = 0;
+        }
+        else
+        {
+            lf->dataStart = lm.bufTail;
+        }
+
+        LmBufClose(&lm);
+    }
+
+    return true;
+}
+
+
+/*
+ * NAME:        LmFileClose
+ * ACTION:      Closes a list mode data file. Buffers attached to the file
+ *              can't be used after this.
+ * PARAMETERS:  LmFile *lf - the list mode file.
+ */
+
+void LmFileClose(LmFile *lf)
+{
+#ifdef _WIN32
+    if (lf->data != NULL)
+        UnmapViewOfFile(lf->data);
+
+    if (lf->mapping != NULL)
+        CloseHandle(lf->mapping);
+
+    if (lf->file != NULL)
+        CloseHandle(lf->file);
+
+    lf->mapping = NULL;
+    lf->file = NULL;
+#else
+    if (lf->data != NULL)
+        munmap((void *)lf->data, lf->size);
+#endif
+
+    if (lf->header != NULL)
+        free(lf->header);
+
+    lf->data = NULL;
+    lf->size = 0;
+    lf->dataStart = 0;
+    lf->header = NULL;
+    lf->headerLen = 0;
+}
+
+
+/*
+ * NAME:        LmFileAttach
+ * ACTION:      Initialises a list mode buffer to decode all of the packets
+ *              in the file in place. Close the buffer with LmBufClose().
+ * PARAMETERS:  LmFile *lf - the list mode file.
+ *              LmBuf *lm - the list mode buffer.
+ */
+
+void LmFileAttach(LmFile *lf, LmBuf *lm)
+{
+    LmFileSegment all;
+
+    all.start = lf->dataStart;
+    all.len = lf->size - lf->dataStart;
+
+    LmFileAttachSegment(lf, &all, lm);
+}
+
+
+/*
+ * NAME:        LmFileFindStreamAlign
+ * ACTION:      Finds the next stream alignment word in the file.
+ * PARAMETERS:  LmFile *lf - the list mode file.
+ *              size_t pos - where to start looking. Must be on a word boundary
+ *                  relative to the start of the packets.
+ * RETURNS:     size_t - the position of the word, or the file size if there isn't one.
+ */
+
+static size_t LmFileFindStreamAlign(LmFile *lf, size_t pos)
+{
+    for (; pos + sizeof(uint32_t) <= lf->size; pos += sizeof(uint32_t))
+    {
+        uint32_t word;
+        memcpy(&word, &lf->data[pos], sizeof(word));  /* Fixes memory alignment. */
+        if (word == LMBUF_STREAM_ALIGN_WORD)
+            return pos;
+    }
+
+    return lf->size;
+}
+
+
+/*
+ * NAME:        LmFileSplit
+ * ACTION:      Splits the packets in the file into segments of about the same
+ *              size which can be decoded at the same time. Each segment after
+ *              the first starts at a stream alignment word so no packet is
+ *              split. There may be fewer segments than asked for if the file
+ *              is small or has few stream alignment words.
+ * PARAMETERS:  LmFile *lf - the list mode file.
+ *              LmFileSegment *segments - the segments are written here.
+ *              int maxSegments - the most segments to split the file into.
+ * RETURNS:     int - the number of segments.
+ */
+
+int LmFileSplit(LmFile *lf, LmFileSegment *segments, int maxSegments)
+{
+    size_t start = lf->dataStart;
+    size_t step;
+    int count = 0;
+    int i;
+
+    if (maxSegments < 1)
+        return 0;
+
+    /* Segments are split on word boundaries. */
+    step = ((lf->size - lf->dataStart) / (size_t)maxSegments) & ~(sizeof(uint32_t) - 1);
+
+    for (i = 1; i < maxSegments && step > 0; i++)
+    {
+        size_t pos = lf->dataStart + step * (size_t)i;
+        size_t next;
+
+        /* The last segment may have run past this split already. */
+        if (pos <= start)
+            pos = start + sizeof(uint32_t);
+
+        next = LmFileFindStreamAlign(lf, pos);
+        if (next >= lf->size)
+            break;
+
+        segments[count].start = start;
+        segments[count].len = next - start;
+        count++;
+        start = next;
+    }
+
+    segments[count].start = start;
+    segments[count].len = lf->size - start;
+    count++;
+
+    return count;
+}
+
+
+/*
+ * NAME:        LmFileAttachSegment
+ * ACTION:      Initialises a list mode buffer to decode the packets in a
+ *              segment of the file in place. Close the buffer with LmBufClose().
+ * PARAMETERS:  LmFile *lf - the list mode file.
+ *              const LmFileSegment *segment - the segment from LmFileSplit().
+ *              LmBuf *lm - the list mode buffer.
+ */
+
+void LmFileAttachSegment(LmFile *lf, const LmFileSegment *segment, LmBuf *lm)
+{
+    LmBufAttach(lm, lf->data + segment->start, segment->len);
+
+    /* Report errors at their offset in the file. */
+    lm->srcTailPos = segment->start;
+}
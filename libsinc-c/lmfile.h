@@ -0,0 +1,119 @@
+/********************************************************************
+ ***                                                              ***
+ ***                 libsinc list mode file reader                ***
+ ***                                                              ***
+ ********************************************************************/
+
+/*
+ * The list mode file reader maps a list mode data file into memory so
+ * its packets can be decoded in place with an LmBuf.
+ */
+
+#ifndef SINC_LMFILE_H
+#define SINC_LMFILE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "lmbuf.h"
+
+
+/* A mapped list mode data file. */
+typedef struct
+{
+    const uint8_t *data;        /* The mapped file. */
+    size_t         size;        /* The size of the file. */
+    size_t         dataStart;   /* Where the list mode packets start, after any header. */
+    char          *header;      /* The JSON header, or NULL if the file doesn't have one. */
+    size_t         headerLen;   /* The length of the JSON header. */
+#ifdef _WIN32
+    void          *file;        /* The file handle. */
+    void          *mapping;     /* The file mapping handle. */
+#endif
+} LmFile;
+
+
+/* A part of a list mode data file which can be decoded on its own. */
+typedef struct
+{
+    size_t start;               /* Where the segment starts in the file. */
+    size_t len;                 /* The length of the segment. */
+} LmFileSegment;
+
+
+/* Prototypes. */
+
+/*
+ * NAME:        LmFileOpen
+ * ACTION:      Opens a list mode data file and maps it into memory. The
+ *              JSON header is read if the file has one.
+ * PARAMETERS:  LmFile *lf - the list mode file.
+ *              const char *fileName - the file to open.
+ *              bool sequential - true if the file will be read from start to end,
+ *                  so the operating system can read ahead.
+ * RETURNS:     bool - true on success, false if the file can't be read or
+ *                  its header is incomplete.
+ */
+
+bool LmFileOpen(LmFile *lf, const char *fileName, bool sequential);
+
+
+/*
+ * NAME:        LmFileClose
+ * ACTION:      Closes a list mode data file. Buffers attached to the file
+ *              can't be used after this.
+ * PARAMETERS:  LmFile *lf - the list mode file.
+ */
+
+void LmFileClose(LmFile *lf);
+
+
+/*
+ * NAME:        LmFileAttach
+ * ACTION:      Initialises a list mode buffer to decode all of the packets
+ *              in the file in place. Close the buffer with LmBufClose().
+ * PARAMETERS:  LmFile *lf - the list mode file.
+ *              LmBuf *lm - the list mode buffer.
+ */
+
+void LmFileAttach(LmFile *lf, LmBuf *lm);
+
+
+/*
+ * NAME:        LmFileSplit
+ * ACTION:      Splits the packets in the file into segments of about the same
+ *              size which can be decoded at the same time. Each segment after
+ *              the first starts at a stream alignment word so no packet is
+ *              split. There may be fewer segments than asked for if the file
+ *              is small or has few stream alignment words.
+ * PARAMETERS:  LmFile *lf - the list mode file.
+ *              LmFileSegment *segments - the segments are written here.
+ *              int maxSegments - the most segments to split the file into.
+ * RETURNS:     int - the number of segments.
+ */
+
+int LmFileSplit(LmFile *lf, LmFileSegment *segments, int maxSegments);
+
+
+/*
+ * NAME:        LmFileAttachSegment
+ * ACTION:      Initialises a list mode buffer to decode the packets in a
+ *              segment of the file in place. Close the buffer with LmBufClose().
+ * PARAMETERS:  LmFile *lf - the list mode file.
+ *              const LmFileSegment *segment - the segment from LmFileSplit().
+ *              LmBuf *lm - the list mode buffer.
+ */
+
+void LmFileAttachSegment(LmFile *lf, const LmFileSegment *segment, LmBuf *lm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SINC_LMFILE_H */
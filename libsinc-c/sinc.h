@@ -58,6 +58,7 @@ typedef struct
     ProtobufCBufferSimple cbuf;             // The packet buffer.
     int                   deviceId;         // Which array device this came from. Used only in SINC arrays.
     int                   channelIdOffset;  // What channel id offset to apply to the decoded data. Used only in SINC arrays.
+    size_t                readPos;          // Offset of the first unconsumed byte. Used only in read buffers.
 } SincBuffer;
 
 
@@ -71,11 +72,14 @@ typedef struct
  *   int success = SincSend(sinc, &buf);
  */
 
-#define SINC_BUFFER_INIT(x)  { PROTOBUF_C_BUFFER_SIMPLE_INIT(x), 0, 0 }
+#define SINC_BUFFER_INIT(x)  { PROTOBUF_C_BUFFER_SIMPLE_INIT(x), 0, 0, 0 }
 #define SINC_BUFFER_CLEAR(x) PROTOBUF_C_BUFFER_SIMPLE_CLEAR(&(x)->cbuf)
 
 
 
+// Datagram reception slots. Internal.
+struct SincDatagramPool;
+
 // A channel of communication to a device.
 typedef struct
 {
@@ -86,6 +90,10 @@ typedef struct
     int        datagramFd;       // The socket used for datagram reception.
     int        datagramPort;     // The socket port used for datagram reception.
     bool       datagramIsOpen;   // Datagram communications are open and working.
+    int        datagramRcvBufSize; // Receive buffer size in bytes for the datagram socket. 0 for the host's default. User settable.
+    uint64_t   datagramsReceived;  // Count of datagrams received.
+    uint64_t   datagramDrops;      // Count of datagrams the host dropped because the receive buffer was full. Linux only.
+    struct SincDatagramPool *datagramPool; // Slots datagrams are read into in batches.
     bool       inSocketWait;     // Connection is currently waiting on the socket.
     SincBuffer readBuf;          // The read data buffer.
     SincError *err;              // The most recent error.
@@ -1002,8 +1010,10 @@ bool SincDecodeListParamDetailsResponse(SincError *err, SincBuffer *packet, SiTo
 bool SincDecodeOscilloscopeDataResponse(SincError *err, SincBuffer *packet, int *fromChannelId, uint64_t *dataSetId, SincOscPlot *resetBlanked, SincOscPlot *rawCurve);
 bool SincDecodeOscilloscopeDataResponseAsPlotArray(SincError *err, SincBuffer *packet, int *fromChannelId, uint64_t *dataSetId, SincOscPlot *plotArray, int maxPlotArray, int *plotArraySize);
 bool SincDecodeHistogramDataResponse(SincError *err, SincBuffer *packet, int *fromChannelId, SincHistogram *accepted, SincHistogram *rejected, SincHistogramCountStats *stats);
+bool SincDecodeHistogramDataResponseView(SincError *err, SincBuffer *packet, int *fromChannelId, SincHistogram *accepted, SincHistogram *rejected, SincHistogramCountStats *stats);
 bool SincDecodeHistogramDatagramResponse(SincError *err, SincBuffer *packet, int *fromChannelId, SincHistogram *accepted, SincHistogram *rejected, SincHistogramCountStats *stats);
 bool SincDecodeListModeDataResponse(SincError *err, SincBuffer *packet, int *fromChannelId, uint8_t **data, int *dataLen, uint64_t *dataSetId);
+bool SincDecodeListModeDataResponseView(SincError *err, SincBuffer *packet, int *fromChannelId, const uint8_t **data, int *dataLen, uint64_t *dataSetId);
 bool SincDecodeMonitorChannelsCommand(SincError *err, SincBuffer *packet, uint64_t *channelBitSet);
 bool SincDecodeCheckParamConsistencyResponse(SincError *err, SincBuffer *packet, SiToro__Sinc__CheckParamConsistencyResponse **resp, int *fromChannelId);
 bool SincDecodeAsynchronousErrorResponse(SincError *err, SincBuffer *packet, SiToro__Sinc__AsynchronousErrorResponse **resp, int *fromChannelId);
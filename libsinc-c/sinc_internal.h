@@ -39,6 +39,17 @@ extern "C"
 #define SINC_READBUF_DEFAULT_SIZE 65536
 #define SINC_MAX_DATAGRAM_BYTES 65536
 
+// The most datagrams read from a socket in one batch.
+#define SINC_DATAGRAM_BATCH 16
+
+// Slots datagrams are read into before they are added to the read buffer.
+struct SincDatagramPool
+{
+    uint8_t  *slots;                      // SINC_DATAGRAM_BATCH slots of SINC_MAX_DATAGRAM_BYTES.
+    size_t    lens[SINC_DATAGRAM_BATCH];  // The size of the datagram in each slot.
+    uint32_t  dropCount;                  // The socket's last reported count of dropped datagrams.
+};
+
 // Handy network write macros. These assume a little endian architecture for speed but we can substitute big endian if necessary.
 #define SINC_PROTOCOL_WRITE_UINT32(buf, val) { uint32_t v = (uint32_t)val; memcpy((buf), &v, sizeof(v)); }
 #define SINC_PROTOCOL_READ_UINT16(buf) ( memcpy(&val_u16, (buf), sizeof(val_u16)), val_u16 )
@@ -67,6 +78,7 @@ void SincWriteErrorSetCode(Sinc *sc, SiToro__Sinc__ErrorCode code);
 int  SincProtocolEncodeHeader(uint8_t *buf, int payloadLen, SiToro__Sinc__MessageType msgType);
 int  SincProtocolEncodeHeaderGeneric(uint8_t *buf, int payloadLen, SiToro__Sinc__MessageType msgType, uint32_t marker);
 bool SincDecodePacketEncapsulation(const SincBuffer *fromBuf, int *bytesConsumed, int *responseCode, SiToro__Sinc__MessageType *msgType, SincBuffer *msg, uint32_t marker);
+bool SincSelectMarkerScan(const char *name);
 void SincProtocolWriteUint32(uint8_t *buf, uint32_t val);
 uint16_t SincProtocolReadUint16(const uint8_t *buf);
 uint32_t SincProtocolReadUint32(const uint8_t *buf);
@@ -84,6 +96,8 @@ int SincSocketWrite(int fd, const uint8_t *buf, int bufLen);
 int SincSocketSetNonBlocking(int fd);
 int SincSocketBindDatagram(int *datagramFd, int *port);
 int SincSocketReadDatagram(int fd, uint8_t *buf, size_t *buflen, bool nonBlocking);
+int SincSocketReadDatagrams(int fd, uint8_t *slots, size_t slotSize, size_t *lens, int numSlots, int *numRead, uint32_t *dropCount);
+int SincSocketSetReceiveBufferSize(int fd, int size);
 
 // Prototypes from readmessage.c.
 bool SincReadMessage(Sinc *sc, int timeout, SincBuffer *buf, SiToro__Sinc__MessageType *msgType);
@@ -91,12 +105,14 @@ bool SincCopyCalibrationPulse(SincError *err, SincCalibrationPlot *pulse, int le
 
 // Prototypes from blocking.c.
 bool SincWaitForMessageType(Sinc *sc, int timeout, SincBuffer *buf, SiToro__Sinc__MessageType seekMsgType);
+void SincDatagramPoolFree(Sinc *sc);
 
 // Prototypes from encode.c.
 void SincEncodeHistogramDatagramContent(SincBuffer *buf, int channelId, SincHistogram *accepted, SincHistogram *rejected, SincHistogramCountStats *stats);
 
 // Prototypes from decode.c.
 bool SincGetNextPacketFromBufferGeneric(SincBuffer *readBuf, uint32_t marker, SiToro__Sinc__MessageType *packetType, SincBuffer *packetBuf, int *packetFound);
+void SincBufferCompact(SincBuffer *readBuf);
 
 // Prototypes from base64.c.
 int Base64Encode(const void* data_buf, size_t dataLength, char* result, size_t resultSize);
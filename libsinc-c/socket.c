@@ -9,6 +9,11 @@
  * standard network sockets.
  */
 
+/* recvmmsg() is a GNU extension. */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #include <ctype.h>
 #include <errno.h>
 
@@ -510,6 +515,12 @@ int SincSocketBindDatagram(int *datagramFd, int *port)
 		return SI_TORO__SINC__ERROR_CODE__OUT_OF_RESOURCES;
     }
 
+#ifdef SO_RXQ_OVFL
+    // Ask for the count of datagrams dropped by the socket. It is not fatal if we can't have it.
+    int rxqOverflow = 1;
+    (void)setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &rxqOverflow, sizeof(rxqOverflow));
+#endif
+
     // Return results.
     *datagramFd = fd;
     *port = ntohs(addr.sin_port);
@@ -550,3 +561,114 @@ int SincSocketReadDatagram(int fd, uint8_t *buf, size_t *bufLen, bool nonBlockin
     *bufLen = (size_t)packetSize;
     return SI_TORO__SINC__ERROR_CODE__NO_ERROR;
 }
+
+
+/*
+ * NAME:        SincSocketSetReceiveBufferSize
+ * ACTION:      Sets the size of a socket's receive buffer. The host may limit
+ *              the size it allows.
+ * PARAMETERS:  int fd - the socket.
+ *              int size - the receive buffer size in bytes.
+ * RETURNS:     0 on success, a SiToro__Sinc__ErrorCode otherwise.
+ */
+
+int SincSocketSetReceiveBufferSize(int fd, int size)
+{
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, (const char *)&size, sizeof(size)) < 0)
+        return SI_TORO__SINC__ERROR_CODE__OUT_OF_RESOURCES;
+
+    return SI_TORO__SINC__ERROR_CODE__NO_ERROR;
+}
+
+
+/*
+ * NAME:        SincSocketReadDatagrams
+ * ACTION:      Reads a batch of the datagrams waiting on a socket without blocking.
+ *              On Linux the batch is read with one recvmmsg() call, otherwise
+ *              the datagrams are read one at a time.
+ * PARAMETERS:  int fd - the datagram socket.
+ *              uint8_t *slots - numSlots buffers of slotSize bytes each. A datagram is read into each slot.
+ *              size_t slotSize - the size of each slot.
+ *              size_t *lens - set to the size of the datagram in each slot read.
+ *              int numSlots - the number of slots.
+ *              int *numRead - set to the number of datagrams read.
+ *              uint32_t *dropCount - set to the socket's count of dropped datagrams
+ *                  when the host reports it. Left unchanged otherwise.
+ * RETURNS:     0 on success, a SiToro__Sinc__ErrorCode otherwise. Returns
+ *                  SI_TORO__SINC__ERROR_CODE__TIMEOUT if no datagram was waiting.
+ */
+
+int SincSocketReadDatagrams(int fd, uint8_t *slots, size_t slotSize, size_t *lens, int numSlots, int *numRead, uint32_t *dropCount)
+{
+    *numRead = 0;
+
+#if defined(__linux__)
+    struct mmsghdr msgs[SINC_DATAGRAM_BATCH];
+    struct iovec iovs[SINC_DATAGRAM_BATCH];
+    uint64_t control[SINC_DATAGRAM_BATCH][4];
+    int i;
+
+    if (numSlots > SINC_DATAGRAM_BATCH)
+        numSlots = SINC_DATAGRAM_BATCH;
+
+    memset(msgs, 0, sizeof(msgs[0]) * (size_t)numSlots);
+    for (i = 0; i < numSlots; i++)
+    {
+        iovs[i].iov_base = &slots[(size_t)i * slotSize];
+        iovs[i].iov_len = slotSize;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_control = control[i];
+        msgs[i].msg_hdr.msg_controllen = sizeof(control[i]);
+    }
+
+    int received = recvmmsg(fd, msgs, (unsigned int)numSlots, MSG_DONTWAIT, NULL);
+    if (received < 0)
+    {
+        if (errno == EWOULDBLOCK || errno == EAGAIN)
+            return SI_TORO__SINC__ERROR_CODE__TIMEOUT;
+        else
+            return SI_TORO__SINC__ERROR_CODE__READ_FAILED;
+    }
+
+    for (i = 0; i < received; i++)
+    {
+        struct cmsghdr *cmsg;
+
+        lens[i] = msgs[i].msg_len;
+
+#ifdef SO_RXQ_OVFL
+        for (cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsg != NULL; cmsg = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsg))
+        {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL)
+                memcpy(dropCount, CMSG_DATA(cmsg), sizeof(*dropCount));
+        }
+#else
+        (void)cmsg;
+        (void)dropCount;
+#endif
+    }
+
+    *numRead = received;
+#else
+    (void)dropCount;
+
+    while (*numRead < numSlots)
+    {
+        size_t len = slotSize;
+        int errCode = SincSocketReadDatagram(fd, &slots[(size_t)*numRead * slotSize], &len, true);
+        if (errCode != SI_TORO__SINC__ERROR_CODE__NO_ERROR)
+        {
+            if (*numRead > 0 && errCode == SI_TORO__SINC__ERROR_CODE__TIMEOUT)
+                break;
+
+            return errCode;
+        }
+
+        lens[*numRead] = len;
+        (*numRead)++;
+    }
+#endif
+
+    return SI_TORO__SINC__ERROR_CODE__NO_ERROR;
+}
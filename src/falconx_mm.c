@@ -79,6 +79,41 @@ size_t psl__MappingModeBuffers_Size(MM_Buffers* buffers)
     return buffers->buffer[0].size;
 }
 
+PSL_STATIC int psl__MappingModeBuffers_Following(MM_Buffers* buffers, int buffer)
+{
+    return (buffer + 1) % buffers->count;
+}
+
+/*
+ * The user sees the ring as alternating A and B buffers. A buffer's label
+ * is set by the order it is made active and not by its index in the ring.
+ */
+PSL_STATIC int psl__MappingModeBuffers_LabelId(MM_Buffers* buffers, int buffer)
+{
+    int distance = (buffer + buffers->count - buffers->active) % buffers->count;
+    if (((buffers->activeNumber + (uint32_t) distance) & 1) == 0)
+        return psl__MappingModeBuffer_A();
+    return psl__MappingModeBuffer_B();
+}
+
+PSL_STATIC char psl__MappingModeBuffers_Label(MM_Buffers* buffers, int buffer)
+{
+    return
+        psl__MappingModeBuffers_LabelId(buffers, buffer) ==
+        psl__MappingModeBuffer_A() ? 'A' : 'B';
+}
+
+/*
+ * The buffer the user knows as A or B. It is the Active buffer if it has
+ * the label else it is the buffer that follows the Active.
+ */
+PSL_STATIC int psl__MappingModeBuffers_Labelled(MM_Buffers* buffers, int label)
+{
+    if (psl__MappingModeBuffers_LabelId(buffers, buffers->active) == label)
+        return buffers->active;
+    return psl__MappingModeBuffers_Following(buffers, buffers->active);
+}
+
 PSL_STATIC boolean_t psl__MappingModeBuffers_Full(MM_Buffers* buffers, int buffer)
 {
     return
@@ -96,41 +131,49 @@ PSL_STATIC size_t psl__MappingModeBuffers_Level(MM_Buffers* buffers, int buffer)
 
 size_t psl__MappingModeBuffers_A_Level(MM_Buffers* buffers)
 {
-    return psl__MappingModeBuffers_Level(buffers,
-                                         psl__MappingModeBuffer_A());
+    int buffer = psl__MappingModeBuffers_Labelled(buffers,
+                                                  psl__MappingModeBuffer_A());
+    return psl__MappingModeBuffers_Level(buffers, buffer);
 }
 
 boolean_t psl__MappingModeBuffers_A_Full(MM_Buffers* buffers)
 {
-    return psl__MappingModeBuffers_Full(buffers,
-                                        psl__MappingModeBuffer_A());
+    int buffer = psl__MappingModeBuffers_Labelled(buffers,
+                                                  psl__MappingModeBuffer_A());
+    return psl__MappingModeBuffers_Full(buffers, buffer);
 }
 
 boolean_t psl__MappingModeBuffers_A_Active(MM_Buffers* buffers)
 {
-    return buffers->active == psl__MappingModeBuffer_A();
+    return
+        psl__MappingModeBuffers_LabelId(buffers, buffers->active) ==
+        psl__MappingModeBuffer_A();
 }
 
 size_t psl__MappingModeBuffers_B_Level(MM_Buffers* buffers)
 {
-    return psl__MappingModeBuffers_Level(buffers,
-                                         psl__MappingModeBuffer_B());
+    int buffer = psl__MappingModeBuffers_Labelled(buffers,
+                                                  psl__MappingModeBuffer_B());
+    return psl__MappingModeBuffers_Level(buffers, buffer);
 }
 
 boolean_t psl__MappingModeBuffers_B_Full(MM_Buffers* buffers)
 {
-    return psl__MappingModeBuffers_Full(buffers,
-                                        psl__MappingModeBuffer_B());
+    int buffer = psl__MappingModeBuffers_Labelled(buffers,
+                                                  psl__MappingModeBuffer_B());
+    return psl__MappingModeBuffers_Full(buffers, buffer);
 }
 
 boolean_t psl__MappingModeBuffers_B_Active(MM_Buffers* buffers)
 {
-    return buffers->active == psl__MappingModeBuffer_B();
+    return
+        psl__MappingModeBuffers_LabelId(buffers, buffers->active) ==
+        psl__MappingModeBuffer_B();
 }
 
 int psl__MappingModeBuffers_Next(MM_Buffers* buffers)
 {
-    return buffers->active ? 0 : 1;
+    return buffers->fill;
 }
 
 int psl__MappingModeBuffers_Active(MM_Buffers* buffers)
@@ -140,12 +183,12 @@ int psl__MappingModeBuffers_Active(MM_Buffers* buffers)
 
 char psl__MappingModeBuffers_Active_Label(MM_Buffers* buffers)
 {
-    return buffers->active == psl__MappingModeBuffer_A() ? 'A' : 'B';
+    return psl__MappingModeBuffers_Label(buffers, buffers->active);
 }
 
 char psl__MappingModeBuffers_Next_Label(MM_Buffers* buffers)
 {
-    return buffers->active == 1 ? 'A' : 'B';
+    return psl__MappingModeBuffers_Label(buffers, buffers->fill);
 }
 
 boolean_t psl__MappingModeBuffers_Next_Full(MM_Buffers* buffers)
@@ -172,9 +215,16 @@ void psl__MappingModeBuffers_Active_SetDone(MM_Buffers* buffers)
     buffers->buffer[buffer].done = TRUE_;
 }
 
+boolean_t psl__MappingModeBuffers_Active_Borrowed(MM_Buffers* buffers)
+{
+    int buffer = psl__MappingModeBuffers_Active(buffers);
+    return buffers->buffer[buffer].borrowed;
+}
+
 PSL_STATIC void psl__MappingModeBuffers_Active_Set(MM_Buffers* buffers, int buffer)
 {
     buffers->active = buffer;
+    buffers->activeNumber++;
     buffers->buffer[buffer].done = FALSE_;
 }
 
@@ -185,9 +235,15 @@ void psl__MappingModeBuffers_Toggle(MM_Buffers* buffers)
      */
     ASSERT(psl__MappingModeBuffers_Active_Done(buffers));
 
-    int buffer = psl__MappingModeBuffers_Next(buffers);
+    /*
+     * The oldest full buffer follows the Active. If that is the Next move
+     * the Next on to the free buffer.
+     */
+    int buffer = psl__MappingModeBuffers_Following(buffers, buffers->active);
     psl__MappingModeBuffers_Active_Set(buffers, buffer);
     psl__MappingModeBuffers_Active_Reset(buffers);
+    if (buffers->fill == buffer)
+        buffers->fill = psl__MappingModeBuffers_Following(buffers, buffer);
 }
 
 void psl__MappingModeBuffers_Overrun(MM_Buffers* buffers)
@@ -234,7 +290,11 @@ PSL_STATIC int psl__MappingModeBuffers_Clear(MM_Buffers* buffers, int buffer)
     mmb->marker = 0;
     mmb->full = FALSE_;
     mmb->done = TRUE_;
+    mmb->borrowed = FALSE_;
+    mmb->lent = 0;
     mmb->drops = 0;
+    mmb->posted = FALSE_;
+    mmb->firstPixel = 0;
     return XIA_SUCCESS;
 }
 
@@ -353,9 +413,21 @@ PSL_STATIC uint32_t psl__MappingModeBuffers_PixelTotal(MM_Buffers* buffers,
     return buffers->pixel;
 }
 
+/*
+ * Note the run pixel number of the first pixel, received or dropped, to
+ * land in a buffer.
+ */
+PSL_STATIC void psl__MappingModeBuffers_Mark_First(MM_Buffers* buffers, int buffer)
+{
+    MM_Buffer* mmb = &buffers->buffer[buffer];
+    if ((mmb->bufferPixel == 0) && (mmb->drops == 0))
+        mmb->firstPixel = buffers->pixel;
+}
+
 void psl__MappingModeBuffers_Drop(MM_Buffers* buffers, uint32_t drops)
 {
     int buffer = psl__MappingModeBuffers_Next(buffers);
+    psl__MappingModeBuffers_Mark_First(buffers, buffer);
     buffers->buffer[buffer].drops += drops;
     buffers->pixel += drops;
 }
@@ -384,15 +456,42 @@ uint32_t psl__MappingModeBuffers_Active_PixelTotal(MM_Buffers* buffers)
     return psl__MappingModeBuffers_PixelTotal(buffers, buffer);
 }
 
+uint32_t psl__MappingModeBuffers_Active_FirstPixel(MM_Buffers* buffers)
+{
+    int buffer = psl__MappingModeBuffers_Active(buffers);
+    return buffers->buffer[buffer].firstPixel;
+}
+
+uint32_t psl__MappingModeBuffers_Active_Drops(MM_Buffers* buffers)
+{
+    int buffer = psl__MappingModeBuffers_Active(buffers);
+    return psl__MappingModeBuffers_Drops(buffers, buffer);
+}
+
+/*
+ * Returns TRUE once for each Active buffer that is full. The caller posts
+ * the buffer's completion record. Clearing the buffer rearms it.
+ */
+boolean_t psl__MappingModeBuffers_Active_Complete(MM_Buffers* buffers)
+{
+    int buffer = psl__MappingModeBuffers_Active(buffers);
+    MM_Buffer* mmb = &buffers->buffer[buffer];
+    if (mmb->posted || !psl__MappingModeBuffers_Full(buffers, buffer))
+        return FALSE_;
+    mmb->posted = TRUE_;
+    return TRUE_;
+}
+
 void psl__MappingModeBuffers_Pixel_Inc(MM_Buffers* buffers)
 {
     int buffer = psl__MappingModeBuffers_Next(buffers);
     MM_Buffer* mmb = &buffers->buffer[buffer];
+    psl__MappingModeBuffers_Mark_First(buffers, buffer);
     ++buffers->pixel;
     ++mmb->bufferPixel;
 }
 
-int psl__MappingModeBuffers_CopyIn(MM_Buffers* buffers, void* value, size_t size)
+int psl__MappingModeBuffers_CopyIn(MM_Buffers* buffers, const void* value, size_t size)
 {
     int status = XIA_SUCCESS;
 
@@ -402,7 +501,7 @@ int psl__MappingModeBuffers_CopyIn(MM_Buffers* buffers, void* value, size_t size
 
     pslLog(PSL_LOG_DEBUG,
            "COPY-IN buffer:%c length:%d level:%d size:%d remaining:%d",
-           buffer == 0 ? 'A' : 'B', (int) size,
+           psl__MappingModeBuffers_Label(buffers, buffer), (int) size,
            (int) mmb->level, (int) mmb->size, (int) (mmb->size - mmb->level));
 
     if ((mmb->level + size) > mmb->size) {
@@ -432,7 +531,8 @@ int psl__MappingModeBuffers_CopyOut(MM_Buffers* buffers, void* value, size_t* si
 
     pslLog(PSL_LOG_DEBUG,
            "COPY-OUT buffer:%c level:%d size:%d",
-           buffer == 0 ? 'A' : 'B', (int) mmb->level, (int) *size);
+           psl__MappingModeBuffers_Label(buffers, buffer),
+           (int) mmb->level, (int) *size);
 
     /*
      * If size is 0 copy the remaining data.
@@ -451,25 +551,137 @@ int psl__MappingModeBuffers_CopyOut(MM_Buffers* buffers, void* value, size_t* si
     return status;
 }
 
+int psl__MappingModeBuffers_Borrow(MM_Buffers* buffers, const uint32_t** data, size_t* size)
+{
+    int status = XIA_SUCCESS;
+
+    const int buffer = psl__MappingModeBuffers_Active(buffers);
+
+    MM_Buffer* mmb = &buffers->buffer[buffer];
+
+    pslLog(PSL_LOG_DEBUG,
+           "BORROW buffer:%c level:%d next:%d",
+           psl__MappingModeBuffers_Label(buffers, buffer),
+           (int) mmb->level, (int) mmb->next);
+
+    /*
+     * Only a full Active buffer the user has not finished with holds data
+     * to lend. An empty or done Active can be swapped out at any time.
+     */
+    if (!psl__MappingModeBuffers_Full(buffers, buffer) || mmb->done) {
+        status = XIA_NOT_ACTIVE;
+        pslLog(PSL_LOG_ERROR, status,
+               "MMBuffer: Buffer %c is not full, cannot borrow",
+               psl__MappingModeBuffers_Label(buffers, buffer));
+        *data = NULL;
+        *size = 0;
+        return status;
+    }
+
+    /*
+     * Borrowing twice hands back the same data.
+     */
+    if (!mmb->borrowed) {
+        mmb->borrowed = TRUE_;
+        mmb->lent = mmb->next;
+        mmb->next = mmb->level;
+        mmb->full = psl__MappingModeBuffers_Full(buffers, buffer);
+    }
+
+    *data = &mmb->buffer[mmb->lent];
+    *size = mmb->level - mmb->lent;
+
+    return status;
+}
+
+int psl__MappingModeBuffers_Borrowed(MM_Buffers* buffers, size_t* size)
+{
+    int status = XIA_SUCCESS;
+
+    const int buffer = psl__MappingModeBuffers_Active(buffers);
+
+    MM_Buffer* mmb = &buffers->buffer[buffer];
+
+    if (!mmb->borrowed) {
+        status = XIA_NOT_ACTIVE;
+        pslLog(PSL_LOG_ERROR, status,
+               "MMBuffer: Buffer %c is not borrowed",
+               psl__MappingModeBuffers_Label(buffers, buffer));
+        *size = 0;
+        return status;
+    }
+
+    *size = mmb->level - mmb->lent;
+
+    return status;
+}
+
+int psl__MappingModeBuffers_Release(MM_Buffers* buffers)
+{
+    int status = XIA_SUCCESS;
+
+    const int buffer = psl__MappingModeBuffers_Active(buffers);
+
+    MM_Buffer* mmb = &buffers->buffer[buffer];
+
+    pslLog(PSL_LOG_DEBUG,
+           "RELEASE buffer:%c borrowed:%c",
+           psl__MappingModeBuffers_Label(buffers, buffer),
+           mmb->borrowed ? 'Y' : 'N');
+
+    if (!mmb->borrowed) {
+        status = XIA_NOT_ACTIVE;
+        pslLog(PSL_LOG_ERROR, status,
+               "MMBuffer: Buffer %c is not borrowed",
+               psl__MappingModeBuffers_Label(buffers, buffer));
+        return status;
+    }
+
+    mmb->borrowed = FALSE_;
+    mmb->lent = 0;
+
+    return status;
+}
+
 boolean_t psl__MappingModeBuffers_Update(MM_Buffers* buffers)
 {
+    boolean_t swapped = FALSE_;
+    int       following;
+
     /*
-     * If the Next buffer is full check if the Active is empty. If empty we can
-     * toggle the buffers. If the Active still has data there is nothing we can
-     * do. The user has to read all the data or we overrun the buffers.
+     * If the buffer following the Active is full check if the Active is
+     * empty. If empty we can toggle the buffers. If the Active still has
+     * data there is nothing we can do. The user has to read all the data.
+     * A borrowed Active is never toggled as the user holds its data.
      */
 
     pslLog(PSL_LOG_DEBUG,
-           "UPDATE: NextFull:%c ActiveDone:%c",
+           "UPDATE: NextFull:%c ActiveDone:%c Active:%d Next:%d Count:%d",
            psl__MappingModeBuffers_Next_Full(buffers) ? 'Y' : 'N',
-           psl__MappingModeBuffers_Active_Done(buffers) ? 'Y' : 'N');
+           psl__MappingModeBuffers_Active_Done(buffers) ? 'Y' : 'N',
+           buffers->active, buffers->fill, buffers->count);
 
-    if (psl__MappingModeBuffers_Next_Full(buffers) &&
-        psl__MappingModeBuffers_Active_Done(buffers)) {
+    following = psl__MappingModeBuffers_Following(buffers, buffers->active);
+
+    if (psl__MappingModeBuffers_Active_Done(buffers) &&
+        !psl__MappingModeBuffers_Active_Borrowed(buffers) &&
+        psl__MappingModeBuffers_Full(buffers, following)) {
         psl__MappingModeBuffers_Toggle(buffers);
-        return TRUE_;
+        swapped = TRUE_;
+    }
+
+    /*
+     * Queue a full Next behind the Active if the ring has a free buffer. If
+     * the ring is full we overrun the buffers when more data arrives.
+     */
+    following = psl__MappingModeBuffers_Following(buffers, buffers->fill);
+
+    if (psl__MappingModeBuffers_Next_Full(buffers) &&
+        (following != buffers->active)) {
+        buffers->fill = following;
     }
-    return FALSE_;
+
+    return swapped;
 }
 
 boolean_t psl__MappingModeBuffers_Stop(MM_Buffers* buffers)
@@ -481,12 +693,10 @@ boolean_t psl__MappingModeBuffers_Stop(MM_Buffers* buffers)
 
     buffers->stopped = TRUE_;
 
-    if (psl__MappingModeBuffers_Next_Pixels(buffers) > 0 &&
-        psl__MappingModeBuffers_Active_Done(buffers)) {
-        psl__MappingModeBuffers_Toggle(buffers);
-        return TRUE_;
-    }
-    return FALSE_;
+    /*
+     * Stopped makes a partial Next full so it can be handed to the user.
+     */
+    return psl__MappingModeBuffers_Update(buffers);
 }
 
 boolean_t psl__MappingModeBuffers_Stopped(MM_Buffers* buffers)
@@ -520,6 +730,8 @@ int psl__MappingModeBuffer_Open(MM_Buffer* buffer, size_t size)
         buffer->next = 0;
         buffer->bufferPixel = 0;
         buffer->drops = 0;
+        buffer->posted = FALSE_;
+        buffer->firstPixel = 0;
         buffer->marker = 0;
         buffer->size = size;
     }
@@ -532,6 +744,16 @@ int psl__MappingModeBuffer_Close(MM_Buffer* buffer)
     int status = XIA_SUCCESS;
 
     if (buffer->buffer) {
+        /*
+         * The user holds a pointer into a borrowed buffer so it cannot be
+         * freed until it is released.
+         */
+        if (buffer->borrowed) {
+            status = XIA_NOT_IDLE;
+            pslLog(PSL_LOG_ERROR, status,
+                   "Cannot close a borrowed MM buffer: %p", (void*) buffer->buffer);
+            return status;
+        }
         handel_md_free(buffer->buffer);
         memset(buffer, 0, sizeof(*buffer));
     }
@@ -539,21 +761,37 @@ int psl__MappingModeBuffer_Close(MM_Buffer* buffer)
     return status;
 }
 
-int psl__MappingModeBuffers_Open(MM_Buffers* buffers, size_t size, int64_t numPixels)
+int psl__MappingModeBuffers_Open(MM_Buffers* buffers, int count,
+                                 size_t size, int64_t numPixels)
 {
     int status = XIA_SUCCESS;
     int buffer = 0;
 
     pslLog(PSL_LOG_DEBUG,
-           "size:%u (%u)", (uint32_t) size, (uint32_t) (size * sizeof(uint32_t)));
+           "count:%d size:%u (%u)", count,
+           (uint32_t) size, (uint32_t) (size * sizeof(uint32_t)));
+
+    if ((count < MMC_BUFFERS) || (count > MMC_BUFFERS_MAX)) {
+        status = XIA_INVALID_VALUE;
+        pslLog(PSL_LOG_ERROR, status,
+               "Invalid MM buffer count: %d", count);
+        return status;
+    }
 
-    buffers->active = 1;
+    /*
+     * The last buffer starts as the done Active so the first buffer is the
+     * Next and the first buffer the user sees is A.
+     */
+    buffers->count = count;
+    buffers->active = count - 1;
+    buffers->fill = 0;
+    buffers->activeNumber = 1;
     buffers->bufferNumber = 0;
     buffers->numPixels = (uint32_t) numPixels;
     buffers->pixel = 0;
     buffers->stopped = FALSE_;
 
-    while (buffer < MMC_BUFFERS) {
+    while (buffer < count) {
         status = psl__MappingModeBuffer_Open(&buffers->buffer[buffer], size);
         if (status != XIA_SUCCESS) {
             while (buffer > 0) {
@@ -571,7 +809,22 @@ int psl__MappingModeBuffers_Open(MM_Buffers* buffers, size_t size, int64_t numPi
 int psl__MappingModeBuffers_Close(MM_Buffers* buffers)
 {
     int status = XIA_SUCCESS;
-    int buffer = MMC_BUFFERS;
+    int buffer;
+
+    /*
+     * Close none of the buffers if any is borrowed.
+     */
+    for (buffer = 0; buffer < buffers->count; ++buffer) {
+        if (buffers->buffer[buffer].borrowed) {
+            status = XIA_NOT_IDLE;
+            pslLog(PSL_LOG_ERROR, status,
+                   "MMBuffer: Buffer %c is borrowed, cannot close",
+                   psl__MappingModeBuffers_Label(buffers, buffer));
+            return status;
+        }
+    }
+
+    buffer = buffers->count;
 
     while (buffer > 0) {
         int this_status;
@@ -592,28 +845,28 @@ int psl__MappingModeBinner_Open(MM_Binner* binner,
 
     if (!binner->bins) {
         binner->bins = handel_md_alloc(bins * sizeof(uint64_t));
-        if (!binner->bins) {
+        binner->buffer = handel_md_alloc(bins * sizeof(uint32_t));
+        binner->amplitude = handel_md_alloc(MM_BINNER_PULSES * sizeof(int32_t));
+        binner->pulseFlags = handel_md_alloc(MM_BINNER_PULSES * sizeof(uint8_t));
+        if (!binner->bins || !binner->buffer ||
+            !binner->amplitude || !binner->pulseFlags ||
+            !LmBufInit(&binner->lm)) {
+            psl__MappingModeBinner_Close(binner);
             status = XIA_NOMEM;
             pslLog(PSL_LOG_ERROR, status,
                    "Error allocating memory for MM bins");
             return status;
         }
-        binner->buffer = NULL; /* point to next buffer's pixel */
-        if (!binner->buffer) {
-            handel_md_free(binner->bins);
-            binner->bins = NULL;
-            status = XIA_NOMEM;
-            pslLog(PSL_LOG_ERROR, status,
-                   "Error allocating memory for MM Bin's buffer");
-            return status;
-        }
         memset(binner->bins, 0, bins * sizeof(uint64_t));
         binner->flags = MM_BINNER_GATE_HIGH;
         binner->numberOfBins = bins;
+        binner->binShift = 0;
         binner->outOfRange = 0;
+        binner->pulses = 0;
         binner->errorBits = 0;
         memset(&binner->stats, 0, sizeof(binner->stats));
-        binner->bufferSize = 0;
+        binner->bufferSize = bins;
+        binner->bufferLevel = 0;
     }
 
     return status;
@@ -623,7 +876,11 @@ int psl__MappingModeBinner_Close(MM_Binner* binner)
 {
     int status = XIA_SUCCESS;
 
-    if (binner->bins) {
+    if (binner->bins || binner->buffer ||
+        binner->amplitude || binner->pulseFlags) {
+        LmBufClose(&binner->lm);
+        handel_md_free(binner->pulseFlags);
+        handel_md_free(binner->amplitude);
         handel_md_free(binner->buffer);
         handel_md_free(binner->bins);
         memset(binner, 0, sizeof(*binner));
@@ -645,6 +902,149 @@ int psl__MappingModeBinner_BinAdd(MM_Binner* binner,
     return XIA_SUCCESS;
 }
 
+int psl__MappingModeBinner_AddData(MM_Binner*     binner,
+                                   const uint8_t* data,
+                                   size_t         size)
+{
+    int status = XIA_SUCCESS;
+
+    if (!LmBufAddData(&binner->lm, data, size)) {
+        status = XIA_NOMEM;
+        pslLog(PSL_LOG_ERROR, status,
+               "Error allocating memory for MM bin's list mode data");
+    }
+
+    return status;
+}
+
+/*
+ * Pulses are binned while the gate is collecting. SYNC advance
+ * ignores the gate.
+ */
+PSL_STATIC boolean_t psl__MappingModeBinner_Collecting(MM_Binner* binner)
+{
+    boolean_t high = (binner->flags & MM_BINNER_GATE_HIGH) != 0;
+    boolean_t collect_lo = (binner->flags & MM_BINNER_GATE_COLLECT_LO) != 0;
+
+    if ((binner->flags & MM_BINNER_ADVANCE_SYNC) != 0)
+        return TRUE_;
+
+    return high != collect_lo;
+}
+
+/*
+ * Bin the buffered list mode data until a pixel is complete or the data
+ * runs out. A complete pixel's bins and stats are held until the pixel
+ * is cleared, so the caller must write it out and clear it before
+ * binning more data.
+ */
+int psl__MappingModeBinner_Bin(MM_Binner* binner, boolean_t* pixel)
+{
+    LmPacket packet;
+
+    while (!MM_BINNER_PIXEL_VALID(binner)) {
+        size_t pulses;
+        size_t p;
+
+        pulses = LmBufDecodePulses(&binner->lm, binner->amplitude, NULL,
+                                   binner->pulseFlags, MM_BINNER_PULSES);
+        if (pulses > 0) {
+            if (psl__MappingModeBinner_Collecting(binner)) {
+                for (p = 0; p < pulses; ++p) {
+                    int32_t amplitude = binner->amplitude[p];
+
+                    if ((binner->pulseFlags[p] & LMBUF_PULSE_INVALID) != 0)
+                        continue;
+
+                    if (amplitude < 0) {
+                        ++binner->outOfRange;
+                        continue;
+                    }
+
+                    psl__MappingModeBinner_BinAdd(binner,
+                                                  (uint32_t) amplitude >> binner->binShift,
+                                                  1);
+                    ++binner->pulses;
+                }
+            }
+            continue;
+        }
+
+        if (!LmBufGetNextPacket(&binner->lm, &packet))
+            break;
+
+        switch (packet.typ) {
+        case LmPacketTypeGateState:
+        {
+            boolean_t collecting = psl__MappingModeBinner_Collecting(binner);
+
+            binner->timestamp = packet.p.gateState.timestamp;
+
+            if (packet.p.gateState.gate)
+                binner->flags |= MM_BINNER_GATE_HIGH;
+            else
+                binner->flags &= ~MM_BINNER_GATE_HIGH;
+
+            /*
+             * The end of a collection period is the end of the pixel.
+             */
+            if (collecting && !psl__MappingModeBinner_Collecting(binner))
+                binner->flags |= MM_BINNER_GATE_TRIGGER;
+            break;
+        }
+
+        case LmPacketTypeGatedStats:
+            if ((binner->flags & MM_BINNER_ADVANCE_SYNC) == 0) {
+                binner->stats = packet.p.gatedStats;
+                binner->timestamp = packet.p.gatedStats.timestamp;
+                binner->flags |= MM_BINNER_STATS_VALID;
+            }
+            break;
+
+        case LmPacketTypeSpatialStats:
+            if ((binner->flags & MM_BINNER_ADVANCE_SYNC) != 0) {
+                binner->stats = packet.p.spatialStats;
+                binner->timestamp = packet.p.spatialStats.timestamp;
+                binner->flags |= MM_BINNER_GATE_TRIGGER | MM_BINNER_STATS_VALID;
+            }
+            break;
+
+        case LmPacketTypeSync:
+            binner->timestamp = packet.p.sync.timestamp;
+            break;
+
+        case LmPacketTypeSpatialPosition:
+            binner->timestamp = packet.p.spatialPosition.timestamp;
+            break;
+
+        case LmPacketTypeError:
+            binner->errorBits |= MM_BINNER_ERROR_CORRUPT;
+            pslLog(PSL_LOG_ERROR, XIA_INVALID_VALUE,
+                   "MM bin's list mode data: %s", packet.p.error.message);
+            break;
+
+        case LmPacketTypeInternalBufferOverflow:
+            binner->errorBits |= MM_BINNER_ERROR_OVERFLOW;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    *pixel = MM_BINNER_PIXEL_VALID(binner);
+
+    return XIA_SUCCESS;
+}
+
+void psl__MappingModeBinner_PixelClear(MM_Binner* binner)
+{
+    memset(binner->bins, 0, binner->numberOfBins * sizeof(uint64_t));
+    memset(&binner->stats, 0, sizeof(binner->stats));
+    binner->pulses = 0;
+    binner->flags &= ~(MM_BINNER_GATE_TRIGGER | MM_BINNER_STATS_VALID);
+}
+
 int psl__MappingModeBinner_DataCopy(MM_Binner*      binner,
                                     MM_Buffers*     buffers)
 {
@@ -663,7 +1063,7 @@ int psl__MappingModeBinner_DataCopy(MM_Binner*      binner,
         if (copy) {
             pslLog(PSL_LOG_DEBUG,
                    "buffer:%c dst:%u src:%u copy:%u full:%s",
-                   buffers->active == 0 ? 'A' : 'B',
+                   psl__MappingModeBuffers_Active_Label(buffers),
                    (int) dstSize, (int) srcSize, (int) copy,
                    (buffer->level + copy) >= buffer->size ? "YES" : "NO");
 
@@ -746,6 +1146,7 @@ int psl__MappingModeControl_OpenMM0(MM_Control* control,
     memset(mm0, 0, sizeof(MMC0_Data));
 
     status = psl__MappingModeBuffers_Open(&mm0->buffers,
+                                          MMC_BUFFERS,
                                           (size_t) ((number_mca_channels * 2) +
                                                     number_stats),
                                           0);
@@ -769,18 +1170,21 @@ int psl__MappingModeControl_CloseMM0(MM_Control* control)
 
     pslLog(PSL_LOG_DEBUG, "MM0 Close");
 
-    control->mode = MAPPING_MODE_NIL;
-
     if (control->dataFormatter) {
         MMC0_Data* mm0 = control->dataFormatter;
-        int        this_status;
-        this_status = psl__MappingModeBuffers_Close(&mm0->buffers);
-        if ((status == XIA_SUCCESS) && (this_status != XIA_SUCCESS))
-            status = this_status;
+
+        /*
+         * A borrowed buffer fails the close and leaves the control open.
+         */
+        status = psl__MappingModeBuffers_Close(&mm0->buffers);
+        if (status != XIA_SUCCESS)
+            return status;
         handel_md_free(control->dataFormatter);
         control->dataFormatter = NULL;
     }
 
+    control->mode = MAPPING_MODE_NIL;
+
     return status;
 }
 
@@ -795,7 +1199,8 @@ int psl__MappingModeControl_OpenMM1(MM_Control* control,
                                     uint32_t    run_number,
                                     int64_t     num_pixels,
                                     uint16_t    number_mca_channels,
-                                    int64_t     num_pixels_per_buffer)
+                                    int64_t     num_pixels_per_buffer,
+                                    int         buffer_count)
 {
     int status = XIA_SUCCESS;
 
@@ -812,9 +1217,10 @@ int psl__MappingModeControl_OpenMM1(MM_Control* control,
 
     pslLog(PSL_LOG_DEBUG,
            "MM1 Open: listmode=%d run_number=%d num_pixels=%d "\
-           "number_mca_channels=%d num_pixels_per_buffer=%d",
+           "number_mca_channels=%d num_pixels_per_buffer=%d buffer_count=%d",
            (int) listmode, (int) run_number, (int) num_pixels,
-           (int) number_mca_channels, (int) num_pixels_per_buffer);
+           (int) number_mca_channels, (int) num_pixels_per_buffer,
+           buffer_count);
 
     control->mode = MAPPING_MODE_NIL;
 
@@ -840,7 +1246,8 @@ int psl__MappingModeControl_OpenMM1(MM_Control* control,
     buffer_size = psl__MappingModeControl_MM1BufferSize(number_mca_channels,
                                                         num_pixels_per_buffer);
 
-    status = psl__MappingModeBuffers_Open(&mm1->buffers, buffer_size, num_pixels);
+    status = psl__MappingModeBuffers_Open(&mm1->buffers, buffer_count,
+                                          buffer_size, num_pixels);
     if (status != XIA_SUCCESS) {
         psl__MappingModeBinner_Close(&mm1->bins);
         handel_md_free(mm1);
@@ -865,16 +1272,18 @@ int psl__MappingModeControl_CloseMM1(MM_Control* control)
 {
     int status = XIA_SUCCESS;
 
-    control->mode = MAPPING_MODE_NIL;
-
     pslLog(PSL_LOG_DEBUG, "MM1 Close");
 
     if (control->dataFormatter) {
         MMC1_Data* data = control->dataFormatter;
         int        this_status;
-        this_status = psl__MappingModeBuffers_Close(&data->buffers);
-        if ((status == XIA_SUCCESS) && (this_status != XIA_SUCCESS))
-            status = this_status;
+
+        /*
+         * A borrowed buffer fails the close and leaves the control open.
+         */
+        status = psl__MappingModeBuffers_Close(&data->buffers);
+        if (status != XIA_SUCCESS)
+            return status;
         this_status = psl__MappingModeBinner_Close(&data->bins);
         if ((status == XIA_SUCCESS) && (this_status != XIA_SUCCESS))
             status = this_status;
@@ -882,6 +1291,8 @@ int psl__MappingModeControl_CloseMM1(MM_Control* control)
         control->dataFormatter = NULL;
     }
 
+    control->mode = MAPPING_MODE_NIL;
+
     return status;
 }
 
@@ -904,7 +1315,8 @@ size_t psl__MappingModeControl_MM1BufferSize(uint16_t number_mca_channels,
 int psl__MappingModeControl_OpenMM3(MM_Control* control,
                                     int         detChan,
                                     uint32_t    run_number,
-                                    size_t      buffer_size)
+                                    size_t      buffer_size,
+                                    int         buffer_count)
 {
     int status = XIA_SUCCESS;
 
@@ -921,8 +1333,8 @@ int psl__MappingModeControl_OpenMM3(MM_Control* control,
         buffer_size = XMAP_LISTMODE_BUFFER;
 
     pslLog(PSL_LOG_DEBUG,
-           "MM2 Open: run_number=%d buffer_size=%d",
-           (int) run_number, (int) buffer_size);
+           "MM3 Open: run_number=%d buffer_size=%d buffer_count=%d",
+           (int) run_number, (int) buffer_size, buffer_count);
 
     control->mode = MAPPING_MODE_NIL;
 
@@ -938,6 +1350,7 @@ int psl__MappingModeControl_OpenMM3(MM_Control* control,
     memset(mm3, 0, sizeof(MMC3_Data));
 
     status = psl__MappingModeBuffers_Open(&mm3->buffers,
+                                          buffer_count,
                                           buffer_size,
                                           0);
     if (status != XIA_SUCCESS) {
@@ -962,18 +1375,21 @@ int psl__MappingModeControl_CloseMM3(MM_Control* control)
 
     pslLog(PSL_LOG_DEBUG, "MM3 Close");
 
-    control->mode = MAPPING_MODE_NIL;
-
     if (control->dataFormatter) {
         MMC3_Data* mm3 = control->dataFormatter;
-        int        this_status;
-        this_status = psl__MappingModeBuffers_Close(&mm3->buffers);
-        if ((status == XIA_SUCCESS) && (this_status != XIA_SUCCESS))
-            status = this_status;
+
+        /*
+         * A borrowed buffer fails the close and leaves the control open.
+         */
+        status = psl__MappingModeBuffers_Close(&mm3->buffers);
+        if (status != XIA_SUCCESS)
+            return status;
         handel_md_free(control->dataFormatter);
         control->dataFormatter = NULL;
     }
 
+    control->mode = MAPPING_MODE_NIL;
+
     return status;
 }
 
@@ -1095,7 +1511,7 @@ int psl__XMAP_WriteBufferHeader_MM1(MMC1_Data* mm1)
 
     status = psl__XMAP_WriteBufferHeader((uint16_t*) psl__MappingModeBuffers_Next_Data(mmb),
                                          mmb->bufferNumber,
-                                         psl__MappingModeBuffers_Next(mmb),
+                                         psl__MappingModeBuffers_Next_Label(mmb) - 'A',
                                          mm1->runNumber,
                                          psl__MappingModeBuffers_Next_PixelTotal(mmb),
                                          mm1->detChan);
@@ -1196,6 +1612,61 @@ int psl__XMAP_WritePixelHeader_MM1(MMC1_Data* mm1, MM_Pixel_Stats* stats)
     return status;
 }
 
+/*
+ * Write the binner's pixel to the Next buffer and clear the binner for
+ * the next pixel. Bins wider than the 32bit pixel data saturate.
+ */
+int psl__XMAP_WriteBinnerPixel_MM1(MMC1_Data* mm1, MM_Pixel_Stats* stats)
+{
+    int status;
+
+    MM_Buffers* mmb = &mm1->buffers;
+    MM_Binner*  binner = &mm1->bins;
+
+    size_t bin;
+
+    if (binner->numberOfBins != mm1->numMCAChannels) {
+        psl__MappingModeBinner_PixelClear(binner);
+        status = XIA_INVALID_VALUE;
+        pslLog(PSL_LOG_ERROR, status,
+               "MM bins do not match the MCA channels");
+        return status;
+    }
+
+    /*
+     * Take the pixel out of the binner first so it is cleared for the
+     * next pixel even if this one cannot be written.
+     */
+    for (bin = 0; bin < binner->numberOfBins; ++bin) {
+        uint64_t count = binner->bins[bin];
+        binner->buffer[bin] = count > UINT32_MAX ? UINT32_MAX : (uint32_t) count;
+    }
+
+    psl__MappingModeBinner_PixelClear(binner);
+
+    /*
+     * If the Next's level is 0 the buffer does not have an XMAP header. Add
+     * it. We always write a pixel into a new buffer.
+     */
+    if (psl__MappingModeBuffers_Next_Level(mmb) == 0) {
+        status = psl__XMAP_WriteBufferHeader_MM1(mm1);
+        if (status != XIA_SUCCESS)
+            return status;
+    }
+
+    status = psl__XMAP_WritePixelHeader_MM1(mm1, stats);
+    psl__MappingModeBuffers_Pixel_Inc(mmb);
+    if (status != XIA_SUCCESS)
+        return status;
+
+    status = psl__MappingModeBuffers_CopyIn(mmb, binner->buffer,
+                                            binner->numberOfBins);
+    if (status != XIA_SUCCESS)
+        return status;
+
+    return psl__XMAP_UpdateBufferHeader_MM1(mm1);
+}
+
 int psl__XMAP_WriteBufferHeader_MM3(MMC3_Data* mm3)
 {
     int status;
@@ -1204,7 +1675,7 @@ int psl__XMAP_WriteBufferHeader_MM3(MMC3_Data* mm3)
 
     status = psl__XMAP_WriteBufferHeader((uint16_t*) psl__MappingModeBuffers_Active_Data(mmb),
                                          mmb->bufferNumber,
-                                         psl__MappingModeBuffers_Active(mmb),
+                                         psl__MappingModeBuffers_Active_Label(mmb) - 'A',
                                          0,
                                          0,
                                          mm3->detChan);
@@ -161,14 +161,40 @@ PSL_STATIC int psl__StartRun(int detChan, unsigned short resume,
 PSL_STATIC int psl__StopRun(int detChan, Detector *detector, Module *m);
 PSL_STATIC int psl__GetRunData(int detChan, const char *name, void *value,
                                XiaDefaults *defs, Detector *detector, Module *m);
+PSL_STATIC int psl__GetRunDataHandle(int detChan, const char *name, int *handle,
+                                     Detector *detector, Module *m);
+PSL_STATIC int psl__GetRunDataByHandle(int detChan, int handle, void *value,
+                                       Detector *detector, Module *m);
+PSL_STATIC int psl__GetRunDataMulti(const char *name, int count,
+                                    const int *detChans, void **values,
+                                    Module *m);
+PSL_STATIC int psl__GetBufferReady(int detChan, int *buffer, boolean_t *active,
+                                   Detector *detector, Module *m);
 PSL_STATIC int psl__SpecialRun(int detChan, const char *name, void *info,
                                XiaDefaults *defaults, Detector *detector, Module *module);
 PSL_STATIC int psl__GetSpecialRunData(int detChan, const char *name, void *value, XiaDefaults *defaults,
                                       Detector *detector, Module *module);
 
 PSL_STATIC int psl__ModuleTransactionSend(Module* module, SincBuffer* packet);
+PSL_STATIC int psl__ModuleTransactionSendExpecting(Module* module, SincBuffer* packet,
+                                                   int channel, int type);
 PSL_STATIC int psl__ModuleTransactionReceive(Module* module, Sinc_Response* response);
 PSL_STATIC int psl__ModuleTransactionEnd(Module* module);
+PSL_STATIC int psl__ModuleRequestSend(Module* module, SincBuffer* packet,
+                                      TransactionState state, const char* what,
+                                      int channel, int type, uint32_t* id);
+PSL_STATIC int psl__ModuleRequestReceive(Module* module, uint32_t id,
+                                         Sinc_Response* response);
+PSL_STATIC int psl__ModulePipelineBegin(Module* module);
+PSL_STATIC int psl__ModulePipelineEnd(Module* module);
+PSL_STATIC int psl__ModuleParamDirty(Module* module, int channel,
+                                     SiToro__Sinc__KeyValue* param);
+PSL_STATIC int psl__ModuleParamsFlush(Module* module);
+
+PSL_STATIC int psl__ModuleReceiverStart(Module* module);
+PSL_STATIC int psl__ModuleReceiverStop(Module* module);
+PSL_STATIC int psl__ModuleArenaReserve(Module* module, size_t size);
+PSL_STATIC int psl__ModuleArenaSize(Module* module);
 
 PSL_STATIC boolean_t psl__CanRemoveName(const char *name);
 
@@ -190,6 +216,10 @@ PSL_STATIC int psl__BoardOp_BufferDone(int detChan, Detector* detector, Module*
                                        const char *name, void *value);
 PSL_STATIC int psl__BoardOp_MappingPixelNext(int detChan, Detector* detector, Module* module,
                                              const char *name, void *value);
+PSL_STATIC int psl__BoardOp_BufferRelease(int detChan, Detector* detector, Module* module,
+                                          const char *name, void *value);
+PSL_STATIC int psl__BoardOp_GetReceiveArena(int detChan, Detector* detector, Module* module,
+                                            const char *name, void *value);
 PSL_STATIC int psl__BoardOp_GetBoardInfo(int detChan, Detector* detector, Module* module,
                                          const char *name, void *value);
 PSL_STATIC int psl__BoardOp_GetConnected(int detChan, Detector* detector, Module* module,
@@ -207,9 +237,16 @@ PSL_STATIC int psl__BoardOp_GetBoardFeatures(int detChan, Detector* detector, Mo
 PSL_STATIC PSL_INLINE int psl__SetAcqValue(acqValue*    acqVal,
                                            const double value);
 PSL_STATIC bool psl__AcqRemoved(const char *name);
+PSL_STATIC void psl__IndexAcquisitions(void);
 PSL_STATIC FalconXNDetector* psl__FindDetector(Module* module, int channel);
+PSL_STATIC void psl__MappingModeBuffers_Notify(FalconXNDetector* fDetector,
+                                               MM_Buffers*       mmb,
+                                               boolean_t         swapped);
 PSL_STATIC int psl__GetParam(Module* module, int channel, const char* name,
                              SiToro__Sinc__GetParamResponse** resp);
+PSL_STATIC int psl__GetParams(Module* module, int count, int* channels,
+                              const char** names,
+                              SiToro__Sinc__GetParamResponse** resp);
 PSL_STATIC int psl__SetParam(Module* module, int modChan,
                              SiToro__Sinc__KeyValue* param);
 PSL_STATIC int psl__GetParamValue(Module* module, int channel, const char* name,
@@ -233,6 +270,7 @@ PSL_STATIC int psl__SyncGateCollectionMode(Module *module, FalconXNDetector *fDe
 PSL_STATIC int psl__ClearGateCollectionMode(Module *module, FalconXNDetector *fDetector);
 PSL_STATIC int psl__SyncGateVetoMode(Module *module, FalconXNDetector *fDetector);
 PSL_STATIC int psl__ClearGateVetoMode(Module *module, FalconXNDetector *fDetector);
+PSL_STATIC ChannelState psl__mm1_RunState(FalconXNDetector* fDetector);
 PSL_STATIC boolean_t psl__GetCalibrated(Module* module, FalconXNDetector* fDetector);
 PSL_STATIC int psl__UpdateCalibration(Module* module, FalconXNDetector* fDetector);
 PSL_STATIC int64_t psl__SamplesToNS(FalconXNDetector *fDetector, int64_t samples);
@@ -324,6 +362,8 @@ ACQ_HANDLER_DECL(number_of_scas);
 ACQ_HANDLER_DECL(sca);
 ACQ_HANDLER_DECL(num_map_pixels);
 ACQ_HANDLER_DECL(num_map_pixels_per_buffer);
+ACQ_HANDLER_DECL(mapping_buffer_count);
+ACQ_HANDLER_DECL(list_mode_binning);
 ACQ_HANDLER_DECL(pixel_advance_mode);
 ACQ_HANDLER_DECL(input_logic_polarity);
 ACQ_HANDLER_DECL(gate_ignore);
@@ -392,6 +432,8 @@ static const AcquisitionValue DEFAULT_ACQ_VALUES[] = {
     ACQ_DEFAULT(sca,                          acqFloat,   0.0, PSL_ACQ_E,  NULL, NULL),
     ACQ_DEFAULT(num_map_pixels_per_buffer,    acqInt,    1024, PSL_ACQ_HD, NULL, NULL),
     ACQ_DEFAULT(num_map_pixels,               acqInt,       0, PSL_ACQ_HD, NULL, NULL),
+    ACQ_DEFAULT(mapping_buffer_count,         acqInt, MMC_BUFFERS, PSL_ACQ_HD, NULL, NULL),
+    ACQ_DEFAULT(list_mode_binning,            acqBool,    0.0, PSL_ACQ_HD, NULL, NULL),
     ACQ_DEFAULT(pixel_advance_mode,           acqInt,       0, PSL_ACQ_HD, NULL, NULL),
     ACQ_DEFAULT(input_logic_polarity,         acqInt,       0, PSL_ACQ_HD, NULL, NULL),
     ACQ_DEFAULT(gate_ignore,                  acqInt,     1.0, PSL_ACQ_HD, NULL, NULL),
@@ -401,6 +443,20 @@ static const AcquisitionValue DEFAULT_ACQ_VALUES[] = {
 
 #define SI_DET_NUM_OF_DEFAULT_ACQ_VALUES ((int)(sizeof(DEFAULT_ACQ_VALUES) / sizeof(const AcquisitionValue)))
 
+/*
+ * The acquisition values sorted by name for lookup. Each name maps to the
+ * entry the STRNEQ scan of the table returns for it, so the order rules
+ * above still hold. Names not in the table, such as the numbered SCA
+ * values, fall back to the scan. Built once by the PSL init.
+ */
+typedef struct {
+    const char*             name;
+    const AcquisitionValue* acq;
+} AcquisitionIndex;
+
+static AcquisitionIndex ACQ_VALUES_INDEX[SI_DET_NUM_OF_DEFAULT_ACQ_VALUES];
+static int acqValuesIndexed;
+
 /* These are allowed in old ini files but not from the API. */
 static const char* REMOVED_ACQ_VALUES[] = {
     "coarse_bin_scale",
@@ -415,6 +471,7 @@ static  BoardOperation boardOps[] =
         { "apply",                psl__BoardOp_Apply },
         { "buffer_done",          psl__BoardOp_BufferDone },
         { "mapping_pixel_next",   psl__BoardOp_MappingPixelNext },
+        { "buffer_release",       psl__BoardOp_BufferRelease },
 
         { "get_board_info",       psl__BoardOp_GetBoardInfo },
         { "get_board_features",   psl__BoardOp_GetBoardFeatures},
@@ -423,12 +480,16 @@ static  BoardOperation boardOps[] =
         { "get_connected",        psl__BoardOp_GetConnected },
         { "get_channel_count",    psl__BoardOp_GetChannelCount },
         { "get_serial_number",    psl__BoardOp_GetSerialNumber },
-        { "get_firmware_version", psl__BoardOp_GetFirmwareVersion }
+        { "get_firmware_version", psl__BoardOp_GetFirmwareVersion },
+        { "get_receive_arena",    psl__BoardOp_GetReceiveArena }
     };
 
 /* The PSL Handlers table. This is exported to Handel. */
 static PSLHandlers handlers;
 
+/* The receive reactor shared by all modules. */
+static FalconXNReactor reactor;
+
 PSL_SHARED int falconxn_PSLInit(const PSLHandlers** psl);
 PSL_SHARED int falconxn_PSLInit(const PSLHandlers** psl)
 {
@@ -448,11 +509,40 @@ PSL_SHARED int falconxn_PSLInit(const PSLHandlers** psl)
     handlers.startRun = psl__StartRun;
     handlers.stopRun = psl__StopRun;
     handlers.getRunData = psl__GetRunData;
+    handlers.getRunDataHandle = psl__GetRunDataHandle;
+    handlers.getRunDataByHandle = psl__GetRunDataByHandle;
+    handlers.getRunDataMulti = psl__GetRunDataMulti;
+    handlers.getBufferReady = psl__GetBufferReady;
     handlers.doSpecialRun = psl__SpecialRun;
     handlers.getSpecialRunData = psl__GetSpecialRunData;
     handlers.canRemoveName = psl__CanRemoveName;
     handlers.freeSCAs = pslDestroySCAs;
 
+    psl__IndexAcquisitions();
+
+    /*
+     * The reactor locks are shared by all modules. Create them once here
+     * rather than on the first attach so attaches and detaches of
+     * different modules are always serialized.
+     */
+    if (!handel_md_mutex_ready(&reactor.control)) {
+        int status = handel_md_mutex_create(&reactor.control);
+        if (status != 0) {
+            pslLog(PSL_LOG_ERROR, XIA_THREAD_ERROR,
+                   "Reactor control mutex create failed: %d", status);
+            return XIA_THREAD_ERROR;
+        }
+    }
+
+    if (!handel_md_mutex_ready(&reactor.lock)) {
+        int status = handel_md_mutex_create(&reactor.lock);
+        if (status != 0) {
+            pslLog(PSL_LOG_ERROR, XIA_THREAD_ERROR,
+                   "Reactor mutex create failed: %d", status);
+            return XIA_THREAD_ERROR;
+        }
+    }
+
     *psl = &handlers;
     return XIA_SUCCESS;
 }
@@ -570,7 +660,7 @@ PSL_STATIC int falconXNSincErrorToHandelError(SincError* se)
  * the given name could have additional parameters appended to it
  * e.g. scalo_0 can match "sca"
  */
-PSL_STATIC const AcquisitionValue* psl__GetAcquisition(const char* name)
+PSL_STATIC const AcquisitionValue* psl__ScanAcquisitions(const char* name)
 {
     int i;
     for (i = 0; i < SI_DET_NUM_OF_DEFAULT_ACQ_VALUES; i++) {
@@ -581,6 +671,55 @@ PSL_STATIC const AcquisitionValue* psl__GetAcquisition(const char* name)
     return NULL;
 }
 
+PSL_STATIC int psl__CompareAcquisitions(const void* a, const void* b)
+{
+    const AcquisitionIndex* aa = a;
+    const AcquisitionIndex* bb = b;
+    return strcmp(aa->name, bb->name);
+}
+
+PSL_STATIC int psl__CompareAcquisitionName(const void* key, const void* entry)
+{
+    const AcquisitionIndex* index = entry;
+    return strcmp((const char*) key, index->name);
+}
+
+/*
+ * Build the sorted index of the acquisition values. The index entry for
+ * a name is found by the scan so a name that has an earlier prefix in
+ * the table resolves to the same entry as before.
+ */
+PSL_STATIC void psl__IndexAcquisitions(void)
+{
+    int i;
+
+    if (acqValuesIndexed)
+        return;
+
+    for (i = 0; i < SI_DET_NUM_OF_DEFAULT_ACQ_VALUES; i++) {
+        ACQ_VALUES_INDEX[i].name = DEFAULT_ACQ_VALUES[i].name;
+        ACQ_VALUES_INDEX[i].acq = psl__ScanAcquisitions(DEFAULT_ACQ_VALUES[i].name);
+    }
+
+    qsort(ACQ_VALUES_INDEX, SI_DET_NUM_OF_DEFAULT_ACQ_VALUES,
+          sizeof(ACQ_VALUES_INDEX[0]), psl__CompareAcquisitions);
+
+    acqValuesIndexed = 1;
+}
+
+PSL_STATIC const AcquisitionValue* psl__GetAcquisition(const char* name)
+{
+    if (acqValuesIndexed) {
+        const AcquisitionIndex* index =
+            bsearch(name, ACQ_VALUES_INDEX, SI_DET_NUM_OF_DEFAULT_ACQ_VALUES,
+                    sizeof(ACQ_VALUES_INDEX[0]), psl__CompareAcquisitionName);
+        if (index != NULL)
+            return index->acq;
+    }
+
+    return psl__ScanAcquisitions(name);
+}
+
 /*
  * Get a typed acq value from its default. It is a debug exception to call
  * on a READ_ONLY value or if the default does not exist. After UserSetup
@@ -1206,7 +1345,8 @@ PSL_STATIC int psl__GetParam(Module*                          module,
 
     SincEncodeGetParam(&packet, channel, name);
 
-    status = psl__ModuleTransactionSend(module, &packet);
+    status = psl__ModuleTransactionSendExpecting(module, &packet, channel,
+                                                 SI_TORO__SINC__MESSAGE_TYPE__GET_PARAM_RESPONSE);
     if (status != XIA_SUCCESS) {
         pslLog(PSL_LOG_ERROR, status,
                "Error requesting the parameter");
@@ -1235,35 +1375,106 @@ PSL_STATIC int psl__GetParam(Module*                          module,
     return status;
 }
 
+/*
+ * Get a number of parameters in one request. Each name is read from the
+ * matching channel and the results are in the order of the names.
+ */
+PSL_STATIC int psl__GetParams(Module*                          module,
+                              int                              count,
+                              int*                             channels,
+                              const char**                     names,
+                              SiToro__Sinc__GetParamResponse** resp)
+{
+    int status = XIA_SUCCESS;
+    int i;
+
+    uint8_t    pad[1024];
+    SincBuffer packet = PSL_SINC_BUFFER_INIT(pad);
+    Sinc_Response response;
+
+    char logValue[MAX_PARAM_STR_LEN];
+
+    *resp = NULL;
+
+    if (!SincEncodeGetParams(&packet, channels, names, count)) {
+        status = XIA_NOMEM;
+        pslLog(PSL_LOG_ERROR, status,
+               "Error encoding the parameters request");
+        return status;
+    }
+
+    status = psl__ModuleTransactionSendExpecting(module, &packet, -1,
+                                                 SI_TORO__SINC__MESSAGE_TYPE__GET_PARAM_RESPONSE);
+    if (status != XIA_SUCCESS) {
+        pslLog(PSL_LOG_ERROR, status,
+               "Error requesting the parameters");
+        return status;
+    }
+
+    response.channel = -1;
+    response.type = SI_TORO__SINC__MESSAGE_TYPE__GET_PARAM_RESPONSE;
+
+    status = psl__ModuleTransactionReceive(module, &response);
+
+    if (status == XIA_SUCCESS) {
+        *resp = response.response;
+
+        if ((*resp)->n_results != (size_t) count) {
+            status = XIA_PROTOCOL_ERROR;
+            pslLog(PSL_LOG_ERROR, status,
+                   "Parameters response has %zu results, expected %d",
+                   (*resp)->n_results, count);
+            si_toro__sinc__get_param_response__free_unpacked(*resp, NULL);
+            *resp = NULL;
+        }
+        else {
+            for (i = 0; i < count; ++i) {
+                psl__SPrintKV(logValue, sizeof(logValue) / sizeof(logValue[0]),
+                              (*resp)->results[i]);
+                pslLog(PSL_LOG_INFO, "Param read: %s = %s", names[i], logValue);
+            }
+        }
+    }
+    else {
+        pslLog(PSL_LOG_ERROR, status,
+               "Error receiving parameters");
+    }
+
+    psl__ModuleTransactionEnd(module);
+
+    return status;
+}
+
 PSL_STATIC int psl__SetParam(Module*                 module,
                              int                     modChan,
                              SiToro__Sinc__KeyValue* param)
 {
     int status;
 
-    uint8_t    pad[256];
-    SincBuffer packet = PSL_SINC_BUFFER_INIT(pad);
-
     char logValue[MAX_PARAM_STR_LEN];
 
     psl__SPrintKV(logValue, sizeof(logValue) / sizeof(logValue[0]),
                   param);
     pslLog(PSL_LOG_DEBUG, "Param write: %s = %s", param->key, logValue);
 
-    SincEncodeSetParam(&packet, modChan, param);
+    /*
+     * A set is a pipeline of one. In an outer pipeline the set is held in
+     * the dirty set and sent with the other sets when the outer pipeline
+     * ends. Any error is returned at the end of the outer pipeline.
+     */
+    status = psl__ModulePipelineBegin(module);
+    if (status != XIA_SUCCESS)
+        return status;
 
-    status = psl__ModuleTransactionSend(module, &packet);
+    status = psl__ModuleParamDirty(module, modChan, param);
     if (status != XIA_SUCCESS) {
         pslLog(PSL_LOG_ERROR, status,
                "Error setting a parameter");
+        psl__ModulePipelineEnd(module);
         return status;
     }
 
-    status = psl__CheckSuccessResponse(module);
-
-    psl__ModuleTransactionEnd(module);
-
-    return status;
+    return psl__ModulePipelineEnd(module);
 }
 
 /*
@@ -1572,7 +1783,9 @@ PSL_STATIC int psl__UpdateCalibration(Module* module, FalconXNDetector* fDetecto
     pslLog(PSL_LOG_DEBUG, "Get calibration data");
     SincEncodeGetCalibration(&packet, psl__DetectorChannel(fDetector));
 
-    status = psl__ModuleTransactionSend(module, &packet);
+    status = psl__ModuleTransactionSendExpecting(module, &packet,
+                                                 psl__DetectorChannel(fDetector),
+                                                 SI_TORO__SINC__MESSAGE_TYPE__GET_CALIBRATION_RESPONSE);
     if (status != XIA_SUCCESS) {
         pslLog(PSL_LOG_ERROR, status,
                "Error requesting detector characterisation data");
@@ -1639,7 +1852,8 @@ PSL_STATIC int psl__GetParamDetails(Module* module, int channel, const char *pre
 
     SincEncodeListParamDetails(&packet, channel, prefix);
 
-    status = psl__ModuleTransactionSend(module, &packet);
+    status = psl__ModuleTransactionSendExpecting(module, &packet, channel,
+                                                 SI_TORO__SINC__MESSAGE_TYPE__LIST_PARAM_DETAILS_RESPONSE);
     if (status != XIA_SUCCESS) {
         pslLog(PSL_LOG_ERROR, status, "Error requesting param details");
         return status;
@@ -1716,10 +1930,22 @@ PSL_STATIC int psl__SetAcquisitionValues(int        detChan,
             return status;
         }
 
-        /* Validate the value and send it to the board */
+        /*
+         * Validate the value and send it to the board. A value can map to
+         * many parameters and the pipeline sends them in one message.
+         */
+        status = psl__ModulePipelineBegin(module);
+        if (status != XIA_SUCCESS)
+            return status;
+
         status = acq->handler(module, detector, fDetector->modDetChan,
                               fDetector, defaults, name, &dvalue, FALSE_);
 
+        if (status == XIA_SUCCESS)
+            status = psl__ModulePipelineEnd(module);
+        else
+            psl__ModulePipelineEnd(module);
+
         if (status != XIA_SUCCESS) {
             pslLog(PSL_LOG_ERROR, status,
                    "Error writing in acquisition value handler: %s", name);
@@ -2913,7 +3139,6 @@ ACQ_HANDLER_DECL(mapping_mode)
     int status;
 
     UNUSED(defaults);
-    UNUSED(fDetector);
     UNUSED(detector);
     UNUSED(channel);
     UNUSED(module);
@@ -2929,6 +3154,8 @@ ACQ_HANDLER_DECL(mapping_mode)
                    "Invalid mapping_mode: %f", *value);
             return status;
         }
+
+        fDetector->mappingMode = (MM_Mode) *value;
     }
 
     return XIA_SUCCESS;
@@ -2980,32 +3207,35 @@ ACQ_HANDLER_DECL(number_mca_channels)
     ACQ_HANDLER_LOG(number_mca_channels);
 
     if (read) {
-        psl__SincParamValue sincVal;
-        int64_t lowIndex, highIndex;
+        SiToro__Sinc__GetParamResponse* resp = NULL;
 
-        status = psl__GetParamValue(module, channel, "histogram.binSubRegion.highIndex",
-                                    SI_TORO__SINC__KEY_VALUE__PARAM_TYPE__INT_TYPE,
-                                    &sincVal);
+        int         channels[2];
+        const char* names[2] = {
+            "histogram.binSubRegion.highIndex",
+            "histogram.binSubRegion.lowIndex"
+        };
+
+        channels[0] = channels[1] = channel;
+
+        status = psl__GetParams(module, 2, channels, names, &resp);
         if (status != XIA_SUCCESS) {
             pslLog(PSL_LOG_ERROR, status,
-                   "Unable to get the histogram region high index");
+                   "Unable to get the histogram region indexes");
             return status;
         }
 
-        highIndex = sincVal.intval;
-
-        status = psl__GetParamValue(module, channel, "histogram.binSubRegion.lowIndex",
-                                    SI_TORO__SINC__KEY_VALUE__PARAM_TYPE__INT_TYPE,
-                                    &sincVal);
-        if (status != XIA_SUCCESS) {
+        if (!resp->results[0]->has_intval || !resp->results[1]->has_intval) {
+            status = XIA_BAD_VALUE;
             pslLog(PSL_LOG_ERROR, status,
-                   "Unable to get the histogram region low index");
-            return status;
+                   "Histogram region indexes are not integers");
+        }
+        else {
+            *value = (double) resp->results[0]->intval - resp->results[1]->intval + 1;
         }
 
-        lowIndex = sincVal.intval;
+        si_toro__sinc__get_param_response__free_unpacked(resp, NULL);
 
-        *value = (double) highIndex - lowIndex + 1;
+        return status;
     }
     else {
         if (*value > MAX_MCA_CHANNELS || *value < MIN_MCA_CHANNELS) {
@@ -3697,6 +3927,50 @@ ACQ_HANDLER_DECL(num_map_pixels_per_buffer)
     return status;
 }
 
+/* The number of mapping buffers in the ring. The user reads the A/B
+ * pair and the extra buffers absorb readout stalls. Used on run start.
+ */
+ACQ_HANDLER_DECL(mapping_buffer_count)
+{
+    int status = XIA_SUCCESS;
+
+    UNUSED(detector);
+    UNUSED(fDetector);
+    UNUSED(defaults);
+
+    ACQ_HANDLER_LOG(mapping_buffer_count);
+
+    if (read) {
+    }
+    else {
+        if ((*value < MMC_BUFFERS) || (*value > MMC_BUFFERS_MAX))
+            status = XIA_ACQ_OOR;
+    }
+
+    return status;
+}
+
+/* This acquisition value only caches the value. When set, mapping mode
+ * 1 runs the channel in list mode and bins the pulses into pixels on
+ * the host, for pixels too short for a histogram transfer each.
+ */
+ACQ_HANDLER_DECL(list_mode_binning)
+{
+    UNUSED(detector);
+    UNUSED(fDetector);
+    UNUSED(defaults);
+    UNUSED(value);
+
+    ACQ_HANDLER_LOG(list_mode_binning);
+
+    if (read) {
+    }
+    else {
+    }
+
+    return XIA_SUCCESS;
+}
+
 /* This acquisition value only caches the value. The set is performed
  * on run start because a single SINC param is shared by preset_type
  * and pixel_advance_mode.
@@ -4280,10 +4554,13 @@ PSL_STATIC int psl__Stop_MappingMode_1(Module* module)
         if ((status == XIA_SUCCESS) && (cstatus != XIA_SUCCESS))
             status = cstatus;
 
-        cstatus = psl__StopHistogram(module, channel);
-
         FalconXNDetector* fDetector = psl__FindDetector(module, channel);
 
+        if (psl__mm1_RunState(fDetector) == ChannelListMode)
+            cstatus = psl__StopListMode(module, channel);
+        else
+            cstatus = psl__StopHistogram(module, channel);
+
         lstatus = psl__DetectorLock(fDetector);
         if (lstatus != XIA_SUCCESS) {
             pslLog(PSL_LOG_ERROR, lstatus,
@@ -4293,7 +4570,11 @@ PSL_STATIC int psl__Stop_MappingMode_1(Module* module)
 
         if (psl__MappingModeControl_IsMode(&fDetector->mmc, MAPPING_MODE_MCA_FSM)) {
             MMC1_Data* mm1 = psl__MappingModeControl_MM1Data(&fDetector->mmc);
-            psl__MappingModeBuffers_Stop(&mm1->buffers);
+            /*
+             * Stopping can make a partial buffer full and swap it in.
+             */
+            boolean_t swapped = psl__MappingModeBuffers_Stop(&mm1->buffers);
+            psl__MappingModeBuffers_Notify(fDetector, &mm1->buffers, swapped);
         } else {
             cstatus = XIA_NOT_ACTIVE;
             pslLog(PSL_LOG_ERROR, status, "Not MM1 mode: %s:%d", module->alias, channel);
@@ -4330,7 +4611,12 @@ PSL_STATIC int psl__Start_MappingMode_1(unsigned short resume, Module* module)
         acqValue number_mca_channels;
         acqValue num_map_pixels;
         acqValue num_map_pixels_per_buffer;
+        acqValue mapping_buffer_count;
         acqValue pixel_advance_mode;
+        acqValue input_logic_polarity;
+        acqValue list_mode_binning;
+
+        int64_t coarse_bin_scaling = 1;
 
         FalconXNDetector* fDetector = psl__FindDetector(module, channel);
         ASSERT(fDetector);
@@ -4361,8 +4647,43 @@ PSL_STATIC int psl__Start_MappingMode_1(unsigned short resume, Module* module)
         num_map_pixels = psl__GetAcqValue(fDetector, "num_map_pixels");
         num_map_pixels_per_buffer = psl__GetAcqValue(fDetector,
                                                      "num_map_pixels_per_buffer");
+        mapping_buffer_count = psl__GetAcqValue(fDetector, "mapping_buffer_count");
         pixel_advance_mode = psl__GetAcqValue(fDetector, "pixel_advance_mode");
+        input_logic_polarity = psl__GetAcqValue(fDetector, "input_logic_polarity");
+        list_mode_binning = psl__GetAcqValue(fDetector, "list_mode_binning");
+
+        if (list_mode_binning.ref.b) {
+            psl__SincParamValue sincVal;
+
+            /*
+             * Binned pixels advance on the gate or sync marks in the list
+             * mode stream. There is no mark for a user advance.
+             */
+            if (pixel_advance_mode.ref.i == XIA_MAPPING_CTL_USER) {
+                status = XIA_BAD_VALUE;
+                pslLog(PSL_LOG_ERROR, status,
+                       "list_mode_binning needs GATE or SYNC pixel advance: %s:%d",
+                       module->alias, channel);
+                psl__Stop_MappingMode_1(module);
+                return status;
+            }
+
+            /*
+             * Bin the pulse amplitudes the way the box bins its histograms.
+             */
+            status = psl__GetParamValue(module, channel, "histogram.coarseBinScaling",
+                                        SI_TORO__SINC__KEY_VALUE__PARAM_TYPE__INT_TYPE,
+                                        &sincVal);
+            if (status != XIA_SUCCESS) {
+                pslLog(PSL_LOG_ERROR, status,
+                       "Error getting the coarse bin scaling for starting mm1: %s:%d",
+                       module->alias, channel);
+                psl__Stop_MappingMode_1(module);
+                return status;
+            }
 
+            coarse_bin_scaling = sincVal.intval;
+        }
 
         /*
          * Receive histograms on mca_refresh intervals for user advance. Other
@@ -4412,11 +4733,12 @@ PSL_STATIC int psl__Start_MappingMode_1(unsigned short resume, Module* module)
 
         status = psl__MappingModeControl_OpenMM1(&fDetector->mmc,
                                                  fDetector->detChan,
-                                                 FALSE_,
+                                                 list_mode_binning.ref.b,
                                                  fModule->runNumber,
                                                  num_map_pixels.ref.i,
                                                  (uint16_t)number_mca_channels.ref.i,
-                                                 num_map_pixels_per_buffer.ref.i);
+                                                 num_map_pixels_per_buffer.ref.i,
+                                                 (int) mapping_buffer_count.ref.i);
 
         if (status != XIA_SUCCESS) {
             psl__DetectorUnlock(fDetector);
@@ -4435,6 +4757,21 @@ PSL_STATIC int psl__Start_MappingMode_1(unsigned short resume, Module* module)
             mm1->pixelAdvanceCounter = -1;
         }
 
+        /*
+         * Set up the binner for the pixel advance and the box's binning.
+         */
+        if (list_mode_binning.ref.b) {
+            MM_Binner* binner;
+            binner = &psl__MappingModeControl_MM1Data(&fDetector->mmc)->bins;
+            while ((binner->binShift < 31) &&
+                   ((int64_t) 1 << binner->binShift) < coarse_bin_scaling)
+                ++binner->binShift;
+            if (pixel_advance_mode.ref.i == XIA_MAPPING_CTL_SYNC)
+                binner->flags |= MM_BINNER_ADVANCE_SYNC;
+            if (input_logic_polarity.ref.i == XIA_GATE_COLLECT_LO)
+                binner->flags |= MM_BINNER_GATE_COLLECT_LO;
+        }
+
         status = psl__DetectorUnlock(fDetector);
         if (status != XIA_SUCCESS)
             return status;
@@ -4459,7 +4796,10 @@ PSL_STATIC int psl__Start_MappingMode_1(unsigned short resume, Module* module)
             continue;
         }
 
-        status = psl__StartHistogram(module, channel);
+        if (psl__mm1_RunState(fDetector) == ChannelListMode)
+            status = psl__StartListMode(module, channel);
+        else
+            status = psl__StartHistogram(module, channel);
         if (status != XIA_SUCCESS) {
             psl__Stop_MappingMode_1(module);
             return status;
@@ -4473,6 +4813,7 @@ PSL_STATIC int psl__Stop_MappingMode_3(Module* module)
 {
     int status = XIA_SUCCESS;
     int cstatus = XIA_SUCCESS;
+    int lstatus = XIA_SUCCESS;
 
     int channel;
 
@@ -4487,7 +4828,28 @@ PSL_STATIC int psl__Stop_MappingMode_3(Module* module)
         if ((status == XIA_SUCCESS) && (cstatus != XIA_SUCCESS))
             status = cstatus;
 
+        FalconXNDetector* fDetector = psl__FindDetector(module, channel);
+
         cstatus = psl__StopListMode(module, channel);
+
+        lstatus = psl__DetectorLock(fDetector);
+        if (lstatus != XIA_SUCCESS) {
+            pslLog(PSL_LOG_ERROR, lstatus,
+                   "Unable to lock the detector: %s:%d", module->alias, channel);
+            continue;
+        }
+
+        if (psl__MappingModeControl_IsMode(&fDetector->mmc, MAPPING_MODE_LIST)) {
+            MMC3_Data* mm3 = psl__MappingModeControl_MM3Data(&fDetector->mmc);
+            boolean_t  swapped = psl__MappingModeBuffers_Stop(&mm3->buffers);
+            psl__MappingModeBuffers_Notify(fDetector, &mm3->buffers, swapped);
+        }
+
+        lstatus = psl__DetectorUnlock(fDetector);
+        if (lstatus != XIA_SUCCESS) {
+            pslLog(PSL_LOG_ERROR, lstatus,
+                   "Unable to unlock the detector: %s:%d", module->alias, channel);
+        }
     }
 
     if ((status == XIA_SUCCESS) && (cstatus != XIA_SUCCESS))
@@ -4510,6 +4872,7 @@ PSL_STATIC int psl__Start_MappingMode_3(unsigned short resume,
             continue;
 
         FalconXNDetector* fDetector;
+        acqValue          mapping_buffer_count;
 
         fDetector = psl__FindDetector(module, channel);
         ASSERT(fDetector);
@@ -4562,10 +4925,13 @@ PSL_STATIC int psl__Start_MappingMode_3(unsigned short resume,
             return status;
         }
 
+        mapping_buffer_count = psl__GetAcqValue(fDetector, "mapping_buffer_count");
+
         status = psl__MappingModeControl_OpenMM3(&fDetector->mmc,
                                                  fDetector->detChan,
                                                  fModule->runNumber,
-                                                 0);
+                                                 0,
+                                                 (int) mapping_buffer_count.ref.i);
 
         if (status != XIA_SUCCESS) {
             psl__DetectorUnlock(fDetector);
@@ -4633,6 +4999,13 @@ PSL_STATIC int psl__StartRun(int detChan, unsigned short resume, XiaDefaults *de
     pslLog(PSL_LOG_DEBUG, "Detector:%d Mapping Mode:%d",
            detChan, (int) mapping_mode.ref.i);
 
+    status = psl__ModuleArenaSize(module);
+    if (status != XIA_SUCCESS) {
+        pslLog(PSL_LOG_ERROR, status,
+               "Unable to size the receive arena");
+        return status;
+    }
+
     switch (mapping_mode.ref.i)
     {
     case 0:
@@ -4691,6 +5064,18 @@ PSL_STATIC int psl__StopRun(int detChan, Detector *detector, Module *module)
     }
 }
 
+/*
+ * The channel state of an mm1 run. Runs binning list mode on the host
+ * are in list mode.
+ */
+PSL_STATIC ChannelState psl__mm1_RunState(FalconXNDetector* fDetector)
+{
+    if (psl__MappingModeControl_IsMode(&fDetector->mmc, MAPPING_MODE_MCA_FSM) &&
+        psl__MappingModeControl_MM1Data(&fDetector->mmc)->listMode)
+        return ChannelListMode;
+    return ChannelHistogram;
+}
+
 /*
  * True if the detector's current or last mapping mode control matches
  * the given mode and the current state is running or ready. That
@@ -4708,7 +5093,7 @@ PSL_STATIC bool psl__RunningOrReady(FalconXNDetector* fDetector,
 PSL_STATIC bool psl__mm1_RunningOrReady(FalconXNDetector* fDetector)
 {
     return psl__RunningOrReady(fDetector,
-                               ChannelHistogram,
+                               psl__mm1_RunState(fDetector),
                                MAPPING_MODE_MCA_FSM);
 }
 
@@ -4719,6 +5104,38 @@ PSL_STATIC bool psl__mm3_RunningOrReady(FalconXNDetector* fDetector)
                                MAPPING_MODE_LIST);
 }
 
+/*
+ * Wake the threads in xiaWaitForBuffer() if the buffers have swapped or
+ * the Active buffer is full, and post the Active buffer's completion the
+ * first time it is seen full. Called with the detector lock held by the
+ * receive processor, by buffer done on the application's thread and when
+ * a run stops.
+ */
+PSL_STATIC void psl__MappingModeBuffers_Notify(FalconXNDetector* fDetector,
+                                               MM_Buffers*       mmb,
+                                               boolean_t         swapped)
+{
+    if (psl__MappingModeBuffers_Active_Complete(mmb)) {
+        XiaBufferCompletion completion;
+        struct timeval now = dxp_md_gettimeofday();
+
+        completion.detChan = fDetector->detChan;
+        completion.buffer = psl__MappingModeBuffers_Active_Label(mmb) - 'A';
+        completion.bufferNumber = mmb->activeNumber;
+        completion.firstPixel = psl__MappingModeBuffers_Active_FirstPixel(mmb);
+        completion.pixels = psl__MappingModeBuffers_Active_Pixels(mmb);
+        completion.drops = psl__MappingModeBuffers_Active_Drops(mmb);
+        completion.overruns = psl__MappingModeBuffers_Overruns(mmb);
+        completion.lost = 0;
+        completion.time = (double) now.tv_sec + ((double) now.tv_usec / 1.0e6);
+
+        xiaPostBufferCompletion(&completion);
+    }
+
+    if (swapped || psl__MappingModeBuffers_Active_Full(mmb))
+        xiaSignalBufferWaiters();
+}
+
 PSL_STATIC int psl_mm_BufferDone(int modChan, Module* module,
                                   MM_Buffers* mmb, const char* selector)
 {
@@ -4742,6 +5159,15 @@ PSL_STATIC int psl_mm_BufferDone(int modChan, Module* module,
         pslLog(PSL_LOG_ERROR, status,
                "Buffer %c is not active, cannot signal done on it: %s:%d",
                buffer, module->alias, modChan);
+    } else if (psl__MappingModeBuffers_Active_Borrowed(mmb)) {
+        /*
+         * The user holds a pointer to the data. Releasing the buffer marks
+         * it done.
+         */
+        status = XIA_NOT_IDLE;
+        pslLog(PSL_LOG_ERROR, status,
+               "Buffer %c is borrowed, release it rather than signal done: %s:%d",
+               buffer, module->alias, modChan);
     } else {
         psl__MappingModeBuffers_Active_Clear(mmb);
     }
@@ -4750,6 +5176,8 @@ PSL_STATIC int psl_mm_BufferDone(int modChan, Module* module,
      * Update the buffers incase Next is full.
      */
     swapped = psl__MappingModeBuffers_Update(mmb);
+    psl__MappingModeBuffers_Notify(psl__FindDetector(module, modChan),
+                                   mmb, swapped);
     if (swapped) {
         pslLog(PSL_LOG_INFO,
                "A/B buffers swapped: %s:%d", module->alias, modChan);
@@ -4758,22 +5186,94 @@ PSL_STATIC int psl_mm_BufferDone(int modChan, Module* module,
     return status;
 }
 
-PSL_STATIC int psl__mm0_mca_length(int detChan,
-                                   int modChan, Module* module,
-                                   const char *name, void *value)
+/*
+ * Hand the user a pointer to the Active buffer's data rather than a
+ * copy. The buffer is not reused until it is released.
+ */
+PSL_STATIC int psl_mm_BufferBorrow(int modChan, Module* module,
+                                   MM_Buffers* mmb, char buffer, void* value)
 {
-    FalconXNDetector* fDetector = psl__FindDetector(module, modChan);
-
-    acqValue number_mca_channels;
-
-    UNUSED(detChan);
-    UNUSED(name);
-    UNUSED(value);
-    UNUSED(module);
+    int status = XIA_SUCCESS;
 
-    number_mca_channels = psl__GetAcqValue(fDetector, "number_mca_channels");
+    const uint32_t* data = NULL;
+    size_t          size = 0;
 
-    /* Must be in range because we validate parameters in the setters. */
+    if (buffer != psl__MappingModeBuffers_Active_Label(mmb)) {
+        status = XIA_NOT_ACTIVE;
+        pslLog(PSL_LOG_ERROR, status,
+               "Buffer %c is not active, cannot borrow it: %s:%d",
+               buffer, module->alias, modChan);
+    } else {
+        status = psl__MappingModeBuffers_Borrow(mmb, &data, &size);
+        if (status != XIA_SUCCESS) {
+            pslLog(PSL_LOG_ERROR, status,
+                   "Error borrowing buffer %c: %s:%d",
+                   buffer, module->alias, modChan);
+            data = NULL;
+        } else {
+            pslLog(PSL_LOG_DEBUG,
+                   "Buffer %c borrowed, length %d: %s:%d",
+                   buffer, (int) size, module->alias, modChan);
+        }
+    }
+
+    *((const uint32_t**) value) = data;
+
+    return status;
+}
+
+PSL_STATIC int psl_mm_BufferRelease(int modChan, Module* module,
+                                    MM_Buffers* mmb, const char* selector)
+{
+    int status = XIA_SUCCESS;
+
+    char buffer;
+
+    if ((*selector == 'A') || (*selector == 'a'))
+        buffer = 'A';
+    else if ((*selector == 'B') || (*selector == 'b'))
+        buffer = 'B';
+    else
+        buffer = '?';
+
+    if (buffer != psl__MappingModeBuffers_Active_Label(mmb)) {
+        status = XIA_NOT_ACTIVE;
+        pslLog(PSL_LOG_ERROR, status,
+               "Buffer %c is not active, cannot release it: %s:%d",
+               buffer, module->alias, modChan);
+        return status;
+    }
+
+    status = psl__MappingModeBuffers_Release(mmb);
+    if (status != XIA_SUCCESS) {
+        pslLog(PSL_LOG_ERROR, status,
+               "Error releasing buffer %c: %s:%d",
+               buffer, module->alias, modChan);
+        return status;
+    }
+
+    /*
+     * A released buffer has been read so it is done.
+     */
+    return psl_mm_BufferDone(modChan, module, mmb, selector);
+}
+
+PSL_STATIC int psl__mm0_mca_length(int detChan,
+                                   int modChan, Module* module,
+                                   const char *name, void *value)
+{
+    FalconXNDetector* fDetector = psl__FindDetector(module, modChan);
+
+    acqValue number_mca_channels;
+
+    UNUSED(detChan);
+    UNUSED(name);
+    UNUSED(value);
+    UNUSED(module);
+
+    number_mca_channels = psl__GetAcqValue(fDetector, "number_mca_channels");
+
+    /* Must be in range because we validate parameters in the setters. */
     ASSERT(0 < number_mca_channels.ref.i &&
            number_mca_channels.ref.i < ULONG_MAX);
 
@@ -5380,7 +5880,7 @@ PSL_STATIC int psl__mm1_run_active(int detChan,
     mmb = &mm1->buffers;
 
 
-    if ((fDetector->channelState == ChannelHistogram) &&
+    if ((fDetector->channelState == psl__mm1_RunState(fDetector)) &&
         psl__MappingModeControl_IsMode(&fDetector->mmc, MAPPING_MODE_MCA_FSM)) {
 
         /*
@@ -5705,7 +6205,7 @@ PSL_STATIC int psl__mm1_current_pixel(int detChan,
         return status;
     }
 
-    if ((fDetector->channelState == ChannelHistogram) &&
+    if ((fDetector->channelState == psl__mm1_RunState(fDetector)) &&
         psl__MappingModeControl_IsMode(&fDetector->mmc, MAPPING_MODE_MCA_FSM)) {
         MMC1_Data* mm1 = psl__MappingModeControl_MM1Data(&fDetector->mmc);
         MM_Buffers* mmb = &mm1->buffers;
@@ -5748,7 +6248,7 @@ PSL_STATIC int psl__mm1_buffer_overrun(int detChan,
         return status;
     }
 
-    if ((fDetector->channelState == ChannelHistogram) &&
+    if ((fDetector->channelState == psl__mm1_RunState(fDetector)) &&
         psl__MappingModeControl_IsMode(&fDetector->mmc, MAPPING_MODE_MCA_FSM)) {
         MMC1_Data*  mm1 = psl__MappingModeControl_MM1Data(&fDetector->mmc);
         MM_Buffers* mmb = &mm1->buffers;
@@ -5807,7 +6307,7 @@ PSL_STATIC int psl__mm1_mapping_pixel_next(int detChan,
         return status;
     }
 
-    if ((fDetector->channelState == ChannelHistogram) &&
+    if ((fDetector->channelState == psl__mm1_RunState(fDetector)) &&
         psl__MappingModeControl_IsMode(&fDetector->mmc, MAPPING_MODE_MCA_FSM)) {
         MMC1_Data* mm1 = psl__MappingModeControl_MM1Data(&fDetector->mmc);
         /*
@@ -6256,6 +6756,172 @@ PSL_STATIC int psl__mm3_list_buffer_len_b(int detChan,
     return psl__mm3_list_buffer_len('B', detChan, modChan, module, name, value);
 }
 
+/*
+ * Zero-copy buffer access. These are generic to the buffered mapping
+ * modes, MM1 and MM3.
+ */
+PSL_STATIC MM_Buffers* psl__mm_Buffers(FalconXNDetector* fDetector)
+{
+    if (psl__mm1_RunningOrReady(fDetector)) {
+        MMC1_Data* mm1 = psl__MappingModeControl_MM1Data(&fDetector->mmc);
+        return &mm1->buffers;
+    }
+
+    if (psl__mm3_RunningOrReady(fDetector)) {
+        MMC3_Data* mm3 = psl__MappingModeControl_MM3Data(&fDetector->mmc);
+        return &mm3->buffers;
+    }
+
+    return NULL;
+}
+
+PSL_STATIC int psl__mm_buffer_ptr(const char buffer,
+                                  int detChan,
+                                  int modChan, Module* module,
+                                  const char *name, void *value)
+{
+    int status = XIA_SUCCESS;
+    int sstatus;
+
+    FalconXNDetector* fDetector = psl__FindDetector(module, modChan);
+
+    MM_Buffers* mmb;
+
+    UNUSED(detChan);
+    UNUSED(name);
+
+    *((const uint32_t**) value) = NULL;
+
+    status = psl__DetectorLock(fDetector);
+    if (status != XIA_SUCCESS) {
+        pslLog(PSL_LOG_ERROR, status,
+               "Unable to lock the detector: %s:%d", module->alias, modChan);
+        return status;
+    }
+
+    mmb = psl__mm_Buffers(fDetector);
+
+    if (mmb) {
+        status = psl_mm_BufferBorrow(modChan, module, mmb, buffer, value);
+    } else {
+        status = XIA_NOT_ACTIVE;
+        pslLog(PSL_LOG_ERROR, status,
+               "Not running or not MM1/MM3 mode: %s:%d", module->alias, modChan);
+    }
+
+    sstatus = psl__DetectorUnlock(fDetector);
+    if (sstatus != XIA_SUCCESS) {
+        pslLog(PSL_LOG_ERROR, sstatus,
+               "Unable to unlock the detector: %s:%d", module->alias, modChan);
+        if (status == XIA_SUCCESS)
+            status = sstatus;
+    }
+
+    return status;
+}
+
+PSL_STATIC int psl__mm_buffer_a_ptr(int detChan,
+                                    int modChan, Module* module,
+                                    const char *name, void *value)
+{
+    return psl__mm_buffer_ptr('A', detChan, modChan, module, name, value);
+}
+
+PSL_STATIC int psl__mm_buffer_b_ptr(int detChan,
+                                    int modChan, Module* module,
+                                    const char *name, void *value)
+{
+    return psl__mm_buffer_ptr('B', detChan, modChan, module, name, value);
+}
+
+PSL_STATIC int psl__mm_buffer_ptr_len(int detChan,
+                                      int modChan, Module* module,
+                                      const char *name, void *value)
+{
+    int status = XIA_SUCCESS;
+    int sstatus;
+
+    FalconXNDetector* fDetector = psl__FindDetector(module, modChan);
+
+    MM_Buffers* mmb;
+
+    UNUSED(detChan);
+    UNUSED(name);
+
+    *((unsigned long*) value) = 0;
+
+    status = psl__DetectorLock(fDetector);
+    if (status != XIA_SUCCESS) {
+        pslLog(PSL_LOG_ERROR, status,
+               "Unable to lock the detector: %s:%d", module->alias, modChan);
+        return status;
+    }
+
+    mmb = psl__mm_Buffers(fDetector);
+
+    if (mmb) {
+        size_t size = 0;
+        status = psl__MappingModeBuffers_Borrowed(mmb, &size);
+        *((unsigned long*) value) = (unsigned long) size;
+    } else {
+        status = XIA_NOT_ACTIVE;
+        pslLog(PSL_LOG_ERROR, status,
+               "Not running or not MM1/MM3 mode: %s:%d", module->alias, modChan);
+    }
+
+    sstatus = psl__DetectorUnlock(fDetector);
+    if (sstatus != XIA_SUCCESS) {
+        pslLog(PSL_LOG_ERROR, sstatus,
+               "Unable to unlock the detector: %s:%d", module->alias, modChan);
+        if (status == XIA_SUCCESS)
+            status = sstatus;
+    }
+
+    return status;
+}
+
+PSL_STATIC int psl__mm_buffer_release(int detChan,
+                                      int modChan, Module* module,
+                                      const char *name, void *value)
+{
+    int status = XIA_SUCCESS;
+    int sstatus;
+
+    FalconXNDetector* fDetector = psl__FindDetector(module, modChan);
+
+    MM_Buffers* mmb;
+
+    UNUSED(detChan);
+    UNUSED(name);
+
+    status = psl__DetectorLock(fDetector);
+    if (status != XIA_SUCCESS) {
+        pslLog(PSL_LOG_ERROR, status,
+               "Unable to lock the detector: %s:%d", module->alias, modChan);
+        return status;
+    }
+
+    mmb = psl__mm_Buffers(fDetector);
+
+    if (mmb) {
+        status = psl_mm_BufferRelease(modChan, module, mmb, (const char*) value);
+    } else {
+        status = XIA_NOT_ACTIVE;
+        pslLog(PSL_LOG_ERROR, status,
+               "Not running or not MM1/MM3 mode: %s:%d", module->alias, modChan);
+    }
+
+    sstatus = psl__DetectorUnlock(fDetector);
+    if (sstatus != XIA_SUCCESS) {
+        pslLog(PSL_LOG_ERROR, sstatus,
+               "Unable to unlock the detector: %s:%d", module->alias, modChan);
+        if (status == XIA_SUCCESS)
+            status = sstatus;
+    }
+
+    return status;
+}
+
 /*
  * Get run data handlers. The order of the handlers must match the
  * order of the labels.
@@ -6289,7 +6955,11 @@ PSL_STATIC const char* getRunDataLabels[] =
         "total_output_events",
         "list_buffer_len_a",
         "list_buffer_len_b",
-        "mapping_pixel_next"
+        "mapping_pixel_next",
+        "buffer_a_ptr",
+        "buffer_b_ptr",
+        "buffer_ptr_len",
+        "buffer_release"
     };
 
 #define GET_RUN_DATA_HANDLER_COUNT (sizeof(getRunDataLabels) / sizeof(const char*))
@@ -6325,6 +6995,10 @@ PSL_STATIC DoRunData_FP getRunDataHandlers[MAPPING_MODE_COUNT][GET_RUN_DATA_HAND
             NULL,   /* psl__mm0_list_buffer_len_a */
             NULL,   /* psl__mm0_list_buffer_len_b */
             NULL,   /* psl__mm0_mapping_pixel_next */
+            NULL,   /* psl__mm0_buffer_a_ptr */
+            NULL,   /* psl__mm0_buffer_b_ptr */
+            NULL,   /* psl__mm0_buffer_ptr_len */
+            NULL,   /* psl__mm0_buffer_release */
         },
         {
             psl__mm1_mca_length,
@@ -6355,6 +7029,10 @@ PSL_STATIC DoRunData_FP getRunDataHandlers[MAPPING_MODE_COUNT][GET_RUN_DATA_HAND
             NULL,   /* psl__mm1_list_buffer_len_a */
             NULL,   /* psl__mm1_list_buffer_len_b */
             psl__mm1_mapping_pixel_next,
+            psl__mm_buffer_a_ptr,
+            psl__mm_buffer_b_ptr,
+            psl__mm_buffer_ptr_len,
+            psl__mm_buffer_release,
         },
         {
             NULL,   /* psl__mm2_mca_length */
@@ -6385,6 +7063,10 @@ PSL_STATIC DoRunData_FP getRunDataHandlers[MAPPING_MODE_COUNT][GET_RUN_DATA_HAND
             NULL,   /* psl__mm2_list_buffer_len_a */
             NULL,   /* psl__mm2_list_buffer_len_b */
             NULL,   /* psl__mm2_mapping_pixel_next */
+            NULL,   /* psl__mm2_buffer_a_ptr */
+            NULL,   /* psl__mm2_buffer_b_ptr */
+            NULL,   /* psl__mm2_buffer_ptr_len */
+            NULL,   /* psl__mm2_buffer_release */
         },
         {
             NULL,   /* psl__mm3_mca_length */
@@ -6415,84 +7097,281 @@ PSL_STATIC DoRunData_FP getRunDataHandlers[MAPPING_MODE_COUNT][GET_RUN_DATA_HAND
             psl__mm3_list_buffer_len_a,
             psl__mm3_list_buffer_len_b,
             NULL,   /* psl__mm3_mapping_pixel_next */
+            psl__mm_buffer_a_ptr,
+            psl__mm_buffer_b_ptr,
+            psl__mm_buffer_ptr_len,
+            psl__mm_buffer_release,
         },
     };
 
-PSL_STATIC int psl__GetRunData(int detChan, const char *name, void *value,
-                               XiaDefaults *defs, Detector *detector, Module *module)
+/*
+ * Find the run data handler index of a label. Returns -1 if the label is
+ * not run data.
+ */
+PSL_STATIC int psl__FindRunData(const char *name)
 {
-    int status = XIA_SUCCESS;
-
-    FalconXNDetector* fDetector;
+    int h;
 
-    UNUSED(defs);
+    for (h = 0; h < (int) GET_RUN_DATA_HANDLER_COUNT; ++h) {
+        if (STREQ(name, getRunDataLabels[h])) {
+            return h;
+        }
+    }
 
-    acqValue mapping_mode;
+    return -1;
+}
 
-    int h;
+/*
+ * Call the run data handler at index h for the detector's mapping mode.
+ */
+PSL_STATIC int psl__DoRunData(int detChan, int h, void *value, Module *module)
+{
+    int status;
 
-    xiaPSLBadArgs(detChan, module, detector);
+    int modChan = xiaGetModChan(detChan);
 
-    fDetector = psl__FindDetector(module, xiaGetModChan(detChan));
+    FalconXNDetector* fDetector = psl__FindDetector(module, modChan);
 
-    mapping_mode = psl__GetAcqValue(fDetector, "mapping_mode");
+    MM_Mode mapping_mode = fDetector->mappingMode;
 
     pslLog(PSL_LOG_DEBUG, "Detector:%d Mapping Mode:%d Name:%s",
-           detChan, (int) mapping_mode.ref.i, name);
+           detChan, (int) mapping_mode, getRunDataLabels[h]);
 
-    if (mapping_mode.ref.i >= MAPPING_MODE_COUNT) {
+    if (mapping_mode >= MAPPING_MODE_COUNT) {
         status = XIA_INVALID_VALUE;
         pslLog(PSL_LOG_ERROR, status,
-               "Invalid mapping_mode: %d", (int) mapping_mode.ref.i);
+               "Invalid mapping_mode: %d", (int) mapping_mode);
         return status;
     }
 
-    for (h = 0; h < (int) GET_RUN_DATA_HANDLER_COUNT; ++h) {
-        if (STREQ(name, getRunDataLabels[h])) {
-            DoRunData_FP handler;
-            handler = getRunDataHandlers[mapping_mode.ref.i][h];
-            if (handler) {
-                return handler(detChan, xiaGetModChan(detChan), module,
-                               name, value);
-            }
-            break;
-        }
+    if (getRunDataHandlers[mapping_mode][h]) {
+        return getRunDataHandlers[mapping_mode][h](detChan, modChan, module,
+                                                   getRunDataLabels[h], value);
     }
 
     status = XIA_INVALID_VALUE;
     pslLog(PSL_LOG_ERROR, status,
-           "Invalid mapping name: %s", name);
+           "Invalid mapping name: %s", getRunDataLabels[h]);
     return status;
 }
 
-PSL_STATIC int psl__CheckDetCharWaveform(const char* name, SincCalibrationPlot* wave)
+PSL_STATIC int psl__GetRunData(int detChan, const char *name, void *value,
+                               XiaDefaults *defs, Detector *detector, Module *module)
 {
     int status = XIA_SUCCESS;
 
-    int i;
+    int h;
 
-    for (i = 0; i < wave->len; ++i) {
-        if (wave->x[i] != i) {
-            status = XIA_FORMAT_ERROR;
-            pslLog(PSL_LOG_ERROR, status,
-                   "%s X waveform data out of range: %d = %f", name, i, wave->x[i]);
-            return status;
-        }
-    }
+    UNUSED(defs);
 
-    for (i = 0; i < wave->len; ++i) {
-        if ((wave->y[i] < -100) || (wave->y[i] > 100)) {
-            status = XIA_FORMAT_ERROR;
-            pslLog(PSL_LOG_ERROR, status,
-                   "%s Y waveform data out of range: %d = %f", name, i, wave->y[i]);
-            return status;
-        }
-    }
+    xiaPSLBadArgs(detChan, module, detector);
 
-    return status;
-}
+    h = psl__FindRunData(name);
 
-PSL_STATIC int psl__CalculateDCOffset(Module *module, FalconXNDetector *fDetector)
+    if (h < 0) {
+        status = XIA_INVALID_VALUE;
+        pslLog(PSL_LOG_ERROR, status,
+               "Invalid mapping name: %s", name);
+        return status;
+    }
+
+    return psl__DoRunData(detChan, h, value, module);
+}
+
+/*
+ * The run data handle is the handler index. It does not depend on the
+ * mapping mode, which is checked when the data is read.
+ */
+PSL_STATIC int psl__GetRunDataHandle(int detChan, const char *name, int *handle,
+                                     Detector *detector, Module *module)
+{
+    int status;
+
+    xiaPSLBadArgs(detChan, module, detector);
+
+    *handle = psl__FindRunData(name);
+
+    if (*handle < 0) {
+        status = XIA_INVALID_VALUE;
+        pslLog(PSL_LOG_ERROR, status,
+               "Invalid mapping name: %s", name);
+        return status;
+    }
+
+    return XIA_SUCCESS;
+}
+
+PSL_STATIC int psl__GetRunDataByHandle(int detChan, int handle, void *value,
+                                       Detector *detector, Module *module)
+{
+    int status;
+
+    xiaPSLBadArgs(detChan, module, detector);
+
+    if ((handle < 0) || (handle >= (int) GET_RUN_DATA_HANDLER_COUNT)) {
+        status = XIA_INVALID_VALUE;
+        pslLog(PSL_LOG_ERROR, status,
+               "Invalid run data handle: %d", handle);
+        return status;
+    }
+
+    return psl__DoRunData(detChan, handle, value, module);
+}
+
+/*
+ * Report the detector's full mapping buffer and if its run is still
+ * active for xiaWaitForBuffer(). The receiver signals the waiters when
+ * the buffers swap or the run stops.
+ */
+PSL_STATIC int psl__GetBufferReady(int detChan, int *buffer, boolean_t *active,
+                                   Detector *detector, Module *module)
+{
+    int status;
+    int sstatus;
+
+    int modChan;
+
+    FalconXNDetector* fDetector;
+    MM_Buffers*       mmb = NULL;
+
+    xiaPSLBadArgs(detChan, module, detector);
+
+    modChan = xiaGetModChan(detChan);
+    fDetector = psl__FindDetector(module, modChan);
+
+    *buffer = -1;
+    *active = FALSE_;
+
+    status = psl__DetectorLock(fDetector);
+    if (status != XIA_SUCCESS) {
+        pslLog(PSL_LOG_ERROR, status,
+               "Unable to lock the detector: %s:%d", module->alias, modChan);
+        return status;
+    }
+
+    if (psl__mm1_RunningOrReady(fDetector)) {
+        mmb = &psl__MappingModeControl_MM1Data(&fDetector->mmc)->buffers;
+        *active = (fDetector->channelState == psl__mm1_RunState(fDetector)) &&
+            !psl__MappingModeBuffers_PixelsReceived(mmb);
+    } else if (psl__mm3_RunningOrReady(fDetector)) {
+        mmb = &psl__MappingModeControl_MM3Data(&fDetector->mmc)->buffers;
+        *active = fDetector->channelState == ChannelListMode;
+    } else {
+        status = XIA_NOT_ACTIVE;
+        pslLog(PSL_LOG_ERROR, status,
+               "Not running or not MM1 or MM3 mode: %s:%d", module->alias, modChan);
+    }
+
+    if (mmb != NULL) {
+        if (psl__MappingModeBuffers_A_Full(mmb))
+            *buffer = psl__MappingModeBuffer_A();
+        else if (psl__MappingModeBuffers_B_Full(mmb))
+            *buffer = psl__MappingModeBuffer_B();
+    }
+
+    sstatus = psl__DetectorUnlock(fDetector);
+    if (sstatus != XIA_SUCCESS) {
+        pslLog(PSL_LOG_ERROR, sstatus,
+               "Unable to unlock the detector: %s:%d", module->alias, modChan);
+        if (status == XIA_SUCCESS)
+            status = sstatus;
+    }
+
+    return status;
+}
+
+/*
+ * Get the run data for a module's detChans. The name is resolved once.
+ * module_statistics_2 is read once for the module and each detChan gets
+ * its channel's statistics.
+ */
+PSL_STATIC int psl__GetRunDataMulti(const char *name, int count,
+                                    const int *detChans, void **values,
+                                    Module *module)
+{
+    int status;
+
+    int h;
+    int i;
+
+    ASSERT(module);
+    ASSERT(count > 0);
+
+    h = psl__FindRunData(name);
+
+    if (h < 0) {
+        status = XIA_INVALID_VALUE;
+        pslLog(PSL_LOG_ERROR, status,
+               "Invalid mapping name: %s", name);
+        return status;
+    }
+
+    if (STREQ(name, "module_statistics_2")) {
+        double* stats;
+
+        size_t size = (module->number_of_channels *
+                       XIA_NUM_MODULE_STATISTICS * sizeof(double));
+
+        stats = handel_md_alloc(size);
+        if (stats == NULL) {
+            status = XIA_NOMEM;
+            pslLog(PSL_LOG_ERROR, status,
+                   "No memory for the module statistics: %s", module->alias);
+            return status;
+        }
+
+        status = psl__DoRunData(detChans[0], h, stats, module);
+
+        if (status == XIA_SUCCESS) {
+            for (i = 0; i < count; i++) {
+                int modChan = xiaGetModChan(detChans[i]);
+                memcpy(values[i], &stats[modChan * XIA_NUM_MODULE_STATISTICS],
+                       XIA_NUM_MODULE_STATISTICS * sizeof(double));
+            }
+        }
+
+        handel_md_free(stats);
+
+        return status;
+    }
+
+    for (i = 0; i < count; i++) {
+        status = psl__DoRunData(detChans[i], h, values[i], module);
+        if (status != XIA_SUCCESS)
+            return status;
+    }
+
+    return XIA_SUCCESS;
+}
+
+PSL_STATIC int psl__CheckDetCharWaveform(const char* name, SincCalibrationPlot* wave)
+{
+    int status = XIA_SUCCESS;
+
+    int i;
+
+    for (i = 0; i < wave->len; ++i) {
+        if (wave->x[i] != i) {
+            status = XIA_FORMAT_ERROR;
+            pslLog(PSL_LOG_ERROR, status,
+                   "%s X waveform data out of range: %d = %f", name, i, wave->x[i]);
+            return status;
+        }
+    }
+
+    for (i = 0; i < wave->len; ++i) {
+        if ((wave->y[i] < -100) || (wave->y[i] > 100)) {
+            status = XIA_FORMAT_ERROR;
+            pslLog(PSL_LOG_ERROR, status,
+                   "%s Y waveform data out of range: %d = %f", name, i, wave->y[i]);
+            return status;
+        }
+    }
+
+    return status;
+}
+
+PSL_STATIC int psl__CalculateDCOffset(Module *module, FalconXNDetector *fDetector)
 {
     int        status;
     boolean_t  state_Is_DCOffset;
@@ -6942,13 +7821,508 @@ PSL_STATIC int psl__IniWrite(FILE* fp, const char* section, const char* path,
     return XIA_SUCCESS;
 }
 
-PSL_STATIC int psl__ModuleTransactionSend(Module* module, SincBuffer* packet)
+/*
+ * The transaction for a request id.
+ */
+PSL_STATIC Sinc_Transaction* psl__ModuleTransaction(FalconXNModule* fModule, uint32_t id)
+{
+    return &fModule->transactions[id % FALCONXN_TRANSACTIONS];
+}
+
+/*
+ * Move the oldest request id past the free transactions.
+ *
+ * Called with the module lock held.
+ */
+PSL_STATIC void psl__ModuleTransactionsRetire(FalconXNModule* fModule)
+{
+    while ((fModule->requestOldest != fModule->requestAnswered) &&
+           (psl__ModuleTransaction(fModule,
+                                   fModule->requestOldest)->state == TransactionFree))
+        ++fModule->requestOldest;
+}
+
+/*
+ * Check a deferred request's response. The first error is held for the
+ * end of the pipeline.
+ *
+ * Called with the module lock held.
+ */
+PSL_STATIC void psl__ModuleTransactionDeferred(FalconXNModule*   fModule,
+                                               Sinc_Transaction* txn)
+{
+    int status = txn->status;
+
+    if (status == XIA_SUCCESS) {
+        if (txn->response.type == SI_TORO__SINC__MESSAGE_TYPE__SUCCESS_RESPONSE) {
+            SiToro__Sinc__SuccessResponse* resp = txn->response.response;
+            if (resp->has_errorcode) {
+                status = XIA_FN_BASE_CODE + (int) resp->errorcode;
+                pslLog(PSL_LOG_ERROR, status,
+                       "%s: (%d) %s", txn->what, resp->errorcode,
+                       resp->message != NULL ? resp->message : "No error message");
+            }
+        }
+        else {
+            status = XIA_PROTOCOL_ERROR;
+            pslLog(PSL_LOG_ERROR, status,
+                   "%s: invalid response: { %d %d %p }", txn->what,
+                   txn->response.channel,
+                   txn->response.type,
+                   txn->response.response);
+        }
+    }
+    else {
+        pslLog(PSL_LOG_ERROR, status, "%s: response failed", txn->what);
+    }
+
+    if ((status != XIA_SUCCESS) && (fModule->pipelineStatus == XIA_SUCCESS))
+        fModule->pipelineStatus = status;
+}
+
+/*
+ * Send a request and tag it with the next request id. The channel and
+ * type are the response expected, -1 matches any. The transaction is
+ * entered in the table before the send so the response cannot arrive
+ * first. The packet is cleared whether or not it is sent. The caller must
+ * hold the send lock.
+ */
+PSL_STATIC int psl__ModuleRequestSend(Module*          module,
+                                      SincBuffer*      packet,
+                                      TransactionState state,
+                                      const char*      what,
+                                      int              channel,
+                                      int              type,
+                                      uint32_t*        id)
+{
+    int status;
+
+    FalconXNModule*   fModule = module->pslData;
+    Sinc_Transaction* txn;
+    uint32_t          rid;
+
+    for (;;) {
+        status = psl__ModuleLock(module);
+        if (status != XIA_SUCCESS) {
+            PSL_SINC_BUFFER_CLEAR(packet);
+            return status;
+        }
+
+        if ((fModule->requestNext - fModule->requestOldest) < FALCONXN_TRANSACTIONS)
+            break;
+
+        psl__ModuleUnlock(module);
+
+        /*
+         * The table is full of requests in flight. Wait for a response.
+         */
+        status = handel_md_event_wait(&fModule->sendEvent,
+                                      FALCONXN_RESPONSE_TIMEOUT * 1000);
+        if (status != 0) {
+            int me = status;
+            status = XIA_TIMEOUT;
+            pslLog(PSL_LOG_ERROR, status,
+                   "Module transaction table full: %d", me);
+            PSL_SINC_BUFFER_CLEAR(packet);
+            return status;
+        }
+    }
+
+    rid = fModule->requestNext++;
+
+    txn = psl__ModuleTransaction(fModule, rid);
+    txn->state = state;
+    txn->status = XIA_SUCCESS;
+    txn->channel = channel;
+    txn->type = type;
+    psl__FlushResponse(&txn->response);
+    strncpy(txn->what, what, sizeof(txn->what) - 1);
+    txn->what[sizeof(txn->what) - 1] = '\0';
+
+    psl__ModuleUnlock(module);
+
+    pslLog(PSL_LOG_INFO, "SINC Send: %u", rid);
+
+    /*
+     * Send will clear the packet buffer. No need to clear.
+     */
+    status = SincSend(&fModule->sinc, packet);
+    if (status == false) {
+        status = falconXNSincToHandelError(&fModule->sinc);
+        pslLog(PSL_LOG_ERROR, status,
+               "Unable to send to FalconXN connection: %s:%d",
+               fModule->hostAddress, fModule->portBase);
+
+        /*
+         * Nothing was sent so withdraw the request. The send lock means it
+         * is the newest request.
+         */
+        psl__ModuleLock(module);
+        if (fModule->requestAnswered != fModule->requestNext) {
+            --fModule->requestNext;
+            txn->state = TransactionFree;
+        }
+        psl__ModuleUnlock(module);
+
+        return status;
+    }
+
+    if (id != NULL)
+        *id = rid;
+
+    return XIA_SUCCESS;
+}
+
+/*
+ * Wait for the response to a request. The response's channel and type
+ * are checked if they are set.
+ */
+PSL_STATIC int psl__ModuleRequestReceive(Module*        module,
+                                         uint32_t       id,
+                                         Sinc_Response* response)
+{
+    int status;
+
+    FalconXNModule*   fModule = module->pslData;
+    Sinc_Transaction* txn = psl__ModuleTransaction(fModule, id);
+
+    for (;;) {
+        status = psl__ModuleLock(module);
+        if (status != XIA_SUCCESS) {
+            pslLog(PSL_LOG_ERROR, status,
+                   "Module lock failed");
+            return status;
+        }
+
+        if (txn->state == TransactionDone)
+            break;
+
+        psl__ModuleUnlock(module);
+
+        /*
+         * The sender waits here for the response.
+         */
+        status = handel_md_event_wait(&fModule->sendEvent,
+                                      FALCONXN_RESPONSE_TIMEOUT * 1000);
+        if (status != 0) {
+            int me = status;
+
+            psl__ModuleLock(module);
+            if (txn->state == TransactionDone)
+                break;
+
+            /*
+             * The response may still arrive. It is discarded.
+             */
+            txn->state = TransactionDiscard;
+            psl__ModuleUnlock(module);
+
+            status = XIA_TIMEOUT;
+            pslLog(PSL_LOG_ERROR, status,
+                   "Module send event wait failed: %u: %d", id, me);
+            return status;
+        }
+    }
+
+    status = txn->status;
+
+    if (status == XIA_SUCCESS) {
+        boolean_t matching = TRUE_;
+
+        if ((response->channel > 0) &&
+            (txn->response.channel > 0) &&
+            (response->channel != txn->response.channel)) {
+            matching = FALSE_;
+        }
+
+        if (matching &&
+            (response->type > 0) &&
+            (response->type != txn->response.type)) {
+            matching = FALSE_;
+        }
+
+        if (matching) {
+            *response = txn->response;
+        } else {
+            status = XIA_PROTOCOL_ERROR;
+            pslLog(PSL_LOG_ERROR, status,
+                   "Invalid response: %u: { %d %d %p }", id,
+                   txn->response.channel,
+                   txn->response.type,
+                   txn->response.response);
+            psl__FreeResponse(&txn->response);
+        }
+    }
+
+    if (status != XIA_SUCCESS)
+        psl__FlushResponse(response);
+
+    psl__FlushResponse(&txn->response);
+    txn->state = TransactionFree;
+
+    psl__ModuleTransactionsRetire(fModule);
+
+    psl__ModuleUnlock(module);
+
+    return status;
+}
+
+/*
+ * Start a pipeline. Parameter sets made until the pipeline ends are sent
+ * without waiting for their responses so many are in flight at once.
+ * Requests that need a response still wait for it.
+ */
+PSL_STATIC int psl__ModulePipelineBegin(Module* module)
 {
     int status;
 
     FalconXNModule* fModule = module->pslData;
 
-    pslLog(PSL_LOG_INFO, "SINC Send");
+    status = handel_md_mutex_lock(&fModule->sendLock);
+    if (status != 0) {
+        int me = status;
+        status = XIA_THREAD_ERROR;
+        pslLog(PSL_LOG_ERROR, status,
+               "Module send mutex lock failed: %d", me);
+        return status;
+    }
+
+    if (fModule->pipeline++ == 0)
+        fModule->pipelineStatus = XIA_SUCCESS;
+
+    return XIA_SUCCESS;
+}
+
+/*
+ * End a pipeline. The outermost end waits for all requests in flight and
+ * returns the first deferred error.
+ */
+PSL_STATIC int psl__ModulePipelineEnd(Module* module)
+{
+    int status = XIA_SUCCESS;
+
+    FalconXNModule* fModule = module->pslData;
+
+    if (--fModule->pipeline == 0) {
+        status = psl__ModuleParamsFlush(module);
+        if ((status != XIA_SUCCESS) && (fModule->pipelineStatus == XIA_SUCCESS))
+            fModule->pipelineStatus = status;
+
+        for (;;) {
+            status = psl__ModuleLock(module);
+            if (status != XIA_SUCCESS)
+                break;
+
+            if (fModule->requestAnswered == fModule->requestNext) {
+                status = fModule->pipelineStatus;
+                psl__ModuleUnlock(module);
+                break;
+            }
+
+            psl__ModuleUnlock(module);
+
+            status = handel_md_event_wait(&fModule->sendEvent,
+                                          FALCONXN_RESPONSE_TIMEOUT * 1000);
+            if (status != 0) {
+                int me = status;
+                status = XIA_TIMEOUT;
+                pslLog(PSL_LOG_ERROR, status,
+                       "Module pipeline wait failed: %d", me);
+                break;
+            }
+        }
+    }
+
+    handel_md_mutex_unlock(&fModule->sendLock);
+
+    return status;
+}
+
+/*
+ * Add a parameter set to the module's dirty set. A set of a key already
+ * in the set for the channel updates it in place, otherwise the set is
+ * appended. A full set is flushed. Values too long to copy flush the set
+ * and are sent on their own.
+ *
+ * Called in a pipeline.
+ */
+PSL_STATIC int psl__ModuleParamDirty(Module*                 module,
+                                     int                     channel,
+                                     SiToro__Sinc__KeyValue* param)
+{
+    int status;
+    int i;
+
+    FalconXNModule*  fModule = module->pslData;
+    Sinc_DirtyParam* dp;
+    const char*      str = NULL;
+
+    ASSERT(fModule->pipeline > 0);
+
+    if (param->strval != NULL)
+        str = param->strval;
+    else if (param->optionval != NULL)
+        str = param->optionval;
+
+    if ((strlen(param->key) >= FALCONXN_DIRTY_STR_LEN) ||
+        ((str != NULL) && (strlen(str) >= FALCONXN_DIRTY_STR_LEN))) {
+        uint8_t    pad[256];
+        SincBuffer packet = PSL_SINC_BUFFER_INIT(pad);
+
+        status = psl__ModuleParamsFlush(module);
+        if (status != XIA_SUCCESS)
+            return status;
+
+        SincEncodeSetParam(&packet, channel, param);
+
+        ++fModule->dirtySets;
+        ++fModule->dirtyMessages;
+
+        return psl__ModuleRequestSend(module, &packet, TransactionDeferred,
+                                      param->key, -1,
+                                      SI_TORO__SINC__MESSAGE_TYPE__SUCCESS_RESPONSE,
+                                      NULL);
+    }
+
+    dp = NULL;
+
+    for (i = 0; i < fModule->dirtyCount; ++i) {
+        if ((fModule->dirty[i].channel == channel) &&
+            STREQ(fModule->dirty[i].key, param->key)) {
+            dp = &fModule->dirty[i];
+            break;
+        }
+    }
+
+    if (dp == NULL) {
+        if (fModule->dirtyCount == FALCONXN_DIRTY_PARAMS) {
+            status = psl__ModuleParamsFlush(module);
+            if (status != XIA_SUCCESS)
+                return status;
+        }
+
+        dp = &fModule->dirty[fModule->dirtyCount++];
+    }
+
+    /*
+     * The copy's pointers are set when it is sent. The entries move in
+     * the table.
+     */
+    dp->channel = channel;
+    dp->kv = *param;
+    dp->kv.key = NULL;
+    dp->kv.strval = NULL;
+    dp->kv.optionval = NULL;
+    strcpy(dp->key, param->key);
+    dp->str[0] = '\0';
+    if (str != NULL)
+        strcpy(dp->str, str);
+    dp->option = param->optionval != NULL ? TRUE_ : FALSE_;
+
+    ++fModule->dirtySets;
+
+    return XIA_SUCCESS;
+}
+
+/*
+ * Send the module's dirty set in order. Each run of sets to a channel is
+ * sent in one SetParams message as a deferred request. The set is empty
+ * on return even if a send fails.
+ *
+ * Called in a pipeline.
+ */
+PSL_STATIC int psl__ModuleParamsFlush(Module* module)
+{
+    int status = XIA_SUCCESS;
+
+    FalconXNModule* fModule = module->pslData;
+
+    while ((status == XIA_SUCCESS) && (fModule->dirtyCount > 0)) {
+        SiToro__Sinc__KeyValue params[FALCONXN_DIRTY_PARAMS];
+
+        uint8_t    pad[1024];
+        SincBuffer packet = PSL_SINC_BUFFER_INIT(pad);
+
+        char what[64];
+
+        int channel = fModule->dirty[0].channel;
+        int count = 0;
+
+        /*
+         * Take the run of sets to the channel at the front. Sets to a
+         * channel after another channel's wait their turn so the writes
+         * stay in order.
+         */
+        while ((count < fModule->dirtyCount) &&
+               (fModule->dirty[count].channel == channel)) {
+            Sinc_DirtyParam*        dp = &fModule->dirty[count];
+            SiToro__Sinc__KeyValue* kv = &params[count];
+
+            *kv = dp->kv;
+            kv->key = dp->key;
+            if (dp->option)
+                kv->optionval = dp->str;
+            else if (dp->str[0] != '\0')
+                kv->strval = dp->str;
+
+            ++count;
+        }
+
+        if (!SincEncodeSetParams(&packet, channel, params, count)) {
+            status = XIA_NOMEM;
+            pslLog(PSL_LOG_ERROR, status,
+                   "Error encoding %d parameter sets", count);
+            PSL_SINC_BUFFER_CLEAR(&packet);
+        }
+
+        if (status == XIA_SUCCESS) {
+            if (count == 1)
+                snprintf(what, sizeof(what), "%s", params[0].key);
+            else
+                snprintf(what, sizeof(what), "%d params: %s ...", count, params[0].key);
+
+            pslLog(PSL_LOG_DEBUG, "Params write: %s: channel %d: %d params",
+                   module->alias, channel, count);
+
+            ++fModule->dirtyMessages;
+
+            status = psl__ModuleRequestSend(module, &packet, TransactionDeferred,
+                                            what, -1,
+                                            SI_TORO__SINC__MESSAGE_TYPE__SUCCESS_RESPONSE,
+                                            NULL);
+        }
+
+        /*
+         * The params point into the sets so they move once sent.
+         */
+        fModule->dirtyCount -= count;
+        memmove(&fModule->dirty[0], &fModule->dirty[count],
+                sizeof(fModule->dirty[0]) * (size_t) fModule->dirtyCount);
+    }
+
+    fModule->dirtyCount = 0;
+
+    return status;
+}
+
+/*
+ * Sequential transactions. The send takes the send lock and the caller
+ * receives the response, if any, and then ends the transaction. The
+ * packet is cleared whether or not it is sent. The response expected is
+ * a success response unless the channel and type are given.
+ */
+PSL_STATIC int psl__ModuleTransactionSend(Module* module, SincBuffer* packet)
+{
+    return psl__ModuleTransactionSendExpecting(module, packet, -1,
+                                               SI_TORO__SINC__MESSAGE_TYPE__SUCCESS_RESPONSE);
+}
+
+PSL_STATIC int psl__ModuleTransactionSendExpecting(Module* module, SincBuffer* packet,
+                                                   int channel, int type)
+{
+    int status;
+
+    FalconXNModule* fModule = module->pslData;
 
     status = handel_md_mutex_lock(&fModule->sendLock);
     if (status != 0) {
@@ -6956,19 +8330,25 @@ PSL_STATIC int psl__ModuleTransactionSend(Module* module, SincBuffer* packet)
         status = XIA_THREAD_ERROR;
         pslLog(PSL_LOG_ERROR, status,
                "Module send mutex lock failed: %d", me);
+        PSL_SINC_BUFFER_CLEAR(packet);
+        return status;
+    }
+
+    /*
+     * Requests see the sets made before them.
+     */
+    status = psl__ModuleParamsFlush(module);
+    if (status != XIA_SUCCESS) {
+        handel_md_mutex_unlock(&fModule->sendLock);
+        PSL_SINC_BUFFER_CLEAR(packet);
         return status;
     }
 
-    /*
-     * Send will clear the packet buffer. No need to clear.
-     */
-    status = SincSend(&fModule->sinc, packet);
-    if (status == false) {
-        status = falconXNSincToHandelError(&fModule->sinc);
+    status = psl__ModuleRequestSend(module, packet, TransactionWaiting,
+                                    "transaction", channel, type,
+                                    &fModule->sendId);
+    if (status != XIA_SUCCESS) {
         handel_md_mutex_unlock(&fModule->sendLock);
-        pslLog(PSL_LOG_ERROR, status,
-               "Unable to send to FalconXN connection: %s:%d",
-               fModule->hostAddress, fModule->portBase);
         return status;
     }
 
@@ -6977,79 +8357,9 @@ PSL_STATIC int psl__ModuleTransactionSend(Module* module, SincBuffer* packet)
 
 PSL_STATIC int psl__ModuleTransactionReceive(Module* module, Sinc_Response* response)
 {
-    int sstatus = XIA_SUCCESS;
-
-    boolean_t waiting = TRUE_;
-
-    response->response = NULL;
-
-    while (waiting) {
-        int status;
-
-        FalconXNModule* fModule = module->pslData;
-
-        boolean_t matching = TRUE_;
-
-        /*
-         * The sender waits here for the response.
-         */
-        status = handel_md_event_wait(&fModule->sendEvent,
-                                      FALCONXN_RESPONSE_TIMEOUT * 1000);
-        if (status != 0) {
-            int me = status;
-            status = XIA_TIMEOUT;
-            pslLog(PSL_LOG_ERROR, status,
-                   "Module send event wait failed: %d", me);
-            return status;
-        }
-
-        status = psl__ModuleLock(module);
-        if (status != XIA_SUCCESS) {
-            pslLog(PSL_LOG_ERROR, status,
-                   "Module lock failed");
-            return status;
-        }
-
-        sstatus = fModule->sendStatus;
-        if (sstatus != XIA_SUCCESS) {
-            psl__FlushResponse(response);
-            waiting = FALSE_;
-        } else {
-            if ((response->channel > 0) &&
-                (fModule->response.channel > 0) &&
-                (response->channel != fModule->response.channel)) {
-                matching = FALSE_;
-            }
-
-            if (matching &&
-                (response->type > 0) &&
-                (response->type != fModule->response.type)) {
-                matching = FALSE_;
-            }
-
-            if (matching) {
-                *response = fModule->response;
-                psl__FlushResponse(&fModule->response);
-                waiting = FALSE_;
-            } else {
-                pslLog(PSL_LOG_ERROR, XIA_PROTOCOL_ERROR,
-                       "Invalid response: { %d %d %p }",
-                       fModule->response.channel,
-                       fModule->response.type,
-                       fModule->response.response);
-                psl__FreeResponse(&fModule->response);
-            }
-        }
-
-        status = psl__ModuleUnlock(module);
-        if (status != XIA_SUCCESS) {
-            pslLog(PSL_LOG_ERROR, status,
-                   "Module unlock failed");
-            return status;
-        }
-    }
+    FalconXNModule* fModule = module->pslData;
 
-    return sstatus;
+    return psl__ModuleRequestReceive(module, fModule->sendId, response);
 }
 
 PSL_STATIC int psl__ModuleTransactionEnd(Module* module)
@@ -7084,69 +8394,132 @@ PSL_STATIC FalconXNDetector* psl__FindDetector(Module* module, int channel)
     return module->ch[channel].pslData;
 }
 
-PSL_STATIC int psl__ModuleResponse(Module* module, int channel, int type, void* resp)
+/*
+ * Can the response answer the transaction? A status without a response
+ * and a success response, which carries any request's error, answer
+ * any request. A channel or type of -1 matches any.
+ */
+PSL_STATIC boolean_t psl__ModuleTransactionMatches(Sinc_Transaction*    txn,
+                                                   const Sinc_Response* sresp)
 {
-    int status;
+    if ((sresp->type < 0) ||
+        (sresp->type == SI_TORO__SINC__MESSAGE_TYPE__SUCCESS_RESPONSE))
+        return TRUE_;
 
-    FalconXNModule* fModule = module->pslData;
+    if ((txn->type > 0) && (sresp->type != txn->type))
+        return FALSE_;
 
-    Sinc_Response sresp = { channel, type, resp };
+    if ((txn->channel >= 0) && (sresp->channel >= 0) &&
+        (sresp->channel != txn->channel))
+        return FALSE_;
 
-    status = psl__ModuleLock(module);
-    if (status != 0) {
-        psl__FreeResponse(&sresp);
-        return status;
-    }
+    return TRUE_;
+}
 
-    pslLog(PSL_LOG_INFO,
-           "SET channel=%d type=%d response=%p", channel, type, resp);
+/*
+ * Complete a transaction with the response and status it holds.
+ *
+ * Called with the module lock held.
+ */
+PSL_STATIC void psl__ModuleTransactionComplete(FalconXNModule*   fModule,
+                                               Sinc_Transaction* txn)
+{
+    switch (txn->state) {
+    case TransactionWaiting:
+        txn->state = TransactionDone;
+        break;
 
-    if (fModule->response.response != NULL) {
-        pslLog(PSL_LOG_INFO,
-               "Module response not empty: { %d %d %p }",
-               fModule->response.channel,
-               fModule->response.type,
-               fModule->response.response);
-        psl__FreeResponse(&fModule->response);
+    case TransactionDeferred:
+        psl__ModuleTransactionDeferred(fModule, txn);
+        psl__FreeResponse(&txn->response);
+        txn->state = TransactionFree;
+        break;
+
+    case TransactionDiscard:
+    case TransactionFree:
+    case TransactionDone:
+    default:
+        psl__FreeResponse(&txn->response);
+        txn->state = TransactionFree;
+        break;
     }
+}
 
-    fModule->response = sresp;
-    fModule->sendStatus = status;
+/*
+ * Complete the oldest unanswered request with a response or a status. If
+ * the response cannot answer the oldest request that request's response
+ * was lost; the requests before the first one the response matches are
+ * failed to resync the table. A response no request matches is dropped.
+ */
+PSL_STATIC int psl__ModuleComplete(Module* module, int mstatus, Sinc_Response* sresp)
+{
+    int status;
 
-    pslLog(PSL_LOG_INFO,
-           "Set response: { %d, %d, %p }",
-           fModule->response.channel,
-           fModule->response.type,
-           fModule->response.response);
+    FalconXNModule*   fModule = module->pslData;
+    Sinc_Transaction* txn;
+    uint32_t          id;
 
-    status = psl__ModuleUnlock(module);
+    status = psl__ModuleLock(module);
     if (status != 0) {
-        psl__FreeResponse(&sresp);
+        psl__FreeResponse(sresp);
         return status;
     }
 
-    status = handel_md_event_signal(&fModule->sendEvent);
-    if (status != 0) {
-        pslLog(PSL_LOG_ERROR, status,
-               "Cannot signal requestor: %d", channel);
-        return status;
+    if (fModule->requestAnswered == fModule->requestNext) {
+        pslLog(PSL_LOG_INFO,
+               "Module response without a request: { %d %d %p } status=%d",
+               sresp->channel, sresp->type, sresp->response, mstatus);
+        psl__FreeResponse(sresp);
+        psl__ModuleUnlock(module);
+        return XIA_SUCCESS;
     }
 
-    return XIA_SUCCESS;
-}
+    for (id = fModule->requestAnswered; id != fModule->requestNext; ++id) {
+        if (psl__ModuleTransactionMatches(psl__ModuleTransaction(fModule, id), sresp))
+            break;
+    }
 
-PSL_STATIC int psl__ModuleStatusResponse(Module* module, int mstatus)
-{
-    int status;
+    if (id == fModule->requestNext) {
+        pslLog(PSL_LOG_ERROR, XIA_PROTOCOL_ERROR,
+               "Module response matches no request: { %d %d %p } status=%d",
+               sresp->channel, sresp->type, sresp->response, mstatus);
+        psl__FreeResponse(sresp);
+        psl__ModuleUnlock(module);
+        return XIA_SUCCESS;
+    }
 
-    FalconXNModule* fModule = module->pslData;
+    if (id != fModule->requestAnswered) {
+        pslLog(PSL_LOG_ERROR, XIA_PROTOCOL_ERROR,
+               "Module responses lost, resyncing: dropping %u request(s) %u..%u",
+               id - fModule->requestAnswered, fModule->requestAnswered, id - 1);
 
-    status = psl__ModuleLock(module);
-    if (status != 0) {
-        return status;
+        while (fModule->requestAnswered != id) {
+            txn = psl__ModuleTransaction(fModule, fModule->requestAnswered++);
+            pslLog(PSL_LOG_ERROR, XIA_PROTOCOL_ERROR,
+                   "Dropped request: %s: expected { %d %d }",
+                   txn->what, txn->channel, txn->type);
+            txn->status = XIA_PROTOCOL_ERROR;
+            psl__FlushResponse(&txn->response);
+            psl__ModuleTransactionComplete(fModule, txn);
+        }
     }
 
-    fModule->sendStatus = mstatus;
+    id = fModule->requestAnswered++;
+    txn = psl__ModuleTransaction(fModule, id);
+
+    txn->status = mstatus;
+    txn->response = *sresp;
+
+    pslLog(PSL_LOG_INFO,
+           "Set response: %u: { %d, %d, %p } status=%d", id,
+           txn->response.channel,
+           txn->response.type,
+           txn->response.response,
+           txn->status);
+
+    psl__ModuleTransactionComplete(fModule, txn);
+
+    psl__ModuleTransactionsRetire(fModule);
 
     status = psl__ModuleUnlock(module);
     if (status != 0) {
@@ -7156,13 +8529,30 @@ PSL_STATIC int psl__ModuleStatusResponse(Module* module, int mstatus)
     status = handel_md_event_signal(&fModule->sendEvent);
     if (status != 0) {
         pslLog(PSL_LOG_ERROR, status,
-               "Cannot signal requestor");
+               "Cannot signal requestor: %u", id);
         return status;
     }
 
     return XIA_SUCCESS;
 }
 
+PSL_STATIC int psl__ModuleResponse(Module* module, int channel, int type, void* resp)
+{
+    Sinc_Response sresp = { channel, type, resp };
+
+    pslLog(PSL_LOG_INFO,
+           "SET channel=%d type=%d response=%p", channel, type, resp);
+
+    return psl__ModuleComplete(module, XIA_SUCCESS, &sresp);
+}
+
+PSL_STATIC int psl__ModuleStatusResponse(Module* module, int mstatus)
+{
+    Sinc_Response sresp = { -1, -1, NULL };
+
+    return psl__ModuleComplete(module, mstatus, &sresp);
+}
+
 PSL_STATIC int psl__ReceiveHistogram_MM0(Module*                  module,
                                          FalconXNDetector*        fDetector,
                                          int                      channel,
@@ -7405,6 +8795,7 @@ PSL_STATIC int psl__ReceiveHistogram_MM1(Module*                  module,
      * Update so any data is waiting for the user to read from the Active buffer.
      */
     swapped = psl__MappingModeBuffers_Update(mmb);
+    psl__MappingModeBuffers_Notify(fDetector, mmb, swapped);
     if (swapped) {
         pslLog(PSL_LOG_INFO,
                "A/B buffers swapped: %s:%d", module->alias, channel);
@@ -7419,6 +8810,7 @@ PSL_STATIC int psl__ReceiveHistogram_MM1(Module*                  module,
     if (psl__MappingModeBuffers_PixelsReceived(mmb)) {
         pslLog(PSL_LOG_INFO,
                "Pixel count reached: %s:%d", module->alias, channel);
+        xiaSignalBufferWaiters();
     }
 
     return status;
@@ -7445,12 +8837,16 @@ PSL_STATIC int psl__ReceiveHistogramData(Module* module, SincBuffer* packet)
     memset(&rejected, 0, sizeof(rejected));
     memset(&stats, 0, sizeof(stats));
 
-    status = SincDecodeHistogramDataResponse(&se,
-                                             packet,
-                                             &channel,
-                                             &accepted,
-                                             &rejected,
-                                             &stats);
+    /*
+     * The histograms point into the packet and are copied from there
+     * straight into the mapping buffers.
+     */
+    status = SincDecodeHistogramDataResponseView(&se,
+                                                 packet,
+                                                 &channel,
+                                                 &accepted,
+                                                 &rejected,
+                                                 &stats);
     if (status != true) {
         status = falconXNSincErrorToHandelError(&se);
         pslLog(PSL_LOG_ERROR, status,
@@ -7464,8 +8860,7 @@ PSL_STATIC int psl__ReceiveHistogramData(Module* module, SincBuffer* packet)
      */
     fDetector = psl__FindDetector(module, channel);
     if (fDetector == NULL) {
-        free(accepted.data);
-        free(rejected.data);
+        free(stats.intensityData);
         status = XIA_INVALID_DETCHAN;
         pslLog(PSL_LOG_ERROR, status,
                "Cannot find channel detector: %d", channel);
@@ -7487,8 +8882,7 @@ PSL_STATIC int psl__ReceiveHistogramData(Module* module, SincBuffer* packet)
 
     status = psl__DetectorLock(fDetector);
     if (status != XIA_SUCCESS) {
-        free(accepted.data);
-        free(rejected.data);
+        free(stats.intensityData);
         pslLog(PSL_LOG_ERROR, status,
                "Unable to lock the detector: %s:%d", module->alias, channel);
         return status;
@@ -7545,8 +8939,7 @@ PSL_STATIC int psl__ReceiveHistogramData(Module* module, SincBuffer* packet)
         /* drop through to free the memory */
     }
 
-    free(accepted.data);
-    free(rejected.data);
+    free(stats.intensityData);
 
     return XIA_SUCCESS;
 }
@@ -7555,7 +8948,7 @@ PSL_STATIC int psl__ReceiveListMode_MM3(Module*           module,
                                         FalconXNDetector* fDetector,
                                         int               channel,
                                         MM_Control*       mmc,
-                                        uint8_t*          data,
+                                        const uint8_t*    data,
                                         int               data_len,
                                         uint64_t          data_setId)
 {
@@ -7626,20 +9019,25 @@ PSL_STATIC int psl__ReceiveListMode_MM3(Module*           module,
             return status;
         }
 
+        data += copy_len * sizeof(uint32_t);
         data_len -= (int) copy_len;
 
         /*
          * Update so any data is waiting for the user to read from the Active buffer.
          */
         swapped = psl__MappingModeBuffers_Update(mmb);
+        psl__MappingModeBuffers_Notify(fDetector, mmb, swapped);
         if (swapped) {
             pslLog(PSL_LOG_INFO,
                    "A/B buffers swapped: %s:%d", module->alias, channel);
-        } else if (data_len > 0) {
+        }
+
+        if ((data_len > 0) && psl__MappingModeBuffers_Next_Full(mmb)) {
             psl__MappingModeBuffers_Overrun(mmb);
             status = XIA_INTERNAL_BUFFER_OVERRUN;
             pslLog(PSL_LOG_ERROR, status,
-                   "Overflow, swap falied with more data: %s:%d", module->alias, channel);
+                   "Overflow, no free buffer with more data: %s:%d",
+                   module->alias, channel);
             return status;
         }
     }
@@ -7647,6 +9045,113 @@ PSL_STATIC int psl__ReceiveListMode_MM3(Module*           module,
     return status;
 }
 
+PSL_STATIC int psl__ReceiveListMode_MM1(Module*           module,
+                                        FalconXNDetector* fDetector,
+                                        int               channel,
+                                        MM_Control*       mmc,
+                                        const uint8_t*    data,
+                                        int               data_len)
+{
+    int status;
+
+    MMC1_Data*  mm1;
+    MM_Buffers* mmb;
+    MM_Binner*  binner;
+
+    mm1 = psl__MappingModeControl_MM1Data(mmc);
+    mmb = &mm1->buffers;
+    binner = &mm1->bins;
+
+    status = psl__MappingModeBinner_AddData(binner, data, (size_t) data_len);
+    if (status != XIA_SUCCESS) {
+        pslLog(PSL_LOG_ERROR, status,
+               "Error adding list mode data to the bins: %s:%d",
+               module->alias, channel);
+        return status;
+    }
+
+    /*
+     * Write out each pixel the data completes.
+     */
+    while (TRUE_) {
+        boolean_t pixel;
+        boolean_t swapped;
+
+        MM_Pixel_Stats pstats;
+
+        double samples_per_sec;
+        double realtime;
+        double livetime;
+
+        status = psl__MappingModeBinner_Bin(binner, &pixel);
+        if ((status != XIA_SUCCESS) || !pixel)
+            break;
+
+        /*
+         * See if we have received all the pixels we will need.
+         */
+        if (psl__MappingModeBuffers_PixelsReceived(mmb)) {
+            psl__MappingModeBinner_PixelClear(binner);
+            xiaSignalBufferWaiters();
+            continue;
+        }
+
+        /*
+         * Are the buffers full? Increment the overflow counter. This is used to
+         * signal the user if they call the buffer_overrun call.
+         */
+        if (psl__MappingModeBuffers_Next_Full(mmb)) {
+            psl__MappingModeBuffers_Overrun(mmb);
+            psl__MappingModeBuffers_Pixel_Inc(mmb);
+            psl__MappingModeBinner_PixelClear(binner);
+            pslLog(PSL_LOG_ERROR, XIA_INTERNAL_BUFFER_OVERRUN,
+                   "Overflow, next buffer is full: %s:%d", module->alias, channel);
+            continue;
+        }
+
+        /*
+         * The stats are in samples. Scale times to standard format ticks.
+         */
+        samples_per_sec = fDetector->features.sampleRate * 1.0e6;
+        realtime = (double) binner->stats.sampleCount / samples_per_sec;
+        livetime = (double) (binner->stats.sampleCount -
+                             binner->stats.erasedSampleCount) / samples_per_sec;
+
+        pstats.realtime = (uint32_t) (realtime / XMAP_MAPPING_TICKS);
+        pstats.livetime = (uint32_t) (livetime / XMAP_MAPPING_TICKS);
+        pstats.triggers = binner->stats.estimatedIncomingPulseCount;
+        pstats.output_events = (uint32_t) binner->pulses;
+        pstats.icr = livetime > 0.0 ? (double) pstats.triggers / livetime : 0.0;
+        pstats.ocr = realtime > 0.0 ? (double) pstats.output_events / realtime : 0.0;
+
+        status = psl__XMAP_WriteBinnerPixel_MM1(mm1, &pstats);
+        if (status != XIA_SUCCESS) {
+            pslLog(PSL_LOG_ERROR, status,
+                   "Error adding a binned pixel: %s:%d", module->alias, channel);
+            break;
+        }
+
+        /*
+         * Update so any data is waiting for the user to read from the Active buffer.
+         */
+        swapped = psl__MappingModeBuffers_Update(mmb);
+        psl__MappingModeBuffers_Notify(fDetector, mmb, swapped);
+        if (swapped) {
+            pslLog(PSL_LOG_INFO,
+                   "A/B buffers swapped: %s:%d", module->alias, channel);
+        }
+    }
+
+    if (binner->errorBits != 0) {
+        pslLog(PSL_LOG_WARNING,
+               "List mode data errors binning pixels (0x%x): %s:%d",
+               binner->errorBits, module->alias, channel);
+        binner->errorBits = 0;
+    }
+
+    return status;
+}
+
 PSL_STATIC int psl__ReceiveListModeData(Module* module, SincBuffer* packet)
 {
     int status;
@@ -7656,7 +9161,7 @@ PSL_STATIC int psl__ReceiveListModeData(Module* module, SincBuffer* packet)
 
     int channel = -1;
 
-    uint8_t* data = NULL;
+    const uint8_t* data = NULL;
     int data_len = 0;
     uint64_t data_setId = 0;
 
@@ -7664,12 +9169,16 @@ PSL_STATIC int psl__ReceiveListModeData(Module* module, SincBuffer* packet)
 
     MM_Control* mmc;
 
-    status = SincDecodeListModeDataResponse(&se,
-                                            packet,
-                                            &channel,
-                                            &data,
-                                            &data_len,
-                                            &data_setId);
+    /*
+     * The data points into the packet and is copied from there straight
+     * into the mapping buffers.
+     */
+    status = SincDecodeListModeDataResponseView(&se,
+                                                packet,
+                                                &channel,
+                                                &data,
+                                                &data_len,
+                                                &data_setId);
     if (status != true) {
         status = falconXNSincErrorToHandelError(&se);
         pslLog(PSL_LOG_ERROR, status,
@@ -7683,7 +9192,6 @@ PSL_STATIC int psl__ReceiveListModeData(Module* module, SincBuffer* packet)
      */
     fDetector = psl__FindDetector(module, channel);
     if (fDetector == NULL) {
-        free(data);
         status = XIA_INVALID_DETCHAN;
         pslLog(PSL_LOG_ERROR, status,
                "Cannot find channel detector: %d", channel);
@@ -7695,7 +9203,6 @@ PSL_STATIC int psl__ReceiveListModeData(Module* module, SincBuffer* packet)
 
     status = psl__DetectorLock(fDetector);
     if (status != XIA_SUCCESS) {
-        free(data);
         pslLog(PSL_LOG_ERROR, status,
                "Unable to lock the detector: %s:%d", module->alias, channel);
         return status;
@@ -7722,8 +9229,26 @@ PSL_STATIC int psl__ReceiveListModeData(Module* module, SincBuffer* packet)
         }
         break;
 
-    case MAPPING_MODE_MCA:
     case MAPPING_MODE_MCA_FSM:
+        if (psl__MappingModeControl_MM1Data(mmc)->listMode) {
+            status = psl__ReceiveListMode_MM1(module,
+                                              fDetector,
+                                              channel,
+                                              mmc,
+                                              data,
+                                              data_len);
+            if (status != XIA_SUCCESS) {
+                pslLog(PSL_LOG_ERROR, status,
+                       "Error in MM1 listmode receiver: %s:%d", module->alias, channel);
+            }
+            break;
+        }
+        pslLog(PSL_LOG_ERROR, XIA_INVALID_VALUE,
+               "Invalid mapping mode (%d): %s:%d",
+               psl__MappingModeControl_Mode(mmc), module->alias, channel);
+        break;
+
+    case MAPPING_MODE_MCA:
     case MAPPING_MODE_SCA:
     case MAPPING_MODE_COUNT:
     default:
@@ -7737,11 +9262,8 @@ PSL_STATIC int psl__ReceiveListModeData(Module* module, SincBuffer* packet)
     if (status != XIA_SUCCESS) {
         pslLog(PSL_LOG_ERROR, status,
                "Unable to unlock the detector: %s:%d", module->alias, channel);
-        /* drop through to free the memory */
     }
 
-    free(data);
-
     return XIA_SUCCESS;
 }
 
@@ -8006,11 +9528,15 @@ PSL_STATIC int psl__ReceiveGetParam(Module* module, SincBuffer* packet)
         return status;
     }
 
-    if (resp->n_results != 1) {
+    /*
+     * A request for many parameters has a result for each. The requester
+     * checks the count.
+     */
+    if (resp->n_results == 0) {
         status = XIA_INVALID_VALUE;
         psl__ModuleStatusResponse(module, status);
         pslLog(PSL_LOG_ERROR, status,
-               "Too many results from FalconXN connection: %s:%d",
+               "No results from FalconXN connection: %s:%d",
                fModule->hostAddress, fModule->portBase);
         return status;
     }
@@ -8111,7 +9637,6 @@ PSL_STATIC int psl__ReceiveCalculateDCOffset(Module* module, SincBuffer* packet)
                                                  &channel);
     if (status != true) {
         status = falconXNSincErrorToHandelError(&se);
-        psl__ModuleStatusResponse(module, status);
         pslLog(PSL_LOG_ERROR, status,
                "Decode from FalconXN connection failed: %s:%d",
                fModule->hostAddress, fModule->portBase);
@@ -8124,7 +9649,6 @@ PSL_STATIC int psl__ReceiveCalculateDCOffset(Module* module, SincBuffer* packet)
     fDetector = psl__FindDetector(module, channel);
     if (fDetector == NULL) {
         status = XIA_INVALID_DETCHAN;
-        psl__ModuleStatusResponse(module, status);
         pslLog(PSL_LOG_ERROR, status,
                "Cannot find channel detector: %d", channel);
         return status;
@@ -8132,22 +9656,17 @@ PSL_STATIC int psl__ReceiveCalculateDCOffset(Module* module, SincBuffer* packet)
 
     status = psl__DetectorLock(fDetector);
     if (status != XIA_SUCCESS) {
-        psl__ModuleStatusResponse(module, status);
         return status;
     }
 
     ASSERT(fDetector->dcOffset == DC_OFFSET_REQUESTED);
     fDetector->dcOffset = dcOffset;
 
-    status = psl__DetectorUnlock(fDetector);
-    if (status != XIA_SUCCESS) {
-        psl__ModuleStatusResponse(module, status);
-        return status;
-    }
-
-    return psl__ModuleResponse(module, channel,
-                               SI_TORO__SINC__MESSAGE_TYPE__CALCULATE_DC_OFFSET_RESPONSE,
-                               NULL);
+    /*
+     * The offset arrives after the command's success response and is not
+     * a response to a request.
+     */
+    return psl__DetectorUnlock(fDetector);
 }
 
 PSL_STATIC int psl__ReceiveListParamDetails(Module* module, SincBuffer* packet)
@@ -8198,7 +9717,6 @@ PSL_STATIC int psl__ReceiveParamUpdated(Module* module, SincBuffer* packet)
                                             &channel);
     if (status != true) {
         status = falconXNSincErrorToHandelError(&se);
-        psl__ModuleStatusResponse(module, status);
         pslLog(PSL_LOG_ERROR, status,
                "Decode from FalconXN connection failed: %s:%d",
                fModule->hostAddress, fModule->portBase);
@@ -8209,7 +9727,6 @@ PSL_STATIC int psl__ReceiveParamUpdated(Module* module, SincBuffer* packet)
     if (fDetector == NULL) {
         si_toro__sinc__param_updated_response__free_unpacked(resp, NULL);
         status = XIA_INVALID_DETCHAN;
-        psl__ModuleStatusResponse(module, status);
         pslLog(PSL_LOG_ERROR, status,
                "Cannot find channel detector: %d", channel);
         return status;
@@ -8218,7 +9735,6 @@ PSL_STATIC int psl__ReceiveParamUpdated(Module* module, SincBuffer* packet)
     status = psl__DetectorLock(fDetector);
     if (status != XIA_SUCCESS) {
         si_toro__sinc__param_updated_response__free_unpacked(resp, NULL);
-        psl__ModuleStatusResponse(module, status);
         return status;
     }
 
@@ -8306,6 +9822,11 @@ PSL_STATIC int psl__UpdateChannelState(SiToro__Sinc__KeyValue* kv,
         else {
             pslLog(PSL_LOG_WARNING, "Unexpected channel.state: %s", kv->optionval);
         }
+
+        /*
+         * A run may have stopped.
+         */
+        xiaSignalBufferWaiters();
     }
     else {
         status = XIA_BAD_VALUE;
@@ -8467,121 +9988,470 @@ PSL_STATIC int psl__ModuleReceiveProcessor(Module*                   module,
         break;
     }
 
-    return status;
+    return status;
+}
+
+/*
+ * Sync the module's datagram socket with the reactor. The socket is
+ * opened by Sinc on demand so it can appear after the module attaches.
+ *
+ * Called with the reactor and module locks held.
+ */
+PSL_STATIC void psl__ReactorDatagramSync(Module* module)
+{
+    FalconXNModule* fModule = module->pslData;
+    int             r;
+
+    if (fModule->sinc.datagramFd == fModule->reactorDatagramFd)
+        return;
+
+    if (fModule->reactorDatagramFd >= 0)
+        handel_md_poller_remove(&reactor.poller, fModule->reactorDatagramFd);
+
+    fModule->reactorDatagramFd = -1;
+
+    if (fModule->sinc.datagramFd >= 0) {
+        r = handel_md_poller_add(&reactor.poller, fModule->sinc.datagramFd, module);
+        if (r != 0) {
+            pslLog(PSL_LOG_ERROR, XIA_THREAD_ERROR,
+                   "Reactor datagram attach failed for %s: %d",
+                   module->alias, r);
+            return;
+        }
+        fModule->reactorDatagramFd = fModule->sinc.datagramFd;
+    }
+}
+
+/*
+ * Remove the module's sockets from the reactor and the module from the
+ * reactor's list.
+ *
+ * Called with the reactor and module locks held.
+ */
+PSL_STATIC void psl__ReactorDetach(Module* module)
+{
+    FalconXNModule* fModule = module->pslData;
+    Module**        link;
+
+    if (!fModule->receiverRunning)
+        return;
+
+    handel_md_poller_remove(&reactor.poller, fModule->reactorFd);
+    if (fModule->reactorDatagramFd >= 0)
+        handel_md_poller_remove(&reactor.poller, fModule->reactorDatagramFd);
+
+    fModule->reactorFd = -1;
+    fModule->reactorDatagramFd = -1;
+
+    for (link = &reactor.modules; *link != NULL;
+         link = &((FalconXNModule*) (*link)->pslData)->reactorNext) {
+        if (*link == module) {
+            *link = fModule->reactorNext;
+            break;
+        }
+    }
+
+    fModule->reactorNext = NULL;
+    fModule->reactorPending = FALSE_;
+    fModule->receiverRunning = FALSE_;
+
+    --reactor.attached;
 }
 
-PSL_STATIC void psl__ModuleReceiver(void* arg)
+/*
+ * Read the packets available on the module's sockets and pass them to the
+ * receive processor. The reads do not block. A module with a steady stream
+ * of data is limited to a batch so other ready modules are not starved.
+ * Sinc reads the socket in bulk so packets can remain in its read buffer
+ * after the socket is drained and the poller will not report them. A
+ * module that reaches the batch limit stays pending and the reactor
+ * dispatches it again without waiting. A read that times out has emptied
+ * the read buffer of complete packets.
+ *
+ * Called with the reactor lock held.
+ */
+PSL_STATIC void psl__ReactorDispatch(Module* module)
 {
-    Module*         module = (Module*) arg;
     FalconXNModule* fModule = module->pslData;
-    int             r = 0;
-
-    pslLog(PSL_LOG_DEBUG,
-           "Receiver thread starting: %s", module->alias);
+    int             packets;
+    int             r;
 
     r = handel_md_mutex_lock(&fModule->lock);
     if (r != 0) {
         pslLog(PSL_LOG_DEBUG,
-               "Receiver thread failed locking module: %s: %d", module->alias, r);
+               "Reactor failed locking module: %s: %d", module->alias, r);
         return;
     }
 
-    fModule->receiverRunning = TRUE_;
-
-    while (fModule->receiverActive) {
+    for (packets = 0;
+         fModule->receiverRunning && (packets < FALCONXN_REACTOR_BATCH);
+         ++packets) {
         SiToro__Sinc__MessageType msgType;
         int                       status;
-        uint8_t                   receiveBufferData[4096];
-        SincBuffer                sb = PSL_SINC_BUFFER_INIT(receiveBufferData);
+        SincBuffer                sb;
 
         /*
-         * The receive message in the Sinc API is thread safe in respect to
-         * the send path so we can unlock the module mutex. We hold the
-         * mutex while decoding the received data.
+         * Read into the module's arena. The Sinc buffer only allocates if
+         * the packet does not fit.
          */
-        r = handel_md_mutex_unlock(&fModule->lock);
-        if (r != 0)
-            break;
+        memset(&sb, 0, sizeof(sb));
+        sb.cbuf.base.append = protobuf_c_buffer_simple_append;
+        sb.cbuf.alloced = fModule->arenaSize;
+        sb.cbuf.data = fModule->arena;
 
         status = SincReadMessage(&fModule->sinc,
-                                 100,
+                                 0,
                                  &sb,
                                  &msgType);
 
-        r = handel_md_mutex_lock(&fModule->lock);
-        if (r != 0)
-            break;
-
         if (status != true) {
             SiToro__Sinc__ErrorCode sincErrCode = SincReadErrorCode(&fModule->sinc);
             if (sincErrCode == SI_TORO__SINC__ERROR_CODE__TIMEOUT)
-                continue;
+                break;
 
             status = falconXNSincToHandelError(&fModule->sinc);
             pslLog(PSL_LOG_ERROR, status,
                    "Read message failed for FalconXN connection: %s:%d",
                    fModule->hostAddress, fModule->portBase);
+            psl__ReactorDetach(module);
             break;
         }
 
-        status = psl__ModuleReceiveProcessor(module,
-                                             msgType,
-                                             &sb);
+        psl__ModuleReceiveProcessor(module,
+                                    msgType,
+                                    &sb);
 
-        /* We have to clear SINC buffers after reading. They clear automatically for sends.
+        ++fModule->arenaPackets;
+
+        /*
+         * An overflowed packet was allocated by the Sinc buffer. Clear it
+         * and grow the arena so the next packet this size fits.
          */
-        PSL_SINC_BUFFER_CLEAR(&sb);
+        if (sb.cbuf.must_free_data) {
+            size_t size = sb.cbuf.len;
+            ++fModule->arenaOverflows;
+            PSL_SINC_BUFFER_CLEAR(&sb);
+            psl__ModuleArenaReserve(module, size);
+        }
+    }
 
-        if (status != XIA_SUCCESS)
-            continue;
+    if (fModule->receiverRunning) {
+        fModule->reactorPending = packets == FALCONXN_REACTOR_BATCH;
+        psl__ReactorDatagramSync(module);
     }
 
-    fModule->receiverRunning = FALSE_;
+    handel_md_mutex_unlock(&fModule->lock);
+}
 
-    pslLog(PSL_LOG_DEBUG,
-           "Receiver thread stopping: %s: %d", module->alias, r);
+PSL_STATIC void psl__Reactor(void* arg)
+{
+    FalconXNReactor* fReactor = (FalconXNReactor*) arg;
+    int              r;
 
-    handel_md_mutex_unlock(&fModule->lock);
+    pslLog(PSL_LOG_DEBUG, "Reactor thread starting");
+
+    r = handel_md_mutex_lock(&fReactor->lock);
+    if (r != 0) {
+        pslLog(PSL_LOG_DEBUG, "Reactor thread failed locking: %d", r);
+        handel_md_event_signal(&fReactor->stopped);
+        return;
+    }
+
+    while (fReactor->active) {
+        void*   ready[FALCONXN_REACTOR_EVENTS];
+        int     count = FALCONXN_REACTOR_EVENTS;
+        int     e;
+        Module* module;
+        Module* next;
+
+        /*
+         * Attaches, detaches and stops wake the poller so the wait does not
+         * need a timeout. Pending modules have packets to dispatch so the
+         * poller only checks for other ready sockets.
+         */
+        r = handel_md_mutex_unlock(&fReactor->lock);
+        if (r != 0)
+            break;
+
+        r = handel_md_poller_wait(&fReactor->poller,
+                                  fReactor->pending > 0 ? THREADING_NO_WAIT : 0,
+                                  ready, &count);
+
+        if (handel_md_mutex_lock(&fReactor->lock) != 0)
+            break;
+
+        if (r == THREADING_TIMEOUT) {
+            r = 0;
+            count = 0;
+        }
+
+        if (r != 0) {
+            pslLog(PSL_LOG_ERROR, XIA_THREAD_ERROR,
+                   "Reactor wait failed: %d", r);
+            break;
+        }
+
+        /*
+         * A module detached since the wait returned is no longer in the
+         * list and is skipped.
+         */
+        for (e = 0; e < count; ++e) {
+            for (module = fReactor->modules; module != NULL;
+                 module = ((FalconXNModule*) module->pslData)->reactorNext) {
+                if (module == ready[e]) {
+                    ((FalconXNModule*) module->pslData)->reactorPending = TRUE_;
+                    break;
+                }
+            }
+        }
+
+        /*
+         * Dispatch each pending module once per pass. A dispatch can detach
+         * its module so take the next link first.
+         */
+        fReactor->pending = 0;
+        for (module = fReactor->modules; module != NULL; module = next) {
+            FalconXNModule* fModule = module->pslData;
+            next = fModule->reactorNext;
+            if (fModule->reactorPending) {
+                psl__ReactorDispatch(module);
+                if (fModule->reactorPending)
+                    ++fReactor->pending;
+            }
+        }
+    }
+
+    pslLog(PSL_LOG_DEBUG, "Reactor thread stopping: %d", r);
+
+    handel_md_mutex_unlock(&fReactor->lock);
+
+    handel_md_event_signal(&fReactor->stopped);
 }
 
-PSL_STATIC int psl__ModuleReceiverStop(const char* alias, FalconXNModule* fModule)
+/*
+ * Make the module's receive arena at least size bytes. The arena only
+ * grows.
+ *
+ * Called with the module lock held.
+ */
+PSL_STATIC int psl__ModuleArenaReserve(Module* module, size_t size)
 {
-    int status;
+    FalconXNModule* fModule = module->pslData;
+    uint8_t*        arena;
+
+    if (size <= fModule->arenaSize)
+        return XIA_SUCCESS;
+
+    arena = handel_md_alloc(size);
+    if (arena == NULL) {
+        pslLog(PSL_LOG_ERROR, XIA_NOMEM,
+               "No memory for the receive arena: %s: %zu bytes",
+               module->alias, size);
+        return XIA_NOMEM;
+    }
+
+    if (fModule->arena != NULL)
+        handel_md_free(fModule->arena);
+
+    fModule->arena = arena;
+    fModule->arenaSize = size;
+
+    pslLog(PSL_LOG_DEBUG, "Receive arena: %s: %zu bytes", module->alias, size);
+
+    return XIA_SUCCESS;
+}
+
+/*
+ * Size the module's receive arena for the largest histogram of the
+ * module's channels and a list mode block. The acquisition values are
+ * read under the detector lock.
+ */
+PSL_STATIC int psl__ModuleArenaSize(Module* module)
+{
+    int    status;
+    int    channel;
+    size_t size = FALCONXN_ARENA_LIST_MODE_SIZE;
+
+    for (channel = 0; channel < (int) module->number_of_channels; channel++) {
+        FalconXNDetector* fDetector = module->ch[channel].pslData;
+        if (fDetector != NULL) {
+            acqValue number_mca_channels;
+            size_t   histogram;
 
-    int period;
+            status = psl__DetectorLock(fDetector);
+            if (status != XIA_SUCCESS)
+                return status;
+
+            number_mca_channels = psl__GetAcqValue(fDetector, "number_mca_channels");
+
+            status = psl__DetectorUnlock(fDetector);
+            if (status != XIA_SUCCESS)
+                return status;
+
+            histogram = ((size_t) number_mca_channels.ref.i *
+                         FALCONXN_ARENA_BIN_SIZE) +
+                FALCONXN_ARENA_HISTOGRAM_OVERHEAD;
+            if (histogram > size)
+                size = histogram;
+        }
+    }
+
+    status = psl__ModuleLock(module);
+    if (status != XIA_SUCCESS)
+        return status;
+
+    status = psl__ModuleArenaReserve(module, size);
+
+    psl__ModuleUnlock(module);
+
+    return status;
+}
+
+/*
+ * Attach the module's sockets to the reactor, starting the reactor if this
+ * is the first module.
+ */
+PSL_STATIC int psl__ModuleReceiverStart(Module* module)
+{
+    FalconXNModule* fModule = module->pslData;
+    int             status;
+
+    handel_md_mutex_lock(&reactor.control);
+    handel_md_mutex_lock(&reactor.lock);
+
+    if (reactor.attached == 0) {
+        status = handel_md_poller_create(&reactor.poller);
+        if (status != 0) {
+            handel_md_mutex_unlock(&reactor.lock);
+            handel_md_mutex_unlock(&reactor.control);
+            pslLog(PSL_LOG_ERROR, XIA_THREAD_ERROR,
+                   "Reactor poller create failed: %d", status);
+            return XIA_THREAD_ERROR;
+        }
+
+        status = handel_md_event_create(&reactor.stopped);
+        if (status != 0) {
+            handel_md_poller_destroy(&reactor.poller);
+            handel_md_mutex_unlock(&reactor.lock);
+            handel_md_mutex_unlock(&reactor.control);
+            pslLog(PSL_LOG_ERROR, XIA_THREAD_ERROR,
+                   "Reactor event create failed: %d", status);
+            return XIA_THREAD_ERROR;
+        }
+
+        reactor.thread.name = "Module.reactor";
+        reactor.thread.priority = 10;
+        reactor.thread.stackSize = 128 * 1024;
+        reactor.thread.attributes = 0;
+        reactor.thread.realtime = FALSE_;
+        reactor.thread.entryPoint = psl__Reactor;
+        reactor.thread.argument = &reactor;
+
+        reactor.active = TRUE_;
+        reactor.modules = NULL;
+        reactor.pending = 0;
+
+        status = handel_md_thread_create(&reactor.thread);
+        if (status != 0) {
+            reactor.active = FALSE_;
+            handel_md_event_destroy(&reactor.stopped);
+            handel_md_poller_destroy(&reactor.poller);
+            handel_md_mutex_unlock(&reactor.lock);
+            handel_md_mutex_unlock(&reactor.control);
+            pslLog(PSL_LOG_ERROR, XIA_THREAD_ERROR,
+                   "Reactor thread create failed: %d", status);
+            return XIA_THREAD_ERROR;
+        }
+    }
 
     handel_md_mutex_lock(&fModule->lock);
-    fModule->receiverActive = FALSE_;
+
+    fModule->reactorFd = -1;
+    fModule->reactorDatagramFd = -1;
+
+    status = handel_md_poller_add(&reactor.poller, fModule->sinc.fd, module);
+    if (status == 0) {
+        fModule->reactorFd = fModule->sinc.fd;
+        fModule->reactorNext = reactor.modules;
+        fModule->receiverRunning = TRUE_;
+        fModule->reactorPending = TRUE_;
+        reactor.modules = module;
+        ++reactor.attached;
+        psl__ReactorDatagramSync(module);
+        /*
+         * Sinc may hold packets read before the receiver started. Wake the
+         * reactor to dispatch the pending module.
+         */
+        handel_md_poller_wake(&reactor.poller);
+    }
+
     handel_md_mutex_unlock(&fModule->lock);
+    handel_md_mutex_unlock(&reactor.lock);
+    handel_md_mutex_unlock(&reactor.control);
 
-    status = handel_md_event_signal(&fModule->receiverEvent);
     if (status != 0) {
         pslLog(PSL_LOG_ERROR, XIA_THREAD_ERROR,
-               "Receiver thread signal failed for %s: %d",
-               alias, status);
+               "Reactor attach failed for %s: %d", module->alias, status);
+        psl__ModuleReceiverStop(module);
+        return XIA_THREAD_ERROR;
     }
 
-    period = 2000;
+    pslLog(PSL_LOG_DEBUG, "Receiver attached: %s", module->alias);
+
+    return XIA_SUCCESS;
+}
+
+/*
+ * Detach the module's sockets from the reactor. The last module to detach
+ * stops the reactor. The reactor thread is woken and signals when it has
+ * exited so the stop has no poll latency. The control lock is held until
+ * the reactor is stopped so an attach cannot start it while it stops.
+ */
+PSL_STATIC int psl__ModuleReceiverStop(Module* module)
+{
+    FalconXNModule* fModule = module->pslData;
+    boolean_t       last;
+    int             status = XIA_SUCCESS;
+
+    handel_md_mutex_lock(&reactor.control);
+    handel_md_mutex_lock(&reactor.lock);
 
     handel_md_mutex_lock(&fModule->lock);
+    psl__ReactorDetach(module);
+    handel_md_mutex_unlock(&fModule->lock);
 
-    while (period > 0) {
-        if (!fModule->receiverRunning)
-            break;
-        handel_md_mutex_unlock(&fModule->lock);
-        handel_md_thread_sleep(50);
-        period -= 50;
-        handel_md_mutex_lock(&fModule->lock);
+    last = (reactor.attached == 0) && reactor.active;
+
+    if (last) {
+        reactor.active = FALSE_;
+        status = handel_md_poller_wake(&reactor.poller);
+        if (status != 0) {
+            pslLog(PSL_LOG_ERROR, XIA_THREAD_ERROR,
+                   "Reactor wake failed for %s: %d",
+                   module->alias, status);
+        }
     }
 
-    handel_md_mutex_unlock(&fModule->lock);
+    handel_md_mutex_unlock(&reactor.lock);
 
-    if (period <= 0) {
-        pslLog(PSL_LOG_ERROR, XIA_THREAD_ERROR,
-               "Receiver thread stop failed for %s", alias);
+    if (last) {
+        status = handel_md_event_wait(&reactor.stopped,
+                                      FALCONXN_REACTOR_STOP_TIMEOUT);
+        if (status != 0) {
+            pslLog(PSL_LOG_ERROR, XIA_THREAD_ERROR,
+                   "Reactor thread stop failed for %s: %d",
+                   module->alias, status);
+            status = XIA_THREAD_ERROR;
+        } else {
+            handel_md_thread_destroy(&reactor.thread);
+            handel_md_event_destroy(&reactor.stopped);
+            handel_md_poller_destroy(&reactor.poller);
+        }
     }
 
-    return XIA_SUCCESS;
+    handel_md_mutex_unlock(&reactor.control);
+
+    return status;
 }
 
 PSL_STATIC int psl__SetupModule(Module *module)
@@ -8591,7 +10461,6 @@ PSL_STATIC int psl__SetupModule(Module *module)
     FalconXNModule* fModule = NULL;
     char            item[MAXITEM_LEN];
     int             value;
-    int             period;
 
     pslLog(PSL_LOG_DEBUG, "Module %s", module->alias);
 
@@ -8686,104 +10555,53 @@ PSL_STATIC int psl__SetupModule(Module *module)
         return status;
     }
 
-    status = handel_md_event_create(&fModule->receiverEvent);
+    status = handel_md_mutex_create(&fModule->sendLock);
     if (status != 0) {
-        int me = status;
         status = XIA_THREAD_ERROR;
-        SincDisconnect(&fModule->sinc);
         handel_md_mutex_destroy(&fModule->lock);
-        handel_md_free(fModule);
-        module->pslData = NULL;
-        pslLog(PSL_LOG_ERROR, status,
-               "Module event create failed for %s: %d",
-               module->alias, me);
-        return status;
-    }
-
-    fModule->receiver.name = "Module.receiver";
-    fModule->receiver.priority = 10;
-    fModule->receiver.stackSize = 128 * 1024;
-    fModule->receiver.attributes = 0;
-    fModule->receiver.realtime = FALSE_;
-    fModule->receiver.entryPoint = psl__ModuleReceiver;
-    fModule->receiver.argument = module;
-
-    fModule->receiverActive = TRUE_;
-
-    status = handel_md_thread_create(&fModule->receiver);
-    if (status != 0) {
-        int te = status;
-        status = XIA_THREAD_ERROR;
         SincDisconnect(&fModule->sinc);
-        handel_md_event_destroy(&fModule->receiverEvent);
-        handel_md_mutex_destroy(&fModule->lock);
         handel_md_free(fModule);
         module->pslData = NULL;
         pslLog(PSL_LOG_ERROR, status,
-               "Receive thread create failed for %s: %d",
-               module->alias, te);
+               "Module send lock create failed for %s", module->alias);
         return status;
     }
 
-    /*
-     * Wait 2 seconds for the thread to say it is running.
-     */
-    period = 2000;
-
-    handel_md_mutex_lock(&fModule->lock);
-
-    while (period > 0) {
-        if (fModule->receiverRunning)
-            break;
-        handel_md_mutex_unlock(&fModule->lock);
-        handel_md_thread_sleep(50);
-        period -= 50;
-        handel_md_mutex_lock(&fModule->lock);
-    }
-
-    handel_md_mutex_unlock(&fModule->lock);
-
-    if (period <= 0) {
+    status = handel_md_event_create(&fModule->sendEvent);
+    if (status != 0) {
         status = XIA_THREAD_ERROR;
-        handel_md_thread_destroy(&fModule->receiver);
-        handel_md_event_destroy(&fModule->receiverEvent);
+        handel_md_mutex_destroy(&fModule->sendLock);
         handel_md_mutex_destroy(&fModule->lock);
         SincDisconnect(&fModule->sinc);
         handel_md_free(fModule);
         module->pslData = NULL;
         pslLog(PSL_LOG_ERROR, status,
-               "Receive thread start failed for %s", module->alias);
+               "Module send event create failed for %s", module->alias);
         return status;
     }
 
-    status = handel_md_mutex_create(&fModule->sendLock);
-    if (status != 0) {
-        psl__ModuleReceiverStop(module->alias, fModule);
-        status = XIA_THREAD_ERROR;
-        handel_md_thread_destroy(&fModule->receiver);
-        handel_md_event_destroy(&fModule->receiverEvent);
+    status = psl__ModuleArenaReserve(module, FALCONXN_ARENA_LIST_MODE_SIZE);
+    if (status != XIA_SUCCESS) {
+        handel_md_event_destroy(&fModule->sendEvent);
+        handel_md_mutex_destroy(&fModule->sendLock);
         handel_md_mutex_destroy(&fModule->lock);
         SincDisconnect(&fModule->sinc);
         handel_md_free(fModule);
         module->pslData = NULL;
-        pslLog(PSL_LOG_ERROR, status,
-               "Module send lock create failed for %s", module->alias);
         return status;
     }
 
-    status = handel_md_event_create(&fModule->sendEvent);
-    if (status != 0) {
+    status = psl__ModuleReceiverStart(module);
+    if (status != XIA_SUCCESS) {
+        handel_md_free(fModule->arena);
+        handel_md_event_destroy(&fModule->sendEvent);
         handel_md_mutex_destroy(&fModule->sendLock);
-        psl__ModuleReceiverStop(module->alias, fModule);
-        status = XIA_THREAD_ERROR;
-        handel_md_thread_destroy(&fModule->receiver);
-        handel_md_event_destroy(&fModule->receiverEvent);
         handel_md_mutex_destroy(&fModule->lock);
         SincDisconnect(&fModule->sinc);
         handel_md_free(fModule);
         module->pslData = NULL;
         pslLog(PSL_LOG_ERROR, status,
-               "Receive thread start failed for %s", module->alias);
+               "Receiver start failed for %s", module->alias);
         return status;
     }
 
@@ -8794,10 +10612,11 @@ PSL_STATIC int psl__EndModule(Module *module)
 {
     if (module && module->pslData) {
         FalconXNModule* fModule = fModule = module->pslData;
+        int             i;
 
         pslLog(PSL_LOG_DEBUG, "Module %s", module->alias);
 
-        psl__ModuleReceiverStop(module->alias, fModule);
+        psl__ModuleReceiverStop(module);
 
         if (fModule->sinc.connected) {
             pslLog(PSL_LOG_DEBUG, "Disconnecting %s:%d",
@@ -8806,12 +10625,23 @@ PSL_STATIC int psl__EndModule(Module *module)
             SincCleanup(&fModule->sinc);
         }
 
+        for (i = 0; i < FALCONXN_TRANSACTIONS; ++i)
+            psl__FreeResponse(&fModule->transactions[i].response);
+
         handel_md_event_destroy(&fModule->sendEvent);
         handel_md_mutex_destroy(&fModule->sendLock);
-        handel_md_thread_destroy(&fModule->receiver);
-        handel_md_event_destroy(&fModule->receiverEvent);
         handel_md_mutex_destroy(&fModule->lock);
 
+        pslLog(PSL_LOG_INFO,
+               "Receive arena %s: %zu bytes, %" PRIu64 " packets, %" PRIu64 " overflows",
+               module->alias, fModule->arenaSize,
+               fModule->arenaPackets, fModule->arenaOverflows);
+
+        pslLog(PSL_LOG_INFO,
+               "Params %s: %" PRIu64 " sets in %" PRIu64 " messages",
+               module->alias, fModule->dirtySets, fModule->dirtyMessages);
+
+        handel_md_free(fModule->arena);
         handel_md_free(module->pslData);
         module->pslData = NULL;
     }
@@ -8865,6 +10695,7 @@ PSL_STATIC int psl__SetupDetChan(int detChan, Detector *detector, Module *module
 
     fDetector->modDetChan = modChan;
     fDetector->mmc.mode = MAPPING_MODE_NIL;
+    fDetector->mappingMode = MAPPING_MODE_MCA;
     fModule->channelActive[modChan] = TRUE_;
 
     status = handel_md_mutex_create(&fDetector->lock);
@@ -9111,6 +10942,15 @@ PSL_STATIC int psl__UserSetup(int detChan, Detector *detector, Module *module)
         }
     }
 
+    /*
+     * The synchronizations and the initial values are set in one
+     * pipeline. The parameter sets collect in the module's dirty set and
+     * go to the box as one message per channel.
+     */
+    status = psl__ModulePipelineBegin(module);
+    if (status != XIA_SUCCESS)
+        return status;
+
     /*
      * Some acquisition values require synchronization with another data
      * structure in the program prior to setting the initial acquisition
@@ -9124,6 +10964,7 @@ PSL_STATIC int psl__UserSetup(int detChan, Detector *detector, Module *module)
                 pslLog(PSL_LOG_ERROR, status,
                        "Error synchronizing '%s' for detChan %d (%u)",
                        DEFAULT_ACQ_VALUES[i].name, detChan, channel);
+                psl__ModulePipelineEnd(module);
                 return status;
             }
         }
@@ -9149,6 +10990,7 @@ PSL_STATIC int psl__UserSetup(int detChan, Detector *detector, Module *module)
                     status = XIA_UNKNOWN_VALUE;
                     pslLog(PSL_LOG_ERROR, status,
                            "invalid entry: %s\n", entry->name);
+                    psl__ModulePipelineEnd(module);
                     return status;
                 }
 
@@ -9168,6 +11010,7 @@ PSL_STATIC int psl__UserSetup(int detChan, Detector *detector, Module *module)
                     pslLog(PSL_LOG_ERROR, status,
                            "Error setting '%s' to %0.3f for detChan %d.",
                            entry->name, entry->data, detChan);
+                    psl__ModulePipelineEnd(module);
                     return status;
                 }
             }
@@ -9175,6 +11018,13 @@ PSL_STATIC int psl__UserSetup(int detChan, Detector *detector, Module *module)
         entry = entry->next;
     }
 
+    status = psl__ModulePipelineEnd(module);
+    if (status != XIA_SUCCESS) {
+        pslLog(PSL_LOG_ERROR, status,
+               "Error setting the initial values for detChan %d.", detChan);
+        return status;
+    }
+
     /*
      * Set digital pin configuration.
      */
@@ -10276,7 +12126,8 @@ PSL_STATIC int psl__BoardOp_Apply(int detChan, Detector* detector, Module* modul
 
     SincEncodeCheckParamConsistency(&packet, channel);
 
-    status = psl__ModuleTransactionSend(module, &packet);
+    status = psl__ModuleTransactionSendExpecting(module, &packet, -1,
+                                                 SI_TORO__SINC__MESSAGE_TYPE__CHECK_PARAM_CONSISTENCY_RESPONSE);
     if (status != XIA_SUCCESS) {
         pslLog(PSL_LOG_ERROR, status,
                "Error checking param consistency");
@@ -10344,6 +12195,22 @@ PSL_STATIC int psl__BoardOp_MappingPixelNext(int detChan, Detector* detector,
     return xiaGetRunData(detChan, name, value);
 }
 
+PSL_STATIC int psl__BoardOp_BufferRelease(int detChan, Detector* detector, Module* module,
+                                          const char *name, void *value)
+{
+    UNUSED(detChan);
+    UNUSED(detector);
+    UNUSED(module);
+    UNUSED(name);
+    UNUSED(value);
+
+    /*
+     * This is handled by the xiaGetRunData call. This lets the API get the
+     * required data.
+     */
+    return xiaGetRunData(detChan, name, value);
+}
+
 PSL_STATIC int psl__BoardOp_GetBoardFeatures(int detChan, Detector* detector,
                                              Module* module,
                                              const char *name, void *value)
@@ -10656,3 +12523,37 @@ PSL_STATIC int psl__BoardOp_GetFirmwareVersion(int detChan, Detector* detector,
 
     return XIA_SUCCESS;
 }
+
+/*
+ * The module's receive arena statistics. The value is an array of 3
+ * doubles: the arena size in bytes, the packets received and the packets
+ * that overflowed the arena.
+ */
+PSL_STATIC int psl__BoardOp_GetReceiveArena(int detChan, Detector* detector, Module* module,
+                                            const char *name, void *value)
+{
+    int status;
+
+    FalconXNModule* fModule;
+    double*         stats = (double*) value;
+
+    UNUSED(detChan);
+    UNUSED(detector);
+    UNUSED(name);
+
+    ASSERT(value);
+
+    fModule = module->pslData;
+
+    status = psl__ModuleLock(module);
+    if (status != XIA_SUCCESS)
+        return status;
+
+    stats[0] = (double) fModule->arenaSize;
+    stats[1] = (double) fModule->arenaPackets;
+    stats[2] = (double) fModule->arenaOverflows;
+
+    psl__ModuleUnlock(module);
+
+    return XIA_SUCCESS;
+}
@@ -146,6 +146,7 @@ HANDEL_EXPORT int HANDEL_API xiaInitHandel(void)
         handel_md_enable_log    = dxp_md_enable_log;
         handel_md_suppress_log  = dxp_md_suppress_log;
         handel_md_set_log_level = dxp_md_set_log_level;
+        handel_md_set_log_async = dxp_md_set_log_async;
         handel_md_alloc         = malloc;
         handel_md_free          = free;
         handel_md_wait          = dxp_md_wait;
@@ -163,6 +164,13 @@ HANDEL_EXPORT int HANDEL_API xiaInitHandel(void)
         return status;
     }
 
+    status = xiaRunControlInit();
+
+    if (status != XIA_SUCCESS) {
+        xiaLog(XIA_LOG_ERROR, status, "xiaInitHandel", "Unable to initialize run control");
+        return status;
+    }
+
     xiaGetVersionInfo(NULL, NULL, NULL, version);
 
     xiaLog(XIA_LOG_INFO, "xiaInitHandel", "Successfully initialized Handel %s", version);
@@ -220,6 +228,7 @@ HANDEL_EXPORT int HANDEL_API xiaExit(void)
         xiaLog(XIA_LOG_ERROR, status, "xiaExit", "Unable to remove module connections");
     }
     xiaInitMemory();
+    xiaRunControlExit();
 
     return XIA_SUCCESS;
 }
@@ -36,6 +36,7 @@
 
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "xia_assert.h"
 #include "xia_handel.h"
@@ -50,9 +51,24 @@
  */
 static DetChanElement *xiaDetChanHead = NULL;
 
+/*
+ * The detChan index, NULL when it has not been built or has been
+ * invalidated. Lookups fall back to walking the list when there is no
+ * index.
+ */
+static DetChanIndex *xiaDetChanIndex = NULL;
+static int xiaDetChanIndexSize = 0;
+
+/*
+ * The largest detChan the index covers. A system with detChans above this
+ * is resolved by walking the list.
+ */
+#define DETCHAN_INDEX_MAX 16384
+
 
 HANDEL_STATIC DetChanSetElem* HANDEL_API xiaGetDetSetTail(DetChanSetElem *head);
 HANDEL_STATIC int HANDEL_API xiaAddToExistingSet(int detChan, int newChan);
+HANDEL_STATIC DetChanIndex* HANDEL_API xiaFindDetChanIndex(int detChan);
 
 
 /*****************************************************************************
@@ -65,6 +81,13 @@ HANDEL_SHARED boolean_t HANDEL_API xiaIsDetChanFree(int detChan)
 {
     DetChanElement *current;
 
+    DetChanIndex *entry = xiaFindDetChanIndex(detChan);
+
+    if (entry != NULL)
+    {
+        return entry->element == NULL ? TRUE_ : FALSE_;
+    }
+
     current = xiaDetChanHead;
 
     if (isListEmpty(current))
@@ -108,6 +131,8 @@ HANDEL_SHARED int HANDEL_API xiaAddDetChan(int type, int detChan, void *data)
      * new element. This includes allocating memory and such.
      */
 
+    xiaInvalidateDetChanIndex();
+
     if (data == NULL)
     {
         status = XIA_BAD_VALUE;
@@ -301,6 +326,8 @@ HANDEL_SHARED int HANDEL_API xiaRemoveDetChan(int detChan)
     DetChanElement *prev;
     DetChanElement *next;
 
+    xiaInvalidateDetChanIndex();
+
     current = xiaDetChanHead;
 
     if (isListEmpty(current))
@@ -592,6 +619,18 @@ HANDEL_EXPORT int HANDEL_API xiaAddChannelSetElem(int detChanSet, int newChan)
         return status;
     }
 
+    if (xiaHandelSystemRunning())
+    {
+        status = xiaBuildDetChanIndex();
+
+        if (status != XIA_SUCCESS)
+        {
+            xiaLog(XIA_LOG_ERROR, status, "xiaAddChannelSetElem",
+                   "Error indexing the detChans");
+            return status;
+        }
+    }
+
     return XIA_SUCCESS;
 }
 
@@ -625,6 +664,7 @@ HANDEL_STATIC int HANDEL_API xiaAddToExistingSet(int detChan, int newChan)
     newDetChanElem->channel = newChan;
     newDetChanElem->next = NULL;
 
+    xiaInvalidateDetChanIndex();
 
     current = xiaDetChanHead;
 
@@ -668,6 +708,8 @@ HANDEL_EXPORT int HANDEL_API xiaRemoveChannelSetElem(int detChan, int chan)
         return status;
     }
 
+    xiaInvalidateDetChanIndex();
+
     currentDetChan = xiaDetChanHead;
 
     /* No need to check for NULL since we already verified that detChan exists
@@ -697,6 +739,18 @@ HANDEL_EXPORT int HANDEL_API xiaRemoveChannelSetElem(int detChan, int chan)
 
     handel_md_free((void *)current);
 
+    if (xiaHandelSystemRunning())
+    {
+        status = xiaBuildDetChanIndex();
+
+        if (status != XIA_SUCCESS)
+        {
+            xiaLog(XIA_LOG_ERROR, status, "xiaRemoveChannelSetElem",
+                   "Error indexing the detChans");
+            return status;
+        }
+    }
+
     return XIA_SUCCESS;
 }
 
@@ -729,6 +783,18 @@ HANDEL_EXPORT int HANDEL_API xiaRemoveChannelSet(int detChan)
         return status;
     }
 
+    if (xiaHandelSystemRunning())
+    {
+        status = xiaBuildDetChanIndex();
+
+        if (status != XIA_SUCCESS)
+        {
+            xiaLog(XIA_LOG_ERROR, status, "xiaRemoveChannelSet",
+                   "Error indexing the detChans");
+            return status;
+        }
+    }
+
     return XIA_SUCCESS;
 }
 
@@ -741,6 +807,13 @@ HANDEL_SHARED int HANDEL_API xiaGetElemType(int detChan)
 {
     DetChanElement *current = NULL;
 
+    DetChanIndex *entry = xiaFindDetChanIndex(detChan);
+
+    if (entry != NULL)
+    {
+        return entry->element == NULL ? 999 : entry->element->type;
+    }
+
     current = xiaDetChanHead;
 
     while (current != NULL)
@@ -801,6 +874,18 @@ HANDEL_SHARED char* HANDEL_API xiaGetAliasFromDetChan(int detChan)
 {
     DetChanElement *current = NULL;
 
+    DetChanIndex *entry = xiaFindDetChanIndex(detChan);
+
+    if (entry != NULL)
+    {
+        if ((entry->element == NULL) || (entry->element->type == SET))
+        {
+            return NULL;
+        }
+
+        return entry->element->data.modAlias;
+    }
+
     if (xiaIsDetChanFree(detChan))
     {
         return NULL;
@@ -858,6 +943,13 @@ HANDEL_SHARED DetChanElement* HANDEL_API xiaGetDetChanPtr(int detChan)
 {
     DetChanElement *current = NULL;
 
+    DetChanIndex *entry = xiaFindDetChanIndex(detChan);
+
+    if (entry != NULL)
+    {
+        return entry->element;
+    }
+
     current = xiaDetChanHead;
 
     while (current != NULL)
@@ -874,6 +966,57 @@ HANDEL_SHARED DetChanElement* HANDEL_API xiaGetDetChanPtr(int detChan)
 }
 
 
+/*****************************************************************************
+ *
+ * This routine writes the SINGLE detChans that make up detChan to detChans,
+ * walking nested sets in order. A SINGLE detChan is its own set. Returns the
+ * number of detChans found, which can be more than size. Only the first size
+ * are written. Returns -1 if detChan, or a detChan in the set, is invalid.
+ *
+ *****************************************************************************/
+HANDEL_SHARED int HANDEL_API xiaGetDetChanSetChannels(int detChan,
+                                                      int *detChans, int size)
+{
+    int count = 0;
+
+    DetChanElement *element = xiaGetDetChanPtr(detChan);
+
+    DetChanSetElem *setElem = NULL;
+
+    if (element == NULL)
+    {
+        return -1;
+    }
+
+    if (element->type == SINGLE)
+    {
+        if (size > 0)
+        {
+            detChans[0] = detChan;
+        }
+
+        return 1;
+    }
+
+    for (setElem = element->data.detChanSet; setElem != NULL;
+         setElem = getListNext(setElem))
+    {
+        int found = xiaGetDetChanSetChannels(setElem->channel,
+                                             detChans + count,
+                                             size > count ? size - count : 0);
+
+        if (found < 0)
+        {
+            return -1;
+        }
+
+        count += found;
+    }
+
+    return count;
+}
+
+
 /*****************************************************************************
  *
  * This routine returns default string used to find a detector's defaults.
@@ -908,6 +1051,12 @@ HANDEL_SHARED XiaDefaults* HANDEL_API xiaGetDefaultFromDetChan(int detChan)
 
     char defaultStr[MAXALIAS_LEN];
 
+    const DetChanIndex *entry = xiaGetDetChanIndex(detChan);
+
+    if ((entry != NULL) && (entry->defaults != NULL)) {
+        return entry->defaults;
+    }
+
     status = xiaGetDefaultStrFromDetChan(detChan, defaultStr);
 
     if (status != XIA_SUCCESS) {
@@ -925,6 +1074,7 @@ HANDEL_SHARED XiaDefaults* HANDEL_API xiaGetDefaultFromDetChan(int detChan)
  *****************************************************************************/
 HANDEL_SHARED int HANDEL_API xiaInitDetChanDS(void)
 {
+    xiaInvalidateDetChanIndex();
     xiaDetChanHead = NULL;
     return XIA_SUCCESS;
 }
@@ -939,3 +1089,156 @@ HANDEL_SHARED DetChanElement * HANDEL_API xiaGetDetChanHead(void)
 {
     return xiaDetChanHead;
 }
+
+
+/*****************************************************************************
+ *
+ * This routine builds the detChan index from the DetChanElement LL and the
+ * modules, detectors and defaults the SINGLE detChans refer to. A detChan
+ * that does not resolve to a module keeps a NULL module in its entry and
+ * its lookups fall back to the list.
+ *
+ *****************************************************************************/
+HANDEL_SHARED int HANDEL_API xiaBuildDetChanIndex(void)
+{
+    int status;
+    int size = 0;
+
+    DetChanElement *current = NULL;
+
+    DetChanIndex *index = NULL;
+
+
+    xiaInvalidateDetChanIndex();
+
+    for (current = xiaDetChanHead; current != NULL; current = getListNext(current)) {
+        if (current->detChan >= size) {
+            size = current->detChan + 1;
+        }
+    }
+
+    if (size == 0) {
+        return XIA_SUCCESS;
+    }
+
+    if (size > DETCHAN_INDEX_MAX) {
+        xiaLog(XIA_LOG_INFO, "xiaBuildDetChanIndex",
+               "detChan %d is larger than the index maximum of %d. "
+               "detChans will be found by searching the list.",
+               size - 1, DETCHAN_INDEX_MAX);
+        return XIA_SUCCESS;
+    }
+
+    index = (DetChanIndex *)handel_md_alloc((size_t) size * sizeof(DetChanIndex));
+
+    if (index == NULL) {
+        status = XIA_NOMEM;
+        xiaLog(XIA_LOG_ERROR, status, "xiaBuildDetChanIndex",
+               "Not enough memory to create the index of %d detChans", size);
+        return status;
+    }
+
+    memset(index, 0, (size_t) size * sizeof(DetChanIndex));
+
+    for (current = xiaDetChanHead; current != NULL; current = getListNext(current)) {
+        DetChanIndex *entry;
+        Module *module;
+        int modChan;
+
+        if (current->detChan < 0) {
+            continue;
+        }
+
+        entry = &index[current->detChan];
+        entry->element = current;
+        entry->modChan = 999;
+
+        if (current->type != SINGLE) {
+            continue;
+        }
+
+        module = xiaFindModule(current->data.modAlias);
+
+        if (module == NULL) {
+            continue;
+        }
+
+        status = xiaGetAbsoluteChannel(current->detChan, module, &modChan);
+
+        if (status != XIA_SUCCESS) {
+            continue;
+        }
+
+        entry->module = module;
+        entry->modChan = modChan;
+
+        if (module->detector && module->detector[modChan]) {
+            entry->detector = xiaFindDetector(module->detector[modChan]);
+        }
+
+        if (module->defaults && module->defaults[modChan]) {
+            entry->defaults = xiaFindDefault(module->defaults[modChan]);
+        }
+    }
+
+    xiaDetChanIndex = index;
+    xiaDetChanIndexSize = size;
+
+    xiaLog(XIA_LOG_DEBUG, "xiaBuildDetChanIndex",
+           "Indexed %d detChans", size);
+
+    return XIA_SUCCESS;
+}
+
+
+/*****************************************************************************
+ *
+ * This routine frees the detChan index. Any change to the detChans, modules,
+ * detectors or defaults must invalidate the index before it is made.
+ *
+ *****************************************************************************/
+HANDEL_SHARED void HANDEL_API xiaInvalidateDetChanIndex(void)
+{
+    if (xiaDetChanIndex != NULL) {
+        handel_md_free(xiaDetChanIndex);
+        xiaDetChanIndex = NULL;
+        xiaDetChanIndexSize = 0;
+    }
+}
+
+
+/*****************************************************************************
+ *
+ * This routine returns the index entry for a SINGLE detChan that resolved to
+ * a module when the index was built. Returns NULL if there is no index or
+ * the detChan is not such a detChan.
+ *
+ *****************************************************************************/
+HANDEL_SHARED const DetChanIndex* HANDEL_API xiaGetDetChanIndex(int detChan)
+{
+    DetChanIndex *entry = xiaFindDetChanIndex(detChan);
+
+    if ((entry == NULL) || (entry->module == NULL)) {
+        return NULL;
+    }
+
+    return entry;
+}
+
+
+/*****************************************************************************
+ *
+ * This routine returns the index entry for detChan. Returns NULL if there is
+ * no index or detChan is out of its range, in which case the caller must
+ * search the list. An entry with a NULL element is a free detChan.
+ *
+ *****************************************************************************/
+HANDEL_STATIC DetChanIndex* HANDEL_API xiaFindDetChanIndex(int detChan)
+{
+    if ((xiaDetChanIndex == NULL) ||
+        (detChan < 0) || (detChan >= xiaDetChanIndexSize)) {
+        return NULL;
+    }
+
+    return &xiaDetChanIndex[detChan];
+}
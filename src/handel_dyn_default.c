@@ -53,6 +53,23 @@
  */
 static XiaDefaults *xiaDefaultsHead = NULL;
 
+/*
+ * The last XiaDefaults in the LL, where new defaults are appended
+ */
+static XiaDefaults *xiaDefaultsTail = NULL;
+
+/*
+ * The XiaDefaults hashed by alias, chained through aliasNext and grown like
+ * the entries index of a XiaDefaults. NULL until a default is created.
+ */
+static XiaDefaults **xiaDefaultsIndex = NULL;
+static size_t xiaDefaultsIndexSize = 0;
+static size_t xiaDefaultsIndexCount = 0;
+
+static size_t xiaDefaultsHash(const char *name);
+static int xiaIndexDefault(XiaDefaults *defaults);
+static void xiaUnindexDefault(XiaDefaults *defaults);
+
 
 /*****************************************************************************
  *
@@ -97,6 +114,9 @@ HANDEL_SHARED int HANDEL_API xiaNewDefault(const char *alias)
                "Alias %s already in use.", alias);
         return status;
     }
+
+    xiaInvalidateDetChanIndex();
+
     /* Check that the Head of the linked list exists */
     if (xiaDefaultsHead == NULL)
     {
@@ -104,15 +124,9 @@ HANDEL_SHARED int HANDEL_API xiaNewDefault(const char *alias)
         xiaDefaultsHead = (XiaDefaults *) handel_md_alloc(sizeof(XiaDefaults));
         current = xiaDefaultsHead;
     } else {
-        /* Find the end of the linked list */
-        current= xiaDefaultsHead;
-        while (current->next != NULL)
-        {
-            current= current->next;
-        }
-
-        current->next = (XiaDefaults *) handel_md_alloc(sizeof(XiaDefaults));
-        current= current->next;
+        /* Append to the end of the linked list */
+        xiaDefaultsTail->next = (XiaDefaults *) handel_md_alloc(sizeof(XiaDefaults));
+        current = xiaDefaultsTail->next;
     }
 
     /* Make sure memory was allocated */
@@ -124,6 +138,8 @@ HANDEL_SHARED int HANDEL_API xiaNewDefault(const char *alias)
         return status;
     }
 
+    xiaDefaultsTail = current;
+
     /* Do any other allocations, or initialize to NULL/0 */
     current->alias = (char *) handel_md_alloc((strlen(alias)+1)*sizeof(char));
     if (current->alias == NULL)
@@ -137,8 +153,20 @@ HANDEL_SHARED int HANDEL_API xiaNewDefault(const char *alias)
     strcpy(current->alias,alias);
 
     current->entry = NULL;
+    current->index = NULL;
+    current->indexSize = 0;
+    current->indexCount = 0;
+    current->aliasNext = NULL;
     current->next = NULL;
 
+    status = xiaIndexDefault(current);
+    if (status != XIA_SUCCESS)
+    {
+        xiaLog(XIA_LOG_ERROR, status, "xiaNewDefault",
+               "Unable to index default %s.", alias);
+        return status;
+    }
+
     return XIA_SUCCESS;
 }
 
@@ -188,44 +216,28 @@ HANDEL_SHARED int HANDEL_API xiaAddDefaultItem(const char *alias,
      * will be generated if an invalid name is used at a later time in program
      * execution.
      */
-    current = chosen->entry;
+    /* First check if the default exists already. If so, just modify and
+     * return.
+     */
+    current = xiaFindDefaultEntry(chosen, name);
     if (current != NULL)
     {
-        /* First check if the default exists already. If so, just modify and
-         * return.
-         */
-        /* Now find a match to the name. */
-        while (current!=NULL)
-        {
-            if (STREQ(name, current->name))
-            {
-                break;
-            }
-            prev = current;
-            current=current->next;
-        }
+        /* Now modify the value. */
+        current->data = *((double *) value);
 
-        if (current != NULL)
-        {
-            /* Now modify the value. */
-            current->data = *((double *) value);
-
-            status = XIA_SUCCESS;
-            return status;
-        }
+        status = XIA_SUCCESS;
+        return status;
     }
-    /* If we are here, then we are at the end of the defaults list, else we found
-     * a match and returned already.  Time to allocate memory for a new entry.
+
+    /* Find the end of the defaults list. Time to allocate memory for a new
+     * entry.
      */
-    if (chosen->entry == NULL)
+    for (current = chosen->entry; current != NULL; current = current->next)
     {
-        chosen->entry = (XiaDaqEntry *) handel_md_alloc(sizeof(XiaDaqEntry));
-        current = chosen->entry;
-    } else {
-        prev->next = (XiaDaqEntry *) handel_md_alloc(sizeof(XiaDaqEntry));
-        current = prev->next;
+        prev = current;
     }
 
+    current = (XiaDaqEntry *) handel_md_alloc(sizeof(XiaDaqEntry));
     if (current == NULL)
     {
         status = XIA_NOMEM;
@@ -235,11 +247,13 @@ HANDEL_SHARED int HANDEL_API xiaAddDefaultItem(const char *alias,
     }
 
     current->next = NULL;
+    current->indexNext = NULL;
 
     /* Create the name entry. */
     current->name = (char *) handel_md_alloc((strlen(name)+1)*sizeof(char));
     if (current->name == NULL)
     {
+        handel_md_free(current);
         status = XIA_NOMEM;
         xiaLog(XIA_LOG_ERROR, status, "xiaAddDefaultItem",
                "Unable to allocate memory for current->name");
@@ -252,6 +266,23 @@ HANDEL_SHARED int HANDEL_API xiaAddDefaultItem(const char *alias,
     current->pending = 0.0;
     current->state   = AV_STATE_UNKNOWN;
 
+    status = xiaIndexDefaultEntry(chosen, current);
+    if (status != XIA_SUCCESS)
+    {
+        handel_md_free(current->name);
+        handel_md_free(current);
+        xiaLog(XIA_LOG_ERROR, status, "xiaAddDefaultItem",
+               "Unable to index DAQ entry %s", name);
+        return status;
+    }
+
+    if (prev == NULL)
+    {
+        chosen->entry = current;
+    } else {
+        prev->next = current;
+    }
+
     return XIA_SUCCESS;
 }
 
@@ -297,15 +328,7 @@ HANDEL_SHARED int HANDEL_API xiaModifyDefaultItem(const char *alias,
     }
 
     /* Now find a match to the name */
-    current = chosen->entry;
-    while (current!=NULL)
-    {
-        if (STREQ(name, current->name))
-        {
-            break;
-        }
-        current=current->next;
-    }
+    current = xiaFindDefaultEntry(chosen, name);
 
     if (current == NULL)
     {
@@ -345,21 +368,11 @@ HANDEL_SHARED int HANDEL_API xiaGetDefaultItem(const char *alias,
         return status;
     }
 
-    /* Decide which data to return by searching through the entries LL */
-    current = chosen->entry;
-
     /* Search first and then cast as the last step. A little opposite of
      * the way that we usually do this, but these structures are also
      * organized different then usual, so...
      */
-    while (current!=NULL)
-    {
-        if (STREQ(name, current->name))
-        {
-            break;
-        }
-        current=current->next;
-    }
+    current = xiaFindDefaultEntry(chosen, name);
 
     if (current == NULL)
     {
@@ -392,6 +405,8 @@ HANDEL_SHARED int HANDEL_API xiaRemoveDefault(const char *alias)
     xiaLog(XIA_LOG_DEBUG, "xiaRemoveDefault",
            "Preparing to remove default w/ alias %s", alias);
 
+    xiaInvalidateDetChanIndex();
+
     if (isListEmpty(xiaDefaultsHead))
     {
         status = XIA_NO_ALIAS;
@@ -426,6 +441,13 @@ HANDEL_SHARED int HANDEL_API xiaRemoveDefault(const char *alias)
         return status;
     }
 
+    xiaUnindexDefault(current);
+
+    if (current == xiaDefaultsTail)
+    {
+        xiaDefaultsTail = prev;
+    }
+
     /* Check if match is the head of the list */
     if (current == xiaDefaultsHead)
     {
@@ -459,6 +481,11 @@ HANDEL_SHARED int HANDEL_API xiaRemoveDefault(const char *alias)
         entry = nextEntry;
     }
 
+    if (current->index != NULL)
+    {
+        handel_md_free(current->index);
+    }
+
     /* Free the XiaDefaults structure */
     handel_md_free(current);
 
@@ -491,8 +518,12 @@ HANDEL_SHARED XiaDefaults* HANDEL_API xiaFindDefault(const char *alias)
 {
     XiaDefaults *current = NULL;
 
-    /* First check if this alias exists already? */
-    current = xiaDefaultsHead;
+    if (xiaDefaultsIndex == NULL)
+    {
+        return NULL;
+    }
+
+    current = xiaDefaultsIndex[xiaDefaultsHash(alias) & (xiaDefaultsIndexSize - 1)];
     while (current != NULL)
     {
         /* If the alias matches, return a pointer to the detector */
@@ -500,8 +531,8 @@ HANDEL_SHARED XiaDefaults* HANDEL_API xiaFindDefault(const char *alias)
         {
             return current;
         }
-        /* Move to the next element */
-        current = current->next;
+        /* Move to the next element in the bucket */
+        current = current->aliasNext;
     }
 
     return NULL;
@@ -529,19 +560,262 @@ HANDEL_SHARED double HANDEL_API xiaGetValueFromDefaults(const char *name,
         return 0.0;
     }
 
-    entry = current->entry;
+    entry = xiaFindDefaultEntry(current, name);
+    if (entry != NULL)
+    {
+        return entry->data;
+    }
+
+    return 0.0;
+}
+
+
+/*****************************************************************************
+ *
+ * The defaults entry index. The entries of a XiaDefaults are hashed by name
+ * into a power of 2 number of buckets chained through the entries. The
+ * buckets double when the entries outnumber them. The linked list remains
+ * the record of the entries and their order.
+ *
+ *****************************************************************************/
+#define XIA_DEFAULTS_INDEX_MIN_SIZE 64
+
+static size_t xiaDefaultsHash(const char *name)
+{
+    /* FNV-1a */
+    size_t hash = (size_t) 2166136261u;
+
+    while (*name != '\0')
+    {
+        hash ^= (size_t) (unsigned char) *name++;
+        hash *= (size_t) 16777619u;
+    }
+
+    return hash;
+}
+
+static int xiaDefaultsIndexResize(XiaDefaults *defaults, size_t size)
+{
+    XiaDaqEntry **index;
+    XiaDaqEntry *entry;
+
+    size_t bucket;
+
+    index = (XiaDaqEntry **) handel_md_alloc(size * sizeof(XiaDaqEntry *));
+    if (index == NULL)
+    {
+        return XIA_NOMEM;
+    }
+
+    memset(index, 0, size * sizeof(XiaDaqEntry *));
+
+    for (entry = defaults->entry; entry != NULL; entry = entry->next)
+    {
+        bucket = xiaDefaultsHash(entry->name) & (size - 1);
+        entry->indexNext = index[bucket];
+        index[bucket] = entry;
+    }
+
+    if (defaults->index != NULL)
+    {
+        handel_md_free(defaults->index);
+    }
+
+    defaults->index = index;
+    defaults->indexSize = size;
+
+    return XIA_SUCCESS;
+}
+
+/*****************************************************************************
+ *
+ * This routine returns the entry of the defaults matching the name. If NULL
+ * is returned, then no match was found.
+ *
+ *****************************************************************************/
+HANDEL_SHARED XiaDaqEntry* HANDEL_API xiaFindDefaultEntry(XiaDefaults *defaults,
+                                                          const char *name)
+{
+    XiaDaqEntry *entry;
+
+    if (defaults->index == NULL)
+    {
+        return NULL;
+    }
+
+    entry = defaults->index[xiaDefaultsHash(name) & (defaults->indexSize - 1)];
 
     while (entry != NULL)
     {
-        if (STREQ(entry->name, name))
+        if (STREQ(name, entry->name))
         {
-            return entry->data;
+            return entry;
         }
 
-        entry = getListNext(entry);
+        entry = entry->indexNext;
     }
 
-    return 0.0;
+    return NULL;
+}
+
+/*****************************************************************************
+ *
+ * This routine adds an entry to the defaults index. The caller links the
+ * entry into the defaults list after it is indexed.
+ *
+ *****************************************************************************/
+HANDEL_SHARED int HANDEL_API xiaIndexDefaultEntry(XiaDefaults *defaults,
+                                                  XiaDaqEntry *entry)
+{
+    int status;
+
+    size_t bucket;
+
+    if (defaults->indexCount >= defaults->indexSize)
+    {
+        size_t size = defaults->indexSize * 2;
+
+        if (size < XIA_DEFAULTS_INDEX_MIN_SIZE)
+        {
+            size = XIA_DEFAULTS_INDEX_MIN_SIZE;
+        }
+
+        status = xiaDefaultsIndexResize(defaults, size);
+        if (status != XIA_SUCCESS)
+        {
+            return status;
+        }
+    }
+
+    bucket = xiaDefaultsHash(entry->name) & (defaults->indexSize - 1);
+    entry->indexNext = defaults->index[bucket];
+    defaults->index[bucket] = entry;
+
+    ++defaults->indexCount;
+
+    return XIA_SUCCESS;
+}
+
+/*****************************************************************************
+ *
+ * This routine removes an entry from the defaults index. Call before the
+ * entry is freed.
+ *
+ *****************************************************************************/
+HANDEL_SHARED void HANDEL_API xiaUnindexDefaultEntry(XiaDefaults *defaults,
+                                                     XiaDaqEntry *entry)
+{
+    XiaDaqEntry **link;
+
+    if (defaults->index == NULL)
+    {
+        return;
+    }
+
+    link = &defaults->index[xiaDefaultsHash(entry->name) & (defaults->indexSize - 1)];
+
+    while (*link != NULL)
+    {
+        if (*link == entry)
+        {
+            *link = entry->indexNext;
+            entry->indexNext = NULL;
+            --defaults->indexCount;
+            return;
+        }
+
+        link = &(*link)->indexNext;
+    }
+}
+
+/*****************************************************************************
+ *
+ * This routine adds a XiaDefaults to the alias index, doubling the buckets
+ * when the defaults outnumber them.
+ *
+ *****************************************************************************/
+static int xiaIndexDefault(XiaDefaults *defaults)
+{
+    XiaDefaults **index;
+    XiaDefaults *current;
+
+    size_t size;
+    size_t bucket;
+
+    if (xiaDefaultsIndexCount >= xiaDefaultsIndexSize)
+    {
+        size = xiaDefaultsIndexSize * 2;
+
+        if (size < XIA_DEFAULTS_INDEX_MIN_SIZE)
+        {
+            size = XIA_DEFAULTS_INDEX_MIN_SIZE;
+        }
+
+        index = (XiaDefaults **) handel_md_alloc(size * sizeof(XiaDefaults *));
+        if (index == NULL)
+        {
+            return XIA_NOMEM;
+        }
+
+        memset(index, 0, size * sizeof(XiaDefaults *));
+
+        for (current = xiaDefaultsHead; current != NULL; current = current->next)
+        {
+            if (current != defaults)
+            {
+                bucket = xiaDefaultsHash(current->alias) & (size - 1);
+                current->aliasNext = index[bucket];
+                index[bucket] = current;
+            }
+        }
+
+        if (xiaDefaultsIndex != NULL)
+        {
+            handel_md_free(xiaDefaultsIndex);
+        }
+
+        xiaDefaultsIndex = index;
+        xiaDefaultsIndexSize = size;
+    }
+
+    bucket = xiaDefaultsHash(defaults->alias) & (xiaDefaultsIndexSize - 1);
+    defaults->aliasNext = xiaDefaultsIndex[bucket];
+    xiaDefaultsIndex[bucket] = defaults;
+
+    ++xiaDefaultsIndexCount;
+
+    return XIA_SUCCESS;
+}
+
+/*****************************************************************************
+ *
+ * This routine removes a XiaDefaults from the alias index. Call before the
+ * alias is freed.
+ *
+ *****************************************************************************/
+static void xiaUnindexDefault(XiaDefaults *defaults)
+{
+    XiaDefaults **link;
+
+    if (xiaDefaultsIndex == NULL)
+    {
+        return;
+    }
+
+    link = &xiaDefaultsIndex[xiaDefaultsHash(defaults->alias) & (xiaDefaultsIndexSize - 1)];
+
+    while (*link != NULL)
+    {
+        if (*link == defaults)
+        {
+            *link = defaults->aliasNext;
+            defaults->aliasNext = NULL;
+            --xiaDefaultsIndexCount;
+            return;
+        }
+
+        link = &(*link)->aliasNext;
+    }
 }
 
 
@@ -553,6 +827,17 @@ HANDEL_SHARED double HANDEL_API xiaGetValueFromDefaults(const char *name,
 HANDEL_SHARED int HANDEL_API xiaInitXiaDefaultsDS(void)
 {
     xiaDefaultsHead = NULL;
+    xiaDefaultsTail = NULL;
+
+    if (xiaDefaultsIndex != NULL)
+    {
+        handel_md_free(xiaDefaultsIndex);
+        xiaDefaultsIndex = NULL;
+    }
+
+    xiaDefaultsIndexSize = 0;
+    xiaDefaultsIndexCount = 0;
+
     return XIA_SUCCESS;
 }
 
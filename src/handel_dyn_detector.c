@@ -118,6 +118,9 @@ HANDEL_EXPORT int HANDEL_API xiaNewDetector(const char *alias)
                "Alias %s already in use.", alias);
         return status;
     }
+
+    xiaInvalidateDetChanIndex();
+
     /* Check that the Head of the linked list exists */
     if (xiaDetectorHead == NULL)
     {
@@ -1276,6 +1279,8 @@ HANDEL_EXPORT int HANDEL_API xiaRemoveDetector(const char *alias)
     xiaLog(XIA_LOG_INFO, "xiaRemoveDetector",
            "Removing %s", alias);
 
+    xiaInvalidateDetChanIndex();
+
    if (detector == NULL) {
         int status = XIA_NO_ALIAS;
         xiaLog(XIA_LOG_ERROR, status, "xiaRemoveDetector",
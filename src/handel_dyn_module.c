@@ -290,6 +290,8 @@ HANDEL_EXPORT int HANDEL_API xiaAddModuleItem(const char *alias,
     Module *m = NULL;
 
 
+    xiaInvalidateDetChanIndex();
+
     /* Verify the arguments */
     if (alias == NULL) {
         status = XIA_NULL_ALIAS;
@@ -1563,6 +1565,8 @@ HANDEL_EXPORT int HANDEL_API xiaRemoveModule(const char *alias)
 
     xiaLog(XIA_LOG_INFO, "xiaRemoveModule", "Removing %s", alias);
 
+    xiaInvalidateDetChanIndex();
+
     current = xiaGetModuleHead();
 
     if (current != NULL)
@@ -1798,6 +1802,12 @@ HANDEL_SHARED int HANDEL_API xiaGetModChan(int detChan)
     char *modAlias = NULL;
     Module *module = NULL;
 
+    const DetChanIndex *entry = xiaGetDetChanIndex(detChan);
+
+    if (entry != NULL) {
+        return entry->modChan;
+    }
+
     modAlias = xiaGetAliasFromDetChan(detChan);
 
     module = xiaFindModule(modAlias);
@@ -2235,11 +2245,24 @@ HANDEL_SHARED int HANDEL_API xiaFindModuleAndDetector(int detChan,
     Module* mod = NULL;
     Detector* det = NULL;
 
+    const DetChanIndex *entry = xiaGetDetChanIndex(detChan);
+
     if (module)
         *module = NULL;
     if (detector)
         *detector = NULL;
 
+    /* An indexed detChan that is not fully resolved takes the path below so
+     * the failure is reported the same way.
+     */
+    if (entry && entry->module->psl && (entry->detector || !detector)) {
+        if (module)
+            *module = entry->module;
+        if (detector)
+            *detector = entry->detector;
+        return XIA_SUCCESS;
+    }
+
     modAlias = xiaGetAliasFromDetChan(detChan);
 
     if (modAlias == NULL) {
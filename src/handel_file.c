@@ -66,6 +66,27 @@ PRAGMA_POP
 
 /** Structures **/
 
+/* A line of the ini file held in memory. Name-value lines are split in
+ * place so name and value point into the line; they are NULL for all other
+ * lines.
+ */
+typedef struct
+{
+    char *text;
+    char *name;
+    char *value;
+} IniLine;
+
+/* The ini file loaded into memory and indexed by line. Lines without any
+ * printable characters are not indexed.
+ */
+typedef struct
+{
+    char *data;
+    IniLine *lines;
+    int numLines;
+} IniFile;
+
 /* This structure exists so that we can re-use the
  * section of the code that parses in the sections
  * of the ini files
@@ -73,7 +94,7 @@ PRAGMA_POP
 typedef struct
 {
     /* Pointer to the proper xiaLoadRoutine */
-    int (*function_ptr)(FILE *, fpos_t *, fpos_t *);
+    int (*function_ptr)(IniFile *, int, int);
 
     /* Section heading name: the part in brackets */
     const char *section;
@@ -86,26 +107,31 @@ typedef struct
 /** Prototypes **/
 HANDEL_STATIC int HANDEL_API xiaWriteIniFile(const char *filename);
 
-HANDEL_STATIC int HANDEL_API xiaFindEntryStart(FILE *fp, const char *section, fpos_t *start);
-HANDEL_STATIC int HANDEL_API xiaFindEntryLimits(FILE *fp, const char *section,
-                        fpos_t *start, fpos_t *end);
+HANDEL_STATIC int HANDEL_API xiaIniRead(FILE *fp, IniFile *ini);
+HANDEL_STATIC void HANDEL_API xiaIniFree(IniFile *ini);
+HANDEL_STATIC void HANDEL_API xiaIniSplitLine(IniLine *line);
+HANDEL_STATIC int HANDEL_API xiaIniFindSection(IniFile *ini, const char *section,
+                                               int *first, int *last);
+HANDEL_STATIC int HANDEL_API xiaIniLineData(IniFile *ini, int line,
+                                            const char **name, const char **value);
+HANDEL_STATIC int HANDEL_API xiaIniFindLine(IniFile *ini, int first, int last,
+                                            const char *name, int *line);
+HANDEL_STATIC int HANDEL_API xiaIniFind(IniFile *ini, int first, int last,
+                                        const char *name, char *value);
 HANDEL_STATIC int HANDEL_API xiaGetLine_N(FILE *fp, char *lline, int len);
 HANDEL_STATIC int HANDEL_API xiaGetLine(FILE *fp, char *line);
 HANDEL_STATIC int HANDEL_API xiaGetLineData(const char *line,
                                             char *name, char *value);
-HANDEL_STATIC int HANDEL_API xiaSetPosOnNext(FILE *fp, fpos_t *start, fpos_t *end,
-                                             const char *name, fpos_t *newPos,
-                                             boolean_t after);
 HANDEL_SHARED int HANDEL_API xiaCopyFile(const char *src, const char *dest);
 
-HANDEL_STATIC int xiaLoadDetector(FILE *fp, fpos_t *start, fpos_t *end);
-HANDEL_STATIC int xiaLoadModule(FILE *fp, fpos_t *start, fpos_t *end);
-HANDEL_STATIC int xiaLoadModChanData(FILE *fp, fpos_t *start, fpos_t *end);
-HANDEL_STATIC int xiaLoadFirmware(FILE *fp, fpos_t *start, fpos_t *end);
-HANDEL_STATIC int xiaLoadDefaults(FILE *fp, fpos_t *start, fpos_t *end);
+HANDEL_STATIC int xiaLoadDetector(IniFile *ini, int first, int last);
+HANDEL_STATIC int xiaLoadModule(IniFile *ini, int first, int last);
+HANDEL_STATIC int xiaLoadModChanData(IniFile *ini, int first, int last);
+HANDEL_STATIC int xiaLoadFirmware(IniFile *ini, int first, int last);
+HANDEL_STATIC int xiaLoadDefaults(IniFile *ini, int first, int last);
 
-HANDEL_STATIC int HANDEL_API xiaReadPTRRs(FILE *fp, fpos_t *start, fpos_t *end, char *alias);
-HANDEL_STATIC int HANDEL_API xiaReadChanData(FILE *fp);
+HANDEL_STATIC int HANDEL_API xiaReadPTRRs(IniFile *ini, int first, int last, char *alias);
+HANDEL_STATIC int HANDEL_API xiaReadChanData(IniFile *ini, int *line, int last);
 
 static int writeInterface(FILE *fp, Module *m);
 
@@ -771,25 +797,26 @@ HANDEL_SHARED int HANDEL_API xiaCopyFile(const char *src, const char *dest)
  *
  * Routine to read in "handel_ini" type ini files
  *
+ * The file is read into memory and indexed once. Each section is then found
+ * in the index and the START/END blocks in it are passed to the section's
+ * loader as a range of lines.
+ *
  *****************************************************************************/
 HANDEL_SHARED int HANDEL_API xiaReadIniFile(const char *inifile)
 {
     int status = XIA_SUCCESS;
     int numSections;
     int i;
-    /*
-     * Pointers to keep track of the xia.ini file
-     */
+    int line;
+    int end;
+    int first;
+    int last;
+
     FILE *fp = NULL;
 
-    char newFile[MAXFILENAME_LEN];
-    char tmpLine[XIA_LINE_LEN];
-    char line[XIA_LINE_LEN];
+    IniFile ini;
 
-    fpos_t start;
-    fpos_t end;
-    fpos_t local;
-    fpos_t local_end;
+    char newFile[MAXFILENAME_LEN];
 
     char xiaini[8] = "xia.ini";
 
@@ -811,6 +838,16 @@ HANDEL_SHARED int HANDEL_API xiaReadIniFile(const char *inifile)
         return status;
     }
 
+    status = xiaIniRead(fp, &ini);
+
+    xia_file_close(fp);
+
+    if (status != XIA_SUCCESS) {
+        xiaLog(XIA_LOG_ERROR, status, "xiaReadIniFile",
+               "Could not read %s", inifile);
+        return status;
+    }
+
     /* Loop over all the sections as defined in sectionInfo */
     /* XXX BUG: Should be sectionInfo / sectionInfo[0]?
      */
@@ -818,143 +855,373 @@ HANDEL_SHARED int HANDEL_API xiaReadIniFile(const char *inifile)
 
     for (i = 0; i < numSections; i++)
     {
-        if (!sectionInfo[i].multiSection) {
-            fpos_t unknownEnd;
+        status = xiaIniFindSection(&ini, sectionInfo[i].section, &first, &last);
 
-            status = xiaFindEntryStart(fp, sectionInfo[i].section, &start);
+        if (status != XIA_SUCCESS) {
+            xiaLog(XIA_LOG_WARNING, "xiaReadIniFile",
+                   "Section missing from ini file: %s", sectionInfo[i].section);
+            continue;
+        }
+
+        if (!sectionInfo[i].multiSection) {
+            status = sectionInfo[i].function_ptr(&ini, first, last);
 
             if (status != XIA_SUCCESS) {
-                xiaLog(XIA_LOG_WARNING, "xiaReadIniFile",
-                       "Section missing from ini file: %s", sectionInfo[i].section);
+                xiaIniFree(&ini);
+                xiaLog(XIA_LOG_ERROR, status, "xiaReadIniFile",
+                       "Error loading \"%s\" section from ini file", sectionInfo[i].section);
+                return status;
+            }
+
+            continue;
+        }
+
+        /* Pass the lines between each START and its END to the loader. The
+         * END must come before the next START and the end of the section.
+         */
+        for (line = first; line < last; line++)
+        {
+            if (!STRNEQ(ini.lines[line].text, "START")) {
                 continue;
             }
 
-            status = sectionInfo[i].function_ptr(fp, &local, &unknownEnd);
+            for (end = line + 1; end < last; end++) {
+                if (STRNEQ(ini.lines[end].text, "END") ||
+                    STRNEQ(ini.lines[end].text, "START")) {
+                    break;
+                }
+            }
+
+            if (end == last || !STRNEQ(ini.lines[end].text, "END")) {
+                xiaIniFree(&ini);
+                status = XIA_FILE_RA;
+                xiaLog(XIA_LOG_ERROR, status, "xiaReadIniFile",
+                       "Error loading information from ini file, no END found");
+                return status;
+            }
+
+            status = sectionInfo[i].function_ptr(&ini, line + 1, end);
 
             if (status != XIA_SUCCESS) {
-                xia_file_close(fp);
+                xiaIniFree(&ini);
                 xiaLog(XIA_LOG_ERROR, status, "xiaReadIniFile",
-                       "Error loading \"%s\" section from ini file", sectionInfo[i].section);
+                       "Error loading information from ini file");
                 return status;
             }
 
-            continue;
+            line = end;
         }
+    }
 
-        status = xiaFindEntryLimits(fp, sectionInfo[i].section, &start, &end);
+    xiaIniFree(&ini);
 
-        if (status != XIA_SUCCESS)
-        {
-            xiaLog(XIA_LOG_WARNING, "xiaReadIniFile",
-                   "Section missing from ini file: %s", sectionInfo[i].section);
-            continue;
+    return XIA_SUCCESS;
+}
+
+/*
+ * Reads all of fp into memory and indexes the lines in a single pass.
+ * Trailing white space, including the end of line, is removed and lines
+ * with no printable characters are skipped, as xiaGetLine() does.
+ */
+HANDEL_STATIC int HANDEL_API xiaIniRead(FILE *fp, IniFile *ini)
+{
+    int maxLines;
+
+    long size;
+
+    size_t i;
+    size_t len;
+
+    char *text;
+    char *next;
+
+
+    ASSERT(fp);
+    ASSERT(ini);
+
+
+    ini->data = NULL;
+    ini->lines = NULL;
+    ini->numLines = 0;
+
+    if (fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) < 0 ||
+        fseek(fp, 0, SEEK_SET) != 0) {
+        xiaLog(XIA_LOG_ERROR, XIA_BAD_FILE_READ, "xiaIniRead",
+               "Unable to size the ini file. errno = %d, '%s'.",
+               (int)errno, strerror(errno));
+        return XIA_BAD_FILE_READ;
+    }
+
+    ini->data = handel_md_alloc((size_t) size + 1);
+
+    if (ini->data == NULL) {
+        xiaLog(XIA_LOG_ERROR, XIA_NOMEM, "xiaIniRead",
+               "No memory for the ini file: %ld bytes", size);
+        return XIA_NOMEM;
+    }
+
+    if (size > 0 && fread(ini->data, (size_t) size, 1, fp) != 1) {
+        xiaIniFree(ini);
+        xiaLog(XIA_LOG_ERROR, XIA_BAD_FILE_READ, "xiaIniRead",
+               "Unable to read the ini file");
+        return XIA_BAD_FILE_READ;
+    }
+
+    ini->data[size] = '\0';
+
+    /* One more line than there are new lines */
+    maxLines = 1;
+
+    for (i = 0; i < (size_t) size; i++) {
+        if (ini->data[i] == '\n') {
+            maxLines++;
         }
+    }
 
-        /* Here is the psuedocode for parsing in a section w/ multiple headings
-         *
-         * 1) Set local to line with START on it (this is a one shot thing)
-         * 2) Cache line pointed to by "end" (this is because we can't do direct
-         *    arithmetic comparisons with fpos_t structs). Also, actually do a
-         *    comparison between local's "line" and the end's "line". If they
-         *    match then we've reached the end of the section and are finished.
-         *    N.b.: I pray to god that a situation never somes up that would
-         *    break this comparison. In principle it shouldn't happen since
-         *    end's "line" is either EOF or a section heading.
-         * 3) Increment local until we run into END
-         * 4) Set local_end
-         * 5) xiaLoadxxxxx(local, local_end);
-         * 6) Set current to local_end and jump to step (2)
-         */
+    ini->lines = handel_md_alloc(sizeof(IniLine) * (size_t) maxLines);
 
-        status = fsetpos(fp, &end);
+    if (ini->lines == NULL) {
+        xiaIniFree(ini);
+        xiaLog(XIA_LOG_ERROR, XIA_NOMEM, "xiaIniRead",
+               "No memory for the ini file index: %d lines", maxLines);
+        return XIA_NOMEM;
+    }
+
+    for (text = ini->data; text != NULL; text = next) {
+        next = strchr(text, '\n');
 
-        if (status != 0) {
-            xiaLog(XIA_LOG_ERROR, status, "xiaReadIniFile",
-                   "Error setting file position to the end of the current section."
-                   " errno = %d, '%s'.", (int)errno, strerror(errno));
-            return XIA_SET_POS;
+        if (next != NULL) {
+            *next++ = '\0';
         }
 
-        status = xiaGetLine(fp, tmpLine);
+        len = strlen(text);
 
-        if (status != XIA_SUCCESS && status != XIA_EOF) {
-            xiaLog(XIA_LOG_ERROR, status, "xiaReadIniFile",
-                   "Error getting end of section line after setting the file position.");
-            return status;
+        while (len > 0 && isspace(CTYPE_CHAR(text[len - 1]))) {
+            text[--len] = '\0';
+        }
+
+        for (i = 0; i < len; i++) {
+            if (isgraph(CTYPE_CHAR(text[i]))) {
+                break;
+            }
+        }
+
+        if (i == len) {
+            continue;
         }
 
-        ASSERT(tmpLine[0] == '[');
+        ini->lines[ini->numLines].text = text;
+        xiaIniSplitLine(&ini->lines[ini->numLines]);
+        ini->numLines++;
+    }
+
+    return XIA_SUCCESS;
+}
+
+HANDEL_STATIC void HANDEL_API xiaIniFree(IniFile *ini)
+{
+    if (ini->lines != NULL) {
+        handel_md_free(ini->lines);
+        ini->lines = NULL;
+    }
+
+    if (ini->data != NULL) {
+        handel_md_free(ini->data);
+        ini->data = NULL;
+    }
+
+    ini->numLines = 0;
+}
+
+/*
+ * Splits a "name = value" line in place, trimming the white space around
+ * the name and value. Section headings, comments and START/END lines are
+ * left whole, as is any line without a name and a value.
+ */
+HANDEL_STATIC void HANDEL_API xiaIniSplitLine(IniLine *line)
+{
+    char *text = line->text;
+    char *equals;
+    char *name;
+    char *nameEnd;
+    char *value;
+
+
+    line->name = NULL;
+    line->value = NULL;
+
+    if (text[0] == '[' || text[0] == '*' ||
+        STRNEQ(text, "START") || STRNEQ(text, "END")) {
+        return;
+    }
+
+    equals = strchr(text, '=');
+
+    if (equals == NULL) {
+        return;
+    }
 
-        xiaLog(XIA_LOG_DEBUG, "xiaReadIniFile",
-               "Cached end string = %s", tmpLine);
+    for (name = text; isspace(CTYPE_CHAR(*name)); name++)
+        ;
 
-        status = fsetpos(fp, &start);
+    for (nameEnd = equals; nameEnd > name && isspace(CTYPE_CHAR(nameEnd[-1])); nameEnd--)
+        ;
 
-        if (status != 0) {
-            xiaLog(XIA_LOG_ERROR, status, "xiaReadIniFile",
-                   "Error setting file position to the end of the current section."
-                   " errno = %d, '%s'.", (int)errno, strerror(errno));
-            return XIA_SET_POS;
+    for (value = equals + 1; isspace(CTYPE_CHAR(*value)); value++)
+        ;
+
+    if (nameEnd == name || *value == '\0') {
+        return;
+    }
+
+    *nameEnd = '\0';
+
+    line->name = name;
+    line->value = value;
+}
+
+/*
+ * Finds [section] and sets first to the line after the heading and last to
+ * the next heading or the end of the file. As before the heading only has
+ * to match the start of section.
+ */
+HANDEL_STATIC int HANDEL_API xiaIniFindSection(IniFile *ini, const char *section,
+                                               int *first, int *last)
+{
+    int status;
+    int i;
+
+    char *close;
+
+
+    for (i = 0; i < ini->numLines; i++)
+    {
+        const char *text = ini->lines[i].text;
+
+        if (text[0] != '[') {
+            continue;
         }
 
-        status = xiaGetLine(fp, line);
+        close = strchr(text, ']');
 
-        if (status != XIA_SUCCESS && status != XIA_EOF) {
-            xiaLog(XIA_LOG_ERROR, status, "xiaReadIniFile",
-                   "Error getting start of section line after setting the file position.");
+        if (close == NULL) {
+            status = XIA_FORMAT_ERROR;
+            xiaLog(XIA_LOG_ERROR, status, "xiaIniFindSection",
+                   "Syntax error in Init file, no terminating ] found");
             return status;
         }
 
-        while(!STREQ(line, tmpLine))
-        {
-            status = fgetpos(fp, &local);
+        if (strncmp(text + 1, section, (size_t) (close - text - 1)) == 0) {
+            *first = i + 1;
 
-            if (STRNEQ(line, "START"))
-            {
-                int count = 0;
+            for (*last = *first; *last < ini->numLines; (*last)++) {
+                if (ini->lines[*last].text[0] == '[') {
+                    break;
+                }
+            }
 
-                do
-                {
-                    status = fgetpos(fp, &local_end);
+            return XIA_SUCCESS;
+        }
+    }
+
+    return XIA_NOSECTION;
+}
 
-                    status = xiaGetLine(fp, line);
+/*
+ * Gets the name and value of an indexed line the way xiaGetLineData()
+ * does: comments are named "COMMENT" and any other line that is not a
+ * name-value pair is a format error.
+ */
+HANDEL_STATIC int HANDEL_API xiaIniLineData(IniFile *ini, int line,
+                                            const char **name, const char **value)
+{
+    int status;
 
-                    xiaLog(XIA_LOG_DEBUG, "xiaReadIniFile",
-                           "Inside START/END bracket: %s", line);
+    IniLine *l = &ini->lines[line];
 
-                    if (++count > 500) {
-                        xia_file_close(fp);
-                        status = XIA_FILE_RA;
-                        xiaLog(XIA_LOG_ERROR, status, "xiaReadIniFile",
-                               "Error loading information from ini file, no END found");
-                        return status;
-                    }
 
-                } while (!STRNEQ(line, "END"));
+    if (l->text[0] == '*') {
+        *name = "COMMENT";
+        *value = l->text;
+        return XIA_SUCCESS;
+    }
 
-                status = sectionInfo[i].function_ptr(fp, &local, &local_end);
+    if (l->name == NULL) {
+        status = XIA_FORMAT_ERROR;
+        xiaLog(XIA_LOG_ERROR, status, "xiaIniLineData",
+               "Invalid name-value line in xia.ini: \n %s", l->text);
+        return status;
+    }
 
-                if (status != XIA_SUCCESS) {
-                    xia_file_close(fp);
-                    xiaLog(XIA_LOG_ERROR, status, "xiaReadIniFile",
-                           "Error loading information from ini file");
-                    return status;
-                }
-            }
+    *name = l->name;
+    *value = l->value;
 
-            status = xiaGetLine(fp, line);
+    return XIA_SUCCESS;
+}
 
-            if (status == XIA_EOF)
-            {
-                break;
-            }
+/*
+ * Finds the first line from first up to last with the name. Returns
+ * XIA_FILE_RA if there is no such line.
+ */
+HANDEL_STATIC int HANDEL_API xiaIniFindLine(IniFile *ini, int first, int last,
+                                            const char *name, int *line)
+{
+    int status;
+    int i;
+
+    const char *tmpName;
+    const char *tmpValue;
+
+
+    for (i = first; i < last; i++)
+    {
+        status = xiaIniLineData(ini, i, &tmpName, &tmpValue);
 
-            xiaLog(XIA_LOG_DEBUG, "xiaReadIniFile",
-                   "Looking for START: %s", line);
+        if (status != XIA_SUCCESS)
+        {
+            xiaLog(XIA_LOG_ERROR, status, "xiaIniFindLine",
+                   "Error trying to find value for %s", name);
+            return status;
+        }
+
+        if (STREQ(name, tmpName))
+        {
+            *line = i;
+            return XIA_SUCCESS;
         }
     }
 
-    xia_file_close(fp);
+    return XIA_FILE_RA;
+}
+
+/*
+ * The in-memory version of xiaFileRA(). The value is truncated to
+ * XIA_LINE_LEN - 1 characters, the longest a line read by xiaGetLine() can
+ * be, so callers' buffers stay large enough.
+ */
+HANDEL_STATIC int HANDEL_API xiaIniFind(IniFile *ini, int first, int last,
+                                        const char *name, char *value)
+{
+    int status;
+    int line;
+
+    size_t len;
+
+
+    status = xiaIniFindLine(ini, first, last, name, &line);
+
+    if (status != XIA_SUCCESS) {
+        return status;
+    }
+
+    len = strlen(ini->lines[line].value);
+
+    if (len > XIA_LINE_LEN - 1) {
+        len = XIA_LINE_LEN - 1;
+    }
+
+    memcpy(value, ini->lines[line].value, len);
+    value[len] = '\0';
 
     return XIA_SUCCESS;
 }
@@ -1238,125 +1505,14 @@ HANDEL_STATIC int HANDEL_API xiaGetLine_N(FILE *fp, char *lline, int llen)
     return XIA_EOF;
 }
 
-/*
- * Searches thru the .ini file and finds the start of a specific
- * section starting at [section]. The fp is left on the first line
- * after the section tag.
- */
-HANDEL_STATIC int HANDEL_API xiaFindEntryStart(FILE *fp, const char *section, fpos_t *start)
-{
-    int status = XIA_SUCCESS;
-    unsigned int j;
-
-    boolean_t isStartFound = FALSE_;
-
-    char *cstatus;
-
-    char line[XIA_LINE_LEN];
-
-    /* First rewind the file to the beginning */
-    rewind(fp);
-
-    /* Now find the match to the section entry */
-    do {
-        do {
-            cstatus = handel_md_fgets(line, XIA_LINE_LEN, fp);
-
-        } while ((line[0]!='[') &&
-                 (cstatus!=NULL));
-
-        if (cstatus == NULL)
-        {
-            status = XIA_NOSECTION;
-            /* This isn't an error since the user has the option of specifying
-             * the missing information using the dynamic configuration
-             * routines.
-             */
-            xiaLog(XIA_LOG_WARNING, "xiaFindEntryLimits",
-                   "Unable to find section %s", section);
-            return status;
-        }
-
-        /* Find the terminating ] to this section */
-        for (j = 1; j < (strlen(line) + 1); j++)
-        {
-            if (line[j]==']')
-            {
-                break;
-            }
-        }
-        /* Did we not find the terminating ]? */
-        if (j == (unsigned int)strlen(line))
-        {
-            status = XIA_FORMAT_ERROR;
-            xiaLog(XIA_LOG_ERROR, status, "xiaFindEntryLimits",
-                   "Syntax error in Init file, no terminating ] found");
-            return status;
-        }
-
-        if (strncmp(line + 1, section, j - 1) == 0)
-        {
-            /* Recorcd the starting position) */
-            fgetpos(fp, start);
-
-            isStartFound = TRUE_;
-        }
-        /* Else look for the next section entry */
-    } while (!isStartFound);
-
-    return XIA_SUCCESS;
-}
-
-/*
- * Searches thru the .ini file and finds the start and end of a
- * specific section starting at [section] and ending at the
- * next [].
- */
-HANDEL_STATIC int HANDEL_API xiaFindEntryLimits(FILE *fp, const char *section,
-                                                fpos_t *start, fpos_t *end)
-{
-    int status = XIA_SUCCESS;
-
-    char *cstatus;
-
-    char line[XIA_LINE_LEN];
-
-    status = xiaFindEntryStart(fp, section, start);
-    if (status != XIA_SUCCESS) {
-        xiaLog(XIA_LOG_ERROR, status, "xiaFindEntryLimits",
-               "Finding \"%s\" section start.", section);
-        return status;
-    }
-
-    do
-    {
-        /* Get the current file position before the next read.  If the file
-         * ends or we find a '[' then we are done and want to sent the ending
-         * position to the location of the previous read
-         */
-        status = fgetpos(fp, end);
-
-        cstatus = handel_md_fgets(line, XIA_LINE_LEN, fp);
-
-    } while ((line[0] != '[') &&
-             (cstatus != NULL));
-
-    if (!cstatus) {
-        ASSERT(feof(fp));
-    }
-
-    return XIA_SUCCESS;
-}
-
-
 /*****************************************************************************
  *
- * This routine parses data in from fp (and bounded by start & end) as
+ * This routine parses data in from lines first to last of the ini file as
  * detector information. If it fails, then it fails hard and the user needs
  * to fix their inifile.
  *
  *****************************************************************************/
-HANDEL_STATIC int xiaLoadDetector(FILE *fp, fpos_t *start, fpos_t *end)
+HANDEL_STATIC int xiaLoadDetector(IniFile *ini, int first, int last)
 {
     int status;
 
@@ -1377,7 +1533,7 @@ HANDEL_STATIC int xiaLoadDetector(FILE *fp, fpos_t *start, fpos_t *end)
      * 3) rest of the detector information
      */
 
-    status = xiaFileRA(fp, start, end, "alias", value);
+    status = xiaIniFind(ini, first, last, "alias", value);
 
     if (status != XIA_SUCCESS)
     {
@@ -1400,7 +1556,7 @@ HANDEL_STATIC int xiaLoadDetector(FILE *fp, fpos_t *start, fpos_t *end)
         return status;
     }
 
-    status = xiaFileRA(fp, start, end, "number_of_channels", value);
+    status = xiaIniFind(ini, first, last, "number_of_channels", value);
 
     if (status != XIA_SUCCESS)
     {
@@ -1423,7 +1579,7 @@ HANDEL_STATIC int xiaLoadDetector(FILE *fp, fpos_t *start, fpos_t *end)
         return status;
     }
 
-    status = xiaFileRA(fp, start, end, "type", value);
+    status = xiaIniFind(ini, first, last, "type", value);
 
     if (status != XIA_SUCCESS)
     {
@@ -1441,7 +1597,7 @@ HANDEL_STATIC int xiaLoadDetector(FILE *fp, fpos_t *start, fpos_t *end)
         return status;
     }
 
-    status = xiaFileRA(fp, start, end, "type_value", value);
+    status = xiaIniFind(ini, first, last, "type_value", value);
 
     if (status != XIA_SUCCESS)
     {
@@ -1464,7 +1620,7 @@ HANDEL_STATIC int xiaLoadDetector(FILE *fp, fpos_t *start, fpos_t *end)
     for (i = 0; i < numChans; i++)
     {
         sprintf(name, "channel%hu_gain", i);
-        status = xiaFileRA(fp, start, end, name, value);
+        status = xiaIniFind(ini, first, last, name, value);
 
         if (status == XIA_FILE_RA)
         {
@@ -1496,7 +1652,7 @@ HANDEL_STATIC int xiaLoadDetector(FILE *fp, fpos_t *start, fpos_t *end)
         }
 
         sprintf(name, "channel%hu_polarity", i);
-        status = xiaFileRA(fp, start, end, name, value);
+        status = xiaIniFind(ini, first, last, name, value);
 
         if (status == XIA_FILE_RA)
         {
@@ -1534,12 +1690,12 @@ HANDEL_STATIC int xiaLoadDetector(FILE *fp, fpos_t *start, fpos_t *end)
 
 /*****************************************************************************
  *
- * This routine parses data in from fp (and bounded by start & end) as
+ * This routine parses data in from lines first to last of the ini file as
  * module information. If it fails, then it fails hard and the user needs
  * to fix their inifile.
  *
  *****************************************************************************/
-HANDEL_STATIC int xiaLoadModule(FILE *fp, fpos_t *start, fpos_t *end)
+HANDEL_STATIC int xiaLoadModule(IniFile *ini, int first, int last)
 {
     int status;
     int chanAlias;
@@ -1556,12 +1712,10 @@ HANDEL_STATIC int xiaLoadModule(FILE *fp, fpos_t *start, fpos_t *end)
     char firmAlias[MAXALIAS_LEN];
     char defAlias[MAXALIAS_LEN];
 
-    ASSERT(fp);
-    ASSERT(start);
-    ASSERT(end);
+    ASSERT(ini);
 
 
-    status = xiaFileRA(fp, start, end, "alias", value);
+    status = xiaIniFind(ini, first, last, "alias", value);
 
     if (status != XIA_SUCCESS)
     {
@@ -1584,7 +1738,7 @@ HANDEL_STATIC int xiaLoadModule(FILE *fp, fpos_t *start, fpos_t *end)
         return status;
     }
 
-    status = xiaFileRA(fp, start, end, "module_type", value);
+    status = xiaIniFind(ini, first, last, "module_type", value);
 
     if (status != XIA_SUCCESS)
     {
@@ -1606,7 +1760,7 @@ HANDEL_STATIC int xiaLoadModule(FILE *fp, fpos_t *start, fpos_t *end)
                "Error adding module type to module %s", alias);
     }
 
-    status = xiaFileRA(fp, start, end, "number_of_channels", value);
+    status = xiaIniFind(ini, first, last, "number_of_channels", value);
 
     if (status != XIA_SUCCESS)
     {
@@ -1630,7 +1784,7 @@ HANDEL_STATIC int xiaLoadModule(FILE *fp, fpos_t *start, fpos_t *end)
     }
 
     /* Deal with interface here */
-    status = xiaFileRA(fp, start, end, "interface", value);
+    status = xiaIniFind(ini, first, last, "interface", value);
 
     sscanf(value, "%s", iface);
 
@@ -1658,7 +1812,7 @@ HANDEL_STATIC int xiaLoadModule(FILE *fp, fpos_t *start, fpos_t *end)
             return status;
         }
 
-        status = xiaFileRA(fp, start, end, "inet_address", value);
+        status = xiaIniFind(ini, first, last, "inet_address", value);
 
         if (status != XIA_SUCCESS)
         {
@@ -1680,7 +1834,7 @@ HANDEL_STATIC int xiaLoadModule(FILE *fp, fpos_t *start, fpos_t *end)
             return status;
         }
 
-        status = xiaFileRA(fp, start, end, "inet_port", value);
+        status = xiaIniFind(ini, first, last, "inet_port", value);
 
         if (status != XIA_SUCCESS)
         {
@@ -1702,7 +1856,7 @@ HANDEL_STATIC int xiaLoadModule(FILE *fp, fpos_t *start, fpos_t *end)
             return status;
         }
 
-        status = xiaFileRA(fp, start, end, "inet_timeout", value);
+        status = xiaIniFind(ini, first, last, "inet_timeout", value);
 
         if (status != XIA_SUCCESS)
         {
@@ -1732,7 +1886,7 @@ HANDEL_STATIC int xiaLoadModule(FILE *fp, fpos_t *start, fpos_t *end)
 
     for (i = 0; i < numChans; i++) {
         sprintf(name, "channel%u_alias", i);
-        status = xiaFileRA(fp, start, end, name, value);
+        status = xiaIniFind(ini, first, last, name, value);
 
         if (status != XIA_SUCCESS) {
             xiaLog(XIA_LOG_ERROR, status, "xiaLoadModule",
@@ -1754,7 +1908,7 @@ HANDEL_STATIC int xiaLoadModule(FILE *fp, fpos_t *start, fpos_t *end)
         }
 
         sprintf(name, "channel%u_detector", i);
-        status = xiaFileRA(fp, start, end, name, value);
+        status = xiaIniFind(ini, first, last, name, value);
 
         if (status == XIA_FILE_RA) {
             xiaLog(XIA_LOG_WARNING, "xiaLoadModule",
@@ -1787,14 +1941,14 @@ HANDEL_STATIC int xiaLoadModule(FILE *fp, fpos_t *start, fpos_t *end)
      * and defaults. Check for *_all first and if that isn't found then
      * try and find ones for individual channels.
      */
-    status = xiaFileRA(fp, start, end, "firmware_set_all", value);
+    status = xiaIniFind(ini, first, last, "firmware_set_all", value);
 
     if (status != XIA_SUCCESS)
     {
         for (i = 0; i < numChans; i++)
         {
             sprintf(name, "firmware_set_chan%u", i);
-            status = xiaFileRA(fp, start, end, name, value);
+            status = xiaIniFind(ini, first, last, name, value);
 
             if (status == XIA_FILE_RA)
             {
@@ -1839,14 +1993,14 @@ HANDEL_STATIC int xiaLoadModule(FILE *fp, fpos_t *start, fpos_t *end)
         }
     }
 
-    status = xiaFileRA(fp, start, end, "default_all", value);
+    status = xiaIniFind(ini, first, last, "default_all", value);
 
     if (status != XIA_SUCCESS)
     {
         for (i = 0; i < numChans; i++)
         {
             sprintf(name, "default_chan%u", i);
-            status = xiaFileRA(fp, start, end, name, value);
+            status = xiaIniFind(ini, first, last, name, value);
 
             if (status == XIA_FILE_RA)
             {
@@ -1896,39 +2050,36 @@ HANDEL_STATIC int xiaLoadModule(FILE *fp, fpos_t *start, fpos_t *end)
 }
 
 
-HANDEL_STATIC int xiaLoadModChanData(FILE *fp, fpos_t *start, fpos_t *end)
+HANDEL_STATIC int xiaLoadModChanData(IniFile *ini, int first, int last)
 {
     int status;
+    int line = first;
 
-    UNUSED(start);
-    UNUSED(end);
-
-    do {
-        status = xiaReadChanData(fp);
-    } while (status == XIA_SUCCESS);
+    while (line < last) {
+        status = xiaReadChanData(ini, &line, last);
 
-    if (status == XIA_EOF) {
-        return XIA_SUCCESS;
+        if (status != XIA_SUCCESS) {
+            return status;
+        }
     }
 
-    return status;
+    return XIA_SUCCESS;
 }
 
 
 /*
- * Search the section for module channel data starting with prefix,
- * e.g. "data_all" or "data_chan0". If both the length and data are
- * found, the data is parsed and added to the module. Otherwise
- * XIA_FILE_RA is returned.
+ * Reads the channel data for the module whose START line is at line, e.g.
+ * "data_all" or "data_chan0". The data for each channel is preceded by its
+ * length, and is decoded and added to the module. line is left after the
+ * module's END line.
  */
-HANDEL_STATIC int xiaReadChanData(FILE *fp)
+HANDEL_STATIC int xiaReadChanData(IniFile *ini, int *line, int last)
 {
-    char line[XIA_LINE_LEN];
+    const char *text;
+    const char *name;
+    const char *value;
 
-    char name[MAXITEM_LEN];
-    char value[MAXITEM_LEN];
     char prefix[MAXITEM_LEN];
-    char dataKey[MAXITEM_LEN];
 
     int match;
     char alias[MAXALIAS_LEN];
@@ -1946,203 +2097,170 @@ HANDEL_STATIC int xiaReadChanData(FILE *fp)
     uLong uncmpLen;
     GenBuffer buf;
 
-    /* Loop over the module sections: START module1. */
-    do {
-        /* Get the next module alias. */
-        status = xiaGetLine(fp, line);
-        if (status != XIA_SUCCESS) {
-            if (status != XIA_EOF) {
-                xiaLog(XIA_LOG_ERROR, status, "xiaReadChanData",
-                       "Finding channel data.");
-            }
-            return status;
-        }
+    /* Get the module alias: START module1. */
+    text = ini->lines[*line].text;
+
+    if (!STRNEQ(text, "START ")) {
+        status = XIA_FILE_RA;
+        xiaLog(XIA_LOG_ERROR, status, "xiaReadChanData",
+               "Expected module name: %.40s", text);
+        return status;
+    }
+
+    strncpy(alias, text + strlen("START "), MAXALIAS_LEN - 1);
+    alias[MAXALIAS_LEN - 1] = '\0';
+
+    xiaLog(XIA_LOG_DEBUG, "xiaReadChanData",
+           "Channel data for %s.", alias);
+
+    /*
+     * The end of the section also ends the module, as the end of the file
+     * does.
+     */
+    for ((*line)++; *line < last; (*line)++) {
+        text = ini->lines[*line].text;
 
         /*
-         * If we hit another section, treat it like EOF for the
-         * purposes of this section parser.
+         * If we hit the end of the section, we're done with one module.
          */
-        if (line[0] == '[') {
-            return XIA_EOF;
+        if (STRNEQ(text, "END ")) {
+            (*line)++;
+            break;
         }
 
-        if (!STRNEQ(line, "START ")) {
-            status = XIA_FILE_RA;
+        /* Read the channel and length. */
+        status = xiaIniLineData(ini, *line, &name, &value);
+        if (status != XIA_SUCCESS) {
             xiaLog(XIA_LOG_ERROR, status, "xiaReadChanData",
-                   "Expected module name: %.40s", line);
+                   "Finding channel data length: %.40s", text);
             return status;
         }
 
-        strncpy(alias, line + strlen("START "), MAXALIAS_LEN);
-
-        xiaLog(XIA_LOG_DEBUG, "xiaReadChanData",
-               "Channel data for %s.", alias);
+        /* Handle data_all or data_chanN. */
+        if (STRNEQ(text, "data_all_len")) {
+            sprintf(prefix, "data_all");
+        }
+        else {
+            /* Parse the channel from the name. */
+            match = sscanf(name, "data_chan%u_len", &ch);
 
-        do {
-            /* Get the next channel's data length. */
-            status = xiaGetLine(fp, line);
-            if (status != XIA_SUCCESS) {
-                if (status != XIA_EOF) {
-                    xiaLog(XIA_LOG_ERROR, status, "xiaReadChanData",
-                           "Finding channel data.");
-                }
+            if (match != 1) {
+                status = XIA_FILE_RA;
+                xiaLog(XIA_LOG_ERROR, status, "xiaReadChanData",
+                       "Finding channel number in %s, %d matches", name, match);
                 return status;
             }
 
-            /*
-             * If we hit the end of the section, we're done with one module.
-             */
-            if (STRNEQ(line, "END ")) {
-                break;
-            }
+            sprintf(prefix, "data_chan%u", ch);
+        }
 
-            /* Read the channel and length. */
-            status = xiaGetLineData(line, name, value);
-            if (status != XIA_SUCCESS) {
-                xiaLog(XIA_LOG_ERROR, status, "xiaReadChanData",
-                       "Finding channel data length: %.40s", line);
-                return status;
-            }
+        xiaLog(XIA_LOG_DEBUG, "xiaLoadModule",
+               "%s = %s", name, value);
 
-            /* Handle data_all or data_chanN. */
-            if (STRNEQ(line, "data_all_len")) {
-                sprintf(prefix, "data_all");
-            }
-            else {
-                /* Parse the channel from the name. */
-                match = sscanf(name, "data_chan%u_len", &ch);
-
-                if (match != 1) {
-                    status = XIA_FILE_RA;
-                    xiaLog(XIA_LOG_ERROR, status, "xiaReadChanData",
-                           "Finding channel number in %s, %d matches", name, match);
-                    return status;
-                }
+        /* Parse the length from the value. */
+        sscanf(value, "%zu", &dataEncLen);
 
-                sprintf(prefix, "data_chan%u", ch);
-            }
+        /* The next line should be the data for the same key. */
+        (*line)++;
 
-            xiaLog(XIA_LOG_DEBUG, "xiaLoadModule",
-                   "%s = %s", name, value);
+        if (*line == last ||
+            ini->lines[*line].name == NULL ||
+            !STREQ(prefix, ini->lines[*line].name)) {
+            status = XIA_FILE_RA;
+            xiaLog(XIA_LOG_ERROR, status, "xiaReadChanData",
+                   "Expected %s, got %.40s", prefix,
+                   *line == last ? "the end of the section" : ini->lines[*line].text);
+            return status;
+        }
 
-            /* Parse the length from the value. */
-            sscanf(value, "%zu", &dataEncLen);
+        /* The data is used in place, up to its length. */
+        dataEnc = ini->lines[*line].value;
 
-            /*
-             * The next line should be the data for the same key. Scan the key, leaving
-             * the fp at the data.
-             */
-            match = fscanf(fp, "%200[^= ]%*10[= ]", name);
-            if (match != 1 || !STREQ(prefix, name)) {
-                status = XIA_FILE_RA;
-                xiaLog(XIA_LOG_ERROR, status, "xiaReadChanData",
-                       "Expected %s, got %s, %d matches", dataKey, name, match);
-                return status;
-            }
+        if (strlen(dataEnc) < dataEncLen) {
+            dataEncLen = strlen(dataEnc);
+        }
 
-            /* Now use the length to allocate and slurp the data. */
-            dataEnc = handel_md_alloc((dataEncLen + 1) * sizeof(char));
-            if (dataEnc == NULL) {
-                status = XIA_NOMEM;
-                xiaLog(XIA_LOG_ERROR, status, "xiaReadChanData",
-                       "No memory for %s %s", alias, prefix);
-                return status;
-            }
+        /* Decode. Base64 deflates by 3/4. Add one for the null terminator. */
+        dataDecLen = dataEncLen * 3 / 4 + 1;
+        dataDec = handel_md_alloc(dataDecLen);
+        if (dataDec == NULL) {
+            status = XIA_NOMEM;
+            xiaLog(XIA_LOG_ERROR, status, "_addData",
+                   "Unable to allocate memory to decode chosen->data[i]");
+            return status;
+        }
 
-            status = xiaGetLine_N(fp, dataEnc, (int)dataEncLen + 1);
-            if (status != XIA_SUCCESS) {
-                handel_md_free(dataEnc);
-                xiaLog(XIA_LOG_ERROR, status, "xiaReadChanData",
-                       "Unable to load %s %s", alias, prefix);
-                return status;
-            }
+        decStatus = Base64Decode(dataEnc, dataEncLen, dataDec, &dataDecLen);
+        if (decStatus) {
+            handel_md_free(dataDec);
+            status = XIA_DECODE;
+            xiaLog(XIA_LOG_ERROR, status, "_addData",
+                   "Unable to decode %s %s. Decode status=%d.", alias, prefix, decStatus);
+            return status;
+        }
 
-            /* Decode. Base64 deflates by 3/4. Add one for the null terminator. */
-            dataDecLen = dataEncLen * 3 / 4 + 1;
-            dataDec = handel_md_alloc(dataDecLen);
-            if (dataDec == NULL) {
-                handel_md_free(dataEnc);
-                status = XIA_NOMEM;
-                xiaLog(XIA_LOG_ERROR, status, "_addData",
-                       "Unable to allocate memory to decode chosen->data[i]");
-                return status;
-            }
+        uncmpLen = (uLong)dataDecLen * 64; /* Conservative estimate 64x deflate */
+        buf.data = handel_md_alloc(uncmpLen);
+        if (buf.data == NULL) {
+            handel_md_free(dataDec);
+            status = XIA_NOMEM;
+            xiaLog(XIA_LOG_ERROR, status, "_addData",
+                   "Unable to allocate memory for chosen->data[i]");
+            return status;
+        }
 
-            decStatus = Base64Decode(dataEnc, dataEncLen, dataDec, &dataDecLen);
-            if (decStatus) {
-                handel_md_free(dataEnc);
-                handel_md_free(dataDec);
-                status = XIA_DECODE;
-                xiaLog(XIA_LOG_ERROR, status, "_addData",
-                       "Unable to decode %s %s. Decode status=%d.", alias, name, decStatus);
-                return status;
-            }
+        memset(buf.data, 0, uncmpLen);
 
-            handel_md_free(dataEnc);
+        uncmpStatus = uncompress(buf.data, &uncmpLen, dataDec, (uLong)dataDecLen);
 
-            uncmpLen = (uLong)dataDecLen * 64; /* Conservative estimate 64x deflate */
+        /* In the rare case where the deflate ratio is more than 64
+         * increase buffer size and try again*/
+        if (uncmpStatus == MZ_BUF_ERROR) {
+            xiaLog(XIA_LOG_WARNING, "_addData",
+                   "Inflated buffer size larger than %ul, trying again with %ul",
+                   uncmpLen, uncmpLen * 4);
+            uncmpLen = uncmpLen * 4;
+            handel_md_free(buf.data);
             buf.data = handel_md_alloc(uncmpLen);
-            if (buf.data == NULL) {
-                handel_md_free(dataDec);
-                status = XIA_NOMEM;
-                xiaLog(XIA_LOG_ERROR, status, "_addData",
-                       "Unable to allocate memory for chosen->data[i]");
-                return status;
-            }
-
             memset(buf.data, 0, uncmpLen);
-
             uncmpStatus = uncompress(buf.data, &uncmpLen, dataDec, (uLong)dataDecLen);
+        }
 
-            /* In the rare case where the deflate ratio is more than 64
-             * increase buffer size and try again*/
-            if (uncmpStatus == MZ_BUF_ERROR) {
-                xiaLog(XIA_LOG_WARNING, "_addData",
-                       "Inflated buffer size larger than %ul, trying again with %ul",
-                       uncmpLen, uncmpLen * 4);
-                uncmpLen = uncmpLen * 4;
-                handel_md_free(buf.data);
-                buf.data = handel_md_alloc(uncmpLen);
-                memset(buf.data, 0, uncmpLen);
-                uncmpStatus = uncompress(buf.data, &uncmpLen, dataDec, (uLong)dataDecLen);
-            }
-
-            if (uncmpStatus != Z_OK) {
-                handel_md_free(dataDec);
-                handel_md_free(buf.data);
-                status = XIA_DECODE;
-                xiaLog(XIA_LOG_ERROR, status, "_addData",
-                       "Unable to uncompress %s %s. Uncompress status=%d.", alias, name, uncmpStatus);
-                return status;
-            }
-
+        if (uncmpStatus != Z_OK) {
             handel_md_free(dataDec);
+            handel_md_free(buf.data);
+            status = XIA_DECODE;
+            xiaLog(XIA_LOG_ERROR, status, "_addData",
+                   "Unable to uncompress %s %s. Uncompress status=%d.", alias, prefix, uncmpStatus);
+            return status;
+        }
 
-            buf.length = uncmpLen + 1;
+        handel_md_free(dataDec);
 
-            status = xiaAddModuleItem(alias, prefix, &buf);
+        buf.length = uncmpLen + 1;
 
-            handel_md_free(buf.data);
+        status = xiaAddModuleItem(alias, prefix, &buf);
 
-            if (status != XIA_SUCCESS) {
-                xiaLog(XIA_LOG_ERROR, status, "xiaReadChanData",
-                       "Error adding module %s %s", alias, prefix);
-                return status;
-            }
-        } while (status == XIA_SUCCESS); /* Channels in a module */
-    } while (status == XIA_SUCCESS); /* Module sections */
+        handel_md_free(buf.data);
+
+        if (status != XIA_SUCCESS) {
+            xiaLog(XIA_LOG_ERROR, status, "xiaReadChanData",
+                   "Error adding module %s %s", alias, prefix);
+            return status;
+        }
+    }
 
     return XIA_SUCCESS;
 }
 
 /*****************************************************************************
  *
- * This routine parses data in from fp (and bounded by start & end) as
+ * This routine parses data in from lines first to last of the ini file as
  * firmware information. If it fails, then it fails hard and the user needs
  * to fix their inifile.
  *
  *****************************************************************************/
-HANDEL_STATIC int xiaLoadFirmware(FILE *fp, fpos_t *start, fpos_t *end)
+HANDEL_STATIC int xiaLoadFirmware(IniFile *ini, int first, int last)
 {
     int status;
 
@@ -2159,7 +2277,7 @@ HANDEL_STATIC int xiaLoadFirmware(FILE *fp, fpos_t *start, fpos_t *end)
      */
     char keyword[10];
 
-    status = xiaFileRA(fp, start, end, "alias", value);
+    status = xiaIniFind(ini, first, last, "alias", value);
 
     if (status != XIA_SUCCESS)
     {
@@ -2183,7 +2301,7 @@ HANDEL_STATIC int xiaLoadFirmware(FILE *fp, fpos_t *start, fpos_t *end)
     }
 
     /* Check for an MMU first since we'll be exiting if we find a filename */
-    status = xiaFileRA(fp, start, end, "mmu", value);
+    status = xiaIniFind(ini, first, last, "mmu", value);
 
     if (status == XIA_SUCCESS)
     {
@@ -2202,7 +2320,7 @@ HANDEL_STATIC int xiaLoadFirmware(FILE *fp, fpos_t *start, fpos_t *end)
     }
 
     /* If we find a filename, then we are done and can return */
-    status = xiaFileRA(fp, start, end, "filename", value);
+    status = xiaIniFind(ini, first, last, "filename", value);
 
     if (status == XIA_SUCCESS)
     {
@@ -2219,7 +2337,7 @@ HANDEL_STATIC int xiaLoadFirmware(FILE *fp, fpos_t *start, fpos_t *end)
             return status;
         }
 
-        status = xiaFileRA(fp, start, end, "fdd_tmp_path", value);
+        status = xiaIniFind(ini, first, last, "fdd_tmp_path", value);
 
         if (status == XIA_SUCCESS) {
             strcpy(path, value);
@@ -2236,7 +2354,7 @@ HANDEL_STATIC int xiaLoadFirmware(FILE *fp, fpos_t *start, fpos_t *end)
         /* Check for keywords, if any...no need to really warn since the most
          * important "keywords" are generated by Handel.
          */
-        status = xiaFileRA(fp, start, end, "num_keywords", value);
+        status = xiaIniFind(ini, first, last, "num_keywords", value);
 
         if (status == XIA_SUCCESS)
         {
@@ -2247,7 +2365,7 @@ HANDEL_STATIC int xiaLoadFirmware(FILE *fp, fpos_t *start, fpos_t *end)
             for (i = 0; i < numKeywords; i++)
             {
                 sprintf(keyword, "keyword%hu", i);
-                status = xiaFileRA(fp, start, end, keyword, value);
+                status = xiaIniFind(ini, first, last, keyword, value);
 
                 if (status != XIA_SUCCESS)
                 {
@@ -2276,7 +2394,7 @@ HANDEL_STATIC int xiaLoadFirmware(FILE *fp, fpos_t *start, fpos_t *end)
     /* Need to be a little careful here about how we parse in the PTRR chunks.
      * Start slowly by getting the number of PTRRs first.
      */
-    status = xiaReadPTRRs(fp, start, end, alias);
+    status = xiaReadPTRRs(ini, first, last, alias);
 
     if (status != XIA_SUCCESS)
     {
@@ -2295,22 +2413,22 @@ HANDEL_STATIC int xiaLoadFirmware(FILE *fp, fpos_t *start, fpos_t *end)
  * definitions.
  *
  *****************************************************************************/
-HANDEL_STATIC int xiaLoadDefaults(FILE *fp, fpos_t *start, fpos_t *end)
+HANDEL_STATIC int xiaLoadDefaults(IniFile *ini, int first, int last)
 {
     int status;
 
+    int i;
+    int aliasLine;
+
     char value[MAXITEM_LEN];
     char alias[MAXALIAS_LEN];
-    char tmpName[MAXITEM_LEN];
-    char tmpValue[MAXITEM_LEN];
-    char endLine[XIA_LINE_LEN];
-    char line[XIA_LINE_LEN];
 
-    double defValue;
+    const char *tmpName;
+    const char *tmpValue;
 
-    fpos_t dataStart;
+    double defValue;
 
-    status = xiaFileRA(fp, start, end, "alias", value);
+    status = xiaIniFind(ini, first, last, "alias", value);
 
     if (status != XIA_SUCCESS)
     {
@@ -2333,24 +2451,16 @@ HANDEL_STATIC int xiaLoadDefaults(FILE *fp, fpos_t *start, fpos_t *end)
         return status;
     }
 
-    /* Want a position after the alias line so that we can just read in line-
-     * by-line until we reach endLine
-     */
-    xiaSetPosOnNext(fp, start, end, "alias", &dataStart, TRUE_);
-
-    fsetpos(fp, end);
-    status = xiaGetLine(fp, endLine);
-
-    fsetpos(fp, &dataStart);
-    status = xiaGetLine(fp, line);
+    /* Every line after the alias line is a default */
+    xiaIniFindLine(ini, first, last, "alias", &aliasLine);
 
-    while (!STREQ(line, endLine))
+    for (i = aliasLine + 1; i < last; i++)
     {
-        status = xiaGetLineData(line, tmpName, tmpValue);
+        status = xiaIniLineData(ini, i, &tmpName, &tmpValue);
         if (status != XIA_SUCCESS)
         {
             xiaLog(XIA_LOG_ERROR, status, "xiaLoadDefaults",
-                   "Error getting data for entry %s", tmpName);
+                   "Error getting data for entry %s", ini->lines[i].text);
             return status;
         }
 
@@ -2373,8 +2483,6 @@ HANDEL_STATIC int xiaLoadDefaults(FILE *fp, fpos_t *start, fpos_t *end)
                    "Added %s (value = %.3f) to alias %s",
                    tmpName, defValue, alias);
         }
-
-        status = xiaGetLine(fp, line);
     }
 
     return XIA_SUCCESS;
@@ -2391,8 +2499,8 @@ HANDEL_STATIC int xiaLoadDefaults(FILE *fp, fpos_t *start, fpos_t *end)
  * (*) -- Actually, it will read in the number specified by number_of_ptrrs.
  *
  *****************************************************************************/
-HANDEL_STATIC int HANDEL_API xiaReadPTRRs(FILE *fp, fpos_t *start,
-                                          fpos_t *end, char *alias)
+HANDEL_STATIC int HANDEL_API xiaReadPTRRs(IniFile *ini, int first,
+                                          int last, char *alias)
 {
     int status;
 
@@ -2408,33 +2516,41 @@ HANDEL_STATIC int HANDEL_API xiaReadPTRRs(FILE *fp, fpos_t *start,
     char filterName[14];
     char value[MAXITEM_LEN];
 
-    fpos_t newStart;
-    fpos_t newEnd;
-    fpos_t lookAheadStart;
-
-    boolean_t isLast = FALSE_;
+    int ptrrFirst;
+    int ptrrLast;
 
 
     xiaLog(XIA_LOG_DEBUG, "xiaReadPTRRs",
            "Starting parse of PTRRs");
 
     /* This assumes that there is at least one PTRR for a specified alias */
-    newEnd = *start;
-    while (!isLast)
+    status = xiaIniFindLine(ini, first, last, "ptrr", &ptrrFirst);
+
+    if (status != XIA_SUCCESS)
     {
-        xiaSetPosOnNext(fp, &newEnd, end, "ptrr", &lookAheadStart, TRUE_);
-        xiaSetPosOnNext(fp, &newEnd, end, "ptrr", &newStart, FALSE_);
+        xiaLog(XIA_LOG_ERROR, status, "xiaReadPTRRs",
+               "Unable to read ptrr from file");
+        return status;
+    }
 
+    while (ptrrFirst < last)
+    {
         /* Find the end here: either the END or another ptrr */
-        status = xiaSetPosOnNext(fp, &lookAheadStart, end, "ptrr", &newEnd, FALSE_);
+        status = xiaIniFindLine(ini, ptrrFirst + 1, last, "ptrr", &ptrrLast);
 
-        if (status == XIA_END)
+        if (status == XIA_FILE_RA)
         {
-            isLast = TRUE_;
+            ptrrLast = last;
+        }
+        else if (status != XIA_SUCCESS)
+        {
+            xiaLog(XIA_LOG_ERROR, status, "xiaReadPTRRs",
+                   "Unable to find the end of the PTRR");
+            return status;
         }
 
         /* Do the actual actions here */
-        status = xiaFileRA(fp, &newStart, &newEnd, "ptrr", value);
+        status = xiaIniFind(ini, ptrrFirst, ptrrLast, "ptrr", value);
 
         if (status != XIA_SUCCESS)
         {
@@ -2457,7 +2573,7 @@ HANDEL_STATIC int HANDEL_API xiaReadPTRRs(FILE *fp, fpos_t *start,
             return status;
         }
 
-        status = xiaFileRA(fp, &newStart, &newEnd, "min_peaking_time", value);
+        status = xiaIniFind(ini, ptrrFirst, ptrrLast, "min_peaking_time", value);
 
         if (status != XIA_SUCCESS)
         {
@@ -2477,7 +2593,7 @@ HANDEL_STATIC int HANDEL_API xiaReadPTRRs(FILE *fp, fpos_t *start,
             return status;
         }
 
-        status = xiaFileRA(fp, &newStart, &newEnd, "max_peaking_time", value);
+        status = xiaIniFind(ini, ptrrFirst, ptrrLast, "max_peaking_time", value);
 
         if (status != XIA_SUCCESS)
         {
@@ -2497,7 +2613,7 @@ HANDEL_STATIC int HANDEL_API xiaReadPTRRs(FILE *fp, fpos_t *start,
             return status;
         }
 
-        status = xiaFileRA(fp, &newStart, &newEnd, "fippi", value);
+        status = xiaIniFind(ini, ptrrFirst, ptrrLast, "fippi", value);
 
         if (status != XIA_SUCCESS)
         {
@@ -2515,7 +2631,7 @@ HANDEL_STATIC int HANDEL_API xiaReadPTRRs(FILE *fp, fpos_t *start,
             return status;
         }
 
-        status = xiaFileRA(fp, &newStart, &newEnd, "dsp", value);
+        status = xiaIniFind(ini, ptrrFirst, ptrrLast, "dsp", value);
 
         if (status != XIA_SUCCESS)
         {
@@ -2534,7 +2650,7 @@ HANDEL_STATIC int HANDEL_API xiaReadPTRRs(FILE *fp, fpos_t *start,
         }
 
         /* Check for the quite optional "user_fippi"... */
-        status = xiaFileRA(fp, &newStart, &newEnd, "user_fippi", value);
+        status = xiaIniFind(ini, ptrrFirst, ptrrLast, "user_fippi", value);
 
         if (status == XIA_SUCCESS)
         {
@@ -2558,7 +2674,7 @@ HANDEL_STATIC int HANDEL_API xiaReadPTRRs(FILE *fp, fpos_t *start,
             return status;
         }
 
-        status = xiaFileRA(fp, &newStart, &newEnd, "num_filter", value);
+        status = xiaIniFind(ini, ptrrFirst, ptrrLast, "num_filter", value);
 
         if (status != XIA_SUCCESS)
         {
@@ -2575,7 +2691,7 @@ HANDEL_STATIC int HANDEL_API xiaReadPTRRs(FILE *fp, fpos_t *start,
         for (i = 0; i < numFilter; i++)
         {
             sprintf(filterName, "filter_info%hu", i);
-            status = xiaFileRA(fp, &newStart, &newEnd, filterName, value);
+            status = xiaIniFind(ini, ptrrFirst, ptrrLast, filterName, value);
 
             if (status != XIA_SUCCESS)
             {
@@ -2599,86 +2715,13 @@ HANDEL_STATIC int HANDEL_API xiaReadPTRRs(FILE *fp, fpos_t *start,
             }
         }
 
+        ptrrFirst = ptrrLast;
     }
 
     return XIA_SUCCESS;
 }
 
 
-/*****************************************************************************
- *
- * This routine searches between start and end for name. If it finds a name,
- * it sets newPos to that location. If not, it returns a value of XIA_END
- * and sets newPos to end. There are a couple of important caveats here:
- * You can't use fpos_t pointers in direct arithmetic comparisons. They just
- * don't work that way. Instead, I set the file to the position and then read
- * a line from the file. This line serves as the "unique" identifier from
- * which all future comparisons are done. There is a finite probability that
- * the same string may appear elsewhere in the file. Hopefully the same string
- * won't appear twice between start and end.
- *
- *****************************************************************************/
-HANDEL_STATIC int HANDEL_API xiaSetPosOnNext(FILE *fp, fpos_t *start, fpos_t *end,
-                                             const char *name, fpos_t *newPos,
-                                             boolean_t after)
-{
-    int status;
-
-    char endLine[XIA_LINE_LEN];
-    char line[XIA_LINE_LEN];
-    char tmpValue[XIA_LINE_LEN];
-    char tmpName[XIA_LINE_LEN];
-
-    fsetpos(fp, end);
-    status = xiaGetLine(fp, endLine);
-
-    fsetpos(fp, start);
-    fgetpos(fp, newPos);
-    status = xiaGetLine(fp, line);
-
-    xiaLog(XIA_LOG_DEBUG, "xiaSetPosOnNext",
-           "endLine: %s", endLine);
-    xiaLog(XIA_LOG_DEBUG, "xiaSetPosOnNext",
-           "startLine: %s", line);
-
-    while (!STREQ(line, endLine))
-    {
-        status = xiaGetLineData(line, tmpName, tmpValue);
-
-        if (status != XIA_SUCCESS)
-        {
-            xiaLog(XIA_LOG_ERROR, status, "xiaSetPosOnNext",
-                   "Error trying to find %s", name);
-            return status;
-        }
-
-
-        if (STREQ(name, tmpName))
-        {
-            if (after)
-            {
-                fgetpos(fp, newPos);
-            }
-
-            fsetpos(fp, newPos);
-            status = xiaGetLine(fp, line);
-
-            xiaLog(XIA_LOG_DEBUG, "xiaSetPosOnNext",
-                   "newPos set to line: %s", line);
-
-            return XIA_SUCCESS;
-        }
-
-        fgetpos(fp, newPos);
-
-        status = xiaGetLine(fp, line);
-    }
-
-    /* Okay, we must have made it to the end of the file */
-    return XIA_END;
-}
-
-
 /*****************************************************************************
  *
  * This routine will attempt to find the value from the specified name-value
@@ -44,6 +44,7 @@
 #include "xia_handel.h"
 #include "handel_errors.h"
 
+#include "md_shim.h"
 #include "md_threads.h"
 
 /*****************************************************************************
@@ -129,6 +130,34 @@ HANDEL_EXPORT int HANDEL_API xiaSetLogLevel(int level)
     return XIA_SUCCESS;
 }
 
+/*****************************************************************************
+ *
+ * This routine enables or disables asynchronous logging. When enabled
+ * messages are queued and written by a writer thread so logging does not
+ * block the caller on the output. Disable it or close the log before
+ * exiting to write the queued messages.
+ *
+ *****************************************************************************/
+HANDEL_EXPORT int HANDEL_API xiaSetLogAsync(int async)
+/* int async;                            Input: Non-zero to queue messages    */
+{
+    int status;
+
+    if (handel_md_set_log_async == NULL)
+    {
+        xiaInitHandel();
+    }
+
+    status = handel_md_set_log_async(async);
+
+    if (status != XIA_SUCCESS)
+    {
+        return XIA_MD;
+    }
+
+    return XIA_SUCCESS;
+}
+
 /*****************************************************************************
  *
  * This routine sets the output stream for the logging routines. By default,
@@ -151,15 +180,21 @@ HANDEL_EXPORT int HANDEL_API xiaSetLogOutput(const char *filename)
 
 /*****************************************************************************
  *
- * This routine outputs the log.
+ * This routine outputs the log. The xiaLog() macro checks the level before
+ * the call, the check here covers callers built without it.
  *
  *****************************************************************************/
+#undef xiaLog
 HANDEL_SHARED void HANDEL_API xiaLog(int level, const char* file, int line,
                                      int status, const char* func, const char* fmt, ...)
 {
     char formatBuffer[2048];
     va_list args;
 
+    if (!dxp_md_log_enabled(level)) {
+        return;
+    }
+
     va_start(args, fmt);
 
     /*
@@ -43,6 +43,14 @@
 #include <sys/time.h>
 #include <unistd.h>
 
+#if defined(__linux__)
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#else
+#include <fcntl.h>
+#include <poll.h>
+#endif
 
 #include "xia_assert.h"
 #include "xia_common.h"
@@ -418,3 +426,423 @@ XIA_SHARED int handel_md_event_ready(handel_md_Event* event)
 {
     return event->handle != NULL;
 }
+
+#if defined(__linux__)
+
+/*
+ * The Linux poller is an epoll set with an eventfd to wake it. The wake
+ * fd's user pointer is NULL.
+ */
+typedef struct
+{
+    int epfd;
+    int wakefd;
+} pollerInternal;
+
+#define POLLER_EVENTS 32
+
+XIA_SHARED int handel_md_poller_create(handel_md_Poller* poller)
+{
+    int r = EBUSY;
+    if (poller->handle == NULL)
+    {
+        pollerInternal* pi = malloc(sizeof(pollerInternal));
+        if (pi != NULL)
+        {
+            struct epoll_event ev;
+            r = 0;
+            pi->epfd = epoll_create1(EPOLL_CLOEXEC);
+            pi->wakefd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if ((pi->epfd < 0) || (pi->wakefd < 0))
+            {
+                r = errno;
+            }
+            else
+            {
+                ev.events = EPOLLIN;
+                ev.data.ptr = NULL;
+                if (epoll_ctl(pi->epfd, EPOLL_CTL_ADD, pi->wakefd, &ev) < 0)
+                    r = errno;
+            }
+            if (r)
+            {
+                if (pi->epfd >= 0)
+                    close(pi->epfd);
+                if (pi->wakefd >= 0)
+                    close(pi->wakefd);
+                free(pi);
+            }
+            else
+            {
+                poller->handle = pi;
+            }
+        }
+        else
+        {
+            r = ENOMEM;
+        }
+    }
+    return r;
+}
+
+XIA_SHARED int handel_md_poller_destroy(handel_md_Poller* poller)
+{
+    int r = ENOENT;
+    if (poller->handle != NULL)
+    {
+        pollerInternal* pi = (pollerInternal*) poller->handle;
+        close(pi->epfd);
+        close(pi->wakefd);
+        free(pi);
+        poller->handle = NULL;
+        r = 0;
+    }
+    return r;
+}
+
+XIA_SHARED int handel_md_poller_add(handel_md_Poller* poller, int fd, void* user)
+{
+    int r = ENOENT;
+    if (poller->handle != NULL)
+    {
+        pollerInternal* pi = (pollerInternal*) poller->handle;
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = user;
+        r = epoll_ctl(pi->epfd, EPOLL_CTL_ADD, fd, &ev) == 0 ? 0 : errno;
+    }
+    return r;
+}
+
+XIA_SHARED int handel_md_poller_remove(handel_md_Poller* poller, int fd)
+{
+    int r = ENOENT;
+    if (poller->handle != NULL)
+    {
+        pollerInternal* pi = (pollerInternal*) poller->handle;
+        struct epoll_event ev;
+        ev.events = 0;
+        ev.data.ptr = NULL;
+        r = epoll_ctl(pi->epfd, EPOLL_CTL_DEL, fd, &ev) == 0 ? 0 : errno;
+    }
+    return r;
+}
+
+XIA_SHARED int handel_md_poller_wait(handel_md_Poller* poller, unsigned int timeout,
+                                     void** ready, int* count)
+{
+    int r = ENOENT;
+    if (poller->handle != NULL)
+    {
+        pollerInternal* pi = (pollerInternal*) poller->handle;
+        struct epoll_event events[POLLER_EVENTS];
+        int max = *count < POLLER_EVENTS ? *count : POLLER_EVENTS;
+        int n;
+
+        *count = 0;
+
+        n = epoll_wait(pi->epfd, events, max,
+                       timeout == 0 ? -1 :
+                       timeout == THREADING_NO_WAIT ? 0 : (int) timeout);
+        if (n < 0)
+        {
+            r = errno == EINTR ? 0 : errno;
+        }
+        else if (n == 0)
+        {
+            r = THREADING_TIMEOUT;
+        }
+        else
+        {
+            int e;
+            for (e = 0; e < n; ++e)
+            {
+                if (events[e].data.ptr == NULL)
+                {
+                    uint64_t value;
+                    ssize_t  ignored = read(pi->wakefd, &value, sizeof(value));
+                    (void) ignored;
+                }
+                else
+                {
+                    ready[(*count)++] = events[e].data.ptr;
+                }
+            }
+            r = 0;
+        }
+    }
+    return r;
+}
+
+XIA_SHARED int handel_md_poller_wake(handel_md_Poller* poller)
+{
+    int r = ENOENT;
+    if (poller->handle != NULL)
+    {
+        pollerInternal* pi = (pollerInternal*) poller->handle;
+        uint64_t value = 1;
+        r = 0;
+        if (write(pi->wakefd, &value, sizeof(value)) < 0)
+        {
+            /* A full counter is already a pending wake. */
+            if (errno != EAGAIN)
+                r = errno;
+        }
+    }
+    return r;
+}
+
+#else
+
+/*
+ * The generic POSIX poller is a poll() set rebuilt on each wait with a
+ * pipe to wake it. Adds and removes wake the waiter so the next wait sees
+ * the change.
+ */
+typedef struct
+{
+    pthread_mutex_t mutex;
+    int             wake[2];
+    int             size;
+    int             count;
+    int*            fds;
+    void**          users;
+} pollerInternal;
+
+XIA_SHARED int handel_md_poller_create(handel_md_Poller* poller)
+{
+    int r = EBUSY;
+    if (poller->handle == NULL)
+    {
+        pollerInternal* pi = malloc(sizeof(pollerInternal));
+        if (pi != NULL)
+        {
+            pi->size = 0;
+            pi->count = 0;
+            pi->fds = NULL;
+            pi->users = NULL;
+            r = pthread_mutex_init(&pi->mutex, 0);
+            if (r == 0)
+            {
+                if (pipe(pi->wake) < 0)
+                {
+                    r = errno;
+                    pthread_mutex_destroy(&pi->mutex);
+                }
+                else
+                {
+                    fcntl(pi->wake[0], F_SETFL, O_NONBLOCK);
+                    fcntl(pi->wake[1], F_SETFL, O_NONBLOCK);
+                }
+            }
+            if (r)
+                free(pi);
+            else
+                poller->handle = pi;
+        }
+        else
+        {
+            r = ENOMEM;
+        }
+    }
+    return r;
+}
+
+XIA_SHARED int handel_md_poller_destroy(handel_md_Poller* poller)
+{
+    int r = ENOENT;
+    if (poller->handle != NULL)
+    {
+        pollerInternal* pi = (pollerInternal*) poller->handle;
+        close(pi->wake[0]);
+        close(pi->wake[1]);
+        r = pthread_mutex_destroy(&pi->mutex);
+        free(pi->fds);
+        free(pi->users);
+        free(pi);
+        poller->handle = NULL;
+    }
+    return r;
+}
+
+XIA_SHARED int handel_md_poller_add(handel_md_Poller* poller, int fd, void* user)
+{
+    int r = ENOENT;
+    if (poller->handle != NULL)
+    {
+        pollerInternal* pi = (pollerInternal*) poller->handle;
+        r = pthread_mutex_lock(&pi->mutex);
+        if (r == 0)
+        {
+            if (pi->count == pi->size)
+            {
+                int    size = pi->size == 0 ? 8 : pi->size * 2;
+                int*   fds = realloc(pi->fds, sizeof(int) * (size_t) size);
+                void** users = NULL;
+                if (fds != NULL)
+                {
+                    pi->fds = fds;
+                    users = realloc(pi->users, sizeof(void*) * (size_t) size);
+                }
+                if (users != NULL)
+                {
+                    pi->users = users;
+                    pi->size = size;
+                }
+                else
+                {
+                    r = ENOMEM;
+                }
+            }
+            if (r == 0)
+            {
+                pi->fds[pi->count] = fd;
+                pi->users[pi->count] = user;
+                ++pi->count;
+            }
+            pthread_mutex_unlock(&pi->mutex);
+        }
+        if (r == 0)
+            r = handel_md_poller_wake(poller);
+    }
+    return r;
+}
+
+XIA_SHARED int handel_md_poller_remove(handel_md_Poller* poller, int fd)
+{
+    int r = ENOENT;
+    if (poller->handle != NULL)
+    {
+        pollerInternal* pi = (pollerInternal*) poller->handle;
+        int rr = pthread_mutex_lock(&pi->mutex);
+        if (rr == 0)
+        {
+            int f;
+            for (f = 0; f < pi->count; ++f)
+            {
+                if (pi->fds[f] == fd)
+                {
+                    --pi->count;
+                    pi->fds[f] = pi->fds[pi->count];
+                    pi->users[f] = pi->users[pi->count];
+                    r = 0;
+                    break;
+                }
+            }
+            pthread_mutex_unlock(&pi->mutex);
+        }
+        else
+        {
+            r = rr;
+        }
+        if (r == 0)
+            r = handel_md_poller_wake(poller);
+    }
+    return r;
+}
+
+XIA_SHARED int handel_md_poller_wait(handel_md_Poller* poller, unsigned int timeout,
+                                     void** ready, int* count)
+{
+    int r = ENOENT;
+    if (poller->handle != NULL)
+    {
+        pollerInternal* pi = (pollerInternal*) poller->handle;
+        struct pollfd*  fds;
+        void**          users;
+        int             max = *count;
+        int             n = 0;
+
+        *count = 0;
+
+        r = pthread_mutex_lock(&pi->mutex);
+        if (r)
+            return r;
+
+        fds = malloc(sizeof(struct pollfd) * (size_t) (pi->count + 1));
+        users = malloc(sizeof(void*) * (size_t) (pi->count + 1));
+        if ((fds == NULL) || (users == NULL))
+        {
+            pthread_mutex_unlock(&pi->mutex);
+            free(fds);
+            free(users);
+            return ENOMEM;
+        }
+
+        fds[0].fd = pi->wake[0];
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        users[0] = NULL;
+        for (n = 0; n < pi->count; ++n)
+        {
+            fds[n + 1].fd = pi->fds[n];
+            fds[n + 1].events = POLLIN;
+            fds[n + 1].revents = 0;
+            users[n + 1] = pi->users[n];
+        }
+        ++n;
+
+        pthread_mutex_unlock(&pi->mutex);
+
+        r = poll(fds, (nfds_t) n,
+                 timeout == 0 ? -1 :
+                 timeout == THREADING_NO_WAIT ? 0 : (int) timeout);
+        if (r < 0)
+        {
+            r = errno == EINTR ? 0 : errno;
+        }
+        else if (r == 0)
+        {
+            r = THREADING_TIMEOUT;
+        }
+        else
+        {
+            int f;
+            for (f = 0; f < n; ++f)
+            {
+                if ((fds[f].revents & (POLLIN | POLLERR | POLLHUP)) == 0)
+                    continue;
+                if (users[f] == NULL)
+                {
+                    char    drain[16];
+                    ssize_t ignored = read(pi->wake[0], drain, sizeof(drain));
+                    (void) ignored;
+                }
+                else if (*count < max)
+                {
+                    ready[(*count)++] = users[f];
+                }
+            }
+            r = 0;
+        }
+
+        free(fds);
+        free(users);
+    }
+    return r;
+}
+
+XIA_SHARED int handel_md_poller_wake(handel_md_Poller* poller)
+{
+    int r = ENOENT;
+    if (poller->handle != NULL)
+    {
+        pollerInternal* pi = (pollerInternal*) poller->handle;
+        char value = 1;
+        r = 0;
+        if (write(pi->wake[1], &value, sizeof(value)) < 0)
+        {
+            /* A full pipe is already a pending wake. */
+            if (errno != EAGAIN)
+                r = errno;
+        }
+    }
+    return r;
+}
+
+#endif
+
+XIA_SHARED int handel_md_poller_ready(handel_md_Poller* poller)
+{
+    return poller->handle != NULL;
+}
@@ -36,8 +36,18 @@
 #include <stdio.h>
 #include <time.h>
 #include <stdlib.h>
+#include <string.h>
 #include <ctype.h>
 
+/*
+ * The poller selects on module sockets. Raise the select limit from
+ * Winsock's default of 64 before it is included.
+ */
+#ifndef FD_SETSIZE
+#define FD_SETSIZE 1024
+#endif
+
+#include <winsock2.h>
 #include <windows.h>
 
 #include "xia_assert.h"
@@ -278,3 +288,271 @@ XIA_SHARED int handel_md_event_ready(handel_md_Event* event)
 {
     return event->handle != NULL;
 }
+
+/*
+ * The Windows poller is a select() set rebuilt on each wait. Select only
+ * works on sockets so the waiter is woken by a datagram sent to a
+ * loopback socket. Adds and removes wake the waiter so the next wait sees
+ * the change.
+ */
+typedef struct
+{
+    CRITICAL_SECTION lock;
+    SOCKET           wake;
+    int              size;
+    int              count;
+    SOCKET*          fds;
+    void**           users;
+} pollerInternal;
+
+XIA_SHARED int handel_md_poller_create(handel_md_Poller* poller)
+{
+    int r = ERROR_BUSY;
+    if (poller->handle == NULL)
+    {
+        pollerInternal* pi = malloc(sizeof(pollerInternal));
+        if (pi != NULL)
+        {
+            struct sockaddr_in addr;
+            u_long             nonBlocking = 1;
+
+            pi->size = 0;
+            pi->count = 0;
+            pi->fds = NULL;
+            pi->users = NULL;
+
+            memset(&addr, 0, sizeof(addr));
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            addr.sin_port = 0;
+
+            pi->wake = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+            if ((pi->wake == INVALID_SOCKET) ||
+                (bind(pi->wake, (struct sockaddr*) &addr, sizeof(addr)) != 0) ||
+                (ioctlsocket(pi->wake, FIONBIO, &nonBlocking) != 0))
+            {
+                r = WSAGetLastError();
+                if (pi->wake != INVALID_SOCKET)
+                    closesocket(pi->wake);
+                free(pi);
+            }
+            else
+            {
+                InitializeCriticalSection(&pi->lock);
+                poller->handle = pi;
+                r = NO_ERROR;
+            }
+        }
+        else
+        {
+            r = ERROR_NOT_ENOUGH_MEMORY;
+        }
+    }
+    return r;
+}
+
+XIA_SHARED int handel_md_poller_destroy(handel_md_Poller* poller)
+{
+    int r = ERROR_INVALID_HANDLE;
+    if (poller->handle != NULL)
+    {
+        pollerInternal* pi = (pollerInternal*) poller->handle;
+        closesocket(pi->wake);
+        DeleteCriticalSection(&pi->lock);
+        free(pi->fds);
+        free(pi->users);
+        free(pi);
+        poller->handle = NULL;
+        r = NO_ERROR;
+    }
+    return r;
+}
+
+XIA_SHARED int handel_md_poller_add(handel_md_Poller* poller, int fd, void* user)
+{
+    int r = ERROR_INVALID_HANDLE;
+    if (poller->handle != NULL)
+    {
+        pollerInternal* pi = (pollerInternal*) poller->handle;
+        r = NO_ERROR;
+        EnterCriticalSection(&pi->lock);
+        if (pi->count == (FD_SETSIZE - 1))
+        {
+            r = ERROR_TOO_MANY_DESCRIPTORS;
+        }
+        else if (pi->count == pi->size)
+        {
+            int     size = pi->size == 0 ? 8 : pi->size * 2;
+            SOCKET* fds = realloc(pi->fds, sizeof(SOCKET) * (size_t) size);
+            void**  users = NULL;
+            if (fds != NULL)
+            {
+                pi->fds = fds;
+                users = realloc(pi->users, sizeof(void*) * (size_t) size);
+            }
+            if (users != NULL)
+            {
+                pi->users = users;
+                pi->size = size;
+            }
+            else
+            {
+                r = ERROR_NOT_ENOUGH_MEMORY;
+            }
+        }
+        if (r == NO_ERROR)
+        {
+            pi->fds[pi->count] = (SOCKET) fd;
+            pi->users[pi->count] = user;
+            ++pi->count;
+        }
+        LeaveCriticalSection(&pi->lock);
+        if (r == NO_ERROR)
+            r = handel_md_poller_wake(poller);
+    }
+    return r;
+}
+
+XIA_SHARED int handel_md_poller_remove(handel_md_Poller* poller, int fd)
+{
+    int r = ERROR_INVALID_HANDLE;
+    if (poller->handle != NULL)
+    {
+        pollerInternal* pi = (pollerInternal*) poller->handle;
+        int             f;
+        r = ERROR_NOT_FOUND;
+        EnterCriticalSection(&pi->lock);
+        for (f = 0; f < pi->count; ++f)
+        {
+            if (pi->fds[f] == (SOCKET) fd)
+            {
+                --pi->count;
+                pi->fds[f] = pi->fds[pi->count];
+                pi->users[f] = pi->users[pi->count];
+                r = NO_ERROR;
+                break;
+            }
+        }
+        LeaveCriticalSection(&pi->lock);
+        if (r == NO_ERROR)
+            r = handel_md_poller_wake(poller);
+    }
+    return r;
+}
+
+XIA_SHARED int handel_md_poller_wait(handel_md_Poller* poller, unsigned int timeout,
+                                     void** ready, int* count)
+{
+    int r = ERROR_INVALID_HANDLE;
+    if (poller->handle != NULL)
+    {
+        pollerInternal* pi = (pollerInternal*) poller->handle;
+        fd_set          fds;
+        SOCKET*         sockets;
+        void**          users;
+        struct timeval  tv;
+        int             max = *count;
+        int             n;
+        int             f;
+
+        *count = 0;
+
+        EnterCriticalSection(&pi->lock);
+
+        sockets = malloc(sizeof(SOCKET) * (size_t) (pi->count + 1));
+        users = malloc(sizeof(void*) * (size_t) (pi->count + 1));
+        if ((sockets == NULL) || (users == NULL))
+        {
+            LeaveCriticalSection(&pi->lock);
+            free(sockets);
+            free(users);
+            return ERROR_NOT_ENOUGH_MEMORY;
+        }
+
+        FD_ZERO(&fds);
+        sockets[0] = pi->wake;
+        users[0] = NULL;
+        FD_SET(pi->wake, &fds);
+        for (n = 0; n < pi->count; ++n)
+        {
+            sockets[n + 1] = pi->fds[n];
+            users[n + 1] = pi->users[n];
+            FD_SET(pi->fds[n], &fds);
+        }
+        ++n;
+
+        LeaveCriticalSection(&pi->lock);
+
+        if (timeout == THREADING_NO_WAIT)
+        {
+            tv.tv_sec = 0;
+            tv.tv_usec = 0;
+        }
+        else
+        {
+            tv.tv_sec = timeout / 1000;
+            tv.tv_usec = (timeout % 1000) * 1000;
+        }
+
+        r = select(0, &fds, NULL, NULL, timeout == 0 ? NULL : &tv);
+        if (r == SOCKET_ERROR)
+        {
+            r = WSAGetLastError();
+        }
+        else if (r == 0)
+        {
+            r = THREADING_TIMEOUT;
+        }
+        else
+        {
+            for (f = 0; f < n; ++f)
+            {
+                if (!FD_ISSET(sockets[f], &fds))
+                    continue;
+                if (users[f] == NULL)
+                {
+                    char drain[16];
+                    while (recv(pi->wake, drain, sizeof(drain), 0) > 0)
+                        ;
+                }
+                else if (*count < max)
+                {
+                    ready[(*count)++] = users[f];
+                }
+            }
+            r = NO_ERROR;
+        }
+
+        free(sockets);
+        free(users);
+    }
+    return r;
+}
+
+XIA_SHARED int handel_md_poller_wake(handel_md_Poller* poller)
+{
+    int r = ERROR_INVALID_HANDLE;
+    if (poller->handle != NULL)
+    {
+        pollerInternal*    pi = (pollerInternal*) poller->handle;
+        struct sockaddr_in addr;
+        int                len = sizeof(addr);
+        char               value = 1;
+        r = NO_ERROR;
+        if ((getsockname(pi->wake, (struct sockaddr*) &addr, &len) != 0) ||
+            (sendto(pi->wake, &value, sizeof(value), 0,
+                    (struct sockaddr*) &addr, len) == SOCKET_ERROR))
+        {
+            /* A full receive queue is already a pending wake. */
+            r = WSAGetLastError();
+            if (r == WSAEWOULDBLOCK)
+                r = NO_ERROR;
+        }
+    }
+    return r;
+}
+
+XIA_SHARED int handel_md_poller_ready(handel_md_Poller* poller)
+{
+    return poller->handle != NULL;
+}
@@ -46,6 +46,9 @@
 #include "handel_errors.h"
 #include "handel_log.h"
 
+#include "md_shim.h"
+#include "md_threads.h"
+
 
 /*****************************************************************************
  *
@@ -361,6 +364,771 @@ HANDEL_EXPORT int HANDEL_API xiaGetRunData(int detChan,
 }
 
 
+/*****************************************************************************
+ *
+ * This routine resolves the run data name to a handle that can be passed to
+ * xiaGetRunDataByHandle(). The handle is valid for any detChan of the same
+ * board type for the life of the library.
+ *
+ *****************************************************************************/
+HANDEL_EXPORT int HANDEL_API xiaGetRunDataHandle(int detChan,
+                                                 const char *name, int *handle)
+{
+    int status;
+    int elemType;
+
+    Module *module = NULL;
+    Detector *detector = NULL;
+
+    if ((name == NULL) || (handle == NULL)) {
+        status = XIA_NULL_VALUE;
+        xiaLog(XIA_LOG_ERROR, status, "xiaGetRunDataHandle",
+               "NULL name or handle passed in for detChan %d", detChan);
+        return status;
+    }
+
+    elemType = xiaGetElemType(detChan);
+
+    switch(elemType)
+    {
+        case SINGLE:
+            status = xiaFindModuleAndDetector(detChan, &module, &detector);
+
+            if (status != XIA_SUCCESS) {
+                xiaLog(XIA_LOG_ERROR, status, "xiaGetRunDataHandle",
+                       "Unable to get run data handle for detChan %d (get module failed).",
+                       detChan);
+                return status;
+            }
+
+            status = module->psl->getRunDataHandle(detChan, name, handle,
+                                                   detector, module);
+
+            if (status != XIA_SUCCESS)
+            {
+                xiaLog(XIA_LOG_ERROR, status, "xiaGetRunDataHandle",
+                       "Unable get run data handle %s for detChan %d", name, detChan);
+                return status;
+            }
+
+            break;
+
+        case SET:
+            status = XIA_BAD_TYPE;
+            xiaLog(XIA_LOG_ERROR, status, "xiaGetRunDataHandle",
+                   "Unable to get a run data handle for a detChan SET");
+            return status;
+
+        case 999:
+            status = XIA_INVALID_DETCHAN;
+            xiaLog(XIA_LOG_ERROR, status, "xiaGetRunDataHandle",
+                   "detChan number is not in the list of valid values");
+            return status;
+        default:
+            status = XIA_UNKNOWN;
+            xiaLog(XIA_LOG_ERROR, status, "xiaGetRunDataHandle",
+                   "Should not be seeing this message");
+            return status;
+    }
+
+    return XIA_SUCCESS;
+}
+
+
+/*****************************************************************************
+ *
+ * This routine gets the run data for a handle from xiaGetRunDataHandle().
+ * It is the same as xiaGetRunData() without the name lookup.
+ *
+ *****************************************************************************/
+HANDEL_EXPORT int HANDEL_API xiaGetRunDataByHandle(int detChan,
+                                                   int handle, void *value)
+{
+    int status;
+    int elemType;
+
+    Module *module = NULL;
+    Detector *detector = NULL;
+
+    elemType = xiaGetElemType(detChan);
+
+    switch(elemType)
+    {
+        case SINGLE:
+            status = xiaFindModuleAndDetector(detChan, &module, &detector);
+
+            if (status != XIA_SUCCESS) {
+                xiaLog(XIA_LOG_ERROR, status, "xiaGetRunDataByHandle",
+                       "Unable to get run data for detChan %d (get module failed).",
+                       detChan);
+                return status;
+            }
+
+            status = module->psl->getRunDataByHandle(detChan, handle, value,
+                                                     detector, module);
+
+            if (status != XIA_SUCCESS)
+            {
+                xiaLog(XIA_LOG_ERROR, status, "xiaGetRunDataByHandle",
+                       "Unable get run data handle %d for detChan %d", handle, detChan);
+                return status;
+            }
+
+            break;
+
+        case SET:
+            status = XIA_BAD_TYPE;
+            xiaLog(XIA_LOG_ERROR, status, "xiaGetRunDataByHandle",
+                   "Unable to get run data for a detChan SET");
+            return status;
+
+        case 999:
+            status = XIA_INVALID_DETCHAN;
+            xiaLog(XIA_LOG_ERROR, status, "xiaGetRunDataByHandle",
+                   "detChan number is not in the list of valid values");
+            return status;
+        default:
+            status = XIA_UNKNOWN;
+            xiaLog(XIA_LOG_ERROR, status, "xiaGetRunDataByHandle",
+                   "Should not be seeing this message");
+            return status;
+    }
+
+    return XIA_SUCCESS;
+}
+
+
+/*****************************************************************************
+ *
+ * This routine gets run data for all of the detChans in detChan, which can be
+ * a SINGLE or a SET. The data of the n-th detChan, in set order, is written
+ * n * stride bytes into value. The detChans are read a module at a time so
+ * the module and the run data are resolved once per module.
+ *
+ * The data for a detChan is what xiaGetRunData() returns, except for
+ * module_statistics_2 which is only the detChan's own statistics.
+ *
+ *****************************************************************************/
+HANDEL_EXPORT int HANDEL_API xiaGetRunDataMulti(int detChan, const char *name,
+                                                void *value, unsigned long stride)
+{
+    int status = XIA_SUCCESS;
+    int count;
+    int i;
+    int j;
+
+    int *detChans = NULL;
+    int *batch = NULL;
+
+    void **values = NULL;
+
+    Module **modules = NULL;
+
+    if ((name == NULL) || (value == NULL)) {
+        status = XIA_NULL_VALUE;
+        xiaLog(XIA_LOG_ERROR, status, "xiaGetRunDataMulti",
+               "NULL name or value passed in for detChan %d", detChan);
+        return status;
+    }
+
+    count = xiaGetDetChanSetChannels(detChan, NULL, 0);
+
+    if (count < 0) {
+        status = XIA_INVALID_DETCHAN;
+        xiaLog(XIA_LOG_ERROR, status, "xiaGetRunDataMulti",
+               "detChan %d or a detChan in its set is not valid", detChan);
+        return status;
+    }
+
+    if (count == 0) {
+        return XIA_SUCCESS;
+    }
+
+    detChans = handel_md_alloc(sizeof(int) * (size_t) count);
+    batch = handel_md_alloc(sizeof(int) * (size_t) count);
+    values = handel_md_alloc(sizeof(void*) * (size_t) count);
+    modules = handel_md_alloc(sizeof(Module*) * (size_t) count);
+
+    if (!detChans || !batch || !values || !modules) {
+        status = XIA_NOMEM;
+        xiaLog(XIA_LOG_ERROR, status, "xiaGetRunDataMulti",
+               "Not enough memory to read %d detChans", count);
+    }
+
+    if (status == XIA_SUCCESS) {
+        xiaGetDetChanSetChannels(detChan, detChans, count);
+
+        for (i = 0; i < count; i++) {
+            status = xiaFindModuleAndDetector(detChans[i], &modules[i], NULL);
+
+            if (status != XIA_SUCCESS) {
+                xiaLog(XIA_LOG_ERROR, status, "xiaGetRunDataMulti",
+                       "Unable to get run data for detChan %d (get module failed).",
+                       detChans[i]);
+                break;
+            }
+        }
+    }
+
+    /*
+     * Each pass reads the detChans of the first module not yet read. The
+     * module's entries are cleared as they are batched.
+     */
+    for (i = 0; (status == XIA_SUCCESS) && (i < count); i++) {
+        Module *module = modules[i];
+        int n = 0;
+
+        if (module == NULL) {
+            continue;
+        }
+
+        for (j = i; j < count; j++) {
+            if (modules[j] == module) {
+                batch[n] = detChans[j];
+                values[n] = (char*) value + ((size_t) j * stride);
+                modules[j] = NULL;
+                n++;
+            }
+        }
+
+        status = module->psl->getRunDataMulti(name, n, batch, values, module);
+
+        if (status != XIA_SUCCESS) {
+            xiaLog(XIA_LOG_ERROR, status, "xiaGetRunDataMulti",
+                   "Unable get run data %s for module %s", name, module->alias);
+        }
+    }
+
+    handel_md_free(modules);
+    handel_md_free(values);
+    handel_md_free(batch);
+    handel_md_free(detChans);
+
+    return status;
+}
+
+
+/*****************************************************************************
+ *
+ * The buffer waiters are the threads in xiaWaitForBuffer(). Each waiter
+ * has its own event so a signal from the PSLs, when a mapping buffer may
+ * have become full or a run may have stopped, wakes every waiter to check
+ * its own detChans. The lock protects the list and is created by
+ * xiaRunControlInit().
+ *
+ *****************************************************************************/
+typedef struct _BufferWaiter
+{
+    handel_md_Event       event;
+    struct _BufferWaiter* next;
+} BufferWaiter;
+
+static struct
+{
+    handel_md_Mutex lock;
+    BufferWaiter*   waiters;
+} bufferWaiters;
+
+
+/*****************************************************************************
+ *
+ * Buffer completions. When enabled the PSLs post a record each time a
+ * mapping buffer fills. The record is passed to the user's callback on
+ * the thread that filled the buffer or, with no callback, queued for
+ * xiaGetBufferCompletion(). The queue is a fixed ring and records that
+ * arrive when it is full are counted in the lost field of the next record
+ * queued. The lock and event are created by xiaRunControlInit().
+ *
+ *****************************************************************************/
+#define XIA_BUFFER_COMPLETIONS 1024
+
+static struct
+{
+    boolean_t           enabled;
+    handel_md_Mutex     lock;
+    handel_md_Event     event;
+    XiaBufferCallback   callback;
+    void*               arg;
+    unsigned long       head;
+    unsigned long       tail;
+    unsigned long       lost;
+    XiaBufferCompletion records[XIA_BUFFER_COMPLETIONS];
+} bufferCompletions;
+
+
+/*****************************************************************************
+ *
+ * This routine returns the time left to wait for a timeout in milliseconds
+ * that started at start. The timeout is in milliseconds, 0 polls and a
+ * negative timeout waits forever. The wait is for handel_md_event_wait(),
+ * where 0 waits forever. FALSE_ is returned if the timeout has expired.
+ *
+ *****************************************************************************/
+HANDEL_STATIC boolean_t HANDEL_API xiaWaitRemaining(int timeout,
+                                                    const struct timeval* start,
+                                                    unsigned int* wait)
+{
+    struct timeval now;
+    long remaining;
+
+    *wait = 0;
+
+    if (timeout < 0) {
+        return TRUE_;
+    }
+
+    now = dxp_md_gettimeofday();
+    remaining = (long) timeout -
+        (((long) (now.tv_sec - start->tv_sec) * 1000L) +
+         ((long) (now.tv_usec - start->tv_usec) / 1000L));
+
+    if (remaining <= 0) {
+        return FALSE_;
+    }
+
+    *wait = (unsigned int) remaining;
+
+    return TRUE_;
+}
+
+
+/*****************************************************************************
+ *
+ * This routine creates the run control locks and events. It is called by
+ * xiaInitHandel() before any module is started and does nothing if they
+ * exist.
+ *
+ *****************************************************************************/
+HANDEL_SHARED int HANDEL_API xiaRunControlInit(void)
+{
+    int status = XIA_SUCCESS;
+
+    if (!handel_md_mutex_ready(&bufferWaiters.lock)) {
+        if (handel_md_mutex_create(&bufferWaiters.lock) != 0) {
+            status = XIA_THREAD_ERROR;
+            xiaLog(XIA_LOG_ERROR, status, "xiaRunControlInit",
+                   "Unable to create the buffer waiter lock");
+            return status;
+        }
+        bufferWaiters.waiters = NULL;
+    }
+
+    if (!handel_md_mutex_ready(&bufferCompletions.lock)) {
+        if (handel_md_mutex_create(&bufferCompletions.lock) != 0) {
+            status = XIA_THREAD_ERROR;
+            xiaLog(XIA_LOG_ERROR, status, "xiaRunControlInit",
+                   "Unable to create the buffer completion lock");
+            return status;
+        }
+        bufferCompletions.enabled = FALSE_;
+    }
+
+    if (!handel_md_event_ready(&bufferCompletions.event)) {
+        if (handel_md_event_create(&bufferCompletions.event) != 0) {
+            status = XIA_THREAD_ERROR;
+            xiaLog(XIA_LOG_ERROR, status, "xiaRunControlInit",
+                   "Unable to create the buffer completion event");
+            return status;
+        }
+    }
+
+    return status;
+}
+
+
+/*****************************************************************************
+ *
+ * This routine destroys the run control locks and events. It is called by
+ * xiaExit() once the modules are removed and no thread can be waiting or
+ * posting.
+ *
+ *****************************************************************************/
+HANDEL_SHARED void HANDEL_API xiaRunControlExit(void)
+{
+    if (handel_md_mutex_ready(&bufferWaiters.lock)) {
+        handel_md_mutex_destroy(&bufferWaiters.lock);
+        bufferWaiters.waiters = NULL;
+    }
+
+    if (handel_md_mutex_ready(&bufferCompletions.lock)) {
+        handel_md_mutex_destroy(&bufferCompletions.lock);
+        bufferCompletions.enabled = FALSE_;
+        bufferCompletions.callback = NULL;
+        bufferCompletions.arg = NULL;
+    }
+
+    if (handel_md_event_ready(&bufferCompletions.event)) {
+        handel_md_event_destroy(&bufferCompletions.event);
+    }
+}
+
+
+/*****************************************************************************
+ *
+ * This routine wakes the threads waiting in xiaWaitForBuffer(). It is safe
+ * to call from any thread and when no thread is waiting.
+ *
+ *****************************************************************************/
+HANDEL_SHARED void HANDEL_API xiaSignalBufferWaiters(void)
+{
+    BufferWaiter* waiter;
+
+    if (handel_md_mutex_lock(&bufferWaiters.lock) != 0) {
+        return;
+    }
+
+    for (waiter = bufferWaiters.waiters; waiter != NULL; waiter = waiter->next) {
+        handel_md_event_signal(&waiter->event);
+    }
+
+    handel_md_mutex_unlock(&bufferWaiters.lock);
+}
+
+
+/*****************************************************************************
+ *
+ * This routine waits for a mapping buffer of any detChan in detChan, a
+ * SINGLE or a SET, to be full. On return readyDetChan is the detChan with
+ * a full buffer and buffer is 0 for buffer A or 1 for buffer B. If the
+ * runs of all the detChans have stopped with no buffer full readyDetChan
+ * and buffer are -1. The timeout is in milliseconds, 0 polls and a
+ * negative timeout waits forever. XIA_TIMEOUT is returned if no buffer is
+ * full and a run is still active when the timeout expires.
+ *
+ * Any number of threads can wait. Each is woken by every signal and
+ * returns for its own detChans.
+ *
+ *****************************************************************************/
+HANDEL_EXPORT int HANDEL_API xiaWaitForBuffer(int detChan, int timeout,
+                                              int *readyDetChan, int *buffer)
+{
+    int status = XIA_SUCCESS;
+    int count;
+    int i;
+
+    int *detChans = NULL;
+
+    Module **modules = NULL;
+    Detector **detectors = NULL;
+
+    BufferWaiter waiter;
+
+    struct timeval start;
+    unsigned int wait;
+
+    if ((readyDetChan == NULL) || (buffer == NULL)) {
+        status = XIA_NULL_VALUE;
+        xiaLog(XIA_LOG_ERROR, status, "xiaWaitForBuffer",
+               "NULL readyDetChan or buffer passed in for detChan %d", detChan);
+        return status;
+    }
+
+    *readyDetChan = -1;
+    *buffer = -1;
+
+    count = xiaGetDetChanSetChannels(detChan, NULL, 0);
+
+    if (count < 0) {
+        status = XIA_INVALID_DETCHAN;
+        xiaLog(XIA_LOG_ERROR, status, "xiaWaitForBuffer",
+               "detChan %d or a detChan in its set is not valid", detChan);
+        return status;
+    }
+
+    if (count == 0) {
+        return XIA_SUCCESS;
+    }
+
+    waiter.event.handle = NULL;
+    waiter.event.name = NULL;
+
+    if (handel_md_event_create(&waiter.event) != 0) {
+        status = XIA_THREAD_ERROR;
+        xiaLog(XIA_LOG_ERROR, status, "xiaWaitForBuffer",
+               "Unable to create the buffer event");
+        return status;
+    }
+
+    /*
+     * Join the waiters before the first check so a signal between a check
+     * and the wait leaves the event set and is not lost.
+     */
+    if (handel_md_mutex_lock(&bufferWaiters.lock) != 0) {
+        handel_md_event_destroy(&waiter.event);
+        status = XIA_THREAD_ERROR;
+        xiaLog(XIA_LOG_ERROR, status, "xiaWaitForBuffer",
+               "Unable to lock the buffer waiters");
+        return status;
+    }
+    waiter.next = bufferWaiters.waiters;
+    bufferWaiters.waiters = &waiter;
+    handel_md_mutex_unlock(&bufferWaiters.lock);
+
+    detChans = handel_md_alloc(sizeof(int) * (size_t) count);
+    modules = handel_md_alloc(sizeof(Module*) * (size_t) count);
+    detectors = handel_md_alloc(sizeof(Detector*) * (size_t) count);
+
+    if (!detChans || !modules || !detectors) {
+        status = XIA_NOMEM;
+        xiaLog(XIA_LOG_ERROR, status, "xiaWaitForBuffer",
+               "Not enough memory to wait on %d detChans", count);
+    }
+
+    if (status == XIA_SUCCESS) {
+        xiaGetDetChanSetChannels(detChan, detChans, count);
+
+        for (i = 0; i < count; i++) {
+            status = xiaFindModuleAndDetector(detChans[i], &modules[i],
+                                              &detectors[i]);
+
+            if (status != XIA_SUCCESS) {
+                xiaLog(XIA_LOG_ERROR, status, "xiaWaitForBuffer",
+                       "Unable to wait for detChan %d (get module failed).",
+                       detChans[i]);
+                break;
+            }
+        }
+    }
+
+    start = dxp_md_gettimeofday();
+
+    /*
+     * Check each detChan then wait for a PSL to signal a change.
+     */
+    while (status == XIA_SUCCESS) {
+        boolean_t anyActive = FALSE_;
+
+        for (i = 0; i < count; i++) {
+            boolean_t active = FALSE_;
+            int ready = -1;
+
+            status = modules[i]->psl->getBufferReady(detChans[i], &ready, &active,
+                                                     detectors[i], modules[i]);
+
+            if (status != XIA_SUCCESS) {
+                xiaLog(XIA_LOG_ERROR, status, "xiaWaitForBuffer",
+                       "Unable to get the buffer state for detChan %d",
+                       detChans[i]);
+                break;
+            }
+
+            if (ready >= 0) {
+                *readyDetChan = detChans[i];
+                *buffer = ready;
+                break;
+            }
+
+            if (active) {
+                anyActive = TRUE_;
+            }
+        }
+
+        if ((status != XIA_SUCCESS) || (*readyDetChan >= 0) || !anyActive) {
+            break;
+        }
+
+        if (!xiaWaitRemaining(timeout, &start, &wait)) {
+            status = XIA_TIMEOUT;
+            break;
+        }
+
+        /*
+         * A timeout here is checked at the top of the loop.
+         */
+        handel_md_event_wait(&waiter.event, wait);
+    }
+
+    handel_md_mutex_lock(&bufferWaiters.lock);
+    {
+        BufferWaiter** link;
+        for (link = &bufferWaiters.waiters; *link != NULL; link = &(*link)->next) {
+            if (*link == &waiter) {
+                *link = waiter.next;
+                break;
+            }
+        }
+    }
+    handel_md_mutex_unlock(&bufferWaiters.lock);
+
+    handel_md_event_destroy(&waiter.event);
+
+    handel_md_free(detectors);
+    handel_md_free(modules);
+    handel_md_free(detChans);
+
+    return status;
+}
+
+
+/*****************************************************************************
+ *
+ * This routine enables buffer completions. If callback is not NULL it is
+ * called with arg for each completion, otherwise completions are queued
+ * for xiaGetBufferCompletion(). Enabling discards any queued completions.
+ *
+ * The callback is called with the completion lock held on the thread that
+ * finds the buffer full. That is a Handel receive thread as data arrives,
+ * or the application's thread inside xiaBoardOperation() for
+ * "buffer_done" or "buffer_release" when freeing a buffer lets a full one
+ * become Active. The PSL's detector lock is also held. The callback must
+ * be short and must not call Handel.
+ *
+ *****************************************************************************/
+HANDEL_EXPORT int HANDEL_API xiaEnableBufferCompletions(XiaBufferCallback callback,
+                                                        void *arg)
+{
+    int status = XIA_SUCCESS;
+
+    if (handel_md_mutex_lock(&bufferCompletions.lock) != 0) {
+        status = XIA_THREAD_ERROR;
+        xiaLog(XIA_LOG_ERROR, status, "xiaEnableBufferCompletions",
+               "Unable to lock the buffer completions");
+        return status;
+    }
+
+    bufferCompletions.callback = callback;
+    bufferCompletions.arg = arg;
+    bufferCompletions.head = 0;
+    bufferCompletions.tail = 0;
+    bufferCompletions.lost = 0;
+    bufferCompletions.enabled = TRUE_;
+    handel_md_mutex_unlock(&bufferCompletions.lock);
+
+    return status;
+}
+
+
+/*****************************************************************************
+ *
+ * This routine disables buffer completions. No callback is running or
+ * will be called once it returns. A thread waiting in
+ * xiaGetBufferCompletion() returns XIA_NOT_ACTIVE.
+ *
+ *****************************************************************************/
+HANDEL_EXPORT int HANDEL_API xiaDisableBufferCompletions(void)
+{
+    if (handel_md_mutex_ready(&bufferCompletions.lock)) {
+        handel_md_mutex_lock(&bufferCompletions.lock);
+        bufferCompletions.enabled = FALSE_;
+        bufferCompletions.callback = NULL;
+        bufferCompletions.arg = NULL;
+        handel_md_mutex_unlock(&bufferCompletions.lock);
+        handel_md_event_signal(&bufferCompletions.event);
+    }
+
+    return XIA_SUCCESS;
+}
+
+
+/*****************************************************************************
+ *
+ * This routine posts a buffer completion. It is called by the PSLs from
+ * any thread and does nothing if completions are not enabled.
+ *
+ *****************************************************************************/
+HANDEL_SHARED void HANDEL_API xiaPostBufferCompletion(const XiaBufferCompletion *completion)
+{
+    boolean_t queued = FALSE_;
+
+    if (handel_md_mutex_lock(&bufferCompletions.lock) != 0) {
+        return;
+    }
+
+    if (bufferCompletions.enabled) {
+        if (bufferCompletions.callback != NULL) {
+            bufferCompletions.callback(completion, bufferCompletions.arg);
+        } else if ((bufferCompletions.tail - bufferCompletions.head) >=
+                   XIA_BUFFER_COMPLETIONS) {
+            ++bufferCompletions.lost;
+        } else {
+            XiaBufferCompletion *record =
+                &bufferCompletions.records[bufferCompletions.tail %
+                                           XIA_BUFFER_COMPLETIONS];
+            *record = *completion;
+            record->lost = bufferCompletions.lost;
+            bufferCompletions.lost = 0;
+            ++bufferCompletions.tail;
+            queued = TRUE_;
+        }
+    }
+
+    handel_md_mutex_unlock(&bufferCompletions.lock);
+
+    if (queued) {
+        handel_md_event_signal(&bufferCompletions.event);
+    }
+}
+
+
+/*****************************************************************************
+ *
+ * This routine removes the oldest queued buffer completion. The timeout
+ * is in milliseconds, 0 polls and a negative timeout waits forever.
+ * XIA_TIMEOUT is returned if no completion arrives in time and
+ * XIA_NOT_ACTIVE if completions are not enabled or are being delivered to
+ * a callback.
+ *
+ * Only one thread can wait at a time.
+ *
+ *****************************************************************************/
+HANDEL_EXPORT int HANDEL_API xiaGetBufferCompletion(int timeout,
+                                                    XiaBufferCompletion *completion)
+{
+    int status = XIA_SUCCESS;
+
+    struct timeval start;
+    unsigned int wait;
+
+    if (completion == NULL) {
+        status = XIA_NULL_VALUE;
+        xiaLog(XIA_LOG_ERROR, status, "xiaGetBufferCompletion",
+               "NULL completion passed in");
+        return status;
+    }
+
+    if (!handel_md_mutex_ready(&bufferCompletions.lock)) {
+        status = XIA_NOT_ACTIVE;
+        xiaLog(XIA_LOG_ERROR, status, "xiaGetBufferCompletion",
+               "Buffer completions are not enabled");
+        return status;
+    }
+
+    start = dxp_md_gettimeofday();
+
+    while (TRUE_) {
+        boolean_t found = FALSE_;
+
+        handel_md_mutex_lock(&bufferCompletions.lock);
+
+        if (!bufferCompletions.enabled ||
+            (bufferCompletions.callback != NULL)) {
+            status = XIA_NOT_ACTIVE;
+        } else if (bufferCompletions.head != bufferCompletions.tail) {
+            *completion =
+                bufferCompletions.records[bufferCompletions.head %
+                                          XIA_BUFFER_COMPLETIONS];
+            ++bufferCompletions.head;
+            found = TRUE_;
+        }
+
+        handel_md_mutex_unlock(&bufferCompletions.lock);
+
+        if ((status != XIA_SUCCESS) || found) {
+            break;
+        }
+
+        if (!xiaWaitRemaining(timeout, &start, &wait)) {
+            status = XIA_TIMEOUT;
+            break;
+        }
+
+        handel_md_event_wait(&bufferCompletions.event, wait);
+    }
+
+    return status;
+}
+
+
 /*****************************************************************************
  *
  * This routine calls the PSL layer to execute a special run. Extremely
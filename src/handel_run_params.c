@@ -276,6 +276,8 @@ HANDEL_EXPORT int HANDEL_API xiaRemoveAcquisitionValues(int detChan, const char
                             previous->next = entry->next;
                         }
 
+                        xiaUnindexDefaultEntry(defaults, entry);
+
                         handel_md_free((void *)entry->name);
                         handel_md_free((void *)entry);
 
@@ -66,6 +66,7 @@ char * (*handel_md_fgets)(char *s, int size, FILE *stream);
 int (*handel_md_enable_log)(void);
 int (*handel_md_suppress_log)(void);
 int (*handel_md_set_log_level)(int level);
+int (*handel_md_set_log_async)(int async);
 
 HANDEL_SHARED boolean_t HANDEL_API xiaHandelSystemStarting(void)
 {
@@ -103,6 +104,8 @@ HANDEL_EXPORT int HANDEL_API xiaStartSystem(void)
 
     systemState = HANDEL_SYSTEM_STATE_STARTING;
 
+    xiaInvalidateDetChanIndex();
+
     status = xiaValidateFirmwareSets();
 
     if (status != XIA_SUCCESS) {
@@ -148,6 +151,15 @@ HANDEL_EXPORT int HANDEL_API xiaStartSystem(void)
         return status;
     }
 
+    status = xiaBuildDetChanIndex();
+
+    if (status != XIA_SUCCESS) {
+        systemState = HANDEL_SYSTEM_STATE_DEAD;
+        xiaLog(XIA_LOG_ERROR, status, "xiaStartSystem",
+               "Error indexing the detector channels.");
+        return status;
+    }
+
     systemState = HANDEL_SYSTEM_STATE_RUNNING;
 
     return XIA_SUCCESS;
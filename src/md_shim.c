@@ -74,16 +74,23 @@ static boolean_t isSuppressed = FALSE_;
 
 static int logLevel = MD_ERROR;
 
+/* The level checked by the log macros, 0 when the log is suppressed. */
+int dxp_md_log_gate = MD_ERROR;
+
 static handel_md_Mutex lock;
 
 HANDEL_STATIC void dxp_md_error(const char* routine, const char* message,
-                                int* error_code, const char *file, int line);
+                                int* error_code, const char *file, int line,
+                                const struct timeval* tod);
 HANDEL_STATIC void dxp_md_warning(const char *routine, const char *message,
-                                  const char *file, int line);
+                                  const char *file, int line,
+                                  const struct timeval* tod);
 HANDEL_STATIC void dxp_md_info(const char *routine, const char *message,
-                               const char *file, int line);
+                               const char *file, int line,
+                               const struct timeval* tod);
 HANDEL_STATIC void dxp_md_debug(const char *routine, const char *message,
-                                const char *file, int line);
+                                const char *file, int line,
+                                const struct timeval* tod);
 
 
 /** @brief Routine to wait a specified time in seconds.
@@ -139,7 +146,7 @@ XIA_SHARED char * dxp_md_fgets(char *s, int length, FILE *stream)
     if (!cstatus) {
         if (ferror(stream)) {
             dxp_md_warning("dxp_md_fgets", "Error detected reading from "
-                           "stream.", __FILE__, __LINE__);
+                           "stream.", __FILE__, __LINE__, NULL);
         }
 
         return NULL;
@@ -166,6 +173,7 @@ XIA_SHARED char * dxp_md_fgets(char *s, int length, FILE *stream)
 XIA_SHARED int dxp_md_enable_log(void)
 {
     isSuppressed = FALSE_;
+    dxp_md_log_gate = logLevel;
 
     return XIA_SUCCESS;
 }
@@ -179,6 +187,7 @@ XIA_SHARED int dxp_md_enable_log(void)
 XIA_SHARED int dxp_md_suppress_log(void)
 {
     isSuppressed = TRUE_;
+    dxp_md_log_gate = 0;
 
     return XIA_SUCCESS;
 }
@@ -201,6 +210,390 @@ XIA_SHARED int dxp_md_set_log_level(int level)
 
     logLevel = level;
 
+    if (!isSuppressed) {
+        dxp_md_log_gate = level;
+    }
+
+    return XIA_SUCCESS;
+}
+
+
+/*****************************************************************************
+ *
+ * Asynchronous logging. Messages are copied into a ring and a writer
+ * thread formats the header and writes them to the output, so a thread
+ * logging on a receive path does not wait on the output or its lock. The
+ * ring holds variable length records and its lock is only held to copy a
+ * record in or out. A message that does not fit is dropped, unless it is
+ * an error, and the writer reports the count dropped. Messages written as they are logged are
+ * flushed at once, the writer flushes when it empties the ring. Disabling
+ * waits for the writer to drain the ring.
+ *
+ *****************************************************************************/
+#define MD_LOG_RING_SIZE      (1024 * 1024)
+#define MD_LOG_RECORD_ALIGN   (64)
+#define MD_LOG_RECORD_MAX     (4096)
+#define MD_LOG_ROUTINE_MAX    (128)
+#define MD_LOG_WRITER_WAIT    (100)
+#define MD_LOG_WRITER_TIMEOUT (5000)
+
+/*
+ * A ring record. The routine name and message follow the record, each
+ * terminated. A record with a level of 0 pads the end of the ring. The
+ * file is a __FILE__ string and is not copied. Records are aligned so a
+ * record header always fits before the end of the ring.
+ */
+typedef struct
+{
+    size_t         size;
+    int            level;
+    int            error;
+    int            line;
+    const char*    file;
+    struct timeval tod;
+} MD_LogRecord;
+
+#define MD_LOG_ALIGN(_s) \
+    (((_s) + MD_LOG_RECORD_ALIGN - 1) / MD_LOG_RECORD_ALIGN * MD_LOG_RECORD_ALIGN)
+
+static struct
+{
+    boolean_t        enabled;
+    boolean_t        stop;
+    handel_md_Mutex  lock;
+    handel_md_Event  ready;
+    handel_md_Event  done;
+    handel_md_Thread writer;
+    char*            data;
+    size_t           head;
+    size_t           tail;
+    size_t           written;
+    unsigned long    drops;
+} logRing;
+
+HANDEL_STATIC void dxp_md_write(int level, const char *routine, const char *message,
+                                int error, const char *file, int line,
+                                const struct timeval* tod)
+{
+    switch (level) {
+        case MD_ERROR:
+            dxp_md_error(routine, message, &error, file, line, tod);
+            break;
+        case MD_WARNING:
+            dxp_md_warning(routine, message, file, line, tod);
+            break;
+        case MD_INFO:
+            dxp_md_info(routine, message, file, line, tod);
+            break;
+        case MD_DEBUG:
+            dxp_md_debug(routine, message, file, line, tod);
+            break;
+        default:
+            FAIL();
+            break;
+    }
+}
+
+/*
+ * Copy a message into the ring. Returns FALSE_ if asynchronous logging is
+ * not enabled or an error message does not fit, and the caller writes the
+ * message.
+ */
+HANDEL_STATIC boolean_t dxp_md_log_queue(int level, const char *routine,
+                                         const char *message, int error,
+                                         const char *file, int line)
+{
+    MD_LogRecord record;
+    size_t routineLen = strlen(routine);
+    size_t messageLen = strlen(message);
+    size_t size;
+    size_t offset;
+    size_t pad = 0;
+    boolean_t wake = FALSE_;
+
+    if (routineLen > MD_LOG_ROUTINE_MAX)
+        routineLen = MD_LOG_ROUTINE_MAX;
+
+    size = sizeof(record) + routineLen + 1 + messageLen + 1;
+    if (size > MD_LOG_RECORD_MAX) {
+        messageLen -= size - MD_LOG_RECORD_MAX;
+        size = MD_LOG_RECORD_MAX;
+    }
+
+    record.size = MD_LOG_ALIGN(size);
+    record.level = level;
+    record.error = error;
+    record.line = line;
+    record.file = file;
+    record.tod = dxp_md_gettimeofday();
+
+    handel_md_mutex_lock(&logRing.lock);
+
+    if (!logRing.enabled) {
+        handel_md_mutex_unlock(&logRing.lock);
+        return FALSE_;
+    }
+
+    offset = logRing.head % MD_LOG_RING_SIZE;
+    if ((offset + record.size) > MD_LOG_RING_SIZE)
+        pad = MD_LOG_RING_SIZE - offset;
+
+    if ((MD_LOG_RING_SIZE - (logRing.head - logRing.tail)) < (pad + record.size)) {
+        /*
+         * Errors are never dropped, they are written now.
+         */
+        if (level == MD_ERROR) {
+            handel_md_mutex_unlock(&logRing.lock);
+            return FALSE_;
+        }
+        ++logRing.drops;
+    } else {
+        char* data;
+
+        wake = logRing.head == logRing.tail;
+
+        if (pad != 0) {
+            MD_LogRecord padding;
+            memset(&padding, 0, sizeof(padding));
+            padding.size = pad;
+            memcpy(&logRing.data[offset], &padding, sizeof(padding));
+            logRing.head += pad;
+            offset = 0;
+        }
+
+        data = &logRing.data[offset];
+        memcpy(data, &record, sizeof(record));
+        data += sizeof(record);
+        memcpy(data, routine, routineLen);
+        data[routineLen] = '\0';
+        data += routineLen + 1;
+        memcpy(data, message, messageLen);
+        data[messageLen] = '\0';
+
+        logRing.head += record.size;
+    }
+
+    handel_md_mutex_unlock(&logRing.lock);
+
+    if (wake)
+        handel_md_event_signal(&logRing.ready);
+
+    return TRUE_;
+}
+
+/*
+ * The writer thread. It exits once stopped and the ring is empty.
+ */
+HANDEL_STATIC void dxp_md_log_writer(void* arg)
+{
+    MD_LogRecord* record;
+    char* buffer = malloc(MD_LOG_RECORD_MAX);
+    size_t written = 0;
+
+    UNUSED(arg);
+
+    if (buffer == NULL) {
+        handel_md_event_signal(&logRing.done);
+        return;
+    }
+
+    record = (MD_LogRecord*) buffer;
+
+    while (TRUE_) {
+        boolean_t empty;
+        boolean_t stop;
+        unsigned long drops;
+
+        handel_md_mutex_lock(&logRing.lock);
+
+        /*
+         * The records taken last time round have been written. A drain
+         * waits for the written position rather than the tail.
+         */
+        logRing.written = written;
+
+        empty = logRing.head == logRing.tail;
+        stop = logRing.stop;
+
+        if (!empty) {
+            memcpy(record, &logRing.data[logRing.tail % MD_LOG_RING_SIZE],
+                   sizeof(*record));
+            if (record->level != 0) {
+                memcpy(buffer, &logRing.data[logRing.tail % MD_LOG_RING_SIZE],
+                       record->size);
+            }
+            logRing.tail += record->size;
+        }
+
+        written = logRing.tail;
+        drops = logRing.drops;
+        logRing.drops = 0;
+
+        handel_md_mutex_unlock(&logRing.lock);
+
+        if (!empty || (drops != 0)) {
+            handel_md_mutex_lock(&lock);
+
+            if (out_stream == NULL) {
+                out_stream = stdout;
+            }
+
+            if (drops != 0) {
+                char info_string[INFO_LEN];
+                sprintf(info_string, "%lu log messages dropped, the log ring is full",
+                        drops);
+                dxp_md_warning("dxp_md_log_writer", info_string, __FILE__, __LINE__,
+                               NULL);
+            }
+
+            if (!empty && (record->level != 0)) {
+                const char* routine = buffer + sizeof(*record);
+                dxp_md_write(record->level, routine, routine + strlen(routine) + 1,
+                             record->error, record->file, record->line, &record->tod);
+            }
+
+            handel_md_mutex_unlock(&lock);
+        }
+
+        if (empty) {
+            /*
+             * Queued messages are flushed when the writer catches up.
+             */
+            handel_md_mutex_lock(&lock);
+            if (out_stream != NULL)
+                fflush(out_stream);
+            handel_md_mutex_unlock(&lock);
+
+            if (stop)
+                break;
+
+            handel_md_event_wait(&logRing.ready, MD_LOG_WRITER_WAIT);
+        }
+    }
+
+    free(buffer);
+
+    handel_md_event_signal(&logRing.done);
+}
+
+/*
+ * Wait for the writer to write every record in the ring. A record taken
+ * from the ring can still be in the writer so the wait is for the written
+ * position rather than the tail.
+ */
+HANDEL_STATIC void dxp_md_log_drain(void)
+{
+    int wait;
+
+    for (wait = 0; wait < MD_LOG_WRITER_TIMEOUT; ++wait) {
+        boolean_t written;
+
+        handel_md_mutex_lock(&logRing.lock);
+        written = !logRing.enabled || (logRing.head == logRing.written);
+        handel_md_mutex_unlock(&logRing.lock);
+
+        if (written)
+            return;
+
+        handel_md_thread_sleep(1);
+    }
+
+    handel_md_mutex_lock(&lock);
+    if (out_stream == NULL) {
+        out_stream = stdout;
+    }
+    dxp_md_warning("dxp_md_log_drain",
+                   "Timeout waiting for the log writer, messages may be lost",
+                   __FILE__, __LINE__, NULL);
+    handel_md_mutex_unlock(&lock);
+}
+
+
+/*****************************************************************************
+ *
+ * This routine enables or disables asynchronous logging. Disabling writes
+ * the messages in the ring before returning.
+ *
+ *****************************************************************************/
+XIA_SHARED int dxp_md_set_log_async(int async)
+{
+    int status = XIA_SUCCESS;
+
+    if (!handel_md_mutex_ready(&logRing.lock)) {
+        if (handel_md_mutex_create(&logRing.lock) != 0)
+            return XIA_THREAD_ERROR;
+    }
+
+    if (async) {
+        if (logRing.enabled)
+            return XIA_SUCCESS;
+
+        if (!handel_md_mutex_ready(&lock))
+            handel_md_mutex_create(&lock);
+
+        logRing.data = malloc(MD_LOG_RING_SIZE);
+        if (logRing.data == NULL)
+            return XIA_NOMEM;
+
+        logRing.head = 0;
+        logRing.tail = 0;
+        logRing.written = 0;
+        logRing.drops = 0;
+        logRing.stop = FALSE_;
+
+        if ((handel_md_event_create(&logRing.ready) != 0) ||
+            (handel_md_event_create(&logRing.done) != 0)) {
+            status = XIA_THREAD_ERROR;
+        }
+
+        if (status == XIA_SUCCESS) {
+            memset(&logRing.writer, 0, sizeof(logRing.writer));
+            logRing.writer.name = "MD.log";
+            logRing.writer.entryPoint = dxp_md_log_writer;
+            logRing.writer.argument = NULL;
+            if (handel_md_thread_create(&logRing.writer) != 0)
+                status = XIA_THREAD_ERROR;
+        }
+
+        if (status != XIA_SUCCESS) {
+            if (handel_md_event_ready(&logRing.ready))
+                handel_md_event_destroy(&logRing.ready);
+            if (handel_md_event_ready(&logRing.done))
+                handel_md_event_destroy(&logRing.done);
+            free(logRing.data);
+            logRing.data = NULL;
+            return status;
+        }
+
+        handel_md_mutex_lock(&logRing.lock);
+        logRing.enabled = TRUE_;
+        handel_md_mutex_unlock(&logRing.lock);
+    } else {
+        if (!logRing.enabled)
+            return XIA_SUCCESS;
+
+        handel_md_mutex_lock(&logRing.lock);
+        logRing.enabled = FALSE_;
+        logRing.stop = TRUE_;
+        handel_md_mutex_unlock(&logRing.lock);
+
+        handel_md_event_signal(&logRing.ready);
+
+        if (handel_md_event_wait(&logRing.done, MD_LOG_WRITER_TIMEOUT) != 0) {
+            /*
+             * Leave the ring to the writer rather than free it under it.
+             */
+            return XIA_TIMEOUT;
+        }
+
+        handel_md_thread_destroy(&logRing.writer);
+        handel_md_event_destroy(&logRing.ready);
+        handel_md_event_destroy(&logRing.done);
+
+        free(logRing.data);
+        logRing.data = NULL;
+    }
+
     return XIA_SUCCESS;
 }
 
@@ -227,6 +620,11 @@ XIA_SHARED void dxp_md_log(int level, const char *routine, const char *message,
         return;
     }
 
+    if (logRing.enabled &&
+        dxp_md_log_queue(level, routine, message, error, file, line)) {
+        return;
+    }
+
     /*
      * Keep the log messaages ordered and sane in a threading environment.
      */
@@ -240,23 +638,7 @@ XIA_SHARED void dxp_md_log(int level, const char *routine, const char *message,
         out_stream = stdout;
     }
 
-    switch (level) {
-        case MD_ERROR:
-            dxp_md_error(routine, message, &error, file, line);
-            break;
-        case MD_WARNING:
-            dxp_md_warning(routine, message, file, line);
-            break;
-        case MD_INFO:
-            dxp_md_info(routine, message, file, line);
-            break;
-        case MD_DEBUG:
-            dxp_md_debug(routine, message, file, line);
-            break;
-        default:
-            FAIL();
-            break;
-    }
+    dxp_md_write(level, routine, message, error, file, line, NULL);
 
     handel_md_mutex_unlock(&lock);
 }
@@ -296,23 +678,30 @@ HANDEL_SHARED struct timeval dxp_md_gettimeofday(void)
 }
 
 /**
- * Returns the current local time as a struct tm for string formatting
- * and the milliseconds on the side for extra precision.
+ * Returns the local time of tod, or the current time if tod is NULL, as a
+ * struct tm for string formatting and the milliseconds on the side for
+ * extra precision.
  */
-HANDEL_STATIC void dxp_md_local_time(struct tm **local, int *milli)
+HANDEL_STATIC void dxp_md_local_time(struct tm **local, int *milli,
+                                     const struct timeval* tod)
 {
-    struct timeval tod;
-    gettimeofday(&tod, NULL);
-    *milli = (int) tod.tv_usec / 1000;
-    time_t current = tod.tv_sec;
+    struct timeval now;
+    if (tod == NULL) {
+        gettimeofday(&now, NULL);
+        tod = &now;
+    }
+    *milli = (int) tod->tv_usec / 1000;
+    time_t current = tod->tv_sec;
     *local = localtime(&current);
 }
 
 /**
- * Write a standard log format header.
+ * Write a standard log format header. The time is tod, or the current
+ * time if tod is NULL.
  */
 HANDEL_STATIC void dxp_md_log_header(const char* type, const char* routine,
-                                     int* error_code, const char *file, int line)
+                                     int* error_code, const char *file, int line,
+                                     const struct timeval* tod)
 {
     struct tm *localTime;
     int milli;
@@ -321,7 +710,7 @@ HANDEL_STATIC void dxp_md_log_header(const char* type, const char* routine,
     const char* basename;
     int out;
 
-    dxp_md_local_time(&localTime, &milli);
+    dxp_md_local_time(&localTime, &milli, tod);
 
     strftime(logTimeFormat, sizeof(logTimeFormat), "%Y-%m-%d %H:%M:%S", localTime);
 
@@ -352,11 +741,13 @@ HANDEL_STATIC void dxp_md_log_header(const char* type, const char* routine,
  *
  *****************************************************************************/
 HANDEL_STATIC void dxp_md_error(const char* routine, const char* message,
-                                int* error_code, const char *file, int line)
+                                int* error_code, const char *file, int line,
+                                const struct timeval* tod)
 {
-    dxp_md_log_header("[ERROR]", routine, error_code, file, line);
+    dxp_md_log_header("[ERROR]", routine, error_code, file, line, tod);
     fprintf(out_stream, "%s\n", message);
-    fflush(out_stream);
+    if (tod == NULL)
+        fflush(out_stream);
 }
 
 
@@ -367,11 +758,13 @@ HANDEL_STATIC void dxp_md_error(const char* routine, const char* message,
  *
  *****************************************************************************/
 HANDEL_STATIC void dxp_md_warning(const char *routine, const char *message,
-                                  const char *file, int line)
+                                  const char *file, int line,
+                                  const struct timeval* tod)
 {
-    dxp_md_log_header("[WARN ]", routine, NULL, file, line);
+    dxp_md_log_header("[WARN ]", routine, NULL, file, line, tod);
     fprintf(out_stream, "%s\n", message);
-    fflush(out_stream);
+    if (tod == NULL)
+        fflush(out_stream);
 }
 
 
@@ -382,11 +775,13 @@ HANDEL_STATIC void dxp_md_warning(const char *routine, const char *message,
  *
  *****************************************************************************/
 HANDEL_STATIC void dxp_md_info(const char *routine, const char *message,
-                               const char *file, int line)
+                               const char *file, int line,
+                               const struct timeval* tod)
 {
-    dxp_md_log_header("[INFO ]", routine, NULL, file, line);
+    dxp_md_log_header("[INFO ]", routine, NULL, file, line, tod);
     fprintf(out_stream, "%s\n", message);
-    fflush(out_stream);
+    if (tod == NULL)
+        fflush(out_stream);
 }
 
 
@@ -397,11 +792,13 @@ HANDEL_STATIC void dxp_md_info(const char *routine, const char *message,
  *
  *****************************************************************************/
 HANDEL_STATIC void dxp_md_debug(const char *routine, const char *message,
-                                const char *file, int line)
+                                const char *file, int line,
+                                const struct timeval* tod)
 {
-    dxp_md_log_header("[DEBUG]", routine, NULL, file, line);
+    dxp_md_log_header("[DEBUG]", routine, NULL, file, line, tod);
     fprintf(out_stream, "%s\n", message);
-    fflush(out_stream);
+    if (tod == NULL)
+        fflush(out_stream);
 }
 
 
@@ -421,12 +818,21 @@ HANDEL_SHARED void dxp_md_output(const char *filename)
     if (!handel_md_mutex_ready(&lock))
         handel_md_mutex_create(&lock);
 
+    /*
+     * Write the queued messages to the stream they were logged to.
+     */
+    if (logRing.enabled)
+        dxp_md_log_drain();
+
+    handel_md_mutex_lock(&lock);
+
     if (out_stream != NULL && out_stream != stdout && out_stream != stderr) {
         fclose(out_stream);
     }
 
     if (filename == NULL || STREQ(filename, "")) {
         out_stream = stdout;
+        handel_md_mutex_unlock(&lock);
         return;
     }
 
@@ -458,9 +864,12 @@ HANDEL_SHARED void dxp_md_output(const char *filename)
             out_stream = stdout;
             sprintf(info_string, "Unable to open filename '%s' for logging. "
                     "Output redirected to stdout.", filename);
-            dxp_md_error("dxp_md_output", info_string, &status, __FILE__, __LINE__);
+            dxp_md_error("dxp_md_output", info_string, &status, __FILE__, __LINE__,
+                         NULL);
         }
     }
 
+    handel_md_mutex_unlock(&lock);
+
     free(strtmp);
 }
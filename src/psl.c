@@ -56,14 +56,19 @@ static char formatBuffer[2048];
 static handel_md_Mutex lock;
 
 /**
- * The PSL layer logging.
+ * The PSL layer logging. The pslLog() macro checks the level before the
+ * call, the check here covers callers built without it.
  */
+#undef pslLog
 PSL_SHARED void PSL_API pslLog(int level, const char* file, int line,
                                const char* routine, int error,
                                const char* message, ...)
 {
     va_list args;
 
+    if (!dxp_md_log_enabled(level))
+        return;
+
     va_start(args, message);
 
     if (!handel_md_mutex_ready(&lock))
@@ -97,17 +102,11 @@ PSL_SHARED int pslGetDefault(const char *name, void *value, XiaDefaults *default
 
     XiaDaqEntry *entry = NULL;
 
-    entry = defaults->entry;
-
-    while (entry != NULL) {
-
-        if (STREQ(name, entry->name)) {
-
-            *((double *)value) = entry->data;
-            return XIA_SUCCESS;
-        }
+    entry = xiaFindDefaultEntry(defaults, name);
 
-        entry = getListNext(entry);
+    if (entry != NULL) {
+        *((double *)value) = entry->data;
+        return XIA_SUCCESS;
     }
 
     pslLog(PSL_LOG_ERROR, XIA_NOT_FOUND,
@@ -129,17 +128,11 @@ PSL_SHARED int PSL_API pslSetDefault(const char *name, void *value,
     XiaDaqEntry *entry = NULL;
 
 
-    entry = defaults->entry;
-
-    while (entry != NULL) {
-
-        if (STREQ(name, entry->name)) {
+    entry = xiaFindDefaultEntry(defaults, name);
 
-            entry->data = *((double *)value);
-            return XIA_SUCCESS;
-        }
-
-        entry = getListNext(entry);
+    if (entry != NULL) {
+        entry->data = *((double *)value);
+        return XIA_SUCCESS;
     }
 
     return XIA_NOT_FOUND;
@@ -175,6 +168,8 @@ PSL_SHARED int pslRemoveDefault(const char *name, XiaDefaults *defs)
 
             pslLog(PSL_LOG_DEBUG, "e = %p", (void*) e);
 
+            xiaUnindexDefaultEntry(defs, e);
+
             free(e->name);
             free(e);
 
@@ -320,18 +315,5 @@ PSL_SHARED int PSL_API pslSetNumberSCAs(Module *m, XiaDefaults *defs, int modCha
  */
 PSL_SHARED XiaDaqEntry *pslFindEntry(const char *name, XiaDefaults *defs)
 {
-    XiaDaqEntry *e = NULL;
-
-
-    e = defs->entry;
-
-    while (e != NULL) {
-        if (STREQ(e->name, name)) {
-            return e;
-        }
-
-        e = e->next;
-    }
-
-    return NULL;
+    return xiaFindDefaultEntry(defs, name);
 }
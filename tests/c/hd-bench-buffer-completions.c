@@ -0,0 +1,312 @@
+/*
+ * Copyright (c) 2020 XIA LLC
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted provided
+ * that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above
+ *     copyright notice, this list of conditions and the
+ *     following disclaimer.
+ *   * Redistributions in binary form must reproduce the
+ *     above copyright notice, this list of conditions and the
+ *     following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *   * Neither the name of XIA LLC
+ *     nor the names of its contributors may be used to endorse
+ *     or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Measures buffer completion delivery. Producer threads post completion
+ * records in bursts the way the receive threads do when mapping buffers
+ * fill, pausing a millisecond between bursts, and the records are taken from the queue by xiaGetBufferCompletion() and
+ * then delivered to a callback. The rate and the latency from post to
+ * delivery are reported and the queue's records are checked for order.
+ * No hardware is needed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "handel_errors.h"
+
+#include "xia_handel.h"
+#include "xia_common.h"
+
+#include "md_generic.h"
+#include "md_threads.h"
+
+#define PRODUCERS_MAX (16)
+
+typedef struct
+{
+    int              detChan;
+    long             posts;
+    long             burst;
+    handel_md_Thread thread;
+    handel_md_Event  done;
+} Producer;
+
+typedef struct
+{
+    unsigned long received;
+    double        latency;
+    double        maxLatency;
+} Delivery;
+
+static void CHECK_ERROR(int status);
+
+static void usage(const char* prog)
+{
+    printf("%s options\n", prog);
+    printf(" -p producers  : number of producer threads\n");
+    printf(" -n posts      : completions posted by each producer\n");
+    printf(" -b burst      : completions posted between pauses\n");
+}
+
+static double seconds(const struct timespec* start, const struct timespec* end)
+{
+    return (double) (end->tv_sec - start->tv_sec) +
+        (double) (end->tv_nsec - start->tv_nsec) / 1.0e9;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1.0e9;
+}
+
+static void delivered(Delivery* delivery, const XiaBufferCompletion* completion)
+{
+    double latency = now() - completion->time;
+    ++delivery->received;
+    delivery->latency += latency;
+    if (latency > delivery->maxLatency)
+        delivery->maxLatency = latency;
+}
+
+static void callback(const XiaBufferCompletion* completion, void* arg)
+{
+    delivered((Delivery*) arg, completion);
+}
+
+static void produce(void* arg)
+{
+    Producer* producer = (Producer*) arg;
+    long n;
+
+    for (n = 0; n < producer->posts; ++n) {
+        XiaBufferCompletion completion;
+        completion.detChan = producer->detChan;
+        completion.buffer = (int) (n & 1);
+        completion.bufferNumber = (unsigned long) n + 1;
+        completion.firstPixel = (unsigned long) n * 100;
+        completion.pixels = 100;
+        completion.drops = 0;
+        completion.overruns = 0;
+        completion.lost = 0;
+        completion.time = now();
+        xiaPostBufferCompletion(&completion);
+        if (((n + 1) % producer->burst) == 0)
+            handel_md_thread_sleep(1);
+    }
+
+    handel_md_event_signal(&producer->done);
+}
+
+static void start_producers(Producer* producers, int count,
+                            long posts, long burst)
+{
+    int p;
+
+    for (p = 0; p < count; ++p) {
+        Producer* producer = &producers[p];
+        memset(producer, 0, sizeof(*producer));
+        producer->detChan = p;
+        producer->posts = posts;
+        producer->burst = burst;
+        if (handel_md_event_create(&producer->done) != 0)
+            CHECK_ERROR(XIA_THREAD_ERROR);
+        producer->thread.name = "bench.producer";
+        producer->thread.entryPoint = produce;
+        producer->thread.argument = producer;
+        if (handel_md_thread_create(&producer->thread) != 0)
+            CHECK_ERROR(XIA_THREAD_ERROR);
+    }
+}
+
+static void stop_producers(Producer* producers, int count)
+{
+    int p;
+
+    for (p = 0; p < count; ++p) {
+        handel_md_event_wait(&producers[p].done, 0);
+        handel_md_thread_destroy(&producers[p].thread);
+        handel_md_event_destroy(&producers[p].done);
+    }
+}
+
+static void report(const char* label, const Delivery* delivery,
+                   unsigned long lost, double secs)
+{
+    printf(" %-17s : %8.3f Mrecords/s, latency mean %7.2f us max %8.2f us, %lu lost\n",
+           label, (double) delivery->received / secs / 1.0e6,
+           delivery->received ?
+           delivery->latency / (double) delivery->received * 1.0e6 : 0.0,
+           delivery->maxLatency * 1.0e6, lost);
+}
+
+int main(int argc, char* argv[])
+{
+    int a;
+    int status;
+    int producers = 2;
+    long posts = 20000;
+    long burst = 64;
+
+    unsigned long total;
+    unsigned long lost;
+    unsigned long next[PRODUCERS_MAX];
+
+    Producer threads[PRODUCERS_MAX];
+    Delivery delivery;
+
+    struct timespec start;
+    struct timespec end;
+
+    for (a = 1; a < argc; ++a) {
+        if (argv[a][0] == '-' && argv[a][1] == 'p' && (a + 1) < argc) {
+            producers = atoi(argv[++a]);
+        }
+        else if (argv[a][0] == '-' && argv[a][1] == 'n' && (a + 1) < argc) {
+            posts = atol(argv[++a]);
+        }
+        else if (argv[a][0] == '-' && argv[a][1] == 'b' && (a + 1) < argc) {
+            burst = atol(argv[++a]);
+        }
+        else {
+            printf("error: invalid option: %s\n", argv[a]);
+            usage(argv[0]);
+            exit(1);
+        }
+    }
+
+    if (producers < 1 || producers > PRODUCERS_MAX || posts <= 0 || burst <= 0) {
+        printf("error: invalid producer, post or burst count\n");
+        exit(1);
+    }
+
+    status = xiaInitHandel();
+    CHECK_ERROR(status);
+
+    xiaSetLogLevel(MD_ERROR);
+
+    total = (unsigned long) producers * (unsigned long) posts;
+
+    printf("Completions: %d producer(s), %ld posts each in bursts of %ld\n",
+           producers, posts, burst);
+
+    /*
+     * Queue: the consumer takes each record and checks each producer's
+     * records arrive in order, allowing for records lost to a full queue.
+     */
+    status = xiaEnableBufferCompletions(NULL, NULL);
+    CHECK_ERROR(status);
+
+    memset(&delivery, 0, sizeof(delivery));
+    memset(next, 0, sizeof(next));
+    lost = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    start_producers(threads, producers, posts, burst);
+    while ((delivery.received + lost) < total) {
+        XiaBufferCompletion completion;
+
+        status = xiaGetBufferCompletion(1000, &completion);
+        if (status == XIA_TIMEOUT) {
+            /* Records lost after the last queued one are not reported. */
+            break;
+        }
+        CHECK_ERROR(status);
+
+        if (completion.detChan < 0 || completion.detChan >= producers ||
+            completion.bufferNumber <= next[completion.detChan]) {
+            printf("error: detChan %d buffer %lu is out of order\n",
+                   completion.detChan, completion.bufferNumber);
+            exit(1);
+        }
+        next[completion.detChan] = completion.bufferNumber;
+
+        lost += completion.lost;
+        delivered(&delivery, &completion);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    stop_producers(threads, producers);
+
+    report("queue", &delivery, total - delivery.received, seconds(&start, &end));
+
+    /*
+     * Callback: the record is delivered on the posting thread.
+     */
+    memset(&delivery, 0, sizeof(delivery));
+
+    status = xiaEnableBufferCompletions(callback, &delivery);
+    CHECK_ERROR(status);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    start_producers(threads, producers, posts, burst);
+    stop_producers(threads, producers);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    status = xiaDisableBufferCompletions();
+    CHECK_ERROR(status);
+
+    if (delivery.received != total) {
+        printf("error: %lu of %lu callbacks\n", delivery.received, total);
+        exit(1);
+    }
+
+    report("callback", &delivery, 0, seconds(&start, &end));
+
+    xiaExit();
+
+    return 0;
+}
+
+/*
+ * This is just an example of how to handle error values.  A program
+ * of any reasonable size should implement a more robust error
+ * handling mechanism.
+ */
+static void CHECK_ERROR(int status)
+{
+    /* XIA_SUCCESS is defined in handel_errors.h */
+    if (status != XIA_SUCCESS) {
+        int status2;
+        printf("Error encountered (exiting)! Status = %d\n", status);
+        status2 = xiaExit();
+        if (status2 != XIA_SUCCESS)
+            printf("Handel exit failed, Status = %d\n", status2);
+        exit(status);
+    }
+}
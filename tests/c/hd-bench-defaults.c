@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2020 XIA LLC
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted provided
+ * that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above
+ *     copyright notice, this list of conditions and the
+ *     following disclaimer.
+ *   * Redistributions in binary form must reproduce the
+ *     above copyright notice, this list of conditions and the
+ *     following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *   * Neither the name of XIA LLC
+ *     nor the names of its contributors may be used to endorse
+ *     or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Measures the cost of a defaults lookup. A channel's defaults are
+ * created with the FalconXN acquisition values and SCA limits, then each
+ * name is looked up many times through the defaults index and by a walk
+ * of the entry list, which is how the lookup was done before the index.
+ * No hardware is needed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "handel_errors.h"
+
+#include "xia_handel.h"
+#include "xia_handel_structures.h"
+
+#include "md_generic.h"
+
+static const char* names[] = {
+    "analog_gain", "analog_offset", "detector_polarity", "termination",
+    "attenuation", "coupling", "decay_time", "dc_offset",
+    "reset_blanking_enable", "reset_blanking_threshold",
+    "reset_blanking_presamples", "reset_blanking_postsamples",
+    "detection_threshold", "min_pulse_pair_separation",
+    "risetime_optimization", "detection_filter", "mapping_mode",
+    "number_mca_channels", "mca_spectrum_accepted", "mca_spectrum_rejected",
+    "mca_start_channel", "mca_refresh", "preset_type", "preset_value",
+    "scale_factor", "mca_bin_width", "sca_trigger_mode", "sca_pulse_duration",
+    "number_of_scas", "num_map_pixels_per_buffer", "num_map_pixels",
+    "mapping_buffer_count", "list_mode_binning", "pixel_advance_mode",
+    "input_logic_polarity", "gate_ignore", "sync_count", "auto_dc_offset"
+};
+
+#define NAMES ((int) (sizeof(names) / sizeof(names[0])))
+#define SCAS  (64)
+
+static void CHECK_ERROR(int status);
+
+static void usage(const char* prog)
+{
+    printf("%s options\n", prog);
+    printf(" -n lookups    : number of lookups to time\n");
+}
+
+static double elapsed_ns(clock_t start, clock_t end, long lookups)
+{
+    return ((double) (end - start) / CLOCKS_PER_SEC) * 1.0e9 / (double) lookups;
+}
+
+int main(int argc, char* argv[])
+{
+    int a;
+    int status;
+    int i;
+    long l;
+    long lookups = 10000000;
+
+    const char* alias = "bench-defaults";
+
+    char   sca_names[SCAS * 2][32];
+    const char* all[NAMES + SCAS * 2];
+    int    count = 0;
+
+    XiaDefaults* defaults;
+    XiaDaqEntry* entry;
+
+    double value;
+    double sum;
+
+    clock_t start;
+    clock_t end;
+
+    for (a = 1; a < argc; ++a) {
+        if (argv[a][0] == '-' && argv[a][1] == 'n' && (a + 1) < argc) {
+            lookups = atol(argv[++a]);
+        }
+        else {
+            printf("error: invalid option: %s\n", argv[a]);
+            usage(argv[0]);
+            exit(1);
+        }
+    }
+
+    status = xiaInitHandel();
+    CHECK_ERROR(status);
+
+    xiaSetLogLevel(MD_ERROR);
+
+    status = xiaNewDefault(alias);
+    CHECK_ERROR(status);
+
+    for (i = 0; i < NAMES; ++i)
+        all[count++] = names[i];
+
+    for (i = 0; i < SCAS; ++i) {
+        sprintf(sca_names[i * 2], "sca%d_lo", i);
+        sprintf(sca_names[i * 2 + 1], "sca%d_hi", i);
+        all[count++] = sca_names[i * 2];
+        all[count++] = sca_names[i * 2 + 1];
+    }
+
+    for (i = 0; i < count; ++i) {
+        value = (double) i;
+        status = xiaAddDefaultItem(alias, all[i], &value);
+        CHECK_ERROR(status);
+    }
+
+    defaults = xiaFindDefault(alias);
+    if (defaults == NULL)
+        CHECK_ERROR(XIA_NO_ALIAS);
+
+    printf("Defaults: %d entries, %ld lookups\n", count, lookups);
+
+    /* The list walk, as the lookup was done before the index. */
+    sum = 0;
+    start = clock();
+    for (l = 0; l < lookups; ++l) {
+        const char* name = all[l % count];
+        for (entry = defaults->entry; entry != NULL; entry = entry->next) {
+            if (strcmp(name, entry->name) == 0) {
+                sum += entry->data;
+                break;
+            }
+        }
+    }
+    end = clock();
+    printf(" list walk         : %8.1f ns/lookup (%.0f)\n",
+           elapsed_ns(start, end, lookups), sum);
+
+    /* The index. */
+    sum = 0;
+    start = clock();
+    for (l = 0; l < lookups; ++l) {
+        entry = xiaFindDefaultEntry(defaults, all[l % count]);
+        if (entry == NULL)
+            CHECK_ERROR(XIA_NOT_FOUND);
+        sum += entry->data;
+    }
+    end = clock();
+    printf(" index             : %8.1f ns/lookup (%.0f)\n",
+           elapsed_ns(start, end, lookups), sum);
+
+    /* The API, which also finds the defaults by alias. */
+    sum = 0;
+    start = clock();
+    for (l = 0; l < lookups; ++l) {
+        status = xiaGetDefaultItem(alias, all[l % count], &value);
+        if (status != XIA_SUCCESS)
+            CHECK_ERROR(status);
+        sum += value;
+    }
+    end = clock();
+    printf(" xiaGetDefaultItem : %8.1f ns/lookup (%.0f)\n",
+           elapsed_ns(start, end, lookups), sum);
+
+    status = xiaExit();
+    CHECK_ERROR(status);
+
+    return 0;
+}
+
+/*
+ * This is just an example of how to handle error values.  A program
+ * of any reasonable size should implement a more robust error
+ * handling mechanism.
+ */
+static void CHECK_ERROR(int status)
+{
+    /* XIA_SUCCESS is defined in handel_errors.h */
+    if (status != XIA_SUCCESS) {
+        int status2;
+        printf("Error encountered (exiting)! Status = %d\n", status);
+        status2 = xiaExit();
+        if (status2 != XIA_SUCCESS)
+            printf("Handel exit failed, Status = %d\n", status2);
+        exit(status);
+    }
+}
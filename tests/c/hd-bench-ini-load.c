@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2020 XIA LLC
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted provided
+ * that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above
+ *     copyright notice, this list of conditions and the
+ *     following disclaimer.
+ *   * Redistributions in binary form must reproduce the
+ *     above copyright notice, this list of conditions and the
+ *     following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *   * Neither the name of XIA LLC
+ *     nor the names of its contributors may be used to endorse
+ *     or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Measures the time to load a system from an ini file. A system of
+ * detectors, a firmware set with PTRRs, per channel defaults and FalconXN
+ * modules is generated and loaded with xiaLoadSystem() a number of times.
+ * A summary of what was loaded is printed so loaders can be compared. No
+ * hardware is needed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "handel_errors.h"
+
+#include "xia_handel.h"
+#include "xia_common.h"
+
+#include "md_generic.h"
+
+#define DEFAULTS (40)
+
+static void CHECK_ERROR(int status);
+
+static void usage(const char* prog)
+{
+    printf("%s options\n", prog);
+    printf(" -m modules    : number of modules\n");
+    printf(" -c channels   : channels per module\n");
+    printf(" -n loads      : number of loads to time\n");
+    printf(" -f file       : ini file to generate\n");
+}
+
+static double seconds(const struct timespec* start, const struct timespec* end)
+{
+    return (double) (end->tv_sec - start->tv_sec) +
+        (double) (end->tv_nsec - start->tv_nsec) / 1.0e9;
+}
+
+static void generate(const char* name, int modules, int channels)
+{
+    int m;
+    int c;
+    int d;
+    int p;
+
+    FILE* fp = fopen(name, "wb");
+    if (fp == NULL) {
+        printf("error: cannot create %s\n", name);
+        exit(1);
+    }
+
+    fprintf(fp, "[detector definitions]\n\n");
+    for (m = 0; m < modules; ++m) {
+        fprintf(fp, "START #%d\n", m);
+        fprintf(fp, "alias = detector%d\n", m);
+        fprintf(fp, "number_of_channels = %d\n", channels);
+        fprintf(fp, "type = reset\n");
+        fprintf(fp, "type_value = 10.000\n");
+        for (c = 0; c < channels; ++c) {
+            fprintf(fp, "channel%d_gain = 1.000000\n", c);
+            fprintf(fp, "channel%d_polarity = %s\n", c, (c & 1) ? "-" : "+");
+        }
+        fprintf(fp, "END #%d\n\n", m);
+    }
+
+    fprintf(fp, "[firmware definitions]\n\n");
+    fprintf(fp, "START #0\n");
+    fprintf(fp, "alias = firmware0\n");
+    for (p = 0; p < 4; ++p) {
+        fprintf(fp, "ptrr = %d\n", p);
+        fprintf(fp, "min_peaking_time = %3.3f\n", 0.25 * (1 << p));
+        fprintf(fp, "max_peaking_time = %3.3f\n", 0.25 * (2 << p));
+        fprintf(fp, "fippi = fippi%d.fip\n", p);
+        fprintf(fp, "dsp = dsp%d.hex\n", p);
+        fprintf(fp, "num_filter = 2\n");
+        fprintf(fp, "filter_info0 = %d\n", p);
+        fprintf(fp, "filter_info1 = %d\n", p + 1);
+    }
+    fprintf(fp, "END #0\n\n");
+
+    fprintf(fp, "***** Generated by Handel -- DO NOT MODIFY *****\n");
+    fprintf(fp, "[default definitions]\n\n");
+    for (m = 0; m < modules; ++m) {
+        for (c = 0; c < channels; ++c) {
+            fprintf(fp, "START #%d\n", (m * channels) + c);
+            fprintf(fp, "alias = defaults_module%d_channel%d\n", m, c);
+            for (d = 0; d < DEFAULTS; ++d)
+                fprintf(fp, "value_%02d = %3.6f\n", d, (double) d + 0.5);
+            fprintf(fp, "END #%d\n\n", (m * channels) + c);
+        }
+    }
+    fprintf(fp, "***** End of Generated Information *****\n\n");
+
+    fprintf(fp, "[module definitions]\n\n");
+    for (m = 0; m < modules; ++m) {
+        fprintf(fp, "START #%d\n", m);
+        fprintf(fp, "alias = module%d\n", m);
+        fprintf(fp, "module_type = falconxn\n");
+        fprintf(fp, "interface = inet\n");
+        fprintf(fp, "inet_address = 192.168.%d.%d\n", m / 200, (m % 200) + 2);
+        fprintf(fp, "inet_port = 8756\n");
+        fprintf(fp, "inet_timeout = 1000\n");
+        fprintf(fp, "number_of_channels = %d\n", channels);
+        for (c = 0; c < channels; ++c) {
+            fprintf(fp, "channel%d_alias = %d\n", c, (m * channels) + c);
+            fprintf(fp, "channel%d_detector = detector%d:%d\n", c, m, c);
+            fprintf(fp, "firmware_set_chan%d = firmware0\n", c);
+            fprintf(fp, "default_chan%d = defaults_module%d_channel%d\n", c, m, c);
+        }
+        fprintf(fp, "END #%d\n\n", m);
+    }
+
+    fclose(fp);
+}
+
+int main(int argc, char* argv[])
+{
+    int a;
+    int n;
+    int status;
+    unsigned int detectors;
+    unsigned int firmware;
+    unsigned int ptrrs;
+    unsigned int numModules;
+    char address[MAXITEM_LEN];
+    char module[MAXALIAS_LEN];
+    int modules = 64;
+    int channels = 8;
+    int loads = 10;
+
+    const char* ini = "hd-bench-ini-load.ini";
+
+    struct timespec start;
+    struct timespec end;
+
+    for (a = 1; a < argc; ++a) {
+        if (argv[a][0] == '-' && argv[a][1] == 'm' && (a + 1) < argc) {
+            modules = atoi(argv[++a]);
+        }
+        else if (argv[a][0] == '-' && argv[a][1] == 'c' && (a + 1) < argc) {
+            channels = atoi(argv[++a]);
+        }
+        else if (argv[a][0] == '-' && argv[a][1] == 'n' && (a + 1) < argc) {
+            loads = atoi(argv[++a]);
+        }
+        else if (argv[a][0] == '-' && argv[a][1] == 'f' && (a + 1) < argc) {
+            ini = argv[++a];
+        }
+        else {
+            printf("error: invalid option: %s\n", argv[a]);
+            usage(argv[0]);
+            exit(1);
+        }
+    }
+
+    if (modules <= 0 || channels <= 0 || loads <= 0) {
+        printf("error: invalid module, channel or load count\n");
+        exit(1);
+    }
+
+    generate(ini, modules, channels);
+
+    status = xiaInitHandel();
+    CHECK_ERROR(status);
+
+    xiaSetLogLevel(MD_ERROR);
+
+    printf("Ini: %d modules of %d channels, %d loads\n", modules, channels, loads);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (n = 0; n < loads; ++n) {
+        status = xiaLoadSystem("handel_ini", ini);
+        CHECK_ERROR(status);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    printf(" xiaLoadSystem     : %8.2f ms/load\n",
+           seconds(&start, &end) * 1.0e3 / (double) loads);
+
+    status = xiaGetNumDetectors(&detectors);
+    CHECK_ERROR(status);
+    status = xiaGetNumFirmwareSets(&firmware);
+    CHECK_ERROR(status);
+    status = xiaGetNumPTRRs("firmware0", &ptrrs);
+    CHECK_ERROR(status);
+    status = xiaGetNumModules(&numModules);
+    CHECK_ERROR(status);
+
+    sprintf(module, "module%d", modules - 1);
+    status = xiaGetModuleItem(module, "inet_address", address);
+    CHECK_ERROR(status);
+
+    printf(" Loaded            : %u detectors, %u firmware sets (%u PTRRs), "
+           "%u modules\n", detectors, firmware, ptrrs, numModules);
+    printf(" %-17s : %s\n", module, address);
+
+    xiaExit();
+
+    return 0;
+}
+
+/*
+ * This is just an example of how to handle error values.  A program
+ * of any reasonable size should implement a more robust error
+ * handling mechanism.
+ */
+static void CHECK_ERROR(int status)
+{
+    /* XIA_SUCCESS is defined in handel_errors.h */
+    if (status != XIA_SUCCESS) {
+        int status2;
+        printf("Error encountered (exiting)! Status = %d\n", status);
+        status2 = xiaExit();
+        if (status2 != XIA_SUCCESS)
+            printf("Handel exit failed, Status = %d\n", status2);
+        exit(status);
+    }
+}
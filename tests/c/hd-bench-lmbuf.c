@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) 2020 XIA LLC
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted provided
+ * that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above
+ *     copyright notice, this list of conditions and the
+ *     following disclaimer.
+ *   * Redistributions in binary form must reproduce the
+ *     above copyright notice, this list of conditions and the
+ *     following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *   * Neither the name of XIA LLC
+ *     nor the names of its contributors may be used to endorse
+ *     or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Measures list mode pulse decoding throughput. A list mode stream of
+ * pulses, with a sync packet every 1000 pulses, is decoded a packet at a
+ * time with LmBufGetNextPacket() and in runs with LmBufDecodePulses(),
+ * and the two decodes are checked against each other. The runs are
+ * decoded from a copy of the whole stream, from the stream added in
+ * 64 KB chunks as a file reader would, and from the stream attached
+ * in place. No hardware is needed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lmbuf.h"
+
+#define BATCH 4096
+#define CHUNK (65536 + 3)
+
+typedef struct {
+    int32_t*  amplitude;
+    uint32_t* timeOfArrival;
+    uint8_t*  flags;
+} Pulses;
+
+static void usage(const char* prog)
+{
+    printf("%s options\n", prog);
+    printf(" -n pulses     : number of pulses in the stream\n");
+    printf(" -t mode       : times of arrival, 0=none 1=all 2=every other pulse\n");
+}
+
+static double rate(clock_t start, clock_t end, long pulses)
+{
+    return (double) pulses / ((double) (end - start) / CLOCKS_PER_SEC);
+}
+
+static void pulses_alloc(Pulses* pulses, long count)
+{
+    pulses->amplitude = malloc(sizeof(int32_t) * (size_t) count);
+    pulses->timeOfArrival = malloc(sizeof(uint32_t) * (size_t) count);
+    pulses->flags = malloc((size_t) count);
+    if (pulses->amplitude == NULL || pulses->timeOfArrival == NULL ||
+        pulses->flags == NULL) {
+        printf("error: out of memory\n");
+        exit(1);
+    }
+
+    /* Fault the pages in so the first decode timed doesn't pay for it. */
+    memset(pulses->amplitude, 0, sizeof(int32_t) * (size_t) count);
+    memset(pulses->timeOfArrival, 0, sizeof(uint32_t) * (size_t) count);
+    memset(pulses->flags, 0, (size_t) count);
+}
+
+static void pulses_free(Pulses* pulses)
+{
+    free(pulses->amplitude);
+    free(pulses->timeOfArrival);
+    free(pulses->flags);
+}
+
+static void lmbuf_load(LmBuf* lm, uint8_t* stream, size_t len)
+{
+    if (!LmBufInit(lm) || !LmBufAddData(lm, stream, len)) {
+        printf("error: out of memory\n");
+        exit(1);
+    }
+}
+
+static long decode_runs(LmBuf* lm, Pulses* decoded, long found, long pulses)
+{
+    LmPacket packet;
+
+    while (true) {
+        size_t max = (size_t) (pulses - found) < BATCH ? (size_t) (pulses - found) : BATCH;
+        size_t n = LmBufDecodePulses(lm,
+                                     &decoded->amplitude[found],
+                                     &decoded->timeOfArrival[found],
+                                     &decoded->flags[found],
+                                     max);
+        if (n == 0 && !LmBufGetNextPacket(lm, &packet))
+            break;
+        found += (long) n;
+    }
+
+    return found;
+}
+
+static void check(const char* label, Pulses* expected, Pulses* decoded,
+                  long found, long pulses)
+{
+    if (found != pulses ||
+        memcmp(expected->amplitude, decoded->amplitude, sizeof(int32_t) * (size_t) pulses) != 0 ||
+        memcmp(expected->timeOfArrival, decoded->timeOfArrival, sizeof(uint32_t) * (size_t) pulses) != 0 ||
+        memcmp(expected->flags, decoded->flags, (size_t) pulses) != 0) {
+        printf("error: %s decode does not match the packet decode\n", label);
+        exit(1);
+    }
+
+    memset(decoded->amplitude, 0, sizeof(int32_t) * (size_t) pulses);
+}
+
+int main(int argc, char* argv[])
+{
+    int a;
+    long p;
+    long pulses = 4000000;
+    int toa = 0;
+
+    uint8_t* stream;
+    size_t len = 0;
+    size_t offset;
+
+    Pulses expected;
+    Pulses decoded;
+    long found;
+
+    LmBuf lm;
+    LmPacket packet;
+
+    clock_t start;
+    clock_t end;
+
+    for (a = 1; a < argc; ++a) {
+        if (argv[a][0] == '-' && argv[a][1] == 'n' && (a + 1) < argc) {
+            pulses = atol(argv[++a]);
+        }
+        else if (argv[a][0] == '-' && argv[a][1] == 't' && (a + 1) < argc) {
+            toa = atoi(argv[++a]);
+        }
+        else {
+            printf("error: invalid option: %s\n", argv[a]);
+            usage(argv[0]);
+            exit(1);
+        }
+    }
+
+    if (pulses <= 0 || toa < 0 || toa > 2) {
+        printf("error: invalid pulse count or toa mode\n");
+        exit(1);
+    }
+
+    stream = malloc((size_t) pulses * 8 + (size_t) (pulses / 1000 + 3) * 4);
+    if (stream == NULL) {
+        printf("error: out of memory\n");
+        exit(1);
+    }
+
+    pulses_alloc(&expected, pulses);
+    pulses_alloc(&decoded, pulses);
+
+    srand(1);
+
+    for (p = 0; p < pulses; ++p) {
+        if (p % 1000 == 0) {
+            memset(&packet, 0, sizeof(packet));
+            packet.typ = LmPacketTypeSync;
+            packet.p.sync.timestamp = (uint32_t) p;
+            len += (size_t) LmBufEncodePacket(stream + len, 4, &packet, LM_VERSION_0_9_0);
+        }
+
+        memset(&packet, 0, sizeof(packet));
+        packet.typ = LmPacketTypePulse;
+        packet.p.pulse.amplitude = (rand() % 65536) - 4096;
+        packet.p.pulse.invalid = (rand() % 100) == 0;
+        packet.p.pulse.hasTimeOfArrival = toa == 1 || (toa == 2 && (p & 1) != 0);
+        packet.p.pulse.inMarkedRange = (rand() % 10) == 0;
+        packet.p.pulse.timeOfArrival = (uint32_t) rand() & 0xfff;
+        packet.p.pulse.subSampleTimeOfArrival = (uint32_t) rand() & 0xff;
+        len += (size_t) LmBufEncodePacket(stream + len, 8, &packet, LM_VERSION_0_9_0);
+    }
+
+    /*
+     * The decoder holds a pulse back until the word after it arrives.
+     * Trailing syncs let the last pulse be decoded.
+     */
+    memset(&packet, 0, sizeof(packet));
+    packet.typ = LmPacketTypeSync;
+    len += (size_t) LmBufEncodePacket(stream + len, 4, &packet, LM_VERSION_0_9_0);
+    len += (size_t) LmBufEncodePacket(stream + len, 4, &packet, LM_VERSION_0_9_0);
+
+    printf("List mode: %ld pulses, %lu bytes, toa mode %d\n",
+           pulses, (unsigned long) len, toa);
+
+    /* A packet at a time. */
+    lmbuf_load(&lm, stream, len);
+
+    found = 0;
+    start = clock();
+    while (LmBufGetNextPacket(&lm, &packet)) {
+        if (packet.typ == LmPacketTypePulse && found < pulses) {
+            LmPulse* pulse = &packet.p.pulse;
+            expected.amplitude[found] = pulse->amplitude;
+            expected.timeOfArrival[found] = pulse->hasTimeOfArrival ?
+                (pulse->timeOfArrival << 8) | pulse->subSampleTimeOfArrival : 0;
+            expected.flags[found] = (uint8_t)
+                ((pulse->invalid ? LMBUF_PULSE_INVALID : 0) |
+                 (pulse->hasTimeOfArrival ? LMBUF_PULSE_TIME_OF_ARRIVAL : 0) |
+                 (pulse->inMarkedRange ? LMBUF_PULSE_IN_MARKED_RANGE : 0));
+            ++found;
+        }
+    }
+    end = clock();
+    printf(" LmBufGetNextPacket : %8.1f Mpulses/s (%ld pulses)\n",
+           rate(start, end, pulses) / 1.0e6, found);
+
+    LmBufClose(&lm);
+
+    if (found != pulses) {
+        printf("error: packet decode found %ld pulses\n", found);
+        exit(1);
+    }
+
+    /* In runs, falling back to a packet at a time for the syncs. */
+    lmbuf_load(&lm, stream, len);
+
+    /* An untimed pass first, so the first timing doesn't include the warm up. */
+    decode_runs(&lm, &decoded, 0, pulses);
+    LmBufClose(&lm);
+    lmbuf_load(&lm, stream, len);
+
+    start = clock();
+    found = decode_runs(&lm, &decoded, 0, pulses);
+    end = clock();
+    printf(" LmBufDecodePulses  : %8.1f Mpulses/s (%ld pulses)\n",
+           rate(start, end, pulses) / 1.0e6, found);
+
+    LmBufClose(&lm);
+
+    check("run", &expected, &decoded, found, pulses);
+
+    /* In runs, adding the stream in chunks. */
+    if (!LmBufInit(&lm)) {
+        printf("error: out of memory\n");
+        exit(1);
+    }
+
+    found = 0;
+    start = clock();
+    for (offset = 0; offset < len; offset += CHUNK) {
+        size_t chunk = len - offset < CHUNK ? len - offset : CHUNK;
+        if (!LmBufAddData(&lm, stream + offset, chunk)) {
+            printf("error: out of memory\n");
+            exit(1);
+        }
+        found = decode_runs(&lm, &decoded, found, pulses);
+    }
+    end = clock();
+    printf("  ... in 64K chunks : %8.1f Mpulses/s (%ld pulses, %lu byte buffer)\n",
+           rate(start, end, pulses) / 1.0e6, found, (unsigned long) lm.bufSize);
+
+    LmBufClose(&lm);
+
+    check("chunked", &expected, &decoded, found, pulses);
+
+    /* In runs, decoding the stream in place. */
+    LmBufAttach(&lm, stream, len);
+
+    start = clock();
+    found = decode_runs(&lm, &decoded, 0, pulses);
+    end = clock();
+    printf("  ... attached      : %8.1f Mpulses/s (%ld pulses)\n",
+           rate(start, end, pulses) / 1.0e6, found);
+
+    LmBufClose(&lm);
+
+    check("attached", &expected, &decoded, found, pulses);
+
+    pulses_free(&decoded);
+    pulses_free(&expected);
+    free(stream);
+
+    return 0;
+}
@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) 2020 XIA LLC
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted provided
+ * that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above
+ *     copyright notice, this list of conditions and the
+ *     following disclaimer.
+ *   * Redistributions in binary form must reproduce the
+ *     above copyright notice, this list of conditions and the
+ *     following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *   * Neither the name of XIA LLC
+ *     nor the names of its contributors may be used to endorse
+ *     or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Measures list mode file decoding throughput. A list mode file with a
+ * JSON header and a stream alignment packet every 1000 pulses is written
+ * to a temporary file, then decoded with LmBufDecodePulses() after
+ * reading it in 64 KB chunks, after mapping it with LmFileOpen(), and
+ * split with LmFileSplit() and decoded by several threads at once. The
+ * pulse counts and amplitude sums are checked against each other. No
+ * hardware is needed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "lmbuf.h"
+#include "lmfile.h"
+
+#define BATCH 4096
+#define CHUNK 65536
+#define MAX_THREADS 64
+
+typedef struct {
+    int32_t  amplitude[BATCH];
+    uint32_t timeOfArrival[BATCH];
+    uint8_t  flags[BATCH];
+} Pulses;
+
+typedef struct {
+    LmFile*       lf;
+    LmFileSegment segment;
+    long          found;
+    int64_t       sum;
+} Worker;
+
+static void usage(const char* prog)
+{
+    printf("%s options\n", prog);
+    printf(" -n pulses     : number of pulses in the file\n");
+    printf(" -j threads    : number of threads for the split decode\n");
+    printf(" -f file       : the temporary file to write\n");
+}
+
+static double seconds(const struct timespec* start, const struct timespec* end)
+{
+    return (double) (end->tv_sec - start->tv_sec) +
+        (double) (end->tv_nsec - start->tv_nsec) / 1.0e9;
+}
+
+static void report(const char* label, const struct timespec* start,
+                   const struct timespec* end, long found)
+{
+    printf(" %-18s : %8.1f Mpulses/s (%ld pulses)\n",
+           label, (double) found / seconds(start, end) / 1.0e6, found);
+}
+
+static void decode_runs(LmBuf* lm, Pulses* pulses, long* found, int64_t* sum)
+{
+    LmPacket packet;
+    size_t i;
+
+    while (true) {
+        size_t n = LmBufDecodePulses(lm, pulses->amplitude, pulses->timeOfArrival,
+                                     pulses->flags, BATCH);
+        if (n == 0 && !LmBufGetNextPacket(lm, &packet))
+            break;
+        for (i = 0; i < n; ++i)
+            *sum += pulses->amplitude[i];
+        *found += (long) n;
+    }
+}
+
+static void* decode_segment(void* arg)
+{
+    Worker* worker = arg;
+    Pulses* pulses = malloc(sizeof(Pulses));
+    LmBuf lm;
+
+    if (pulses == NULL) {
+        printf("error: out of memory\n");
+        exit(1);
+    }
+
+    LmFileAttachSegment(worker->lf, &worker->segment, &lm);
+    decode_runs(&lm, pulses, &worker->found, &worker->sum);
+    LmBufClose(&lm);
+
+    free(pulses);
+
+    return NULL;
+}
+
+static void write_file(const char* name, long pulses)
+{
+    static const char json[] = "{\"bench\": \"hd-bench-lmfile\"}";
+    uint8_t* stream;
+    size_t len;
+    LmPacket packet;
+    long p;
+    FILE* fp;
+
+    stream = malloc((size_t) pulses * 8 + (size_t) (pulses / 1000 + 3) * 4 + 64);
+    if (stream == NULL) {
+        printf("error: out of memory\n");
+        exit(1);
+    }
+
+    len = (size_t) sprintf((char*) stream, "SiToro_List_Mode\nheaderSize %lu\n%s",
+                           (unsigned long) strlen(json), json);
+
+    srand(1);
+
+    for (p = 0; p < pulses; ++p) {
+        if (p % 1000 == 0) {
+            memset(&packet, 0, sizeof(packet));
+            packet.typ = LmPacketTypeStreamAlign;
+            packet.p.streamAlign.pattern = LMBUF_STREAM_ALIGN_WORD;
+            len += (size_t) LmBufEncodePacket(stream + len, 4, &packet, LM_VERSION_0_9_0);
+        }
+
+        memset(&packet, 0, sizeof(packet));
+        packet.typ = LmPacketTypePulse;
+        packet.p.pulse.amplitude = (rand() % 65536) - 4096;
+        packet.p.pulse.hasTimeOfArrival = (p & 1) != 0;
+        packet.p.pulse.timeOfArrival = (uint32_t) rand() & 0xfff;
+        len += (size_t) LmBufEncodePacket(stream + len, 8, &packet, LM_VERSION_0_9_0);
+    }
+
+    fp = fopen(name, "wb");
+    if (fp == NULL || fwrite(stream, 1, len, fp) != len || fclose(fp) != 0) {
+        printf("error: cannot write %s\n", name);
+        exit(1);
+    }
+
+    printf("List mode file: %ld pulses, %lu bytes\n", pulses, (unsigned long) len);
+
+    free(stream);
+}
+
+int main(int argc, char* argv[])
+{
+    int a;
+    int t;
+    long pulses = 4000000;
+    int threads = 4;
+    const char* name = "hd-bench-lmfile.lm";
+
+    Pulses* buffer;
+    uint8_t* chunk;
+    long found;
+    int64_t sum;
+    long expected;
+    int64_t expectedSum;
+    int64_t mappedSum;
+
+    LmFile lf;
+    LmBuf lm;
+    LmFileSegment segments[MAX_THREADS];
+    Worker workers[MAX_THREADS];
+    pthread_t ids[MAX_THREADS];
+    int count;
+    char* header;
+    size_t headerLen;
+    bool invalidHeader;
+    ssize_t got;
+    int fd;
+
+    struct timespec start;
+    struct timespec end;
+
+    for (a = 1; a < argc; ++a) {
+        if (argv[a][0] == '-' && argv[a][1] == 'n' && (a + 1) < argc) {
+            pulses = atol(argv[++a]);
+        }
+        else if (argv[a][0] == '-' && argv[a][1] == 'j' && (a + 1) < argc) {
+            threads = atoi(argv[++a]);
+        }
+        else if (argv[a][0] == '-' && argv[a][1] == 'f' && (a + 1) < argc) {
+            name = argv[++a];
+        }
+        else {
+            printf("error: invalid option: %s\n", argv[a]);
+            usage(argv[0]);
+            exit(1);
+        }
+    }
+
+    if (pulses <= 0 || threads < 1 || threads > MAX_THREADS) {
+        printf("error: invalid pulse or thread count\n");
+        exit(1);
+    }
+
+    buffer = malloc(sizeof(Pulses));
+    chunk = malloc(CHUNK);
+    if (buffer == NULL || chunk == NULL) {
+        printf("error: out of memory\n");
+        exit(1);
+    }
+
+    write_file(name, pulses);
+
+    /* Read in chunks, as a reader without the mapping would. */
+    fd = open(name, O_RDONLY);
+    if (fd < 0 || !LmBufInit(&lm)) {
+        printf("error: cannot open %s\n", name);
+        exit(1);
+    }
+
+    expected = 0;
+    expectedSum = 0;
+    header = NULL;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while ((got = read(fd, chunk, CHUNK)) > 0) {
+        if (!LmBufAddData(&lm, chunk, (size_t) got)) {
+            printf("error: out of memory\n");
+            exit(1);
+        }
+        if (header == NULL) {
+            if (!LmBufGetJsonHeader(&lm, &header, &headerLen, &invalidHeader))
+                continue;
+            if (invalidHeader) {
+                printf("error: invalid header\n");
+                exit(1);
+            }
+        }
+        decode_runs(&lm, buffer, &expected, &expectedSum);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    report("read in 64K chunks", &start, &end, expected);
+
+    LmBufClose(&lm);
+    close(fd);
+    free(header);
+
+    /*
+     * A last pulse without a time of arrival is held back until the word
+     * after it arrives, so the chunked read may decode one fewer.
+     */
+    if (expected != pulses && expected != pulses - 1) {
+        printf("error: chunked read found %ld pulses\n", expected);
+        exit(1);
+    }
+
+    /* Mapped and decoded in place. */
+    found = 0;
+    sum = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (!LmFileOpen(&lf, name, true)) {
+        printf("error: cannot map %s\n", name);
+        exit(1);
+    }
+    LmFileAttach(&lf, &lm);
+    decode_runs(&lm, buffer, &found, &sum);
+    LmBufClose(&lm);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    report("mapped", &start, &end, found);
+    mappedSum = sum;
+
+    if (lf.header == NULL || found != pulses) {
+        printf("error: mapped decode found %ld pulses\n", found);
+        exit(1);
+    }
+
+    /* Mapped, split and decoded by several threads. */
+    found = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    count = LmFileSplit(&lf, segments, threads);
+    for (t = 0; t < count; ++t) {
+        workers[t].lf = &lf;
+        workers[t].segment = segments[t];
+        workers[t].found = 0;
+        workers[t].sum = 0;
+        if (pthread_create(&ids[t], NULL, decode_segment, &workers[t]) != 0) {
+            printf("error: cannot create thread\n");
+            exit(1);
+        }
+    }
+    sum = 0;
+    for (t = 0; t < count; ++t) {
+        pthread_join(ids[t], NULL);
+        found += workers[t].found;
+        sum += workers[t].sum;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf(" %-18s : %8.1f Mpulses/s (%ld pulses, %d segments)\n",
+           "mapped and split", (double) found / seconds(&start, &end) / 1.0e6,
+           found, count);
+
+    LmFileClose(&lf);
+
+    if (found != pulses) {
+        printf("error: split decode found %ld pulses\n", found);
+        exit(1);
+    }
+
+    if (sum != mappedSum) {
+        printf("error: split decode does not match the mapped decode\n");
+        exit(1);
+    }
+
+    unlink(name);
+    free(chunk);
+    free(buffer);
+
+    return 0;
+}
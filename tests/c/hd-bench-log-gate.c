@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2020 XIA LLC
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted provided
+ * that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above
+ *     copyright notice, this list of conditions and the
+ *     following disclaimer.
+ *   * Redistributions in binary form must reproduce the
+ *     above copyright notice, this list of conditions and the
+ *     following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *   * Neither the name of XIA LLC
+ *     nor the names of its contributors may be used to endorse
+ *     or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Measures the cost of disabled logging on the mapping mode receive path.
+ * Pixels are copied into the mapping buffers, counted and the buffers
+ * updated, as the receive thread does for each pixel, at each log level
+ * with the log written to the null device, and at the debug level with
+ * the messages queued to the log writer thread. A disabled log statement is
+ * also timed against formatting the message and discarding it in the
+ * log handler, which is how every statement was handled before the level
+ * was checked first. No hardware is needed.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "handel_errors.h"
+
+#include "xia_handel.h"
+#include "xia_common.h"
+
+#include "md_generic.h"
+#include "md_shim.h"
+
+#include "psl_common.h"
+#include "falconx_mm.h"
+
+#ifdef _WIN32
+#define NULL_DEVICE "NUL"
+#else
+#define NULL_DEVICE "/dev/null"
+#endif
+
+#define PIXELS_PER_BUFFER (1024)
+
+static const struct {
+    const char* name;
+    int         level;
+    int         async;
+} levels[] = {
+    { "suppressed",   0,          0 },
+    { "error",        MD_ERROR,   0 },
+    { "warning",      MD_WARNING, 0 },
+    { "info",         MD_INFO,    0 },
+    { "debug",        MD_DEBUG,   0 },
+    { "debug, async", MD_DEBUG,   1 }
+};
+
+#define LEVELS ((int) (sizeof(levels) / sizeof(levels[0])))
+
+static void CHECK_ERROR(int status);
+
+static void usage(const char* prog)
+{
+    printf("%s options\n", prog);
+    printf(" -p pixels     : number of pixels\n");
+    printf(" -w words      : 32-bit words per pixel\n");
+    printf(" -n logs       : number of log statements to time\n");
+}
+
+static double seconds(const struct timespec* start, const struct timespec* end)
+{
+    return (double) (end->tv_sec - start->tv_sec) +
+        (double) (end->tv_nsec - start->tv_nsec) / 1.0e9;
+}
+
+/* The PSL log before the level check, format then let the handler discard. */
+static void format_log(int level, const char* file, int line,
+                       const char* routine, int error,
+                       const char* message, ...)
+{
+    char formatBuffer[2048];
+    va_list args;
+
+    va_start(args, message);
+    vsprintf(formatBuffer, message, args);
+    formatBuffer[sizeof(formatBuffer) - 1] = '\0';
+    dxp_md_log(level, routine, formatBuffer, error, file, line);
+    va_end(args);
+}
+
+static void set_level(int level, int async)
+{
+    int status;
+
+    status = xiaSetLogAsync(async);
+    CHECK_ERROR(status);
+
+    if (level == 0) {
+        status = xiaSuppressLogOutput();
+    } else {
+        status = xiaEnableLogOutput();
+        CHECK_ERROR(status);
+        status = xiaSetLogLevel(level);
+    }
+    CHECK_ERROR(status);
+}
+
+int main(int argc, char* argv[])
+{
+    int a;
+    int l;
+    int status;
+    long p;
+    long n;
+    long pixels = 200000;
+    long words = 64;
+    long logs = 1000000;
+
+    uint32_t* pixel;
+
+    MM_Buffers buffers;
+
+    struct timespec start;
+    struct timespec end;
+
+    for (a = 1; a < argc; ++a) {
+        if (argv[a][0] == '-' && argv[a][1] == 'p' && (a + 1) < argc) {
+            pixels = atol(argv[++a]);
+        }
+        else if (argv[a][0] == '-' && argv[a][1] == 'w' && (a + 1) < argc) {
+            words = atol(argv[++a]);
+        }
+        else if (argv[a][0] == '-' && argv[a][1] == 'n' && (a + 1) < argc) {
+            logs = atol(argv[++a]);
+        }
+        else {
+            printf("error: invalid option: %s\n", argv[a]);
+            usage(argv[0]);
+            exit(1);
+        }
+    }
+
+    if (pixels <= 0 || words <= 0 || logs <= 0) {
+        printf("error: invalid pixel, word or log count\n");
+        exit(1);
+    }
+
+    status = xiaInitHandel();
+    CHECK_ERROR(status);
+
+    status = xiaSetLogOutput(NULL_DEVICE);
+    CHECK_ERROR(status);
+
+    pixel = calloc((size_t) words, sizeof(uint32_t));
+    if (pixel == NULL) {
+        printf("error: out of memory\n");
+        exit(1);
+    }
+
+    printf("Receive: %ld pixels of %ld words, compiled log level %d\n",
+           pixels, words, XIA_LOG_COMPILE_LEVEL);
+
+    for (l = 0; l < LEVELS; ++l) {
+        set_level(levels[l].level, levels[l].async);
+
+        memset(&buffers, 0, sizeof(buffers));
+        status = psl__MappingModeBuffers_Open(&buffers, 2,
+                                              (size_t) (words * PIXELS_PER_BUFFER),
+                                              pixels);
+        CHECK_ERROR(status);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (p = 0; p < pixels; ++p) {
+            status = psl__MappingModeBuffers_CopyIn(&buffers, pixel, (size_t) words);
+            CHECK_ERROR(status);
+            psl__MappingModeBuffers_Pixel_Inc(&buffers);
+            psl__MappingModeBuffers_Update(&buffers);
+            if (psl__MappingModeBuffers_Active_Full(&buffers)) {
+                psl__MappingModeBuffers_Active_Clear(&buffers);
+                psl__MappingModeBuffers_Update(&buffers);
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        status = psl__MappingModeBuffers_Close(&buffers);
+        CHECK_ERROR(status);
+
+        printf(" %-17s : %8.1f ns/pixel\n", levels[l].name,
+               seconds(&start, &end) * 1.0e9 / (double) pixels);
+    }
+
+    printf("Log statement: %ld statements, log level error\n", logs);
+
+    set_level(MD_ERROR, 0);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (n = 0; n < logs; ++n) {
+        format_log(PSL_LOG_DEBUG, "COPY-IN buffer:%c length:%d level:%d",
+                   'A', (int) words, (int) n);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    printf(" %-17s : %8.1f ns/statement\n", "format, discard",
+           seconds(&start, &end) * 1.0e9 / (double) logs);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (n = 0; n < logs; ++n) {
+        pslLog(PSL_LOG_DEBUG, "COPY-IN buffer:%c length:%d level:%d",
+               'A', (int) words, (int) n);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    printf(" %-17s : %8.1f ns/statement\n", "level checked",
+           seconds(&start, &end) * 1.0e9 / (double) logs);
+
+    free(pixel);
+
+    xiaCloseLog();
+    xiaExit();
+
+    return 0;
+}
+
+/*
+ * This is just an example of how to handle error values.  A program
+ * of any reasonable size should implement a more robust error
+ * handling mechanism.
+ */
+static void CHECK_ERROR(int status)
+{
+    /* XIA_SUCCESS is defined in handel_errors.h */
+    if (status != XIA_SUCCESS) {
+        int status2;
+        printf("Error encountered (exiting)! Status = %d\n", status);
+        status2 = xiaExit();
+        if (status2 != XIA_SUCCESS)
+            printf("Handel exit failed, Status = %d\n", status2);
+        exit(status);
+    }
+}
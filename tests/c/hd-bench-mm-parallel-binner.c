@@ -0,0 +1,575 @@
+/*
+ * Copyright (c) 2020 XIA LLC
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted provided
+ * that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above
+ *     copyright notice, this list of conditions and the
+ *     following disclaimer.
+ *   * Redistributions in binary form must reproduce the
+ *     above copyright notice, this list of conditions and the
+ *     following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *   * Neither the name of XIA LLC
+ *     nor the names of its contributors may be used to endorse
+ *     or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Measures binning decoded list mode pulses on a number of threads, from
+ * one thread up to the requested number. Runs of decoded pulses are binned
+ * into pixels and merged at each pixel boundary. Each pixel's spectrum is
+ * checked against the spectrum binned by one thread. No hardware is needed.
+ *
+ * The parallel binner is local to this benchmark. The PSL bins pulses on
+ * the receive thread with MM_Binner.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "handel_errors.h"
+
+#include "xia_handel.h"
+#include "xia_common.h"
+
+#include "md_generic.h"
+#include "md_threads.h"
+
+#include "lmbuf.h"
+
+/* The parallel binner merges two bins at a time where SSE2 is available. */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PBINNER_MERGE_SSE2
+#include <emmintrin.h>
+#endif
+
+/*
+ * The parallel binner bins runs of decoded pulses on a set of worker
+ * threads. Each thread bins its share of a run into its own bins and the
+ * bins are merged when a pixel is complete.
+ */
+#define PBINNER_THREADS_MAX (64)
+
+/*
+ * A thread's bins are kept apart on cache line boundaries so the threads
+ * do not share lines.
+ */
+#define PBINNER_CACHE_LINE  (64)
+
+/*
+ * A run is not split into shares smaller than this. Short runs are binned
+ * by the caller.
+ */
+#define PBINNER_SHARE_MIN   (4096)
+
+/*
+ * Time in msecs to wait for a worker to exit.
+ */
+#define PBINNER_STOP_TIMEOUT (5000)
+
+struct ParallelBinner_s;
+
+typedef struct
+{
+    struct ParallelBinner_s* owner;
+    int              index;        /* The thread's share of each run. */
+    uint64_t*        bins;        /* The thread's bins. */
+    uint64_t         outOfRange;  /* Count of amplitudes out of range. */
+    uint64_t         pulses;      /* Count of pulses binned. */
+    handel_md_Thread thread;
+    handel_md_Event  go;          /* Signalled when there is a run to bin. */
+    handel_md_Event  done;        /* Signalled when the share is binned. */
+} BinnerWorker;
+
+typedef struct ParallelBinner_s
+{
+    int             threads;      /* The number of threads, including the caller. */
+    boolean_t       active;       /* The workers are running. */
+    size_t          numberOfBins; /* The number of bins. */
+    size_t          stride;       /* Distance between the threads' bins. */
+    uint32_t        binShift;     /* Pulse amplitude to bin shift. */
+    void*           memory;       /* The allocation holding all the bins. */
+    /* The run being binned. */
+    const int32_t*  amplitude;
+    const uint8_t*  pulseFlags;
+    size_t          count;
+    int             shares;       /* The number of shares the run is split into. */
+    BinnerWorker    workers[PBINNER_THREADS_MAX];
+} ParallelBinner;
+
+static int binner_close(ParallelBinner* binner);
+
+/*
+ * Bin a worker's share of the run. The run is split into contiguous shares
+ * so each worker walks its own part of the arrays.
+ */
+static void binner_share(ParallelBinner* binner,
+                         BinnerWorker*   worker,
+                         int             shares)
+{
+    const size_t share = binner->count / (size_t) shares;
+    const size_t start = share * (size_t) worker->index;
+    const size_t end =
+        worker->index == (shares - 1) ? binner->count : start + share;
+    const int32_t* amplitude = binner->amplitude;
+    const uint8_t* pulseFlags = binner->pulseFlags;
+    uint64_t* bins = worker->bins;
+    const size_t numberOfBins = binner->numberOfBins;
+    const uint32_t binShift = binner->binShift;
+    uint64_t outOfRange = 0;
+    uint64_t pulses = 0;
+    size_t p;
+
+    for (p = start; p < end; ++p) {
+        uint32_t bin;
+
+        if ((pulseFlags[p] & LMBUF_PULSE_INVALID) != 0)
+            continue;
+
+        if (amplitude[p] < 0) {
+            ++outOfRange;
+            continue;
+        }
+
+        bin = (uint32_t) amplitude[p] >> binShift;
+
+        if (bin >= numberOfBins) {
+            ++outOfRange;
+        }
+        else {
+            ++bins[bin];
+            ++pulses;
+        }
+    }
+
+    worker->outOfRange += outOfRange;
+    worker->pulses += pulses;
+}
+
+static void binner_worker(void* arg)
+{
+    BinnerWorker*   worker = (BinnerWorker*) arg;
+    ParallelBinner* binner = worker->owner;
+
+    while (TRUE_) {
+        int r = handel_md_event_wait(&worker->go, 0);
+        if (r != 0) {
+            printf("error: binner worker %d wait failed: %d\n", worker->index, r);
+            break;
+        }
+
+        if (!binner->active)
+            break;
+
+        binner_share(binner, worker, binner->shares);
+
+        handel_md_event_signal(&worker->done);
+    }
+
+    handel_md_event_signal(&worker->done);
+}
+
+static int binner_open(ParallelBinner* binner,
+                       size_t          bins,
+                       uint32_t        binShift,
+                       int             threads)
+{
+    int    status = XIA_SUCCESS;
+    size_t lineBins = PBINNER_CACHE_LINE / sizeof(uint64_t);
+    size_t stride;
+    char*  base;
+    int    w;
+
+    if (binner->memory)
+        return status;
+
+    if ((threads < 1) || (threads > PBINNER_THREADS_MAX) || (bins == 0)) {
+        status = XIA_BAD_VALUE;
+        printf("error: invalid binner threads (%d) or bins (%u)\n",
+               threads, (unsigned int) bins);
+        return status;
+    }
+
+    memset(binner, 0, sizeof(*binner));
+
+    /*
+     * Round each worker's bins up to whole cache lines and align the first
+     * so no two workers write the same line.
+     */
+    stride = ((bins + lineBins - 1) / lineBins) * lineBins;
+
+    binner->memory =
+        handel_md_alloc(((size_t) threads * stride * sizeof(uint64_t)) +
+                        PBINNER_CACHE_LINE);
+    if (!binner->memory) {
+        status = XIA_NOMEM;
+        printf("error: allocating memory for the parallel bins\n");
+        return status;
+    }
+
+    base = (char*) binner->memory;
+    base += (PBINNER_CACHE_LINE -
+             ((uintptr_t) base % PBINNER_CACHE_LINE)) % PBINNER_CACHE_LINE;
+
+    memset(base, 0, (size_t) threads * stride * sizeof(uint64_t));
+
+    binner->threads = threads;
+    binner->numberOfBins = bins;
+    binner->stride = stride;
+    binner->binShift = binShift;
+    binner->active = TRUE_;
+
+    for (w = 0; w < threads; ++w) {
+        BinnerWorker* worker = &binner->workers[w];
+        worker->owner = binner;
+        worker->index = w;
+        worker->bins = ((uint64_t*) base) + ((size_t) w * stride);
+    }
+
+    /*
+     * The caller bins the first share so it does not have a thread.
+     */
+    for (w = 1; w < threads; ++w) {
+        BinnerWorker* worker = &binner->workers[w];
+        int r;
+
+        r = handel_md_event_create(&worker->go);
+        if (r == 0)
+            r = handel_md_event_create(&worker->done);
+        if (r == 0) {
+            worker->thread.name = "MM.binner";
+            worker->thread.priority = 0;
+            worker->thread.stackSize = 64 * 1024;
+            worker->thread.attributes = 0;
+            worker->thread.realtime = FALSE_;
+            worker->thread.entryPoint = binner_worker;
+            worker->thread.argument = worker;
+            r = handel_md_thread_create(&worker->thread);
+        }
+
+        if (r != 0) {
+            binner_close(binner);
+            status = XIA_THREAD_ERROR;
+            printf("error: binner worker %d create failed: %d\n", w, r);
+            return status;
+        }
+    }
+
+    return status;
+}
+
+static int binner_close(ParallelBinner* binner)
+{
+    int status = XIA_SUCCESS;
+    int w;
+
+    if (!binner->memory)
+        return status;
+
+    binner->active = FALSE_;
+
+    for (w = 1; w < binner->threads; ++w) {
+        BinnerWorker* worker = &binner->workers[w];
+
+        if (handel_md_thread_ready(&worker->thread)) {
+            int r;
+
+            handel_md_event_signal(&worker->go);
+
+            r = handel_md_event_wait(&worker->done, PBINNER_STOP_TIMEOUT);
+            if (r != 0) {
+                status = XIA_THREAD_ERROR;
+                printf("error: binner worker %d stop failed: %d\n", w, r);
+            }
+
+            handel_md_thread_destroy(&worker->thread);
+        }
+
+        if (handel_md_event_ready(&worker->done))
+            handel_md_event_destroy(&worker->done);
+        if (handel_md_event_ready(&worker->go))
+            handel_md_event_destroy(&worker->go);
+    }
+
+    handel_md_free(binner->memory);
+    memset(binner, 0, sizeof(*binner));
+
+    return status;
+}
+
+static int binner_add(ParallelBinner* binner,
+                      const int32_t*  amplitude,
+                      const uint8_t*  pulseFlags,
+                      size_t          count)
+{
+    int status = XIA_SUCCESS;
+    int shares;
+    int w;
+
+    if (!binner->active)
+        return XIA_NOT_ACTIVE;
+
+    shares = binner->threads;
+    if (count / PBINNER_SHARE_MIN < (size_t) shares)
+        shares = (int) (count / PBINNER_SHARE_MIN);
+    if (shares < 1)
+        shares = 1;
+
+    binner->amplitude = amplitude;
+    binner->pulseFlags = pulseFlags;
+    binner->count = count;
+    binner->shares = shares;
+
+    for (w = 1; w < shares; ++w)
+        handel_md_event_signal(&binner->workers[w].go);
+
+    binner_share(binner, &binner->workers[0], shares);
+
+    for (w = 1; w < shares; ++w) {
+        int r = handel_md_event_wait(&binner->workers[w].done, 0);
+        if (r != 0) {
+            status = XIA_THREAD_ERROR;
+            printf("error: binner worker %d wait failed: %d\n", w, r);
+        }
+    }
+
+    binner->amplitude = NULL;
+    binner->pulseFlags = NULL;
+    binner->count = 0;
+
+    return status;
+}
+
+/*
+ * Add the workers' bins and counts to the caller's and clear the workers'
+ * for the next pixel. The workers are idle between calls to Add so no lock
+ * is needed.
+ */
+static int binner_merge(ParallelBinner* binner,
+                        uint64_t*       bins,
+                        uint64_t*       outOfRange,
+                        uint64_t*       pulses)
+{
+    const size_t numberOfBins = binner->numberOfBins;
+    size_t b = 0;
+    int w;
+
+    if (!binner->memory)
+        return XIA_NOT_ACTIVE;
+
+#ifdef PBINNER_MERGE_SSE2
+    for (; b + 2 <= numberOfBins; b += 2) {
+        __m128i sum = _mm_loadu_si128((const __m128i*) &bins[b]);
+        for (w = 0; w < binner->threads; ++w) {
+            sum = _mm_add_epi64(sum,
+                                _mm_load_si128((const __m128i*) &binner->workers[w].bins[b]));
+        }
+        _mm_storeu_si128((__m128i*) &bins[b], sum);
+    }
+#endif
+
+    for (; b < numberOfBins; ++b) {
+        uint64_t sum = bins[b];
+        for (w = 0; w < binner->threads; ++w)
+            sum += binner->workers[w].bins[b];
+        bins[b] = sum;
+    }
+
+    for (w = 0; w < binner->threads; ++w) {
+        BinnerWorker* worker = &binner->workers[w];
+        if (outOfRange)
+            *outOfRange += worker->outOfRange;
+        if (pulses)
+            *pulses += worker->pulses;
+        worker->outOfRange = 0;
+        worker->pulses = 0;
+    }
+
+    memset(binner->workers[0].bins, 0,
+           (size_t) binner->threads * binner->stride * sizeof(uint64_t));
+
+    return XIA_SUCCESS;
+}
+
+static void CHECK_ERROR(int status);
+
+static void usage(const char* prog)
+{
+    printf("%s options\n", prog);
+    printf(" -p pixels     : number of pixels\n");
+    printf(" -n pulses     : pulses per pixel\n");
+    printf(" -c channels   : number of MCA channels\n");
+    printf(" -t threads    : maximum number of threads\n");
+}
+
+static double seconds(const struct timespec* start, const struct timespec* end)
+{
+    return (double) (end->tv_sec - start->tv_sec) +
+        (double) (end->tv_nsec - start->tv_nsec) / 1.0e9;
+}
+
+int main(int argc, char* argv[])
+{
+    int a;
+    int status;
+    int t;
+    long p;
+    long n;
+    long pixels = 100;
+    long pulses = 200000;
+    int channels = 4096;
+    int threads = 4;
+
+    int32_t* amplitude;
+    uint8_t* pulseFlags;
+    uint64_t* expected;
+    uint64_t* spectrum;
+    uint64_t outOfRange;
+    uint64_t binned;
+
+    ParallelBinner binner;
+
+    struct timespec start;
+    struct timespec end;
+
+    for (a = 1; a < argc; ++a) {
+        if (argv[a][0] == '-' && argv[a][1] == 'p' && (a + 1) < argc) {
+            pixels = atol(argv[++a]);
+        }
+        else if (argv[a][0] == '-' && argv[a][1] == 'n' && (a + 1) < argc) {
+            pulses = atol(argv[++a]);
+        }
+        else if (argv[a][0] == '-' && argv[a][1] == 'c' && (a + 1) < argc) {
+            channels = atoi(argv[++a]);
+        }
+        else if (argv[a][0] == '-' && argv[a][1] == 't' && (a + 1) < argc) {
+            threads = atoi(argv[++a]);
+        }
+        else {
+            printf("error: invalid option: %s\n", argv[a]);
+            usage(argv[0]);
+            exit(1);
+        }
+    }
+
+    if (pixels <= 0 || pulses < 0 || channels <= 0 ||
+        threads < 1 || threads > PBINNER_THREADS_MAX) {
+        printf("error: invalid pixel, pulse, channel or thread count\n");
+        exit(1);
+    }
+
+    status = xiaInitHandel();
+    CHECK_ERROR(status);
+
+    xiaSetLogLevel(MD_ERROR);
+
+    amplitude = malloc((size_t) pixels * (size_t) pulses * sizeof(int32_t));
+    pulseFlags = malloc((size_t) pixels * (size_t) pulses);
+    expected = calloc((size_t) pixels * (size_t) channels, sizeof(uint64_t));
+    spectrum = malloc((size_t) channels * sizeof(uint64_t));
+    if (amplitude == NULL || pulseFlags == NULL ||
+        expected == NULL || spectrum == NULL) {
+        printf("error: out of memory\n");
+        exit(1);
+    }
+
+    srand(1);
+
+    for (n = 0; n < pixels * pulses; ++n) {
+        amplitude[n] = (rand() % (channels + channels / 8)) - channels / 64;
+        pulseFlags[n] = (rand() % 100) == 0 ? LMBUF_PULSE_INVALID : 0;
+    }
+
+    printf("Pulses: %ld pixels, %ld pulses per pixel, %d channels\n",
+           pixels, pulses, channels);
+
+    for (t = 1; t <= threads; ++t) {
+        memset(&binner, 0, sizeof(binner));
+
+        status = binner_open(&binner, (size_t) channels, 0, t);
+        CHECK_ERROR(status);
+
+        outOfRange = 0;
+        binned = 0;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (p = 0; p < pixels; ++p) {
+            uint64_t* bins = t == 1 ? &expected[p * channels] : spectrum;
+
+            if (t != 1)
+                memset(spectrum, 0, (size_t) channels * sizeof(uint64_t));
+
+            status = binner_add(&binner,
+                                &amplitude[p * pulses],
+                                &pulseFlags[p * pulses],
+                                (size_t) pulses);
+            CHECK_ERROR(status);
+
+            status = binner_merge(&binner, bins, &outOfRange, &binned);
+            CHECK_ERROR(status);
+
+            if (t != 1 &&
+                memcmp(spectrum, &expected[p * channels],
+                       (size_t) channels * sizeof(uint64_t)) != 0) {
+                printf("error: %d threads: pixel %ld does not match\n", t, p);
+                exit(1);
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        printf(" %2d thread(s)       : %8.1f Mpulses/s (%lu binned, %lu out of range)\n",
+               t, (double) (pixels * pulses) / seconds(&start, &end) / 1.0e6,
+               (unsigned long) binned, (unsigned long) outOfRange);
+
+        status = binner_close(&binner);
+        CHECK_ERROR(status);
+    }
+
+    free(spectrum);
+    free(expected);
+    free(pulseFlags);
+    free(amplitude);
+
+    xiaExit();
+
+    return 0;
+}
+
+/*
+ * This is just an example of how to handle error values.  A program
+ * of any reasonable size should implement a more robust error
+ * handling mechanism.
+ */
+static void CHECK_ERROR(int status)
+{
+    /* XIA_SUCCESS is defined in handel_errors.h */
+    if (status != XIA_SUCCESS) {
+        int status2;
+        printf("Error encountered (exiting)! Status = %d\n", status);
+        status2 = xiaExit();
+        if (status2 != XIA_SUCCESS)
+            printf("Handel exit failed, Status = %d\n", status2);
+        exit(status);
+    }
+}
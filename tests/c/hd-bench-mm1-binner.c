@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2020 XIA LLC
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted provided
+ * that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above
+ *     copyright notice, this list of conditions and the
+ *     following disclaimer.
+ *   * Redistributions in binary form must reproduce the
+ *     above copyright notice, this list of conditions and the
+ *     following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *   * Neither the name of XIA LLC
+ *     nor the names of its contributors may be used to endorse
+ *     or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Measures host-side list mode binning for mapping mode 1. A list mode
+ * stream of gated pixels, each a gate high, a run of pulses, a gate low
+ * and the gated stats, is fed to the MM1 binner in 64 KB chunks and the
+ * pixels are written to the mapping buffers. The pixel count and each
+ * pixel's spectrum are checked against the stream. No hardware is
+ * needed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "handel_errors.h"
+
+#include "xia_handel.h"
+#include "xia_common.h"
+
+#include "md_generic.h"
+
+#include "falconx_mm.h"
+
+#define CHUNK 65536
+
+static void CHECK_ERROR(int status);
+
+static void usage(const char* prog)
+{
+    printf("%s options\n", prog);
+    printf(" -p pixels     : number of pixels\n");
+    printf(" -n pulses     : pulses per pixel\n");
+    printf(" -c channels   : number of MCA channels\n");
+}
+
+static size_t encode(uint8_t* stream, LmPacket* packet)
+{
+    return (size_t) LmBufEncodePacket(stream, 64, packet, LM_VERSION_0_9_0);
+}
+
+int main(int argc, char* argv[])
+{
+    int a;
+    int status;
+    long p;
+    long n;
+    long pixels = 1000;
+    long pulses = 2000;
+    int channels = 4096;
+
+    uint8_t* stream;
+    size_t len = 0;
+    size_t offset;
+    uint64_t* expected;
+    uint32_t* spectrum;
+
+    MM_Control mmc;
+    MMC1_Data* mm1;
+    MM_Pixel_Stats pstats;
+    LmPacket packet;
+
+    clock_t start;
+    clock_t end;
+
+    memset(&mmc, 0, sizeof(mmc));
+    memset(&pstats, 0, sizeof(pstats));
+
+    for (a = 1; a < argc; ++a) {
+        if (argv[a][0] == '-' && argv[a][1] == 'p' && (a + 1) < argc) {
+            pixels = atol(argv[++a]);
+        }
+        else if (argv[a][0] == '-' && argv[a][1] == 'n' && (a + 1) < argc) {
+            pulses = atol(argv[++a]);
+        }
+        else if (argv[a][0] == '-' && argv[a][1] == 'c' && (a + 1) < argc) {
+            channels = atoi(argv[++a]);
+        }
+        else {
+            printf("error: invalid option: %s\n", argv[a]);
+            usage(argv[0]);
+            exit(1);
+        }
+    }
+
+    if (pixels <= 0 || pulses < 0 || channels <= 0 || channels > 0xffff) {
+        printf("error: invalid pixel, pulse or channel count\n");
+        exit(1);
+    }
+
+    status = xiaInitHandel();
+    CHECK_ERROR(status);
+
+    xiaSetLogLevel(MD_ERROR);
+
+    stream = malloc((size_t) pixels * ((size_t) pulses * 4 + 64) + 64);
+    expected = calloc((size_t) pixels * (size_t) channels, sizeof(uint64_t));
+    if (stream == NULL || expected == NULL) {
+        printf("error: out of memory\n");
+        exit(1);
+    }
+
+    srand(1);
+
+    for (p = 0; p < pixels; ++p) {
+        uint64_t* bins = &expected[p * channels];
+
+        memset(&packet, 0, sizeof(packet));
+        packet.typ = LmPacketTypeGateState;
+        packet.p.gateState.gate = true;
+        len += encode(stream + len, &packet);
+
+        for (n = 0; n < pulses; ++n) {
+            memset(&packet, 0, sizeof(packet));
+            packet.typ = LmPacketTypePulse;
+            packet.p.pulse.amplitude = rand() % (channels + channels / 8);
+            packet.p.pulse.invalid = (rand() % 100) == 0;
+            len += encode(stream + len, &packet);
+
+            if (!packet.p.pulse.invalid && packet.p.pulse.amplitude < channels)
+                ++bins[packet.p.pulse.amplitude];
+        }
+
+        memset(&packet, 0, sizeof(packet));
+        packet.typ = LmPacketTypeGateState;
+        packet.p.gateState.gate = false;
+        len += encode(stream + len, &packet);
+
+        memset(&packet, 0, sizeof(packet));
+        packet.typ = LmPacketTypeGatedStats;
+        packet.p.gatedStats.sampleCount = (uint64_t) pulses * 100;
+        packet.p.gatedStats.estimatedIncomingPulseCount = (uint32_t) pulses;
+        len += encode(stream + len, &packet);
+    }
+
+    printf("List mode: %ld pixels, %ld pulses per pixel, %lu bytes\n",
+           pixels, pulses, (unsigned long) len);
+
+    status = psl__MappingModeControl_OpenMM1(&mmc, 0, TRUE_, 0, pixels,
+                                             (uint16_t) channels, pixels, 2);
+    CHECK_ERROR(status);
+
+    mm1 = psl__MappingModeControl_MM1Data(&mmc);
+
+    start = clock();
+    for (offset = 0; offset < len; offset += CHUNK) {
+        size_t chunk = len - offset < CHUNK ? len - offset : CHUNK;
+
+        status = psl__MappingModeBinner_AddData(&mm1->bins, stream + offset, chunk);
+        CHECK_ERROR(status);
+
+        while (TRUE_) {
+            boolean_t pixel;
+
+            status = psl__MappingModeBinner_Bin(&mm1->bins, &pixel);
+            CHECK_ERROR(status);
+            if (!pixel)
+                break;
+
+            pstats.output_events = (uint32_t) mm1->bins.pulses;
+            status = psl__XMAP_WriteBinnerPixel_MM1(mm1, &pstats);
+            CHECK_ERROR(status);
+        }
+    }
+    end = clock();
+
+    printf(" binned             : %8.1f Mpulses/s (%lu pixels)\n",
+           (double) (pixels * pulses) /
+           ((double) (end - start) / CLOCKS_PER_SEC) / 1.0e6,
+           (unsigned long) mm1->buffers.pixel);
+
+    if (mm1->buffers.pixel != (uint32_t) pixels) {
+        printf("error: binned %lu pixels\n", (unsigned long) mm1->buffers.pixel);
+        exit(1);
+    }
+
+    spectrum = mm1->buffers.buffer[0].buffer + XMAP_BUFFER_HEADER_SIZE_U32;
+
+    for (p = 0; p < pixels; ++p) {
+        int c;
+
+        if (spectrum[0] != 0xcc3333cc) {
+            printf("error: pixel %ld has no pixel header\n", p);
+            exit(1);
+        }
+
+        spectrum += XMAP_PIXEL_HEADER_SIZE_U32;
+
+        for (c = 0; c < channels; ++c) {
+            if (spectrum[c] != expected[p * channels + c]) {
+                printf("error: pixel %ld channel %d is %u not %u\n", p, c,
+                       spectrum[c], (uint32_t) expected[p * channels + c]);
+                exit(1);
+            }
+        }
+
+        spectrum += channels;
+    }
+
+    status = psl__MappingModeControl_CloseMM1(&mmc);
+    CHECK_ERROR(status);
+
+    free(expected);
+    free(stream);
+
+    xiaExit();
+
+    return 0;
+}
+
+/*
+ * This is just an example of how to handle error values.  A program
+ * of any reasonable size should implement a more robust error
+ * handling mechanism.
+ */
+static void CHECK_ERROR(int status)
+{
+    /* XIA_SUCCESS is defined in handel_errors.h */
+    if (status != XIA_SUCCESS) {
+        int status2;
+        printf("Error encountered (exiting)! Status = %d\n", status);
+        status2 = xiaExit();
+        if (status2 != XIA_SUCCESS)
+            printf("Handel exit failed, Status = %d\n", status2);
+        exit(status);
+    }
+}
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2020 XIA LLC
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted provided
+ * that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above
+ *     copyright notice, this list of conditions and the
+ *     following disclaimer.
+ *   * Redistributions in binary form must reproduce the
+ *     above copyright notice, this list of conditions and the
+ *     following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *   * Neither the name of XIA LLC
+ *     nor the names of its contributors may be used to endorse
+ *     or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Measures the cost of extracting packets from the SINC read buffer. A
+ * buffer is filled with back-to-back encapsulated packets, as a burst of
+ * stream data would leave it, then drained one packet at a time. The
+ * drain is timed as the buffer does it now, stepping over each consumed
+ * packet, and with the buffer compacted after every packet, which is how
+ * the remainder was moved before. No hardware is needed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sinc.h"
+#include "sinc_internal.h"
+
+static void usage(const char* prog)
+{
+    printf("%s options\n", prog);
+    printf(" -n packets    : number of packets in the buffer\n");
+    printf(" -s bytes      : payload size of each packet\n");
+}
+
+static double elapsed_ns(clock_t start, clock_t end, long packets)
+{
+    return ((double) (end - start) / CLOCKS_PER_SEC) * 1.0e9 / (double) packets;
+}
+
+static void fill(SincBuffer* readBuf, const uint8_t* stream, size_t len)
+{
+    memcpy(readBuf->cbuf.data, stream, len);
+    readBuf->cbuf.len = len;
+    readBuf->readPos = 0;
+}
+
+static long drain(SincBuffer* readBuf, SincBuffer* packetBuf, int compact,
+                  size_t* bytes)
+{
+    long found = 0;
+    int packetFound;
+    SiToro__Sinc__MessageType packetType;
+
+    *bytes = 0;
+
+    do {
+        SincGetNextPacketFromBuffer(readBuf, &packetType, packetBuf, &packetFound);
+        if (packetFound) {
+            found++;
+            *bytes += packetBuf->cbuf.len;
+            if (compact)
+                SincBufferCompact(readBuf);
+        }
+    } while (packetFound);
+
+    return found;
+}
+
+int main(int argc, char* argv[])
+{
+    int a;
+    long p;
+    long packets = 4000;
+    long payload = 64;
+    long found;
+
+    size_t len;
+    size_t bytes;
+    uint8_t* stream;
+
+    uint8_t readPad[1];
+    uint8_t packetPad[256];
+    SincBuffer readBuf = SINC_BUFFER_INIT(readPad);
+    SincBuffer packetBuf = SINC_BUFFER_INIT(packetPad);
+
+    clock_t start;
+    clock_t end;
+
+    for (a = 1; a < argc; ++a) {
+        if (argv[a][0] == '-' && argv[a][1] == 'n' && (a + 1) < argc) {
+            packets = atol(argv[++a]);
+        }
+        else if (argv[a][0] == '-' && argv[a][1] == 's' && (a + 1) < argc) {
+            payload = atol(argv[++a]);
+        }
+        else {
+            printf("error: invalid option: %s\n", argv[a]);
+            usage(argv[0]);
+            exit(1);
+        }
+    }
+
+    if (packets <= 0 || payload <= 0 || payload > SINC_MAX_DATAGRAM_BYTES) {
+        printf("error: invalid packet count or size\n");
+        exit(1);
+    }
+
+    len = (size_t) packets * (size_t) (SINC_HEADER_LENGTH + payload);
+
+    stream = malloc(len);
+    readBuf.cbuf.data = malloc(len);
+    if (stream == NULL || readBuf.cbuf.data == NULL) {
+        printf("error: out of memory\n");
+        exit(1);
+    }
+    readBuf.cbuf.alloced = len;
+    readBuf.cbuf.must_free_data = 1;
+
+    memset(stream, 0, len);
+    for (p = 0; p < packets; ++p) {
+        uint8_t* packet = stream + (size_t) p * (size_t) (SINC_HEADER_LENGTH + payload);
+        SincProtocolEncodeHeaderGeneric(packet, (int) payload,
+                                        SI_TORO__SINC__MESSAGE_TYPE__LIST_MODE_DATA_RESPONSE,
+                                        SINC_RESPONSE_MARKER);
+    }
+
+    printf("Read buffer: %ld packets, %ld byte payloads, %lu bytes\n",
+           packets, payload, (unsigned long) len);
+
+    /* Compacting after every packet, as the buffer was drained before. */
+    fill(&readBuf, stream, len);
+    start = clock();
+    found = drain(&readBuf, &packetBuf, 1, &bytes);
+    end = clock();
+    printf(" compact per packet : %10.1f ns/packet (%ld packets, %lu bytes)\n",
+           elapsed_ns(start, end, packets), found, (unsigned long) bytes);
+
+    /* Stepping the read position over each packet. */
+    fill(&readBuf, stream, len);
+    start = clock();
+    found = drain(&readBuf, &packetBuf, 0, &bytes);
+    end = clock();
+    printf(" read position      : %10.1f ns/packet (%ld packets, %lu bytes)\n",
+           elapsed_ns(start, end, packets), found, (unsigned long) bytes);
+
+    if (found != packets || readBuf.cbuf.len != 0 || readBuf.readPos != 0) {
+        printf("error: buffer not drained\n");
+        exit(1);
+    }
+
+    SINC_BUFFER_CLEAR(&packetBuf);
+    SINC_BUFFER_CLEAR(&readBuf);
+    free(stream);
+
+    return 0;
+}
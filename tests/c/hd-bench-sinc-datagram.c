@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2020 XIA LLC
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted provided
+ * that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above
+ *     copyright notice, this list of conditions and the
+ *     following disclaimer.
+ *   * Redistributions in binary form must reproduce the
+ *     above copyright notice, this list of conditions and the
+ *     following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *   * Neither the name of XIA LLC
+ *     nor the names of its contributors may be used to endorse
+ *     or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Measures histogram datagram reception. Bursts of datagrams are sent to
+ * the SINC datagram socket over the loopback interface and read back with
+ * SincReadMessage(), which reads them in batches, and then with a poll
+ * and a recv() per datagram as they were read before. The datagrams the
+ * host dropped are reported. No hardware is needed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "sinc.h"
+#include "sinc_internal.h"
+
+static void usage(const char* prog)
+{
+    printf("%s options\n", prog);
+    printf(" -n datagrams  : number of datagrams\n");
+    printf(" -b burst      : datagrams sent in each burst\n");
+    printf(" -s bytes      : size of each datagram\n");
+    printf(" -r bytes      : socket receive buffer size, 0 for the default\n");
+}
+
+static double seconds(const struct timespec* start, const struct timespec* end)
+{
+    return (double) (end->tv_sec - start->tv_sec) +
+        (double) (end->tv_nsec - start->tv_nsec) / 1.0e9;
+}
+
+static void burst(int fd, const struct sockaddr_in* addr,
+                  const uint8_t* datagram, size_t size, long count)
+{
+    long d;
+
+    for (d = 0; d < count; ++d) {
+        if (sendto(fd, datagram, size, 0, (const struct sockaddr*) addr,
+                   sizeof(*addr)) < 0) {
+            perror("error: sendto");
+            exit(1);
+        }
+    }
+}
+
+static void report(const char* label, double secs, long received, long sent)
+{
+    printf(" %-18s : %8.3f Mdatagrams/s (%ld of %ld received)\n",
+           label, (double) received / secs / 1.0e6, received, sent);
+}
+
+int main(int argc, char* argv[])
+{
+    int a;
+    long n;
+    long datagrams = 100000;
+    long burstSize = 64;
+    size_t size = 1024;
+    int rcvBufSize = 0;
+
+    int sendFd;
+    int streamFds[2];
+    int port = 0;
+    int fds[2];
+    bool readOk[2];
+    uint8_t* datagram;
+    uint8_t* slot;
+    double secs;
+    long received;
+
+    Sinc sc;
+    SincBuffer packet = SINC_BUFFER_INIT(NULL);
+    SiToro__Sinc__MessageType msgType;
+    struct sockaddr_in addr;
+    struct timespec start;
+    struct timespec end;
+
+    for (a = 1; a < argc; ++a) {
+        if (argv[a][0] == '-' && argv[a][1] == 'n' && (a + 1) < argc) {
+            datagrams = atol(argv[++a]);
+        }
+        else if (argv[a][0] == '-' && argv[a][1] == 'b' && (a + 1) < argc) {
+            burstSize = atol(argv[++a]);
+        }
+        else if (argv[a][0] == '-' && argv[a][1] == 's' && (a + 1) < argc) {
+            size = (size_t) atol(argv[++a]);
+        }
+        else if (argv[a][0] == '-' && argv[a][1] == 'r' && (a + 1) < argc) {
+            rcvBufSize = atoi(argv[++a]);
+        }
+        else {
+            printf("error: invalid option: %s\n", argv[a]);
+            usage(argv[0]);
+            exit(1);
+        }
+    }
+
+    if (datagrams <= 0 || burstSize <= 0 || size < 8 ||
+        size > 65507 || rcvBufSize < 0) {
+        printf("error: invalid datagram count, burst, size or buffer size\n");
+        exit(1);
+    }
+
+    datagram = calloc(1, size);
+    slot = malloc(SINC_MAX_DATAGRAM_BYTES + SINC_HEADER_LENGTH);
+    if (datagram == NULL || slot == NULL) {
+        printf("error: out of memory\n");
+        exit(1);
+    }
+
+    datagram[6] = SI_TORO__SINC__MESSAGE_TYPE__HISTOGRAM_DATAGRAM_RESPONSE;
+
+    /*
+     * The stream socket is never written. It only has to be a socket.
+     */
+    if (!SincInit(&sc) || socketpair(AF_UNIX, SOCK_STREAM, 0, streamFds) < 0) {
+        printf("error: SINC or stream socket setup failed\n");
+        exit(1);
+    }
+
+    sc.fd = streamFds[0];
+    sc.connected = true;
+
+    if (SincSocketBindDatagram(&sc.datagramFd, &port) != 0) {
+        printf("error: datagram bind failed\n");
+        exit(1);
+    }
+
+    if (rcvBufSize > 0 &&
+        SincSocketSetReceiveBufferSize(sc.datagramFd, rcvBufSize) != 0) {
+        printf("error: receive buffer size failed\n");
+        exit(1);
+    }
+
+    sendFd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sendFd < 0) {
+        perror("error: socket");
+        exit(1);
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t) port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    printf("Datagrams: %ld of %lu bytes in bursts of %ld\n",
+           datagrams, (unsigned long) size, burstSize);
+
+    /*
+     * Batched, through the read buffer.
+     */
+    received = 0;
+    secs = 0;
+    for (n = 0; n < datagrams; n += burstSize) {
+        long count = datagrams - n < burstSize ? datagrams - n : burstSize;
+
+        burst(sendFd, &addr, datagram, size, count);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        while (SincReadMessage(&sc, 0, &packet, &msgType)) {
+            if (msgType != SI_TORO__SINC__MESSAGE_TYPE__HISTOGRAM_DATAGRAM_RESPONSE ||
+                packet.cbuf.len != size) {
+                printf("error: bad datagram: type %d size %lu\n",
+                       (int) msgType, (unsigned long) packet.cbuf.len);
+                exit(1);
+            }
+            ++received;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        secs += seconds(&start, &end);
+
+        if (SincReadErrorCode(&sc) != SI_TORO__SINC__ERROR_CODE__TIMEOUT) {
+            printf("error: read: %s\n", SincReadErrorMessage(&sc));
+            exit(1);
+        }
+    }
+
+    report("batched", secs, received, datagrams);
+    printf(" %-18s : %lu received, %lu dropped\n", "counters",
+           (unsigned long) sc.datagramsReceived,
+           (unsigned long) sc.datagramDrops);
+
+    /*
+     * One poll and one recv() per datagram.
+     */
+    fds[0] = sc.fd;
+    fds[1] = sc.datagramFd;
+    received = 0;
+    secs = 0;
+    for (n = 0; n < datagrams; n += burstSize) {
+        long count = datagrams - n < burstSize ? datagrams - n : burstSize;
+
+        burst(sendFd, &addr, datagram, size, count);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        while (true) {
+            size_t len = SINC_MAX_DATAGRAM_BYTES;
+            if (SincSocketWaitMulti(fds, 2, 0, readOk) != 0 || !readOk[1])
+                break;
+            if (SincSocketReadDatagram(sc.datagramFd, slot + SINC_HEADER_LENGTH,
+                                       &len, true) != 0)
+                break;
+            SincProtocolEncodeHeaderGeneric(slot, (int) len,
+                                            SI_TORO__SINC__MESSAGE_TYPE__HISTOGRAM_DATAGRAM_RESPONSE,
+                                            SINC_RESPONSE_MARKER);
+            ++received;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        secs += seconds(&start, &end);
+    }
+
+    report("single", secs, received, datagrams);
+
+    close(sendFd);
+    close(sc.datagramFd);
+    close(streamFds[1]);
+    SincCleanup(&sc);
+
+    free(slot);
+    free(datagram);
+
+    return 0;
+}
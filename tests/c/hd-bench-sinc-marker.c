@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2020 XIA LLC
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted provided
+ * that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above
+ *     copyright notice, this list of conditions and the
+ *     following disclaimer.
+ *   * Redistributions in binary form must reproduce the
+ *     above copyright notice, this list of conditions and the
+ *     following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *   * Neither the name of XIA LLC
+ *     nor the names of its contributors may be used to endorse
+ *     or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Measures how fast the SINC receiver resynchronises after corrupt data.
+ * A receive buffer is filled with random bytes with no packet marker in
+ * them and a single packet at the end, which is what the receiver sees
+ * after a stream glitch or a dropped datagram. Each marker search the
+ * CPU supports decodes the buffer, along with the byte-wise search that
+ * was used before. No hardware is needed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "sinc.h"
+#include "sinc_internal.h"
+
+static const char* scans[] = { "scalar", "sse2", "avx2" };
+
+#define SCANS ((int) (sizeof(scans) / sizeof(scans[0])))
+
+static void usage(const char* prog)
+{
+    printf("%s options\n", prog);
+    printf(" -m megabytes  : size of the receive buffer\n");
+    printf(" -n decodes    : number of times to decode the buffer\n");
+}
+
+static double elapsed_ms(clock_t start, clock_t end, long decodes)
+{
+    return ((double) (end - start) / CLOCKS_PER_SEC) * 1.0e3 / (double) decodes;
+}
+
+/* The byte-wise search the decoder used before. */
+static uint8_t* byte_scan(uint8_t* buf, size_t len, const uint8_t* marker)
+{
+    uint8_t* cur;
+    uint8_t* last = buf + len - 4;
+
+    for (cur = buf; cur <= last; cur++) {
+        if (cur[0] == marker[0] && memcmp(cur, marker, 4) == 0)
+            return cur;
+    }
+
+    return NULL;
+}
+
+int main(int argc, char* argv[])
+{
+    int a;
+    int s;
+    long d;
+    long decodes = 20;
+    long megabytes = 8;
+
+    size_t i;
+    size_t len;
+    size_t junk;
+
+    uint8_t marker[4];
+    uint32_t value = SINC_RESPONSE_MARKER;
+
+    uint8_t pad[1];
+    SincBuffer readBuf = SINC_BUFFER_INIT(pad);
+
+    clock_t start;
+    clock_t end;
+
+    for (a = 1; a < argc; ++a) {
+        if (argv[a][0] == '-' && argv[a][1] == 'm' && (a + 1) < argc) {
+            megabytes = atol(argv[++a]);
+        }
+        else if (argv[a][0] == '-' && argv[a][1] == 'n' && (a + 1) < argc) {
+            decodes = atol(argv[++a]);
+        }
+        else {
+            printf("error: invalid option: %s\n", argv[a]);
+            usage(argv[0]);
+            exit(1);
+        }
+    }
+
+    if (megabytes <= 0 || decodes <= 0) {
+        printf("error: invalid size or decode count\n");
+        exit(1);
+    }
+
+    memcpy(marker, &value, sizeof(marker));
+
+    junk = (size_t) megabytes * 1024 * 1024;
+    len = junk + SINC_HEADER_LENGTH + 4;
+
+    readBuf.cbuf.data = malloc(len);
+    if (readBuf.cbuf.data == NULL) {
+        printf("error: out of memory\n");
+        exit(1);
+    }
+    readBuf.cbuf.alloced = len;
+    readBuf.cbuf.len = len;
+    readBuf.cbuf.must_free_data = 1;
+
+    srand(1);
+    for (i = 0; i < junk; ++i)
+        readBuf.cbuf.data[i] = (uint8_t) (rand() >> 7);
+
+    /* Break any markers the random data made. */
+    for (i = 0; i + 4 <= junk; ++i) {
+        if (memcmp(&readBuf.cbuf.data[i], marker, 4) == 0)
+            readBuf.cbuf.data[i] ^= 0xff;
+    }
+
+    SincProtocolEncodeHeaderGeneric(&readBuf.cbuf.data[junk], 4,
+                                    SI_TORO__SINC__MESSAGE_TYPE__LIST_MODE_DATA_RESPONSE,
+                                    SINC_RESPONSE_MARKER);
+    memset(&readBuf.cbuf.data[junk + SINC_HEADER_LENGTH], 0, 4);
+
+    printf("Receive buffer: %ld MB of corrupt data, %ld decodes\n",
+           megabytes, decodes);
+
+    start = clock();
+    for (d = 0; d < decodes; ++d) {
+        if (byte_scan(readBuf.cbuf.data, len, marker) != &readBuf.cbuf.data[junk]) {
+            printf("error: byte scan missed the marker\n");
+            exit(1);
+        }
+    }
+    end = clock();
+    printf(" byte scan : %8.3f ms/decode %8.1f MB/s\n",
+           elapsed_ms(start, end, decodes),
+           (double) megabytes * 1.0e3 / elapsed_ms(start, end, decodes));
+
+    for (s = 0; s < SCANS; ++s) {
+        if (!SincSelectMarkerScan(scans[s])) {
+            printf(" %-9s : not available\n", scans[s]);
+            continue;
+        }
+
+        start = clock();
+        for (d = 0; d < decodes; ++d) {
+            int bytesConsumed;
+            int responseCode;
+            SiToro__Sinc__MessageType msgType;
+
+            if (!SincDecodePacketEncapsulation(&readBuf, &bytesConsumed,
+                                               &responseCode, &msgType,
+                                               NULL, SINC_RESPONSE_MARKER) ||
+                (size_t) bytesConsumed != len) {
+                printf("error: %s scan missed the packet\n", scans[s]);
+                exit(1);
+            }
+        }
+        end = clock();
+        printf(" %-9s : %8.3f ms/decode %8.1f MB/s\n", scans[s],
+               elapsed_ms(start, end, decodes),
+               (double) megabytes * 1.0e3 / elapsed_ms(start, end, decodes));
+    }
+
+    SincSelectMarkerScan(NULL);
+
+    SINC_BUFFER_CLEAR(&readBuf);
+
+    return 0;
+}
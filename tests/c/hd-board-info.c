@@ -143,6 +143,7 @@ int main(int argc, char** argv)
         unsigned int number_of_channels;
         char info[160];
         char firmware_version[32];
+        double arena[3];
 
         /* Get the detChan of the first channel in the module. */
         status = xiaGetModuleItem(modules[i], "channel0_alias", &detChan);
@@ -204,6 +205,15 @@ int main(int argc, char** argv)
 
         printf("  Channel count:      Board = %d, INI = %u\n",
                boardChannelCount, number_of_channels);
+
+        status = xiaBoardOperation(detChan, "get_receive_arena", arena);
+        if (status != XIA_SUCCESS) {
+            free_modules(modules, numModules);
+            CHECK_ERROR(status);
+        }
+
+        printf("  Receive arena:      %0.0f bytes, %0.0f packets, %0.0f overflows\n",
+               arena[0], arena[1], arena[2]);
     }
 
     /* Clean up */
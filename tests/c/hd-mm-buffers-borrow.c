@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2020 XIA LLC
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms,
+ * with or without modification, are permitted provided
+ * that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above
+ *     copyright notice, this list of conditions and the
+ *     following disclaimer.
+ *   * Redistributions in binary form must reproduce the
+ *     above copyright notice, this list of conditions and the
+ *     following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *   * Neither the name of XIA LLC
+ *     nor the names of its contributors may be used to endorse
+ *     or promote products derived from this software without
+ *     specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ * INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ * TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * Checks borrowing a mapping buffer in place. An empty or done Active
+ * cannot be borrowed, a borrowed Active is not swapped out when the Next
+ * fills or is closed, and releasing it lets the buffers swap again. No
+ * hardware is needed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "handel_errors.h"
+
+#include "xia_handel.h"
+#include "xia_common.h"
+
+#include "md_generic.h"
+
+#include "falconx_mm.h"
+
+#define SIZE 16
+
+static void CHECK_ERROR(int status);
+static void CHECK(boolean_t test, const char* what);
+
+static void fill(MM_Buffers* buffers, uint32_t value)
+{
+    uint32_t data[SIZE];
+    int      i;
+
+    for (i = 0; i < SIZE; ++i)
+        data[i] = value;
+
+    CHECK_ERROR(psl__MappingModeBuffers_CopyIn(buffers, data, SIZE));
+}
+
+int main(void)
+{
+    int status;
+
+    MM_Buffers      buffers;
+    const uint32_t* data = NULL;
+    size_t          size = 0;
+    char            label;
+
+    memset(&buffers, 0, sizeof(buffers));
+
+    status = xiaInitHandel();
+    CHECK_ERROR(status);
+
+    xiaSetLogLevel(MD_ERROR);
+    xiaSuppressLogOutput();
+
+    status = psl__MappingModeBuffers_Open(&buffers, 2, SIZE, 0);
+    CHECK_ERROR(status);
+
+    /*
+     * The Active left by the open is done and empty.
+     */
+    status = psl__MappingModeBuffers_Borrow(&buffers, &data, &size);
+    CHECK(status == XIA_NOT_ACTIVE, "borrow of the empty Active fails");
+    CHECK(!psl__MappingModeBuffers_Active_Borrowed(&buffers),
+          "empty Active is not borrowed");
+
+    fill(&buffers, 1);
+    CHECK(psl__MappingModeBuffers_Update(&buffers), "full Next swaps in");
+
+    label = psl__MappingModeBuffers_Active_Label(&buffers);
+    CHECK(label == 'A', "A is Active");
+
+    status = psl__MappingModeBuffers_Borrow(&buffers, &data, &size);
+    CHECK_ERROR(status);
+    CHECK((size == SIZE) && (data[0] == 1) && (data[SIZE - 1] == 1),
+          "borrow lends A's data");
+
+    /*
+     * Fill the other buffer and mark the Active done. The borrowed Active
+     * must stay put.
+     */
+    fill(&buffers, 2);
+    psl__MappingModeBuffers_Active_SetDone(&buffers);
+    CHECK(!psl__MappingModeBuffers_Update(&buffers), "borrowed Active is not swapped");
+    CHECK(psl__MappingModeBuffers_Active_Label(&buffers) == label,
+          "borrowed buffer is still Active");
+    CHECK((data[0] == 1) && (data[SIZE - 1] == 1), "borrowed data is intact");
+
+    status = psl__MappingModeBuffers_Close(&buffers);
+    CHECK(status == XIA_NOT_IDLE, "close of a borrowed buffer fails");
+
+    status = psl__MappingModeBuffers_Release(&buffers);
+    CHECK_ERROR(status);
+    CHECK(!psl__MappingModeBuffers_Active_Borrowed(&buffers), "A is released");
+
+    /*
+     * Done, as buffer_done does, then the full Next swaps in.
+     */
+    CHECK_ERROR(psl__MappingModeBuffers_Active_Clear(&buffers));
+    CHECK(psl__MappingModeBuffers_Update(&buffers), "released Active swaps out");
+    CHECK(psl__MappingModeBuffers_Active_Label(&buffers) == 'B', "B is Active");
+
+    status = psl__MappingModeBuffers_Borrow(&buffers, &data, &size);
+    CHECK_ERROR(status);
+    CHECK((size == SIZE) && (data[0] == 2), "borrow lends B's data");
+    CHECK_ERROR(psl__MappingModeBuffers_Release(&buffers));
+
+    status = psl__MappingModeBuffers_Close(&buffers);
+    CHECK_ERROR(status);
+
+    printf("Borrow checks passed\n");
+
+    xiaExit();
+
+    return 0;
+}
+
+static void CHECK(boolean_t test, const char* what)
+{
+    if (!test) {
+        int status2;
+        printf("error: %s\n", what);
+        status2 = xiaExit();
+        if (status2 != XIA_SUCCESS)
+            printf("Handel exit failed, Status = %d\n", status2);
+        exit(1);
+    }
+}
+
+/*
+ * This is just an example of how to handle error values.  A program
+ * of any reasonable size should implement a more robust error
+ * handling mechanism.
+ */
+static void CHECK_ERROR(int status)
+{
+    /* XIA_SUCCESS is defined in handel_errors.h */
+    if (status != XIA_SUCCESS) {
+        int status2;
+        printf("Error encountered (exiting)! Status = %d\n", status);
+        status2 = xiaExit();
+        if (status2 != XIA_SUCCESS)
+            printf("Handel exit failed, Status = %d\n", status2);
+        exit(status);
+    }
+}
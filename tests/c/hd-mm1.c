@@ -58,6 +58,7 @@
 
 
 static int SEC_SLEEP(double time);
+static void wait_for_buffer(double time);
 static void print_usage(void);
 
 
@@ -85,6 +86,7 @@ int main(int argc, char *argv[])
     double variant = 2.0;
     double num_map_pixels = 0.0;
     double num_map_pixels_per_buffer = 16.0;
+    double mapping_buffer_count = 2.0;
     double n_secs = 0.0;
     double n_hrs = 0.0;
     int sync = 0; /* if true no manual advance */
@@ -96,11 +98,21 @@ int main(int argc, char *argv[])
         "buffer_b"
     };
 
+    const char *buffer_ptr_str[2] = {
+        "buffer_a_ptr",
+        "buffer_b_ptr"
+    };
+
     const char *buffer_full_str[2] = {
         "buffer_full_a",
         "buffer_full_b"
     };
 
+    /* The polled run data is resolved to handles once. */
+    int buffer_full_handle[2];
+    int run_active_handle;
+    int current_pixel_handle;
+
     const char buffer_done_char[2] = {
         'a',
         'b'
@@ -120,6 +132,7 @@ int main(int argc, char *argv[])
 
     double wait_period = 0.050; /* 50 msecs */
     int quiet = 0;
+    int zero_copy = 0;
 
     int arg = 1;
 
@@ -186,6 +199,16 @@ int main(int argc, char *argv[])
                 sscanf(argv[arg], "%lf", &num_map_pixels_per_buffer);
                 ++arg;
                 break;
+            case 'N':
+                ++arg;
+                if (arg >= argc) {
+                    fprintf(stderr,
+                            "error: -N requires the number of mapping buffers\n");
+                    exit(1);
+                }
+                sscanf(argv[arg], "%lf", &mapping_buffer_count);
+                ++arg;
+                break;
             case 's':
                 sync = 1;
                 ++arg;
@@ -225,6 +248,10 @@ int main(int argc, char *argv[])
                 quiet = 1;
                 ++arg;
                 break;
+            case 'z':
+                zero_copy = 1;
+                ++arg;
+                break;
             case 'Q':
                 quiet = 2;
                 ++arg;
@@ -325,6 +352,17 @@ int main(int argc, char *argv[])
                     num_map_pixels_per_buffer);
             exit(1);
         }
+
+        status = xiaSetAcquisitionValues(-1, "mapping_buffer_count",
+                                         &mapping_buffer_count);
+
+        if (status != XIA_SUCCESS) {
+            xiaExit();
+
+            fprintf(stderr, "Error setting 'mapping_buffer_count' to %.1f.\n",
+                    mapping_buffer_count);
+            exit(1);
+        }
     }
     else if (mode == 3.0) {
         status = xiaSetAcquisitionValues(-1, "list_mode_variant", &variant);
@@ -382,6 +420,21 @@ int main(int argc, char *argv[])
         exit(1);
     }
 
+    status = xiaGetRunDataHandle(0, "run_active", &run_active_handle);
+    if (status == XIA_SUCCESS)
+        status = xiaGetRunDataHandle(0, "current_pixel", &current_pixel_handle);
+    if (status == XIA_SUCCESS)
+        status = xiaGetRunDataHandle(0, buffer_full_str[A], &buffer_full_handle[A]);
+    if (status == XIA_SUCCESS)
+        status = xiaGetRunDataHandle(0, buffer_full_str[B], &buffer_full_handle[B]);
+
+    if (status != XIA_SUCCESS) {
+        xiaExit();
+
+        fprintf(stderr, "Error resolving the run data handles.\n");
+        exit(1);
+    }
+
     bufferSize = bufferLength * sizeof(uint32_t);
     buffer = malloc(bufferSize);
 
@@ -463,7 +516,7 @@ int main(int argc, char *argv[])
                 active[det] = 0;
                 buffer_full[det] = 0;
 
-                status = xiaGetRunData(det, "run_active", &active[det]);
+                status = xiaGetRunDataByHandle(det, run_active_handle, &active[det]);
 
                 if (status != XIA_SUCCESS) {
                     xiaStopRun(-1);
@@ -488,9 +541,9 @@ int main(int argc, char *argv[])
                     }
                 }
 
-                status = xiaGetRunData(det,
-                                       buffer_full_str[current[det]],
-                                       &buffer_full[det]);
+                status = xiaGetRunDataByHandle(det,
+                                               buffer_full_handle[current[det]],
+                                               &buffer_full[det]);
 
                 if (status != XIA_SUCCESS) {
                     xiaStopRun(-1);
@@ -534,8 +587,16 @@ int main(int argc, char *argv[])
                     any_buffer_full = 1;
             }
 
-            if (!any_buffer_full)
-                SEC_SLEEP(wait_period);
+            /*
+             * With external sync there is no pixel to advance so wait for
+             * a buffer to fill rather than sleep.
+             */
+            if (!any_buffer_full) {
+                if (sync)
+                    wait_for_buffer(wait_period);
+                else
+                    SEC_SLEEP(wait_period);
+            }
 
             ++polls;
 
@@ -564,17 +625,26 @@ int main(int argc, char *argv[])
         printf("\n");
 
         for (det = 0; det < det_channels; ++det) {
-            uint16_t *in = (uint16_t *) buffer;
+            const uint32_t *data = buffer;
+            uint16_t *in;
             uint32_t buffer_size_u16;
 
             if (buffer_full[det]) {
-                status = xiaGetRunData(det, buffer_str[current[det]], buffer);
+                char c = buffer_done_char[current[det]];
+
+                if (zero_copy) {
+                    status = xiaGetRunData(det, buffer_ptr_str[current[det]],
+                                           (void*) &data);
+                } else {
+                    status = xiaGetRunData(det, buffer_str[current[det]], buffer);
+                }
 
                 if (status != XIA_SUCCESS) {
                     xiaStopRun(-1);
                     xiaExit();
 
                     fprintf(stderr, "Error reading '%s'.\n",
+                            zero_copy ? buffer_ptr_str[current[det]] :
                             buffer_str[current[det]]);
                     for (det = 0; det < det_channels; ++det)
                         fclose(fp[det]);
@@ -582,8 +652,11 @@ int main(int argc, char *argv[])
                     exit(1);
                 }
 
-                char c = buffer_done_char[current[det]];
-                status = xiaBoardOperation(det, "buffer_done", (void*) &c);
+                in = (uint16_t *) data;
+
+                /* A borrowed buffer is released once it has been written. */
+                if (!zero_copy)
+                    status = xiaBoardOperation(det, "buffer_done", (void*) &c);
 
                 if (status != XIA_SUCCESS) {
                     xiaStopRun(-1);
@@ -597,9 +670,9 @@ int main(int argc, char *argv[])
                     exit(1);
                 }
 
-                status = xiaGetRunData(det,
-                                       buffer_full_str[current[det]],
-                                       &buffer_full[det]);
+                status = xiaGetRunDataByHandle(det,
+                                               buffer_full_handle[current[det]],
+                                               &buffer_full[det]);
 
                 if (status != XIA_SUCCESS) {
                     xiaStopRun(-1);
@@ -613,7 +686,8 @@ int main(int argc, char *argv[])
                     exit(1);
                 }
 
-                status = xiaGetRunData(det, "current_pixel", &det_current_pixel);
+                status = xiaGetRunDataByHandle(det, current_pixel_handle,
+                                               &det_current_pixel);
 
                 if (status != XIA_SUCCESS) {
                     xiaStopRun(-1);
@@ -645,7 +719,7 @@ int main(int argc, char *argv[])
                         buffer_full[det]);
 
                 if (quiet < 2) {
-                    if (fwrite(&buffer[0], sizeof(uint16_t),
+                    if (fwrite(&data[0], sizeof(uint16_t),
                                buffer_size_u16, fp[det]) != buffer_size_u16) {
                         xiaStopRun(-1);
                         xiaExit();
@@ -658,6 +732,21 @@ int main(int argc, char *argv[])
                     }
                 }
 
+                if (zero_copy) {
+                    status = xiaBoardOperation(det, "buffer_release", (void*) &c);
+
+                    if (status != XIA_SUCCESS) {
+                        xiaStopRun(-1);
+                        xiaExit();
+
+                        fprintf(stderr, "Error releasing buffer '%c'.\n", c);
+                        for (det = 0; det < det_channels; ++det)
+                            fclose(fp[det]);
+                        free(buffer);
+                        exit(1);
+                    }
+                }
+
                 current[det] = SWAP_BUFFER(current[det]);
                 buffer_number[det]++;
             }
@@ -667,9 +756,9 @@ int main(int argc, char *argv[])
             /* Verify buffer full reports false after all pixels are processed. */
             if (num_map_pixels > 0) {
                 for (det = 0; det < det_channels; ++det) {
-                    status = xiaGetRunData(det,
-                                           buffer_full_str[current[det]],
-                                           &buffer_full[det]);
+                    status = xiaGetRunDataByHandle(det,
+                                                   buffer_full_handle[current[det]],
+                                                   &buffer_full[det]);
 
                     if (status != XIA_SUCCESS) {
                         xiaStopRun(-1);
@@ -749,6 +838,21 @@ static int SEC_SLEEP(double time)
 }
 
 
+/*
+ * Wait up to the time in seconds for a buffer of any channel to fill or
+ * the run to stop.
+ */
+static void wait_for_buffer(double time)
+{
+    int status;
+    int ready_det = -1;
+    int ready_buffer = -1;
+
+    status = xiaWaitForBuffer(-1, (int) (time * 1000.0), &ready_det, &ready_buffer);
+    if ((status != XIA_SUCCESS) && (status != XIA_TIMEOUT))
+        fprintf(stderr, "Error waiting for a buffer: %d\n", status);
+}
+
 static void print_usage(void)
 {
     fprintf(stdout,
@@ -761,14 +865,17 @@ static void print_usage(void)
             " -S seconds   : seconds to run the capture\n" \
             " -P pixels    : pixels to capture\n" \
             " -B pixels    : pixels per buffer\n" \
+            " -N buffers   : number of mapping buffers in the ring\n" \
             " -s           : external sync, no manual pixel advance\n" \
             " -w msecs     : wait period in milli-seconds\n" \
             " -d detectors : number of detector channels\n" \
             " -m mca_size  : override number of MCA channels\n" \
             " -q           : quiet, no Handel debug output\n" \
             " -Q           : quiet, no debug output or buffer files\n" \
+            " -z           : zero-copy, borrow the buffers in place\n" \
             "Where:\n" \
             " Pixels to capture overrides hours which overrides seconds.\n" \
-            " Wait time in milli-seconds defines the polling rate.\n");
+            " Wait time in milli-seconds defines the polling rate. With\n" \
+            " external sync the wait ends when a buffer fills.\n");
     return;
 }
@@ -60,7 +60,7 @@
 #include "md_generic.h"
 
 
-static int SEC_SLEEP(double time);
+static void wait_for_buffer(double time);
 static void print_usage(void);
 static void check_error(int status, char* function);
 static void clean_up();
@@ -332,7 +332,7 @@ int main(int argc, char *argv[])
             }
 
             if (!any_buffer_full)
-                SEC_SLEEP(wait_period);
+                wait_for_buffer(wait_period);
 
             ++polls;
 
@@ -414,30 +414,20 @@ int main(int argc, char *argv[])
 }
 
 
-static int SEC_SLEEP(double time)
+/*
+ * Wait up to the time in seconds for a buffer of any channel to fill or
+ * the run to stop.
+ */
+static void wait_for_buffer(double time)
 {
-#ifdef WIN32
-    DWORD wait = (DWORD)(1000.0 * (time));
-    Sleep(wait);
-#else
-    unsigned long secs = (unsigned long) time;
-    struct timespec req = {
-        .tv_sec = (time_t) secs,
-        .tv_nsec = (time_t) ((time - secs) * 1000000000.0)
-    };
-    struct timespec rem = {
-      .tv_sec = 0,
-      .tv_nsec = 0
-    };
-    while (TRUE_) {
-        if (nanosleep(&req, &rem) == 0)
-            break;
-        req = rem;
-    }
-#endif
-    return XIA_SUCCESS;
-}
+    int status;
+    int ready_det = -1;
+    int ready_buffer = -1;
 
+    status = xiaWaitForBuffer(-1, (int) (time * 1000.0), &ready_det, &ready_buffer);
+    if ((status != XIA_SUCCESS) && (status != XIA_TIMEOUT))
+        fprintf(stderr, "Error waiting for a buffer: %d\n", status);
+}
 
 static void print_usage(void)
 {
@@ -454,7 +444,7 @@ static void print_usage(void)
             " -q           : quiet, no Handel debug output\n" \
             "Where:\n" \
             " ListMode data captured for hours which overrides seconds.\n" \
-            " Wait time in milli-seconds defines the polling rate.\n");
+            " Wait time in milli-seconds is the longest wait for a buffer.\n");
     return;
 }
 
@@ -74,6 +74,7 @@ static const AcqNameValues falconxn_values[] =
         { "num_map_pixels", 0, 1ull << 32 },
         { "num_map_pixels_per_buffer", 0, 1024 },
         { "num_map_pixels_per_buffer", -1, 1024 },
+        { "mapping_buffer_count", 8, 2 },
         { "pixel_advance_mode", 0, 1 },
         { NULL, 0, 0 }
     };